@@ -0,0 +1,238 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "accontrol.hpp"
+#include "ircontrol.hpp"
+
+#if IRGW_AC
+
+extern IRControl irControl;
+extern AcControl acControl;
+
+AcControl::AcControl() {
+    for (uint8_t i = 0; i < PARAM_MAX_AC; i++) {
+        reset(i);
+    }
+}
+
+int8_t AcControl::find(const char *name) const {
+    const AcUnit_t *configs = Parameter.acUnits();
+
+    for (int8_t i = 0; i < PARAM_MAX_AC; i++) {
+        if (configs[i].name[0] != 0 && 
+                strcasecmp(configs[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+stdAc::state_t AcControl::getState(uint8_t idx) const {
+    stdAc::state_t state = units[idx].desired;
+
+    state.protocol = (decode_type_t) Parameter.acUnits()[idx].protocol;
+    state.model = Parameter.acUnits()[idx].model;
+
+    return state;
+}
+
+void AcControl::setState(uint8_t idx, const stdAc::state_t &state) {
+    Unit_t *unit = &units[idx];
+
+    if (unit->pending) {
+        unit->stats.merged++;
+    }
+
+    unit->desired = state;
+    unit->pending = true;
+    unit->changed = millis();
+}
+
+void AcControl::reset(uint8_t idx) {
+    Unit_t *unit = &units[idx];
+
+    memset(unit, 0, sizeof(Unit_t));
+    IRac::initState(&unit->desired);
+    unit->sent = unit->desired;
+}
+
+void AcControl::loop(void) {
+    uint32_t now = millis();
+    const AcUnit_t *configs = Parameter.acUnits();
+
+    for (uint8_t i = 0; i < PARAM_MAX_AC; i++) {
+        Unit_t *unit = &units[i];
+        uint8_t channel = configs[i].channel;
+        stdAc::state_t state;
+
+        if (!unit->pending || now - unit->changed < AC_DEBOUNCE) {
+            continue;
+        }
+
+        if (irControl.isBusy(channel)) {
+            continue;
+        }
+
+        unit->pending = false;
+        state = getState(i);
+
+        if (unit->valid && !IRac::cmpState(unit->sent, state)) {
+            unit->stats.skipped++;
+            continue;
+        }
+
+        if (irControl.transmitAc(state, unit->valid ? &unit->sent : nullptr, channel)) {
+            unit->sent = state;
+            unit->valid = true;
+            unit->stats.sent++;
+        }
+    }
+}
+
+String AcControl::getStateString(uint8_t idx) const {
+    const Unit_t *unit = &units[idx];
+    stdAc::state_t state = getState(idx);
+    String data = String(Parameter.acUnits()[idx].name);
+
+    data += "; " + typeToString(state.protocol);
+    data += "; power " + String(state.power ? "on" : "off");
+    data += "; mode " + IRac::opmodeToString(state.mode);
+    data += "; temp " + String(state.degrees, 1);
+    data += "; fan " + IRac::fanspeedToString(state.fanspeed);
+    data += "; swing " + IRac::swingvToString(state.swingv);
+    data += unit->pending ? "; pending" : (unit->valid ? "; sent" : "; unknown");
+    data += "; sent " + String(unit->stats.sent) + ", skipped " + String(unit->stats.skipped) + 
+            ", merged " + String(unit->stats.merged) + "\n";
+
+    return data;
+}
+
+String AcControl::getStateString(void) const {
+    String data;
+    const AcUnit_t *configs = Parameter.acUnits();
+
+    for (uint8_t i = 0; i < PARAM_MAX_AC; i++) {
+        if (configs[i].name[0] != 0) {
+            data += getStateString(i);
+        }
+    }
+
+    if (data.length() == 0) {
+        data = "none\n";
+    }
+
+    return data;
+}
+
+int8_t ac_list(void) {
+    const AcUnit_t *configs = Parameter.acUnits();
+
+    Serial.printf("  #  Name             Type         Model  Channel\n");
+    for (uint8_t i = 0; i < PARAM_MAX_AC; i++) {
+        const AcUnit_t *unit = &configs[i];
+
+        if (unit->name[0] == 0) {
+            continue;
+        }
+
+        Serial.printf("  %u  %-15s  %-11s  %-5d  %u\n", i, unit->name,
+                typeToString((decode_type_t) unit->protocol).c_str(), unit->model,
+                unit->channel);
+    }
+
+    return 0;
+}
+
+int8_t ac_set(int argc, char *argv[]) {
+    AcUnit_t unit;
+    int idx = 0;
+    int channel = 0;
+
+    if (argc < 4 || argc > 6) {
+        Serial.printf("Error: Usage: ac set idx name type [model] [channel]\n");
+        return -1;
+    }
+
+    idx = atoi(argv[1]);
+    if (idx < 0 || idx >= PARAM_MAX_AC) {
+        Serial.printf("Error: Invalid index, valid range is 0 to %u\n", PARAM_MAX_AC - 1);
+        return -1;
+    }
+
+    memset(&unit, 0, sizeof(unit));
+    strncpy(unit.name, argv[2], sizeof(unit.name) - 1);
+    unit.protocol = irControl.stringToIRType(argv[3]);
+    if (!IRac::isProtocolSupported((decode_type_t) unit.protocol)) {
+        Serial.printf("Error: Type is not supported by IRac.\n");
+        return -1;
+    }
+
+    unit.model = argc > 4 ? atoi(argv[4]) : -1;
+    channel = argc > 5 ? atoi(argv[5]) : 0;
+    if (channel < 0 || channel >= IRTX_CHANNELS) {
+        Serial.printf("Error: Invalid channel, valid range is 0 to %u\n", IRTX_CHANNELS - 1);
+        return -1;
+    }
+    unit.channel = channel;
+
+    Parameter.acUnits()[idx] = unit;
+    acControl.reset(idx);
+
+    return 0;
+}
+
+int8_t ac_del(const char *pIdx) {
+    int idx = pIdx == nullptr ? -1 : atoi(pIdx);
+
+    if (idx < 0 || idx >= PARAM_MAX_AC) {
+        Serial.printf("Error: Invalid index, valid range is 0 to %u\n", PARAM_MAX_AC - 1);
+        return -1;
+    }
+
+    memset(&Parameter.acUnits()[idx], 0, sizeof(AcUnit_t));
+    acControl.reset(idx);
+    return 0;
+}
+
+CLI_COMMAND(ac) {
+    if (argc == 0 || strcmp(argv[0], "list") == 0) {
+        return ac_list();
+    }
+
+    if (strcmp(argv[0], "set") == 0) {
+        return ac_set(argc, argv);
+    }
+
+    if (strcmp(argv[0], "del") == 0) {
+        return ac_del(argv[1]);
+    }
+
+    if (strcmp(argv[0], "state") == 0) {
+        Serial.print(acControl.getStateString());
+        return 0;
+    }
+
+    Serial.printf("Error: Invalid command!\n");
+    return -1;
+}
+
+#endif /* IRGW_AC */
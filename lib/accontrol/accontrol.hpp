@@ -0,0 +1,124 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRac.h>
+
+#include "parameter.hpp"
+
+/**
+ * @brief Time in ms a changed state has to be stable before it is sent.
+ */
+#define AC_DEBOUNCE                 500
+
+/**
+ * @brief Air conditioner control.
+ * Keeps the desired and the last sent state of each configured unit. Changes
+ * are collected until the state has been stable for AC_DEBOUNCE ms, e.g. 
+ * while a temperature slider is moved, and are sent as a single frame. 
+ * Nothing is sent if the state equals the one sent last.
+ */
+class AcControl {
+    public:
+
+        /**
+         * @brief Statistics of a unit.
+         */
+        typedef struct {
+            uint32_t sent;
+            uint32_t skipped;
+            uint32_t merged;
+        } Stats_t;
+
+        /**
+         * @brief Constructor
+         */
+        AcControl();
+
+        /**
+         * @brief Find a unit by name.
+         * @param name The name of the unit.
+         * @return The unit index or -1 if not found.
+         */
+        int8_t find(const char *name) const;
+
+        /**
+         * @brief Get the desired state of a unit.
+         * @param idx The unit index.
+         * @return The pending state or the one sent last.
+         */
+        stdAc::state_t getState(uint8_t idx) const;
+
+        /**
+         * @brief Set the desired state of a unit.
+         * The state is sent by loop() after the debounce time.
+         * @param idx The unit index.
+         * @param state The desired state.
+         */
+        void setState(uint8_t idx, const stdAc::state_t &state);
+
+        /**
+         * @brief Forget the state of a unit, has to be called after the unit
+         * has been configured.
+         * @param idx The unit index.
+         */
+        void reset(uint8_t idx);
+
+        /**
+         * @brief Send the pending states which are due. Has to be called 
+         * cyclically.
+         */
+        void loop(void);
+
+        /**
+         * @brief Get the state of a unit as text.
+         * @param idx The unit index.
+         * @return The state and statistics.
+         */
+        String getStateString(uint8_t idx) const;
+
+        /**
+         * @brief Get the state of all configured units as text.
+         * @return One line per unit.
+         */
+        String getStateString(void) const;
+
+    private:
+
+        /**
+         * @brief State of a unit.
+         */
+        typedef struct {
+            stdAc::state_t sent;
+            stdAc::state_t desired;
+            bool valid;
+            bool pending;
+            uint32_t changed;
+            Stats_t stats;
+        } Unit_t;
+
+        /**
+         * @brief The unit states.
+         */
+        Unit_t units[PARAM_MAX_AC];
+};
@@ -0,0 +1,78 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "bootprofile.hpp"
+
+/**
+ * @brief Names of the phases, indexed by BootPhase_t.
+ */
+static const char *phaseNames[BOOT_PHASES] = {
+    "param", "ir", "cli", "network", "server", "setup", "wifi", "mdns", 
+    "ntp", "time", "first-tx"
+};
+
+BootProfile::BootProfile() {
+    memset(stamps, 0, sizeof(stamps));
+}
+
+void BootProfile::mark(BootPhase_t phase) {
+    if (stamps[phase] == 0) {
+        /* micros() counts from reset, 0 is reserved for not reached */
+        stamps[phase] = max((uint32_t) micros(), (uint32_t) 1);
+    }
+}
+
+bool BootProfile::reached(BootPhase_t phase) const {
+    return stamps[phase] != 0;
+}
+
+uint32_t BootProfile::get(BootPhase_t phase) const {
+    return stamps[phase];
+}
+
+String BootProfile::getString(void) const {
+    char buf[64];
+    String ret;
+
+    for (uint8_t i = 0; i < BOOT_PHASES; i++) {
+        uint32_t last = 0;
+
+        /* Background phases may complete in any order */
+        for (uint8_t j = 0; j < BOOT_PHASES; j++) {
+            if (stamps[j] < stamps[i] && stamps[j] > last) {
+                last = stamps[j];
+            }
+        }
+
+        if (stamps[i] == 0) {
+            snprintf(buf, sizeof(buf), "  %-10s   -\n", phaseNames[i]);
+        } else {
+            snprintf(buf, sizeof(buf), "  %-10s %8lu.%03lums (+%lu.%03lums)\n", 
+                phaseNames[i], 
+                (unsigned long) stamps[i] / 1000, (unsigned long) stamps[i] % 1000,
+                (unsigned long) (stamps[i] - last) / 1000, 
+                (unsigned long) (stamps[i] - last) % 1000);
+        }
+        ret += buf;
+    }
+
+    return ret;
+}
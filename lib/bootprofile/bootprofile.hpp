@@ -0,0 +1,91 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief The phases of the startup, in the order they are expected.
+ */
+typedef enum {
+    BOOT_PHASE_PARAM = 0,
+    BOOT_PHASE_IR,
+    BOOT_PHASE_CLI,
+    BOOT_PHASE_NETWORK,
+    BOOT_PHASE_SERVER,
+    BOOT_PHASE_SETUP,
+    BOOT_PHASE_WIFI,
+    BOOT_PHASE_MDNS,
+    BOOT_PHASE_NTP,
+    BOOT_PHASE_TIME,
+    BOOT_PHASE_FIRST_TX,
+    BOOT_PHASES
+} BootPhase_t;
+
+/**
+ * @brief Boot phase profiler.
+ * Records the time since reset at which each phase of the startup has been
+ * reached the first time. Phases completing in the background, like the 
+ * WiFi connection, are marked from the loop.
+ */
+class BootProfile {
+    public:
+
+        /**
+         * @brief Construct a new BootProfile object.
+         */
+        BootProfile();
+
+        /**
+         * @brief Record the current time for a phase, unless it has been 
+         * reached before.
+         * @param phase The phase.
+         */
+        void mark(BootPhase_t phase);
+
+        /**
+         * @brief Returns true if a phase has been reached.
+         * @param phase The phase.
+         */
+        bool reached(BootPhase_t phase) const;
+
+        /**
+         * @brief Returns the time since reset in us at which a phase has been
+         * reached, 0 if it has not been reached yet.
+         * @param phase The phase.
+         */
+        uint32_t get(BootPhase_t phase) const;
+
+        /**
+         * @brief Returns the phases as human readable text, one line per 
+         * phase with the time since reset and since the phase reached 
+         * before.
+         */
+        String getString(void) const;
+
+    private:
+
+        /**
+         * @brief The time since reset in us per phase, 0 if not reached.
+         */
+        uint32_t stamps[BOOT_PHASES];
+};
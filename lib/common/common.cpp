@@ -22,33 +22,85 @@
 #include "common.hpp"
 #include <cli/cli.hpp>
 
-bool is32BitHex(const char *str, uint8_t maxlen) {
-    size_t len = strlen(str);
-    if (len > maxlen) {
-        return false;
+static uint8_t hexValue(char c) {
+    return isdigit(c) ? c - '0' : tolower(c) - 'a' + 10;
+}
+
+const char* parseCode(const char *str, uint64_t &code) {
+    const char *pos = str;
+    uint8_t digits = 0;
+
+    code = 0;
+    if (pos[0] == '0' && tolower(pos[1]) == 'x') {
+        for (pos += 2; isxdigit(*pos); pos++) {
+            if (++digits > 16) {
+                return nullptr;
+            }
+            code = (code << 4) | hexValue(*pos);
+        }
+    } else {
+        for (; isdigit(*pos); pos++) {
+            uint8_t digit = *pos - '0';
+
+            if (code > (UINT64_MAX - digit) / 10) {
+                return nullptr;
+            }
+            code = code * 10 + digit;
+            digits++;
+        }
     }
 
+    return digits == 0 ? nullptr : pos;
+}
+
+int16_t parseState(const char *str, uint8_t *state, uint16_t size, const char **end) {
+    const char *pos = str + 2;
+    uint16_t len = 0;
+
     if (str[0] != '0' || tolower(str[1]) != 'x') {
-        return false;
+        return -1;
     }
 
-    for (size_t i = 2; i < len; i++) {
-        if (!isxdigit(str[i])) {
-            return false;
+    for (; isxdigit(pos[0]); pos += 2) {
+        if (!isxdigit(pos[1]) || len == size) {
+            return -1;
         }
+        state[len++] = (hexValue(pos[0]) << 4) | hexValue(pos[1]);
+    }
+
+    if (end != nullptr) {
+        *end = pos;
     }
 
-    return true;
+    return len == 0 ? -1 : len;
+}
+
+String codeToString(uint64_t code) {
+    char buf[19];
+    uint8_t pos = sizeof(buf) - 1;
+
+    buf[pos] = 0;
+    do {
+        buf[--pos] = "0123456789ABCDEF"[code & 0x0F];
+        code >>= 4;
+    } while (code != 0);
+    buf[--pos] = 'x';
+    buf[--pos] = '0';
+
+    return String(&buf[pos]);
 }
 
 String getTimeStamp(void) {
     struct tm timeinfo;
     char timeStringBuff[20];
 
-    if (getLocalTime(&timeinfo)) {
+    /* Must not wait for NTP, IR is up long before the network */
+    if (getLocalTime(&timeinfo, 0)) {
         strftime(timeStringBuff, sizeof(timeStringBuff), "%Y-%m-%d %H:%M:%S", &timeinfo);
     } else {
-        sprintf(timeStringBuff, "ntp error");
+        uint32_t now = millis();
+        snprintf(timeStringBuff, sizeof(timeStringBuff), "up %u.%03us", 
+                (unsigned) (now / 1000), (unsigned) (now % 1000));
     }
 
     return String(timeStringBuff);
@@ -25,29 +25,110 @@
 #include <version/version.h>
 
 /**
- * Pin definitions
+ * Pin definitions, the IR pins can be set via build flags.
  */
 #define WIFILED_PIN         2
 #define WIFILED_ON          digitalWrite(LED_BUILTIN, 1)
 #define WIFILED_OFF         digitalWrite(LED_BUILTIN, 0)
+#ifndef IRTX_PIN
 #define IRTX_PIN            22
+#endif
+#ifndef IRRX_PIN
 #define IRRX_PIN            23
+#endif
 #define DEBUG_A_PIN         19
 #define DEBUG_B_PIN         18
 
 /**
- * @brief Check if the string is a valid 32-bit hex number.
- * @param str The string to check.
- * @param maxlen The maximum length of the string, default is 10.
- * @return true if the string is a valid 32-bit hex number, false otherwise.
- * @note The string must start with "0x" and can contain up to 8 hex digits.
- *       The maximum length includes the "0x" prefix.
+ * IR transmit channels, each one drives its own IR LED. The first channel 
+ * uses IRTX_PIN.
  */
-bool is32BitHex(const char *str, uint8_t maxlen = 10);
+#ifndef IRTX_CHANNELS
+#define IRTX_CHANNELS       2
+#define IRTX_PINS           {IRTX_PIN, 21}
+#endif
 
 /**
- * @brief Get the current timestamp.
- * @return The current timestamp as a string.
+ * Feature toggles, set to 0 via build flags to compile a feature out, see 
+ * the build profiles in platformio.ini.
+ * IRGW_WEB: The web server with the web UI and the HTTP API.
+ * IRGW_AC: Air conditioner control via IRac, the largest part of the flash 
+ * image.
+ */
+#ifndef IRGW_WEB
+#define IRGW_WEB            1
+#endif
+#ifndef IRGW_AC
+#define IRGW_AC             1
+#endif
+
+/**
+ * Number of entries of the transmission and reception logs, a power of 2. 
+ * The logs are statically allocated.
+ */
+#ifndef IRLOG_SIZE
+#define IRLOG_SIZE          32
+#endif
+
+/**
+ * IR transmit driver selection, set to 0 to generate the carrier in software
+ * via IRsend instead of using the RMT peripheral.
+ */
+#ifndef IRTX_USE_RMT
+#define IRTX_USE_RMT        1
+#endif
+
+/**
+ * IR receive buffer size in timings, large enough to capture raw codes for 
+ * the learn mode.
+ */
+#define IRRX_BUFSIZE        300
+
+/**
+ * Size of the last log entries in the IR statistics snapshot, longer ones 
+ * are truncated.
+ */
+#define IRSTATS_ENTRY_SIZE  96
+
+/**
+ * Time in ms without a frame after which a held button is released.
+ */
+#define IRRX_HOLD_TIMEOUT   250
+
+/**
+ * @brief Parse a IR code in a single pass.
+ * Hex numbers start with "0x" and may have up to 16 digits, all other numbers
+ * are parsed as decimal.
+ * @param str The string to parse.
+ * @param code Stores the parsed code.
+ * @return Pointer to the first character after the code, nullptr if there 
+ *         are no digits or the code exceeds 64 bit.
+ */
+const char* parseCode(const char *str, uint64_t &code);
+
+/**
+ * @brief Parse the state of a state based protocol in a single pass.
+ * The state is given as hex number with "0x" prefix and two digits per byte,
+ * the first byte first, as printed by resultToHexidecimal().
+ * @param str The string to parse.
+ * @param state Stores the parsed bytes.
+ * @param size The size of the state buffer.
+ * @param end Optionally stores the pointer to the first character after the 
+ *        state.
+ * @return The number of bytes, -1 on error.
+ */
+int16_t parseState(const char *str, uint8_t *state, uint16_t size, const char **end = nullptr);
+
+/**
+ * @brief Format a IR code as hex number with "0x" prefix.
+ * @param code The code.
+ * @return The formatted code.
+ */
+String codeToString(uint64_t code);
+
+/**
+ * @brief Get the current timestamp, does not wait for the time to be synced.
+ * @return The local time or the uptime as long as NTP has not synced yet.
  */
 String getTimeStamp(void);
 
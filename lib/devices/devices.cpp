@@ -0,0 +1,444 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "devices.hpp"
+#include "ircontrol.hpp"
+
+extern IRControl irControl;
+extern DeviceTable deviceTable;
+
+const char * const effectNames[] = {"none", "on", "off", "toggle", "input"};
+
+DeviceTable::DeviceTable() {
+    for (int8_t i = 0; i < PARAM_MAX_DEVICES; i++) {
+        resetState(i);
+    }
+}
+
+int8_t DeviceTable::find(decode_type_t type, uint64_t code) const {
+    const Device_t *devices = Parameter.devices();
+
+    for (int8_t i = 0; i < PARAM_MAX_DEVICES; i++) {
+        const Device_t *dev = &devices[i];
+
+        if (dev->name[0] != 0 && dev->protocol == type && 
+                (code & dev->mask) == dev->match) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+const Device_t* DeviceTable::get(int8_t idx) const {
+    if (idx < 0 || idx >= PARAM_MAX_DEVICES) {
+        return nullptr;
+    }
+
+    if (Parameter.devices()[idx].name[0] == 0) {
+        return nullptr;
+    }
+
+    return &Parameter.devices()[idx];
+}
+
+int8_t DeviceTable::findByName(const char *name) const {
+    const Device_t *devices = Parameter.devices();
+
+    for (int8_t i = 0; i < PARAM_MAX_DEVICES; i++) {
+        if (devices[i].name[0] != 0 && 
+                strcasecmp(devices[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+const CatalogEntry_t* DeviceTable::findCatalog(decode_type_t type, uint64_t code) const {
+    const CatalogEntry_t *catalog = Parameter.catalog();
+
+    for (uint8_t i = 0; i < PARAM_MAX_CATALOG; i++) {
+        const CatalogEntry_t *entry = &catalog[i];
+
+        if (entry->name[0] != 0 && entry->protocol == type && entry->code == code) {
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+void DeviceTable::observe(decode_type_t type, uint64_t code) {
+    const CatalogEntry_t *entry = findCatalog(type, code);
+    int8_t idx = find(type, code);
+    State_t *dev = nullptr;
+
+    if (entry == nullptr || idx < 0) {
+        return;
+    }
+
+    dev = &state[idx];
+    switch (entry->effect) {
+        case CATALOG_EFFECT_POWER_ON:
+            dev->power = 1;
+            break;
+
+        case CATALOG_EFFECT_POWER_OFF:
+            dev->power = 0;
+            break;
+
+        case CATALOG_EFFECT_POWER_TOGGLE:
+            if (dev->power != -1) {
+                dev->power = !dev->power;
+            }
+            break;
+
+        case CATALOG_EFFECT_INPUT:
+            dev->input = entry->value;
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool DeviceTable::skip(decode_type_t type, uint64_t code) {
+    const CatalogEntry_t *entry = findCatalog(type, code);
+    int8_t idx = find(type, code);
+    bool redundant = false;
+
+    if (entry == nullptr || idx < 0) {
+        return false;
+    }
+
+    switch (entry->effect) {
+        case CATALOG_EFFECT_POWER_ON:
+            redundant = state[idx].power == 1;
+            break;
+
+        case CATALOG_EFFECT_POWER_OFF:
+            redundant = state[idx].power == 0;
+            break;
+
+        case CATALOG_EFFECT_INPUT:
+            redundant = state[idx].input != 0 && state[idx].input == entry->value;
+            break;
+
+        default:
+            break;
+    }
+
+    if (redundant) {
+        state[idx].skipped++;
+    }
+
+    return redundant;
+}
+
+const DeviceTable::State_t* DeviceTable::getState(int8_t idx) const {
+    if (idx < 0 || idx >= PARAM_MAX_DEVICES) {
+        return nullptr;
+    }
+
+    return &state[idx];
+}
+
+void DeviceTable::resetState(int8_t idx) {
+    if (idx < 0 || idx >= PARAM_MAX_DEVICES) {
+        return;
+    }
+
+    state[idx].power = -1;
+    state[idx].input = 0;
+    state[idx].skipped = 0;
+}
+
+String DeviceTable::getStateString(void) const {
+    String data;
+
+    for (int8_t i = 0; i < PARAM_MAX_DEVICES; i++) {
+        const Device_t *dev = get(i);
+        char line[80];
+
+        if (dev == nullptr) {
+            continue;
+        }
+
+        snprintf(line, sizeof(line), "%s; power %s; input %u; skipped %u\n", 
+                dev->name, state[i].power == -1 ? "unknown" : state[i].power ? "on" : "off",
+                state[i].input, state[i].skipped);
+        data += line;
+    }
+
+    if (data.length() == 0) {
+        data = "no devices\n";
+    }
+
+    return data;
+}
+
+int8_t dev_list(void) {
+    Serial.printf("  #  Name             Type       Match               Mask                Gap    Settle Coalesce Channel\n");
+    for (int8_t i = 0; i < PARAM_MAX_DEVICES; i++) {
+        const Device_t *dev = deviceTable.get(i);
+
+        if (dev == nullptr) {
+            continue;
+        }
+
+        Serial.printf("  %u  %-15s  %-9s  %-18s  %-18s  %-5u  %-5u  %-7u  %u\n", i, dev->name,
+                typeToString((decode_type_t) dev->protocol).c_str(), 
+                codeToString(dev->match).c_str(), codeToString(dev->mask).c_str(), 
+                dev->gap, dev->settle, dev->coalesce, dev->channel);
+    }
+
+    return 0;
+}
+
+int8_t dev_set(int argc, char *argv[]) {
+    Device_t dev;
+    int idx = 0;
+
+    if (argc != 8 && argc != 9) {
+        Serial.printf("Error: Usage: dev set idx name type match mask gap settle [coalesce]\n");
+        return -1;
+    }
+
+    idx = atoi(argv[1]);
+    if (idx < 0 || idx >= PARAM_MAX_DEVICES) {
+        Serial.printf("Error: Invalid index, valid range is 0 to %u\n", PARAM_MAX_DEVICES - 1);
+        return -1;
+    }
+
+    memset(&dev, 0, sizeof(dev));
+    strncpy(dev.name, argv[2], sizeof(dev.name) - 1);
+    dev.protocol = irControl.stringToIRType(argv[3]);
+    if (dev.protocol == decode_type_t::UNKNOWN) {
+        Serial.printf("Error: Unknown type.\n");
+        return -1;
+    }
+
+    if (parseCode(argv[4], dev.match) == nullptr || parseCode(argv[5], dev.mask) == nullptr) {
+        Serial.printf("Error: Invalid match or mask.\n");
+        return -1;
+    }
+    dev.gap = constrain(atoi(argv[6]), 0, 5000);
+    dev.settle = constrain(atoi(argv[7]), 0, 5000);
+    if (argc == 9) {
+        dev.coalesce = constrain(atoi(argv[8]), 0, 10000);
+    }
+    Parameter.devices()[idx] = dev;
+    deviceTable.resetState(idx);
+
+    return 0;
+}
+
+int8_t dev_route(const char *pIdx, const char *pChannel) {
+    int idx = pIdx == nullptr ? -1 : atoi(pIdx);
+    int channel = pChannel == nullptr ? -1 : atoi(pChannel);
+
+    if (idx < 0 || idx >= PARAM_MAX_DEVICES || Parameter.devices()[idx].name[0] == 0) {
+        Serial.printf("Error: Invalid device index.\n");
+        return -1;
+    }
+
+    if (channel < 0 || channel >= IRTX_CHANNELS) {
+        Serial.printf("Error: Invalid channel, valid range is 0 to %u\n", IRTX_CHANNELS - 1);
+        return -1;
+    }
+
+    Parameter.devices()[idx].channel = channel;
+    return 0;
+}
+
+int8_t dev_del(const char *pIdx) {
+    int idx = pIdx == nullptr ? -1 : atoi(pIdx);
+
+    if (idx < 0 || idx >= PARAM_MAX_DEVICES) {
+        Serial.printf("Error: Invalid index, valid range is 0 to %u\n", PARAM_MAX_DEVICES - 1);
+        return -1;
+    }
+
+    memset(&Parameter.devices()[idx], 0, sizeof(Device_t));
+    deviceTable.resetState(idx);
+    return 0;
+}
+
+CLI_COMMAND(dev) {
+    if (argc == 0 || strcmp(argv[0], "list") == 0) {
+        return dev_list();
+    }
+
+    if (strcmp(argv[0], "set") == 0) {
+        return dev_set(argc, argv);
+    }
+
+    if (strcmp(argv[0], "del") == 0) {
+        return dev_del(argv[1]);
+    }
+
+    if (strcmp(argv[0], "route") == 0) {
+        return dev_route(argv[1], argv[2]);
+    }
+
+    if (strcmp(argv[0], "state") == 0) {
+        Serial.print(deviceTable.getStateString());
+        return 0;
+    }
+
+    Serial.printf("Error: Invalid command!\n");
+    return -1;
+}
+
+int8_t cat_list(void) {
+    const CatalogEntry_t *catalog = Parameter.catalog();
+
+    Serial.printf("  #   Name             Type       Code                Channel  Effect\n");
+    for (uint8_t i = 0; i < PARAM_MAX_CATALOG; i++) {
+        const CatalogEntry_t *entry = &catalog[i];
+
+        if (entry->name[0] == 0) {
+            continue;
+        }
+
+        Serial.printf("  %-2u  %-15s  %-9s  %-18s  %-7s  %s", i, entry->name,
+                typeToString((decode_type_t) entry->protocol).c_str(), 
+                codeToString(entry->code).c_str(), 
+                entry->channel < 0 ? "device" : String(entry->channel).c_str(),
+                effectNames[entry->effect]);
+        if (entry->effect == CATALOG_EFFECT_INPUT) {
+            Serial.printf(" %u", entry->value);
+        }
+        Serial.printf("\n");
+    }
+
+    return 0;
+}
+
+int8_t cat_set(int argc, char *argv[]) {
+    CatalogEntry_t entry;
+    int idx = 0;
+
+    if (argc < 5 || argc > 7) {
+        Serial.printf("Error: Usage: cat set idx name type code [effect] [value]\n");
+        return -1;
+    }
+
+    idx = atoi(argv[1]);
+    if (idx < 0 || idx >= PARAM_MAX_CATALOG) {
+        Serial.printf("Error: Invalid index, valid range is 0 to %u\n", PARAM_MAX_CATALOG - 1);
+        return -1;
+    }
+
+    memset(&entry, 0, sizeof(entry));
+    entry.channel = -1;
+    strncpy(entry.name, argv[2], sizeof(entry.name) - 1);
+    entry.protocol = irControl.stringToIRType(argv[3]);
+    if (entry.protocol == decode_type_t::UNKNOWN) {
+        Serial.printf("Error: Unknown type.\n");
+        return -1;
+    }
+    if (parseCode(argv[4], entry.code) == nullptr) {
+        Serial.printf("Error: Invalid code.\n");
+        return -1;
+    }
+
+    if (argc >= 6) {
+        uint8_t effect = 0;
+
+        while (effect <= CATALOG_EFFECT_INPUT && strcmp(argv[5], effectNames[effect]) != 0) {
+            effect++;
+        }
+
+        if (effect > CATALOG_EFFECT_INPUT) {
+            Serial.printf("Error: Invalid effect, use none, on, off, toggle or input.\n");
+            return -1;
+        }
+        entry.effect = effect;
+    }
+
+    if (entry.effect == CATALOG_EFFECT_INPUT) {
+        if (argc != 7 || atoi(argv[6]) < 1) {
+            Serial.printf("Error: The input effect requires an input number >= 1.\n");
+            return -1;
+        }
+        entry.value = constrain(atoi(argv[6]), 1, 255);
+    }
+
+    Parameter.catalog()[idx] = entry;
+    return 0;
+}
+
+int8_t cat_route(const char *pIdx, const char *pChannel) {
+    int idx = pIdx == nullptr ? -1 : atoi(pIdx);
+    int channel = -2;
+
+    if (idx < 0 || idx >= PARAM_MAX_CATALOG || Parameter.catalog()[idx].name[0] == 0) {
+        Serial.printf("Error: Invalid catalog index.\n");
+        return -1;
+    }
+
+    if (pChannel != nullptr) {
+        channel = strcmp(pChannel, "device") == 0 ? -1 : atoi(pChannel);
+    }
+
+    if (channel < -1 || channel >= IRTX_CHANNELS) {
+        Serial.printf("Error: Invalid channel, use device or 0 to %u\n", IRTX_CHANNELS - 1);
+        return -1;
+    }
+
+    Parameter.catalog()[idx].channel = channel;
+    return 0;
+}
+
+int8_t cat_del(const char *pIdx) {
+    int idx = pIdx == nullptr ? -1 : atoi(pIdx);
+
+    if (idx < 0 || idx >= PARAM_MAX_CATALOG) {
+        Serial.printf("Error: Invalid index, valid range is 0 to %u\n", PARAM_MAX_CATALOG - 1);
+        return -1;
+    }
+
+    memset(&Parameter.catalog()[idx], 0, sizeof(CatalogEntry_t));
+    return 0;
+}
+
+CLI_COMMAND(cat) {
+    if (argc == 0 || strcmp(argv[0], "list") == 0) {
+        return cat_list();
+    }
+
+    if (strcmp(argv[0], "set") == 0) {
+        return cat_set(argc, argv);
+    }
+
+    if (strcmp(argv[0], "del") == 0) {
+        return cat_del(argv[1]);
+    }
+
+    if (strcmp(argv[0], "route") == 0) {
+        return cat_route(argv[1], argv[2]);
+    }
+
+    Serial.printf("Error: Invalid command!\n");
+    return -1;
+}
@@ -0,0 +1,126 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRremoteESP8266.h>
+
+#include "parameter.hpp"
+
+/**
+ * @brief Class to access the configured devices.
+ * The devices are stored in the parameters, this class provides the lookup
+ * of a device by the IR command sent to it. Based on the catalog the state of
+ * each device is tracked, which allows to skip commands which would not 
+ * change it.
+ */
+class DeviceTable {
+    public:
+
+        /**
+         * @brief The tracked state of a device.
+         * power is -1 if unknown, input is 0 if unknown.
+         */
+        typedef struct {
+            int8_t power;
+            uint8_t input;
+            uint32_t skipped;
+        } State_t;
+
+        /**
+         * @brief Constructor
+         */
+        DeviceTable();
+
+        /**
+         * @brief Find the device a IR command is addressed to.
+         * @param type The IR protocol of the command.
+         * @param code The code of the command.
+         * @return The index of the device, -1 if no device matches.
+         */
+        int8_t find(decode_type_t type, uint64_t code) const;
+
+        /**
+         * @brief Get a device by its index.
+         * @param idx The index of the device.
+         * @return Pointer to the device, nullptr if the index is invalid or 
+         *         the device is not configured.
+         */
+        const Device_t* get(int8_t idx) const;
+
+        /**
+         * @brief Get a device by its name.
+         * @param name The name of the device.
+         * @return The index of the device, -1 if no device matches.
+         */
+        int8_t findByName(const char *name) const;
+
+        /**
+         * @brief Find the catalog entry of a IR command.
+         * @param type The IR protocol of the command.
+         * @param code The code of the command.
+         * @return Pointer to the entry, nullptr if the command is not listed.
+         */
+        const CatalogEntry_t* findCatalog(decode_type_t type, uint64_t code) const;
+
+        /**
+         * @brief Update the device state by a transmitted or received command.
+         * @param type The IR protocol of the command.
+         * @param code The code of the command.
+         */
+        void observe(decode_type_t type, uint64_t code);
+
+        /**
+         * @brief Check if a command would not change the device state.
+         * If so the skip counter of the device is incremented.
+         * @param type The IR protocol of the command.
+         * @param code The code of the command.
+         * @return true if the device already is in the target state.
+         */
+        bool skip(decode_type_t type, uint64_t code);
+
+        /**
+         * @brief Get the tracked state of a device.
+         * @param idx The index of the device.
+         * @return Pointer to the state, nullptr if the index is invalid.
+         */
+        const State_t* getState(int8_t idx) const;
+
+        /**
+         * @brief Forget the tracked state of a device.
+         * @param idx The index of the device.
+         */
+        void resetState(int8_t idx);
+
+        /**
+         * @brief Get the state of all devices as text.
+         * @return One line per configured device.
+         */
+        String getStateString(void) const;
+
+    private:
+
+        /**
+         * @brief The tracked state per device.
+         */
+        State_t state[PARAM_MAX_DEVICES];
+};
@@ -0,0 +1,140 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "heapmonitor.hpp"
+
+extern LoopMonitor loopMonitor;
+
+/**
+ * @brief The task whose allocations are counted, the loop task.
+ */
+static TaskHandle_t countedTask = nullptr;
+
+/**
+ * @brief The number of allocations per call site.
+ */
+static uint32_t siteAllocs[LOOP_SITES];
+
+/**
+ * @brief The number of bytes allocated per call site.
+ */
+static uint32_t siteBytes[LOOP_SITES];
+
+#ifdef HEAPMON_COUNT_ALLOCS
+
+static inline void countAlloc(size_t size) {
+    if (countedTask != nullptr && xTaskGetCurrentTaskHandle() == countedTask) {
+        LoopSite_t site = loopMonitor.getSite();
+
+        siteAllocs[site]++;
+        siteBytes[site] += size;
+    }
+}
+
+extern "C" {
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    countAlloc(size);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size) {
+    countAlloc(num * size);
+    return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    countAlloc(size);
+    return __real_realloc(ptr, size);
+}
+
+}
+
+#endif
+
+HeapMonitor::HeapMonitor() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void HeapMonitor::begin(void) {
+    countedTask = xTaskGetCurrentTaskHandle();
+    sample();
+}
+
+void HeapMonitor::sample(void) {
+    stats.free = ESP.getFreeHeap();
+    stats.largest = ESP.getMaxAllocHeap();
+    stats.minFree = ESP.getMinFreeHeap();
+    stats.frag = stats.free ? 100 - (uint64_t) stats.largest * 100 / stats.free : 0;
+    stats.maxFrag = max(stats.maxFrag, stats.frag);
+
+    if (stats.minLargest == 0 || stats.largest < stats.minLargest) {
+        stats.minLargest = stats.largest;
+    }
+}
+
+const HeapMonitor::Stats_t &HeapMonitor::getStats(void) const {
+    return stats;
+}
+
+uint32_t HeapMonitor::getAllocs(LoopSite_t site) const {
+    return siteAllocs[site];
+}
+
+void HeapMonitor::reset(void) {
+    memset(siteAllocs, 0, sizeof(siteAllocs));
+    memset(siteBytes, 0, sizeof(siteBytes));
+    stats.minLargest = 0;
+    stats.maxFrag = 0;
+    sample();
+}
+
+String HeapMonitor::getStatsString(void) const {
+    char buf[96];
+    String data;
+
+    snprintf(buf, sizeof(buf), "  Free:          %lu, min %lu\n", 
+        (unsigned long) stats.free, (unsigned long) stats.minFree);
+    data += buf;
+    snprintf(buf, sizeof(buf), "  Largest block: %lu, min %lu\n", 
+        (unsigned long) stats.largest, (unsigned long) stats.minLargest);
+    data += buf;
+    snprintf(buf, sizeof(buf), "  Fragmentation: %u%%, max %u%%\n", stats.frag, stats.maxFrag);
+    data += buf;
+
+#ifdef HEAPMON_COUNT_ALLOCS
+    data += "  Allocations:\n";
+    for (uint8_t i = 0; i < LOOP_SITES; i++) {
+        snprintf(buf, sizeof(buf), "    %-10s   %lu, %lu bytes\n", 
+            LoopMonitor::getSiteName((LoopSite_t) i), 
+            (unsigned long) siteAllocs[i], (unsigned long) siteBytes[i]);
+        data += buf;
+    }
+#else
+    data += "  Allocations:   not counted, build with HEAPMON_COUNT_ALLOCS\n";
+#endif
+
+    return data;
+}
@@ -0,0 +1,95 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "loopmonitor.hpp"
+
+/**
+ * @brief Heap telemetry.
+ * 
+ * Samples the free heap and the largest free block, the fragmentation is 
+ * the share of the free heap not available as one block. If built with 
+ * HEAPMON_COUNT_ALLOCS and malloc, calloc and realloc wrapped by the linker,
+ * the allocations of the loop task are counted per call site of the main 
+ * loop.
+ */
+class HeapMonitor {
+
+    public:
+
+        /**
+         * @brief Heap statistics.
+         */
+        typedef struct {
+            uint32_t free;
+            uint32_t largest;
+            uint32_t minFree;
+            uint32_t minLargest;
+            uint8_t frag;
+            uint8_t maxFrag;
+        } Stats_t;
+
+        /**
+         * @brief Construct a new HeapMonitor object.
+         */
+        HeapMonitor();
+
+        /**
+         * @brief Starts counting the allocations of the calling task, to be
+         * called from the loop task.
+         */
+        void begin(void);
+
+        /**
+         * @brief Samples the heap.
+         */
+        void sample(void);
+
+        /**
+         * @brief Returns the statistics of the last sample.
+         */
+        const Stats_t &getStats(void) const;
+
+        /**
+         * @brief Returns the number of allocations of a call site.
+         * @param site The call site.
+         */
+        uint32_t getAllocs(LoopSite_t site) const;
+
+        /**
+         * @brief Resets the allocation counts and the extremes.
+         */
+        void reset(void);
+
+        /**
+         * @brief Returns the statistics as human readable text.
+         */
+        String getStatsString(void) const;
+
+    private:
+
+        /**
+         * @brief The statistics.
+         */
+        Stats_t stats;
+};
@@ -20,86 +20,462 @@
  */
 
 #include "ircontrol.hpp"
+#include "devices.hpp"
+#include "irlearner.hpp"
+#include "relay.hpp"
+#include "txtrace.hpp"
+#include "bootprofile.hpp"
+#include "serialproto.hpp"
+#include "irdb.hpp"
+#include <new>
 
-IRControl::IRControl(uint8_t txPin, uint8_t rxPin, uint8_t logSize) 
-    : irSend(txPin)
-    , irRecv(rxPin)
-    , lastTx(logSize)
-    , lastRx(logSize)
+extern DeviceTable deviceTable;
+extern IRLearner irLearner;
+extern IRDb irDb;
+extern RelayEngine relayEngine;
+extern SerialProto serialProto;
+extern TxTrace txTrace;
+extern BootProfile bootProfile;
+
+IRControl::IRControl(uint8_t rxPin) 
+    : txActive(0)
+    , irRecv(rxPin, IRRX_BUFSIZE)
     , numTx(0)
-    , numRx(0) {
+    , numRx(0)
+    , echo(true)
+    , lastTxTime(0)
+    , lastRxTime(0) {
+    const uint8_t pins[IRTX_CHANNELS] = IRTX_PINS;
+
+    for (uint8_t i = 0; i < IRTX_CHANNELS; i++) {
+        txChannels[i] = new (txChannelMemory[i]) TxChannel(pins[i], i);
+    }
+
+    memset(&rxStats, 0, sizeof(rxStats));
+    gesture.active = false;
+    setRxFilter(nullptr, 0);
 }
 
 void IRControl::begin(void) {
     pinMode(IRRX_PIN, INPUT);
-    pinMode(IRTX_PIN, OUTPUT);
-    digitalWrite(IRTX_PIN, false);
 
-    irSend.begin();
+    for (uint8_t i = 0; i < IRTX_CHANNELS; i++) {
+        txChannels[i]->begin();
+    }
+    setRxFilter(Parameter.data.rx.protocols, PARAM_MAX_RX_PROTOCOLS);
     irRecv.enableIRIn();
+    publish();
 }
 
-int8_t IRControl::transmit(const char* type, const char* code, const char* repeat) {
+int8_t IRControl::transmit(const char* type, const char* code, const char* repeat, 
+        const char* channel) {
     decode_type_t irType = decode_type_t::UNKNOWN;
-    uint32_t base  = 10;
-    uint32_t irCode = 0;
+    uint64_t irCode = 0;
+    uint16_t irBits = 0;
     uint16_t irRepeat = 0;
+    int irChannel = 0;
+    const char *end = nullptr;
     
     if (type == nullptr || code == nullptr || repeat == nullptr) {
         return -1;
     }
 
-    irType = stringToIRType(type);
-    base  = is32BitHex(code) ? 16 : 10;
-    irCode = strtoul(code, nullptr, base);
     irRepeat = constrain(atoi(repeat), 0, 15);
 
-    if (irType == decode_type_t::UNKNOWN) {
+    if (channel != nullptr) {
+        irChannel = atoi(channel);
+        if (irChannel < 0 || irChannel >= IRTX_CHANNELS) {
+            return -3;
+        }
+    }
+
+    /* Code database commands are addressed by name */
+    if (strcasecmp(type, "db") == 0) {
+        if (!irDb.resolve(code, irType, irCode, irBits)) {
+            return -2;
+        }
+        transmit(irType, irCode, irRepeat, irChannel, irBits);
+        return 0;
+    }
+
+    end = parseType(type, irType, irBits);
+    if (end == nullptr || *end != 0) {
         return -2;
     }
+
+    /* Learned codes are addressed by name */
+    if (irType == decode_type_t::RAW) {
+        int8_t idx = irLearner.find(code);
+        if (idx < 0) {
+            return -2;
+        }
+        irCode = idx;
+    } else if (hasACState(irType)) {
+        uint8_t state[kStateSizeMax];
+        int16_t len = parseState(code, state, sizeof(state), &end);
+
+        if (len < 0 || *end != 0) {
+            return -1;
+        }
+        return transmitState(irType, state, len, irChannel) ? 0 : -2;
+    } else {
+        end = parseCode(code, irCode);
+        if (end == nullptr || *end != 0) {
+            return -1;
+        }
+    }
     
-    transmit(irType, irCode, irRepeat);
+    transmit(irType, irCode, irRepeat, irChannel, irBits);
     return 0;
 }
 
-void IRControl::transmit(decode_type_t type, uint32_t code, uint16_t repeat) {
-    String hexcode = String(code, HEX);
+void IRControl::transmit(decode_type_t type, uint64_t code, uint16_t repeat, uint8_t channel, 
+        uint16_t bits) {
+    TxTrace::Stamp_t start = TxTrace::now();
+    TxTrace::Stamp_t stage;
+    String hexcode = codeToString(code);
     String protocol = typeToString(type);
     String ts = getTimeStamp();
-    uint16_t retransmit = repeat;
+    uint16_t rawLen = 0;
+    uint16_t khz = 0;
+    char entry[96];
+
+    if (type == decode_type_t::RAW && (code & IRDB_REF) != 0) {
+        const IRDbEntry_t *command = irDb.findRef(code);
 
-    hexcode.toUpperCase();
-    lastTx.push(ts + String("; ") + protocol + String("; 0x") + hexcode);
+        /* Copied, the flash mapping is not accessible while flash is written */
+        rawLen = command ? irDb.expand(command, rawBuf, sizeof(rawBuf) / sizeof(rawBuf[0])) : 0;
+        if (rawLen == 0) {
+            reportTxError(ts, String("database code ") + hexcode + String(" not found"));
+            return;
+        }
+        hexcode = irDb.getName(command);
+        khz = command->khz;
+    } else if (type == decode_type_t::RAW) {
+        const LearnedCode_t *learned = irLearner.get(code);
+        
+        rawLen = irLearner.expand(code, rawBuf, sizeof(rawBuf) / sizeof(rawBuf[0]));
+        if (rawLen == 0) {
+            reportTxError(ts, String("learned code ") + hexcode + String(" not found"));
+            return;
+        }
+        hexcode = learned->name;
+        khz = learned->khz;
+    }
+
+    /* Formatted in place, the log slot reuses its allocation */
+    if (channel == 0) {
+        snprintf(entry, sizeof(entry), "%s; %s; %s", ts.c_str(), protocol.c_str(), 
+                hexcode.c_str());
+    } else {
+        snprintf(entry, sizeof(entry), "%s; %s; %s; ch%u", ts.c_str(), protocol.c_str(), 
+                hexcode.c_str(), channel);
+    }
+    lastTx.push(entry);
     numTx++;
+    lastTxTime = millis();
+    deviceTable.observe(type, code);
+
+    if (txActive == 0) {
+        irRecv.pause();
+    }
+    stage = TxTrace::now();
+    if (type == decode_type_t::RAW) {
+        IRTxDriver &driver = txChannels[channel]->getDriver();
 
-    irRecv.pause();
-    do {
-        irSend.send(type, code, 32, 0);
-        if (retransmit > 0) {
-            retransmit--;
+        /* Drivers wait for the previous frame before sending the next one */
+        for (uint16_t i = 0; i <= repeat; i++) {
+            driver.sendRaw(rawBuf, rawLen, khz);
         }
-    } while (retransmit > 0);
-    irRecv.resume();
+    } else {
+        txChannels[channel]->getDriver().send(type, code, bits, repeat);
+    }
+    txTrace.add(TRACE_SEND, txTrace.getId(), 0, stage);
+    bootProfile.mark(BOOT_PHASE_FIRST_TX);
+    txActive |= 1 << channel;
+    isBusy(channel);
 
-    Serial.printf("%s IR TX: %s 0x%0X", ts.c_str(), protocol.c_str(), code);
-    if(repeat != 0) {
-        Serial.printf(" (repeat %dx)", repeat);
-    }      
-    Serial.printf("\n");
+    stage = TxTrace::now();
+    if (echo) {
+        Serial.printf("%s IR TX: %s %s", ts.c_str(), protocol.c_str(), hexcode.c_str());
+        if (channel != 0) {
+            Serial.printf(" ch%u", channel);
+        }
+        if(repeat != 0) {
+            Serial.printf(" (repeat %dx)", repeat);
+        }      
+        Serial.printf("\n");
+    }
+    txTrace.add(TRACE_LOG, txTrace.getId(), 0, stage);
+    publish();
+    txTrace.add(TRACE_TRANSMIT, txTrace.getId(), 0, start);
+}
+
+bool IRControl::transmitState(decode_type_t type, const uint8_t *state, uint16_t nbytes, 
+        uint8_t channel) {
+    String ts = getTimeStamp();
+    String entry = typeToString(type) + String("; 0x");
+    bool ret = false;
+
+    for (uint16_t i = 0; i < nbytes; i++) {
+        entry += "0123456789ABCDEF"[state[i] >> 4];
+        entry += "0123456789ABCDEF"[state[i] & 0x0F];
+    }
+
+    if (txActive == 0) {
+        irRecv.pause();
+    }
+    ret = txChannels[channel]->getDriver().sendState(type, state, nbytes);
+    bootProfile.mark(BOOT_PHASE_FIRST_TX);
+    txActive |= 1 << channel;
+    isBusy(channel);
+
+    if (!ret) {
+        reportTxError(ts, entry + String(" not supported"));
+        return false;
+    }
+
+    if (channel != 0) {
+        entry += String("; ch") + String(channel);
+    }
+    lastTx.push(ts + String("; ") + entry);
+    numTx++;
+    lastTxTime = millis();
+    publish();
+    if (echo) {
+        Serial.printf("%s IR TX: %s\n", ts.c_str(), entry.c_str());
+    }
+
+    return true;
+}
+
+#if IRGW_AC
+bool IRControl::transmitAc(const stdAc::state_t &state, const stdAc::state_t *prev, 
+        uint8_t channel) {
+    String ts = getTimeStamp();
+    String entry = typeToString(state.protocol) + String("; ") + 
+            (state.power ? IRac::opmodeToString(state.mode) : String("Off")) + 
+            String("; ") + String(state.degrees, 1) + String("C; fan ") + 
+            IRac::fanspeedToString(state.fanspeed) + String("; swing ") + 
+            IRac::swingvToString(state.swingv);
+    bool ret = false;
+
+    if (txActive == 0) {
+        irRecv.pause();
+    }
+    ret = txChannels[channel]->getDriver().sendAc(state, prev);
+    txActive |= 1 << channel;
+    isBusy(channel);
+
+    if (!ret) {
+        reportTxError(ts, entry + String(" not supported"));
+        return false;
+    }
+
+    if (channel != 0) {
+        entry += String("; ch") + String(channel);
+    }
+    lastTx.push(ts + String("; ") + entry);
+    numTx++;
+    lastTxTime = millis();
+    publish();
+    if (echo) {
+        Serial.printf("%s IR TX: %s\n", ts.c_str(), entry.c_str());
+    }
+
+    return true;
+}
+#endif
+
+bool IRControl::isBusy(uint8_t channel) {
+    uint8_t mask = 1 << channel;
+
+    if ((txActive & mask) && !txChannels[channel]->getDriver().isBusy()) {
+        txActive &= ~mask;
+        if (txActive == 0) {
+            irRecv.resume();
+        }
+    }
+
+    return txActive & mask;
+}
+
+bool IRControl::isBusy(void) {
+    for (uint8_t i = 0; i < IRTX_CHANNELS; i++) {
+        isBusy(i);
+    }
+
+    return txActive != 0;
 }
 
 void IRControl::handleReceive(void) {
+    uint32_t seq = lastRx.getSeq();
+    uint32_t decoded = rxStats.decoded;
+
+    receive();
+
+    /* Readers in other tasks see the changes as a whole */
+    if (lastRx.getSeq() != seq || rxStats.decoded != decoded) {
+        publish();
+    }
+}
+
+void IRControl::receive(void) {
+    uint32_t now = millis();
+
+    if (gesture.active && now - gesture.last > IRRX_HOLD_TIMEOUT) {
+        release();
+    }
+
+    if (isBusy()) {
+        return;
+    }
+
+    uint32_t start = micros();
+
     if (irRecv.decode(&irRxData)) {
+        uint32_t origin = micros();
+        uint32_t decodeTime = origin - start;
+        bool repeat = false;
+
+        rxStats.decoded++;
+        rxStats.decodeTime += decodeTime;
+        rxStats.decodeMax = max(rxStats.decodeMax, decodeTime);
+
+        if (irLearner.isActive()) {
+            irLearner.capture(&irRxData);
+        }
+
+        /* Drop filtered protocols before any further processing */
+        if (!isRxAllowed(irRxData.decode_type)) {
+            rxStats.filtered++;
+            irRecv.resume();
+            return;
+        }
+
+        repeat = isRepeat(now);
+        if (repeat) {
+            irRecv.resume();
+            gesture.repeats++;
+            gesture.last = now;
+            rxStats.repeats++;
+            relayEngine.handle(gesture.type, gesture.value, true, origin);
+            serialProto.event(gesture.type, gesture.value, irRxData.bits, true);
+            updateGesture();
+            return;
+        }
+
+        /* A repeat frame without a press, e.g. after a filtered frame */
+        if (irRxData.repeat) {
+            irRecv.resume();
+            return;
+        }
+
+        if (gesture.active) {
+            release();
+        }
+
         String ts = getTimeStamp();
         String protocol = typeToString(irRxData.decode_type);
         String hexvalue = resultToHexidecimal(&irRxData);
+        const IRDbEntry_t *known = irDb.findCode(irRxData.decode_type, irRxData.value);
         
         irRecv.resume();
 
-        lastRx.push(ts + String("; ") + protocol + String("; ") + hexvalue);
+        /* Named by the code database if known */
+        if (known != nullptr) {
+            hexvalue += String("; ") + irDb.getName(known);
+        }
+
+        /* Relay first, the triggered commands are queued only */
+        relayEngine.handle(irRxData.decode_type, irRxData.value, false, origin);
+        serialProto.event(irRxData.decode_type, irRxData.value, irRxData.bits, false);
+
+        gesture.type = irRxData.decode_type;
+        gesture.value = irRxData.value;
+        gesture.entry = ts + String("; ") + protocol + String("; ") + hexvalue;
+        gesture.start = now;
+        gesture.last = now;
+        gesture.repeats = 0;
+        gesture.active = true;
+
+        lastRx.push(gesture.entry);
         numRx++;
-        Serial.printf("%s IR RX: %s %s\n", ts.c_str(), protocol.c_str(), hexvalue.c_str());
+        lastRxTime = now;
+        deviceTable.observe(irRxData.decode_type, irRxData.value);
+        if (echo) {
+            Serial.printf("%s IR RX: %s %s\n", ts.c_str(), protocol.c_str(), hexvalue.c_str());
+        }
+    }
+}
+
+bool IRControl::isRepeat(uint32_t now) const {
+    if (!gesture.active || now - gesture.last > IRRX_HOLD_TIMEOUT) {
+        return false;
+    }
+
+    /* Protocols without repeat frames send the full frame again */
+    return irRxData.repeat || (irRxData.decode_type == gesture.type && 
+            irRxData.value == gesture.value);
+}
+
+void IRControl::updateGesture(void) {
+    lastRx.update(gesture.entry + String("; hold ") + String(gesture.last - gesture.start) + 
+            String("ms, ") + String(gesture.repeats) + String(" repeats"));
+}
+
+void IRControl::release(void) {
+    gesture.active = false;
+
+    if (gesture.repeats != 0) {
+        updateGesture();
+        if (echo) {
+            Serial.printf("%s IR RX: released after %ums, %u repeats\n", getTimeStamp().c_str(), 
+                    gesture.last - gesture.start, gesture.repeats);
+        }
+    }
+}
+
+void IRControl::reportTxError(const String &ts, const String &text) {
+    /* Text would break the frames of the binary protocol */
+    if (serialProto.isActive()) {
+        serialProto.notice((String("IR TX: ") + text).c_str());
+    } else {
+        Serial.printf("%s IR TX: %s\n", ts.c_str(), text.c_str());
+    }
+}
+
+const char* IRControl::parseType(const char *str, decode_type_t &type, uint16_t &bits) {
+    char name[32];
+    uint8_t len = 0;
+    uint64_t value = 0;
+
+    type = decode_type_t::UNKNOWN;
+    bits = 0;
+    while (str[len] != 0 && str[len] != ':' && str[len] != '/') {
+        if (len == sizeof(name) - 1) {
+            return nullptr;
+        }
+        name[len] = str[len];
+        len++;
+    }
+    name[len] = 0;
+
+    type = stringToIRType(name);
+    if (type == decode_type_t::UNKNOWN) {
+        return nullptr;
+    }
+
+    str += len;
+    if (*str == '/') {
+        str = parseCode(str + 1, value);
+        if (str == nullptr || value == 0 || value > 64) {
+            return nullptr;
+        }
+        bits = value;
     }
+
+    return str;
 }
 
 decode_type_t IRControl::stringToIRType(const char * const str) {
@@ -117,19 +493,76 @@ decode_type_t IRControl::stringToIRType(const char * const str) {
     return decode_type_t::UNKNOWN;
 }
 
+void IRControl::setRxFilter(const int16_t *protocols, uint8_t count) {
+    bool all = protocols == nullptr || count == 0 || protocols[0] == decode_type_t::UNUSED;
+
+    memset(rxAllowed, all ? 0xFF : 0, sizeof(rxAllowed));
+    if (all) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < count && protocols[i] != decode_type_t::UNUSED; i++) {
+        uint16_t bit = protocols[i] + 1;
+
+        if (bit < sizeof(rxAllowed) * 8) {
+            rxAllowed[bit >> 5] |= 1UL << (bit & 31);
+        }
+    }
+}
+
+bool IRControl::isRxAllowed(decode_type_t type) const {
+    uint16_t bit = type + 1;
+
+    if (bit >= sizeof(rxAllowed) * 8) {
+        return false;
+    }
+
+    return rxAllowed[bit >> 5] & (1UL << (bit & 31));
+}
+
+IRControl::RxStats_t IRControl::getRxStats(void) const {
+    Snapshot_t snapshot;
+
+    stats.read(snapshot);
+    return snapshot.rx;
+}
+
+void IRControl::getSnapshot(Snapshot_t &snapshot) const {
+    stats.read(snapshot);
+}
+
 uint32_t IRControl::getTxCount(void) const {
-    return numTx;
+    Snapshot_t snapshot;
+
+    stats.read(snapshot);
+    return snapshot.numTx;
 }
 
 uint32_t IRControl::getRxCount(void) const {
-    return numRx;
+    Snapshot_t snapshot;
+
+    stats.read(snapshot);
+    return snapshot.numRx;
+}
+
+void IRControl::publish(void) {
+    Snapshot_t snapshot;
+
+    snapshot.numTx = numTx;
+    snapshot.numRx = numRx;
+    snapshot.lastTxTime = lastTxTime;
+    snapshot.lastRxTime = lastRxTime;
+    snapshot.rx = rxStats;
+    snprintf(snapshot.lastTx, sizeof(snapshot.lastTx), "%s", lastTx.peek().c_str());
+    snprintf(snapshot.lastRx, sizeof(snapshot.lastRx), "%s", lastRx.peek().c_str());
+    stats.write(snapshot);
 }
 
-String IRControl::getLastTx(void) const {
+const String &IRControl::getLastTx(void) const {
     return lastTx.peek();
 }
 
-String IRControl::getLastRx(void) const {
+const String &IRControl::getLastRx(void) const {
     return lastRx.peek();
 }
 
@@ -31,6 +31,9 @@
 
 #include "common.hpp"
 #include "stringRingBuffer.hpp"
+#include "seqlock.hpp"
+#include "txchannel.hpp"
+#include "parameter.hpp"
 
 /**
  * @brief Class to handle IR control functionality.
@@ -39,14 +42,39 @@
  */
 class IRControl {
     public:
+
+        /**
+         * @brief Receive statistics.
+         */
+        typedef struct {
+            uint32_t decoded;
+            uint32_t filtered;
+            uint32_t repeats;
+            uint32_t decodeTime;
+            uint32_t decodeMax;
+        } RxStats_t;
+
+        /**
+         * @brief Statistics snapshot, published as a whole after each 
+         * transmission and reception.
+         */
+        typedef struct {
+            uint32_t numTx;
+            uint32_t numRx;
+            uint32_t lastTxTime;
+            uint32_t lastRxTime;
+            RxStats_t rx;
+            char lastTx[IRSTATS_ENTRY_SIZE];
+            char lastRx[IRSTATS_ENTRY_SIZE];
+        } Snapshot_t;
         
         /**
          * Constructor
-         * @param txPin Pin for IR transmission, default is IRTX_PIN.
+         * The transmit channels use the pins given by IRTX_PINS, the logs
+         * have IRLOG_SIZE entries.
          * @param rxPin Pin for IR reception, default is IRRX_PIN.
-         * @param logSize Size of the transmission and reception logs, default is 30.
          */
-        IRControl(uint8_t txPin = IRTX_PIN, uint8_t rxPin = IRRX_PIN, uint8_t logSize = 30);
+        IRControl(uint8_t rxPin = IRRX_PIN);
         
         /**
          * @brief Initialize the IR control.
@@ -56,24 +84,72 @@ class IRControl {
         
         /**
          * @brief Transmit an IR signal.
-         * @param type The type of IR protocol to use.
-         * @param code The code to transmit.
+         * @param type The type of IR protocol to use, optionally followed by
+         *        "/bits" to set the number of bits, or "db".
+         * @param code The code to transmit, the name of a learned code for RAW,
+         *        the state bytes for state based protocols or the name of a 
+         *        code database command as "device/function" for db.
          * @param repeat The number of times to repeat the transmission.
+         * @param channel The transmit channel, nullptr for the first one.
          * @return 0 on success, negative value on error.
          */
-        int8_t transmit(const char* type, const char* code, const char* repeat);
+        int8_t transmit(const char* type, const char* code, const char* repeat, 
+                const char* channel = nullptr);
 
         /**
          * @brief Transmit an IR signal.
          * @param type The type of IR protocol to use.
-         * @param code The code to transmit.
+         * @param code The code to transmit, the learned code index or the code
+         *        database reference for RAW.
          * @param repeat The number of times to repeat the transmission, default is 0.
+         * @param channel The transmit channel, default is 0.
+         * @param bits The number of bits, default is 0 for the protocol default.
+         */
+        void transmit(decode_type_t type, uint64_t code, uint16_t repeat = 0, uint8_t channel = 0,
+                uint16_t bits = 0);
+
+        /**
+         * @brief Transmit the state of a state based protocol.
+         * @param type The type of IR protocol to use.
+         * @param state The state bytes.
+         * @param nbytes The number of bytes.
+         * @param channel The transmit channel.
+         * @return true on success, false if the protocol is not supported.
          */
-        void transmit(decode_type_t type, uint32_t code, uint16_t repeat = 0);
+        bool transmitState(decode_type_t type, const uint8_t *state, uint16_t nbytes, 
+                uint8_t channel);
+
+#if IRGW_AC
+        /**
+         * @brief Transmit the state of an air conditioner.
+         * @param state The state to send, including protocol and model.
+         * @param prev The state sent last, nullptr if unknown.
+         * @param channel The transmit channel.
+         * @return true on success, false if the protocol is not supported.
+         */
+        bool transmitAc(const stdAc::state_t &state, const stdAc::state_t *prev, uint8_t channel);
+#endif
+
+        /**
+         * @brief Check if a transmission is ongoing on a channel.
+         * The transmit driver may send in the background, reception is 
+         * resumed once all channels have finished.
+         * @param channel The transmit channel.
+         * @return true while transmitting.
+         */
+        bool isBusy(uint8_t channel);
+
+        /**
+         * @brief Check if a transmission is ongoing on any channel.
+         * @return true while transmitting.
+         */
+        bool isBusy(void);
         
         /**
          * @brief Handle the reception of IR signals.
          * This method processes incoming IR signals and updates the reception log.
+         * Repeat frames of a held button are collapsed into the press, the log
+         * entry is updated with the hold time and repeat count instead.
          */
         void handleReceive(void);
         
@@ -83,6 +159,50 @@ class IRControl {
          * @return The corresponding decode_type_t enum value.
          */
         decode_type_t stringToIRType(const char * const str);
+
+        /**
+         * @brief Parse a IR type with an optional bit count, e.g. "sony/20".
+         * @param str The string to parse, the type ends at ':', '/' or the
+         *        end of the string.
+         * @param type Stores the IR type.
+         * @param bits Stores the number of bits, 0 if not given.
+         * @return Pointer to the first character after the type, nullptr on 
+         *         error.
+         */
+        const char* parseType(const char *str, decode_type_t &type, uint16_t &bits);
+
+        /**
+         * @brief Set the protocols which are processed when received.
+         * Other protocols are dropped right after decoding, all compiled in
+         * decoders still run, the filter does not reduce the decode time.
+         * @param protocols The protocol set, terminated by UNUSED if shorter
+         *        than count, the order does not matter. UNKNOWN allows codes
+         *        of unknown protocols.
+         * @param count The maximum number of protocols, 0 allows all.
+         */
+        void setRxFilter(const int16_t *protocols, uint8_t count);
+
+        /**
+         * @brief Check if a protocol passes the receive filter.
+         * @param type The protocol.
+         * @return true if received codes of the protocol are processed.
+         */
+        bool isRxAllowed(decode_type_t type) const;
+
+        /**
+         * @brief Get the receive statistics.
+         * @return The statistics, decode times are in microseconds.
+         */
+        RxStats_t getRxStats(void) const;
+
+        /**
+         * @brief Get a consistent snapshot of the counters, statistics and 
+         * last log entries.
+         * Can be called from any task without locking, the IR task never 
+         * waits for readers.
+         * @param snapshot Returns the snapshot, times are millis().
+         */
+        void getSnapshot(Snapshot_t &snapshot) const;
         
         /**
          * @brief Get the number of transmitted IR signals.
@@ -98,15 +218,19 @@ class IRControl {
         
         /**
          * @brief Get the last transmitted IR signal.
-         * @return A string containing the last transmitted IR signal.
+         * @return A string containing the last transmitted IR signal, valid
+         * until the next transmission. Only to be used in the loop task, see
+         * getSnapshot().
          */
-        String getLastTx(void) const;
+        const String &getLastTx(void) const;
         
         /**
          * @brief Get the last received IR signal.
-         * @return A string containing the last received IR signal.
+         * @return A string containing the last received IR signal, valid 
+         * until the next reception. Only to be used in the loop task, see
+         * getSnapshot().
          */
-        String getLastRx(void) const;
+        const String &getLastRx(void) const;
         
         /**
          * @brief Get the transmission log.
@@ -120,13 +244,105 @@ class IRControl {
          */
         String getRxLog(void) const;
 
+        /**
+         * @brief Get the transmission log entries.
+         * @return The ring buffer of the transmission log.
+         */
+        const StringRingBuffer &getTxLogBuffer(void) const {
+            return lastTx;
+        }
+
+        /**
+         * @brief Get the reception log entries.
+         * @return The ring buffer of the reception log.
+         */
+        const StringRingBuffer &getRxLogBuffer(void) const {
+            return lastRx;
+        }
+
+        /**
+         * @brief Enable or disable printing transmitted and received codes to
+         * the serial console.
+         * @param enable true to print them.
+         */
+        void setEcho(bool enable) {
+            echo = enable;
+        }
+
     private:
+
+        /**
+         * @brief Decode and process a received frame.
+         */
+        void receive(void);
+
+        /**
+         * @brief Publish the current statistics for readers in other tasks.
+         */
+        void publish(void);
+
+        /**
+         * @brief Report a failed transmission, on the console or as a NOTICE
+         * frame while the binary protocol is active.
+         * @param ts The time stamp of the transmission.
+         * @param text The error.
+         */
+        void reportTxError(const String &ts, const String &text);
+
+        /**
+         * @brief A button press, lasting until its repeat frames stop.
+         */
+        typedef struct {
+            decode_type_t type;
+            uint64_t value;
+            String entry;
+            uint32_t start;
+            uint32_t last;
+            uint16_t repeats;
+            bool active;
+        } Gesture_t;
+
+        /**
+         * @brief Check if a received frame continues the current gesture.
+         * Either a repeat frame or the same code sent again while held.
+         * @param now The current time in milliseconds.
+         * @return true if it is a repeat.
+         */
+        bool isRepeat(uint32_t now) const;
+
+        /**
+         * @brief Update the reception log entry of the current gesture.
+         */
+        void updateGesture(void);
+
+        /**
+         * @brief End the current gesture.
+         */
+        void release(void);
         
         /**
-         * IR send object.
+         * Memory of the transmit channels, they are constructed in place as
+         * their drivers need the pin, hence nothing is allocated on the heap.
+         */ 
+        uint8_t txChannelMemory[IRTX_CHANNELS][sizeof(TxChannel)]
+                __attribute__((aligned(alignof(TxChannel))));
+
+        /**
+         * The transmit channels.
+         */ 
+        TxChannel *txChannels[IRTX_CHANNELS];
+
+        /**
+         * Bit mask of the channels which are transmitting, reception is 
+         * paused as long as it is not 0.
          */ 
-        IRsend irSend;
+        uint8_t txActive;
         
+        /**
+         * Timings of the learned code being transmitted.
+         */
+        uint16_t rawBuf[LEARN_MAX_TIMINGS + 1];
+
         /**
          * IR receive object.
          */
@@ -140,12 +356,12 @@ class IRControl {
         /**
          * Last transmission log.
          */
-        StringRingBuffer lastTx;
+        StaticStringRingBuffer<IRLOG_SIZE> lastTx;
         
         /**
          * Last reception log.
          */
-        StringRingBuffer lastRx;
+        StaticStringRingBuffer<IRLOG_SIZE> lastRx;
         
         /**
          * Number of transmitted IR signals.
@@ -156,4 +372,36 @@ class IRControl {
          * Number of received IR signals.
          */
         uint32_t numRx;
+
+        /**
+         * Bit mask of the allowed protocols, bit n is protocol n - 1 to 
+         * include UNKNOWN.
+         */
+        uint32_t rxAllowed[(kLastDecodeType + 33) / 32];
+
+        /**
+         * Receive statistics.
+         */
+        RxStats_t rxStats;
+
+        /**
+         * The gesture currently received.
+         */
+        Gesture_t gesture;
+
+        /**
+         * Print transmitted and received codes to the serial console.
+         */
+        bool echo;
+
+        /**
+         * millis() of the last transmission and reception.
+         */
+        uint32_t lastTxTime;
+        uint32_t lastRxTime;
+
+        /**
+         * The published statistics.
+         */
+        SeqLock<Snapshot_t> stats;
 };
@@ -0,0 +1,413 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "irdb.hpp"
+#include "common.hpp"
+#include <IRutils.h>
+#include <cli/cli.hpp>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+
+IRDb::IRDb() :
+      header(nullptr)
+    , entries(nullptr)
+    , codes(nullptr)
+    , hashes(nullptr)
+    , strings(nullptr)
+    , timings(nullptr)
+    , partitionSize(0)
+    , mapTime(0)
+    , lookups(0)
+    , hits(0)
+{
+
+}
+
+bool IRDb::begin(void) {
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, 
+            (esp_partition_subtype_t) IRDB_SUBTYPE, IRDB_PARTITION);
+    spi_flash_mmap_handle_t handle;
+    const void *data = nullptr;
+    IRDbHeader_t head;
+    uint32_t start = micros();
+
+    if (part == nullptr) {
+        return false;
+    }
+    partitionSize = part->size;
+
+    /* Only the used part is mapped, every 64kB page takes a MMU entry */
+    if (esp_partition_read(part, 0, &head, sizeof(head)) != ESP_OK || 
+            head.magic != IRDB_MAGIC || head.size < sizeof(head) || head.size > part->size) {
+        return false;
+    }
+
+    if (esp_partition_mmap(part, 0, head.size, SPI_FLASH_MMAP_DATA, &data, &handle) != ESP_OK) {
+        return false;
+    }
+
+    if (!attach((const uint8_t*) data, head.size)) {
+        spi_flash_munmap(handle);
+        return false;
+    }
+
+    mapTime = micros() - start;
+    return true;
+}
+
+bool IRDb::attach(const uint8_t *data, uint32_t size) {
+    const IRDbHeader_t *head = (const IRDbHeader_t*) data;
+    uint64_t num = 0;
+    uint32_t numTimings = 0;
+    uint32_t numStrings = 0;
+
+    header = nullptr;
+    if (data == nullptr || size < sizeof(IRDbHeader_t) || head->magic != IRDB_MAGIC || 
+            head->version != IRDB_VERSION || head->headerSize != sizeof(IRDbHeader_t) || 
+            head->size > size || head->numEntries > UINT16_MAX) {
+        return false;
+    }
+
+    /* The sections follow each other in this order, the strings end it. 
+       Unaligned loads from flash would raise an exception. */
+    num = head->numEntries;
+    if (((head->entries | head->codes | head->hashes | head->timings) & 7) != 0 || 
+            head->entries < sizeof(IRDbHeader_t) || 
+            head->entries + num * sizeof(IRDbEntry_t) > head->codes ||
+            head->codes + num * sizeof(uint16_t) > head->hashes ||
+            head->hashes + num * sizeof(IRDbHash_t) > head->timings ||
+            head->timings > head->strings || head->strings >= head->size || 
+            data[head->size - 1] != 0) {
+        return false;
+    }
+
+    if (esp_rom_crc32_le(0, data + sizeof(IRDbHeader_t), head->size - sizeof(IRDbHeader_t)) != 
+            head->crc) {
+        return false;
+    }
+
+    entries = (const IRDbEntry_t*) (data + head->entries);
+    codes = (const uint16_t*) (data + head->codes);
+    hashes = (const IRDbHash_t*) (data + head->hashes);
+    timings = (const uint16_t*) (data + head->timings);
+    strings = (const char*) (data + head->strings);
+    numTimings = (head->strings - head->timings) / sizeof(uint16_t);
+    numStrings = head->size - head->strings;
+
+    /* Checked once, the lookups rely on valid offsets */
+    for (uint32_t i = 0; i < num; i++) {
+        const IRDbEntry_t *entry = &entries[i];
+
+        if (entry->device >= numStrings || entry->function >= numStrings || 
+                codes[i] >= num || hashes[i].index >= num) {
+            return false;
+        }
+        if (entry->type == decode_type_t::RAW && entry->code + entry->bits > numTimings) {
+            return false;
+        }
+    }
+
+    header = head;
+    return true;
+}
+
+uint32_t IRDb::getCount(void) const {
+    return header != nullptr ? header->numEntries : 0;
+}
+
+const IRDbEntry_t* IRDb::find(const char *device, const char *function) const {
+    uint32_t idx = lowerBound(device, function);
+
+    lookups++;
+    if (idx == getCount() || compare(&entries[idx], device, function) != 0) {
+        return nullptr;
+    }
+
+    hits++;
+    return &entries[idx];
+}
+
+const IRDbEntry_t* IRDb::find(const char *name) const {
+    char device[IRDB_MAX_NAME];
+    const char *function = strchr(name, '/');
+    size_t len = function != nullptr ? function - name : 0;
+
+    if (function == nullptr || len >= sizeof(device)) {
+        return nullptr;
+    }
+
+    memcpy(device, name, len);
+    device[len] = 0;
+    return find(device, function + 1);
+}
+
+const IRDbEntry_t* IRDb::findCode(decode_type_t type, uint64_t code) const {
+    uint32_t low = 0;
+    uint32_t high = getCount();
+
+    lookups++;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        const IRDbEntry_t *entry = &entries[codes[mid]];
+
+        if (entry->type < type || (entry->type == type && entry->code < code)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low == getCount() || entries[codes[low]].type != type || 
+            entries[codes[low]].code != code) {
+        return nullptr;
+    }
+
+    hits++;
+    return &entries[codes[low]];
+}
+
+const IRDbEntry_t* IRDb::findRef(uint64_t ref) const {
+    uint32_t hash = (uint32_t) ref;
+    uint32_t low = 0;
+    uint32_t high = getCount();
+
+    if ((ref & IRDB_REF) == 0) {
+        return nullptr;
+    }
+
+    lookups++;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+
+        if (hashes[mid].hash < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low == getCount() || hashes[low].hash != hash) {
+        return nullptr;
+    }
+
+    hits++;
+    return &entries[hashes[low].index];
+}
+
+uint64_t IRDb::getRef(const IRDbEntry_t *entry) const {
+    return IRDB_REF | hash(getDevice(entry), getFunction(entry));
+}
+
+bool IRDb::resolve(const char *name, decode_type_t &type, uint64_t &code, uint16_t &bits) const {
+    const IRDbEntry_t *entry = find(name);
+
+    if (entry == nullptr) {
+        return false;
+    }
+
+    type = (decode_type_t) entry->type;
+    if (type == decode_type_t::RAW) {
+        code = getRef(entry);
+        bits = 0;
+    } else {
+        code = entry->code;
+        bits = entry->bits;
+    }
+
+    return true;
+}
+
+const char* IRDb::getDevice(const IRDbEntry_t *entry) const {
+    return strings + entry->device;
+}
+
+const char* IRDb::getFunction(const IRDbEntry_t *entry) const {
+    return strings + entry->function;
+}
+
+String IRDb::getName(const IRDbEntry_t *entry) const {
+    return String(getDevice(entry)) + "/" + getFunction(entry);
+}
+
+uint16_t IRDb::expand(const IRDbEntry_t *entry, uint16_t *buf, uint16_t size) const {
+    if (entry->type != decode_type_t::RAW || entry->bits > size) {
+        return 0;
+    }
+
+    memcpy(buf, &timings[entry->code], entry->bits * sizeof(uint16_t));
+    return entry->bits;
+}
+
+String IRDb::getDeviceString(void) const {
+    String data;
+    uint32_t i = 0;
+
+    /* Names are stored once, all commands of a device share the offset */
+    while (i < getCount()) {
+        uint32_t next = i + 1;
+        char line[IRDB_MAX_NAME + 24];
+
+        while (next < getCount() && entries[next].device == entries[i].device) {
+            next++;
+        }
+        snprintf(line, sizeof(line), "%s; %u commands\n", getDevice(&entries[i]), 
+                (unsigned) (next - i));
+        data += line;
+        i = next;
+    }
+
+    if (data.length() == 0) {
+        data = "none\n";
+    }
+
+    return data;
+}
+
+String IRDb::getListString(const char *device) const {
+    String data;
+
+    for (uint32_t i = lowerBound(device, ""); i < getCount(); i++) {
+        if (strcasecmp(getDevice(&entries[i]), device) != 0) {
+            break;
+        }
+        data += getEntryString(&entries[i]);
+    }
+
+    if (data.length() == 0) {
+        data = "none\n";
+    }
+
+    return data;
+}
+
+String IRDb::getEntryString(const IRDbEntry_t *entry) const {
+    String data = getName(entry) + "; " + typeToString((decode_type_t) entry->type);
+
+    if (entry->type == decode_type_t::RAW) {
+        data += "; " + String(entry->bits) + " timings; " + String(entry->khz) + "kHz\n";
+    } else {
+        data += "/" + String(entry->bits) + "; " + codeToString(entry->code) + "\n";
+    }
+
+    return data;
+}
+
+String IRDb::getStatsString(void) const {
+    char data[160];
+
+    if (partitionSize == 0) {
+        return String("no partition\n");
+    }
+
+    if (header == nullptr) {
+        snprintf(data, sizeof(data), "none, partition %u bytes\n", (unsigned) partitionSize);
+        return String(data);
+    }
+
+    snprintf(data, sizeof(data), 
+            "%u commands, %u of %u bytes, mapped in %uus\nlookups %u, hits %u\n", 
+            (unsigned) header->numEntries, (unsigned) header->size, (unsigned) partitionSize, 
+            (unsigned) mapTime, (unsigned) lookups, (unsigned) hits);
+    return String(data);
+}
+
+uint32_t IRDb::hash(const char *device, const char *function) {
+    uint32_t value = 2166136261UL;
+
+    for (const char *pos = device; *pos; pos++) {
+        value = (value ^ (uint8_t) tolower(*pos)) * 16777619UL;
+    }
+
+    value = (value ^ '/') * 16777619UL;
+    for (const char *pos = function; *pos; pos++) {
+        value = (value ^ (uint8_t) tolower(*pos)) * 16777619UL;
+    }
+
+    return value;
+}
+
+int IRDb::compare(const IRDbEntry_t *entry, const char *device, const char *function) const {
+    int ret = strcasecmp(getDevice(entry), device);
+
+    if (ret == 0) {
+        ret = strcasecmp(getFunction(entry), function);
+    }
+
+    return ret;
+}
+
+uint32_t IRDb::lowerBound(const char *device, const char *function) const {
+    uint32_t low = 0;
+    uint32_t high = getCount();
+
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+
+        if (compare(&entries[mid], device, function) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+extern IRDb irDb;
+
+CLI_COMMAND(irdb) {
+    const IRDbEntry_t *entry = nullptr;
+
+    if (argc == 0 || strcmp(argv[0], "stats") == 0) {
+        Serial.print(irDb.getStatsString());
+        return 0;
+    }
+
+    if (strcmp(argv[0], "list") == 0) {
+        Serial.print(argc > 1 ? irDb.getListString(argv[1]) : irDb.getDeviceString());
+        return 0;
+    }
+
+    if (strcmp(argv[0], "find") == 0 && argc == 2) {
+        entry = irDb.find(argv[1]);
+    } else if (strcmp(argv[0], "code") == 0 && argc == 3) {
+        const char *end = nullptr;
+        uint64_t code = 0;
+
+        end = parseCode(argv[2], code);
+        if (end == nullptr || *end != 0) {
+            Serial.printf("Error: Invalid code %s.\n", argv[2]);
+            return -1;
+        }
+        entry = irDb.findCode(strToDecodeType(argv[1]), code);
+    } else {
+        Serial.printf("Error: Usage: irdb [stats|list [device]|find device/function|code type code]\n");
+        return -1;
+    }
+
+    if (entry == nullptr) {
+        Serial.printf("Error: Not found.\n");
+        return -1;
+    }
+
+    Serial.print(irDb.getEntryString(entry));
+    return 0;
+}
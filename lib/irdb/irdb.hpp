@@ -0,0 +1,324 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRremoteESP8266.h>
+
+/**
+ * @brief Label of the flash partition holding the code database.
+ */
+#define IRDB_PARTITION              "irdb"
+
+/**
+ * @brief Data subtype of the partition, see partitions.csv.
+ */
+#define IRDB_SUBTYPE                0x40
+
+/**
+ * @brief Magic of the database header, "IRDB" in little endian.
+ */
+#define IRDB_MAGIC                  0x42445249
+
+/**
+ * @brief Format version, has to match tools/irdb.py.
+ */
+#define IRDB_VERSION                1
+
+/**
+ * @brief Maximum length of a name as "device/function".
+ */
+#define IRDB_MAX_NAME               64
+
+/**
+ * @brief Marks the code of a RAW command as database reference.
+ * The lower 32 bits are the hash of the name, which stays valid if the 
+ * database is rebuilt, unlike an index. Codes of learned codes are indices
+ * below PARAM_MAX_LEARNED.
+ */
+#define IRDB_REF                    (1ULL << 63)
+
+/**
+ * @brief Header of the database, followed by the sections it points to.
+ * All offsets are relative to the start of the header, all values are little
+ * endian and each section is aligned to 8 bytes.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t size;
+    uint32_t crc;
+    uint32_t numEntries;
+    uint32_t entries;
+    uint32_t codes;
+    uint32_t hashes;
+    uint32_t timings;
+    uint32_t strings;
+} IRDbHeader_t;
+
+/**
+ * @brief A command of the database, sorted by device and function name.
+ * For RAW commands code is the index of the first timing and bits the number
+ * of timings in microseconds, sent with a carrier of khz.
+ */
+typedef struct {
+    uint64_t code;
+    uint32_t device;
+    uint32_t function;
+    int16_t type;
+    uint16_t bits;
+    uint16_t khz;
+    uint16_t reserved;
+} IRDbEntry_t;
+
+/**
+ * @brief Hash of a name and the index of its entry, sorted by hash.
+ */
+typedef struct {
+    uint32_t hash;
+    uint32_t index;
+} IRDbHash_t;
+
+/**
+ * @brief Read only access to a IR code database in flash.
+ * The database is generated by tools/irdb.py from LIRC, Pronto and IRDB 
+ * files and flashed into its own partition. The partition is memory mapped, 
+ * all lookups are binary searches directly on the flash contents, nothing 
+ * is copied to RAM. Commands are found by name, by protocol and code, and by
+ * the hash of the name used to reference RAW commands.
+ */
+class IRDb {
+    public:
+
+        /**
+         * @brief Constructor
+         */
+        IRDb();
+
+        /**
+         * @brief Map the database partition.
+         * @return true if a valid database is present.
+         */
+        bool begin(void);
+
+        /**
+         * @brief Use a database in memory.
+         * Validates the header, the section bounds and the CRC.
+         * @param data The database, has to stay valid while in use.
+         * @param size The number of bytes available at data.
+         * @return true if the database is valid, otherwise the database is 
+         *         empty.
+         */
+        bool attach(const uint8_t *data, uint32_t size);
+
+        /**
+         * @brief Get the number of commands.
+         * @return The number of commands, 0 if there is no valid database.
+         */
+        uint32_t getCount(void) const;
+
+        /**
+         * @brief Find a command by name.
+         * The case of the names is ignored.
+         * @param device The device name.
+         * @param function The function name.
+         * @return Pointer to the command in flash, nullptr if not found.
+         */
+        const IRDbEntry_t* find(const char *device, const char *function) const;
+
+        /**
+         * @brief Find a command by its name as "device/function".
+         * @param name The name of the command.
+         * @return Pointer to the command in flash, nullptr if not found.
+         */
+        const IRDbEntry_t* find(const char *name) const;
+
+        /**
+         * @brief Find a command by protocol and code.
+         * @param type The IR protocol.
+         * @param code The code.
+         * @return Pointer to the first command using the code, nullptr if not 
+         *         found.
+         */
+        const IRDbEntry_t* findCode(decode_type_t type, uint64_t code) const;
+
+        /**
+         * @brief Find a command by its reference.
+         * @param ref The reference, see IRDB_REF.
+         * @return Pointer to the command in flash, nullptr if not found.
+         */
+        const IRDbEntry_t* findRef(uint64_t ref) const;
+
+        /**
+         * @brief Get the reference of a command.
+         * @param entry The command.
+         * @return The reference, see IRDB_REF.
+         */
+        uint64_t getRef(const IRDbEntry_t *entry) const;
+
+        /**
+         * @brief Resolve a command name to a code which can be transmitted.
+         * RAW commands resolve to their reference.
+         * @param name The name of the command as "device/function".
+         * @param type Reference to store the protocol.
+         * @param code Reference to store the code.
+         * @param bits Reference to store the number of bits, 0 for RAW.
+         * @return true on success, false if not found.
+         */
+        bool resolve(const char *name, decode_type_t &type, uint64_t &code, uint16_t &bits) const;
+
+        /**
+         * @brief Get the device name of a command.
+         * @param entry The command.
+         * @return The name in flash.
+         */
+        const char* getDevice(const IRDbEntry_t *entry) const;
+
+        /**
+         * @brief Get the function name of a command.
+         * @param entry The command.
+         * @return The name in flash.
+         */
+        const char* getFunction(const IRDbEntry_t *entry) const;
+
+        /**
+         * @brief Get the name of a command as "device/function".
+         * @param entry The command.
+         * @return The name.
+         */
+        String getName(const IRDbEntry_t *entry) const;
+
+        /**
+         * @brief Copy the timings of a RAW command.
+         * The timings end with the gap separating repeated frames.
+         * @param entry The command.
+         * @param buf The buffer to store the timings in microseconds.
+         * @param size The size of the buffer.
+         * @return The number of timings, 0 if it is no RAW command or the 
+         *         buffer is too small.
+         */
+        uint16_t expand(const IRDbEntry_t *entry, uint16_t *buf, uint16_t size) const;
+
+        /**
+         * @brief Get the devices and their number of commands as text.
+         * @return One line per device.
+         */
+        String getDeviceString(void) const;
+
+        /**
+         * @brief Get the commands of a device as text.
+         * @param device The device name.
+         * @return One line per command.
+         */
+        String getListString(const char *device) const;
+
+        /**
+         * @brief Get a command as text.
+         * @param entry The command.
+         * @return The name, protocol and code of the command in one line.
+         */
+        String getEntryString(const IRDbEntry_t *entry) const;
+
+        /**
+         * @brief Get the size and the lookup statistics as text.
+         * @return The statistics message.
+         */
+        String getStatsString(void) const;
+
+        /**
+         * @brief Hash a command name, FNV-1a of "device/function" in lower case.
+         * @param device The device name.
+         * @param function The function name.
+         * @return The hash.
+         */
+        static uint32_t hash(const char *device, const char *function);
+
+    private:
+
+        /**
+         * @brief Compare a command to a name, ignoring case.
+         * @param entry The command.
+         * @param device The device name.
+         * @param function The function name.
+         * @return <0, 0 or >0 like strcmp.
+         */
+        int compare(const IRDbEntry_t *entry, const char *device, const char *function) const;
+
+        /**
+         * @brief Find the first command not ordered before a name.
+         * @param device The device name.
+         * @param function The function name.
+         * @return The index of the command, getCount() if there is none.
+         */
+        uint32_t lowerBound(const char *device, const char *function) const;
+
+        /**
+         * @brief The database, nullptr if there is none.
+         */
+        const IRDbHeader_t *header;
+
+        /**
+         * @brief The commands, sorted by name.
+         */
+        const IRDbEntry_t *entries;
+
+        /**
+         * @brief Indices of the commands, sorted by protocol and code.
+         */
+        const uint16_t *codes;
+
+        /**
+         * @brief Name hashes, sorted by hash.
+         */
+        const IRDbHash_t *hashes;
+
+        /**
+         * @brief NUL terminated names.
+         */
+        const char *strings;
+
+        /**
+         * @brief Timings of the RAW commands.
+         */
+        const uint16_t *timings;
+
+        /**
+         * @brief The size of the flash partition, 0 if not found.
+         */
+        uint32_t partitionSize;
+
+        /**
+         * @brief Time taken to map and verify the database in microseconds.
+         */
+        uint32_t mapTime;
+
+        /**
+         * @brief Number of lookups.
+         */
+        mutable uint32_t lookups;
+
+        /**
+         * @brief Number of lookups which found a command.
+         */
+        mutable uint32_t hits;
+};
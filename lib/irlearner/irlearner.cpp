@@ -0,0 +1,390 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "irlearner.hpp"
+#include "serialproto.hpp"
+
+extern SerialProto serialProto;
+
+/**
+ * @brief Minimum number of timings of a capture to be learned.
+ */
+#define LEARN_MIN_TIMINGS           6
+
+/**
+ * @brief Maximum number of timings a capture is shifted against the first one,
+ * e.g. for a noise pulse in front of the frame. Even to keep marks on marks.
+ */
+#define LEARN_MAX_SHIFT             4
+
+/**
+ * @brief Percentage of the timings of the first capture which have to match
+ * for a capture to be accepted.
+ */
+#define LEARN_MIN_MATCH             75
+
+static int compareDuration(const void *a, const void *b) {
+    return (int) *(const uint16_t*) a - (int) *(const uint16_t*) b;
+}
+
+/**
+ * @brief Group sorted durations which are within the tolerance of the first
+ * duration of a group.
+ * @param sorted The durations in ascending order.
+ * @param len The number of durations.
+ * @param tolerance The tolerance in percent.
+ * @param table Stores the average of each group, LEARN_MAX_DURATIONS at most.
+ * @return The number of groups, may exceed LEARN_MAX_DURATIONS.
+ */
+static uint16_t cluster(const uint16_t *sorted, uint16_t len, uint32_t tolerance, uint16_t *table) {
+    uint32_t groupSum = sorted[0];
+    uint32_t first = sorted[0];
+    uint16_t groupLen = 1;
+    uint16_t num = 0;
+
+    for (uint16_t i = 1; i <= len; i++) {
+        if (i == len || sorted[i] > first + (first * tolerance) / 100) {
+            if (num < LEARN_MAX_DURATIONS) {
+                table[num] = groupSum / groupLen;
+            }
+            num++;
+
+            if (i < len) {
+                first = sorted[i];
+                groupSum = sorted[i];
+                groupLen = 1;
+            }
+        } else {
+            groupSum += sorted[i];
+            groupLen++;
+        }
+    }
+
+    return num;
+}
+
+IRLearner::IRLearner() :
+      wanted(0)
+    , captured(0)
+    , length(0)
+    , status("idle")
+{
+    name[0] = 0;
+}
+
+void IRLearner::report(void) {
+    /* Text would break the frames of the binary protocol */
+    if (!serialProto.isActive()) {
+        Serial.printf("Learn: %s\n", status.c_str());
+    }
+}
+
+bool IRLearner::start(const char *pName, uint8_t captures) {
+    if (pName == nullptr || pName[0] == 0 || strlen(pName) >= sizeof(name)) {
+        return false;
+    }
+
+    if (captures == 0 || captures > LEARN_MAX_CAPTURES) {
+        return false;
+    }
+
+    strcpy(name, pName);
+    wanted = captures;
+    captured = 0;
+    length = 0;
+    status = "Learning " + String(name) + ", press the button " + String(wanted) + " times";
+    if (!serialProto.isActive()) {
+        Serial.printf("%s\n", status.c_str());
+    }
+
+    return true;
+}
+
+void IRLearner::cancel(void) {
+    if (isActive()) {
+        wanted = 0;
+        status = "Learning " + String(name) + " canceled";
+    }
+}
+
+bool IRLearner::isActive(void) const {
+    return wanted != 0;
+}
+
+void IRLearner::capture(const decode_results *results) {
+    uint16_t len = results->rawlen > 0 ? results->rawlen - 1 : 0;
+
+    /* rawbuf[0] holds the gap before the frame */
+    if (!isActive() || results->repeat || len < LEARN_MIN_TIMINGS) {
+        return;
+    }
+
+    if (results->overflow || len > LEARN_MAX_TIMINGS) {
+        status = "Capture ignored, the code is too long";
+        report();
+        return;
+    }
+
+    if (captured == 0) {
+        length = len;
+        for (uint16_t i = 0; i < len; i++) {
+            sum[i] = results->rawbuf[i + 1] * kRawTick;
+            hits[i] = 1;
+        }
+    } else {
+        uint16_t matches = 0;
+        int16_t shift = align(results, len, &matches);
+
+        if (matches * 100 < length * LEARN_MIN_MATCH) {
+            status = "Capture ignored, only " + String(matches) + " of " + 
+                    String(length) + " timings match";
+            report();
+            return;
+        }
+
+        /* Timings outside the tolerance are left out of the average */
+        for (uint16_t i = 0; i < length; i++) {
+            int16_t j = i + shift;
+
+            if (j >= 0 && j < len && matchTiming(i, results->rawbuf[j + 1] * kRawTick)) {
+                sum[i] += results->rawbuf[j + 1] * kRawTick;
+                hits[i]++;
+            }
+        }
+    }
+
+    captured++;
+    status = "Captured " + String(captured) + " of " + String(wanted);
+    report();
+
+    if (captured == wanted) {
+        finish();
+    }
+}
+
+int16_t IRLearner::align(const decode_results *results, uint16_t len, uint16_t *pMatches) const {
+    int16_t best = 0;
+
+    *pMatches = 0;
+    for (int16_t shift = -LEARN_MAX_SHIFT; shift <= LEARN_MAX_SHIFT; shift += 2) {
+        uint16_t matches = 0;
+
+        for (uint16_t i = 0; i < length; i++) {
+            int16_t j = i + shift;
+
+            if (j >= 0 && j < len && matchTiming(i, results->rawbuf[j + 1] * kRawTick)) {
+                matches++;
+            }
+        }
+
+        /* Prefer the smaller shift on a tie */
+        if (matches > *pMatches || (matches == *pMatches && abs(shift) < abs(best))) {
+            *pMatches = matches;
+            best = shift;
+        }
+    }
+
+    return best;
+}
+
+bool IRLearner::matchTiming(uint16_t idx, uint32_t usec) const {
+    uint32_t avg = sum[idx] / hits[idx];
+    uint32_t delta = usec > avg ? usec - avg : avg - usec;
+
+    return delta <= (avg * LEARN_TOLERANCE) / 100;
+}
+
+int8_t IRLearner::find(const char *pName) const {
+    const LearnedCode_t *codes = Parameter.learned();
+
+    for (int8_t i = 0; i < PARAM_MAX_LEARNED; i++) {
+        if (codes[i].name[0] != 0 && 
+                strcasecmp(codes[i].name, pName) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+const LearnedCode_t* IRLearner::get(int8_t idx) const {
+    if (idx < 0 || idx >= PARAM_MAX_LEARNED || Parameter.learned()[idx].name[0] == 0) {
+        return nullptr;
+    }
+
+    return &Parameter.learned()[idx];
+}
+
+uint16_t IRLearner::expand(int8_t idx, uint16_t *buf, uint16_t size) const {
+    const LearnedCode_t *code = get(idx);
+
+    if (code == nullptr || size < code->count + 1) {
+        return 0;
+    }
+
+    for (uint16_t i = 0; i < code->count; i++) {
+        uint8_t index = code->indices[i >> 1] >> ((i & 1) << 2);
+        buf[i] = code->durations[index & 0x0F];
+    }
+    buf[code->count] = LEARN_GAP_US;
+
+    return code->count + 1;
+}
+
+bool IRLearner::remove(const char *pName) {
+    int8_t idx = find(pName);
+
+    if (idx < 0) {
+        return false;
+    }
+
+    memset(&Parameter.learned()[idx], 0, sizeof(LearnedCode_t));
+    Parameter.write("lrn");
+    return true;
+}
+
+String IRLearner::getStatusString(void) const {
+    return status + "\n";
+}
+
+String IRLearner::getListString(void) const {
+    String data;
+
+    for (int8_t i = 0; i < PARAM_MAX_LEARNED; i++) {
+        const LearnedCode_t *code = get(i);
+        uint32_t rawSize = 0;
+        uint32_t size = 0;
+        char line[112];
+
+        if (code == nullptr) {
+            continue;
+        }
+
+        /* Size of the timings as uint16_t array compared to the template */
+        rawSize = code->count * sizeof(uint16_t);
+        size = code->numDurations * sizeof(uint16_t) + (code->count + 1) / 2 + 4;
+        snprintf(line, sizeof(line), "%s; %u timings; %u durations; %u bytes (raw %u bytes, ratio %.1f)\n",
+                code->name, code->count, code->numDurations, size, rawSize, 
+                (float) rawSize / size);
+        data += line;
+    }
+
+    if (data.length() == 0) {
+        data = "none\n";
+    }
+
+    return data;
+}
+
+void IRLearner::finish(void) {
+    LearnedCode_t code;
+    uint16_t avg[LEARN_MAX_TIMINGS];
+    uint16_t sorted[LEARN_MAX_TIMINGS];
+    uint32_t tolerance = 5;
+    uint16_t num = 0;
+    int8_t idx = find(name);
+
+    wanted = 0;
+
+    if (idx < 0) {
+        const LearnedCode_t *codes = Parameter.learned();
+
+        for (idx = 0; idx < PARAM_MAX_LEARNED; idx++) {
+            if (codes[idx].name[0] == 0) {
+                break;
+            }
+        }
+
+        if (idx == PARAM_MAX_LEARNED) {
+            status = "Learning " + String(name) + " failed, no free slot";
+            report();
+            return;
+        }
+    }
+
+    for (uint16_t i = 0; i < length; i++) {
+        avg[i] = min(sum[i] / hits[i], (uint32_t) UINT16_MAX);
+    }
+    memcpy(sorted, avg, length * sizeof(uint16_t));
+    qsort(sorted, length, sizeof(uint16_t), compareDuration);
+
+    memset(&code, 0, sizeof(code));
+
+    /* Widen the tolerance until all durations fit into the table */
+    do {
+        num = cluster(sorted, length, tolerance, code.durations);
+        tolerance += 5;
+    } while (num > LEARN_MAX_DURATIONS);
+
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t best = 0;
+
+        for (uint8_t j = 1; j < num; j++) {
+            if (abs((int32_t) code.durations[j] - avg[i]) < 
+                    abs((int32_t) code.durations[best] - avg[i])) {
+                best = j;
+            }
+        }
+        code.indices[i >> 1] |= best << ((i & 1) << 2);
+    }
+
+    strcpy(code.name, name);
+    code.count = length;
+    code.numDurations = num;
+    code.khz = 38;
+    Parameter.learned()[idx] = code;
+    Parameter.write("lrn");
+
+    status = "Learned " + String(name) + ", " + String(length) + " timings, " + 
+            String(num) + " durations";
+    report();
+}
+
+extern IRLearner irLearner;
+
+CLI_COMMAND(learn) {
+    if (argc == 0 || strcmp(argv[0], "list") == 0) {
+        Serial.print(irLearner.getStatusString());
+        Serial.print(irLearner.getListString());
+        return 0;
+    }
+
+    if (strcmp(argv[0], "cancel") == 0) {
+        irLearner.cancel();
+        return 0;
+    }
+
+    if (strcmp(argv[0], "del") == 0) {
+        if (argv[1] == nullptr || !irLearner.remove(argv[1])) {
+            Serial.printf("Error: Unknown learned code!\n");
+            return -1;
+        }
+        return 0;
+    }
+
+    if (argc > 2 || !irLearner.start(argv[0], argc == 2 ? atoi(argv[1]) : 3)) {
+        Serial.printf("Error: Usage: learn name [count], up to 15 characters and %u captures\n",
+                LEARN_MAX_CAPTURES);
+        return -1;
+    }
+
+    return 0;
+}
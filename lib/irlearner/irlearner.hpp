@@ -0,0 +1,193 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRrecv.h>
+
+#include "parameter.hpp"
+
+/**
+ * @brief The maximum number of captures averaged for a learned code.
+ */
+#define LEARN_MAX_CAPTURES          8
+
+/**
+ * @brief Tolerance in percent for captures of the same button.
+ */
+#define LEARN_TOLERANCE             25
+
+/**
+ * @brief Space appended to a replayed learned code in microseconds.
+ * Separates repeated frames.
+ */
+#define LEARN_GAP_US                40000
+
+/**
+ * @brief Learns unknown IR codes from raw captures.
+ * Several presses of the same button are captured, aligned to the first 
+ * capture and the matching mark and space timings are averaged. The averages are quantized to a small set of unique
+ * durations and stored as compact template in the parameters.
+ */
+class IRLearner {
+    public:
+
+        /**
+         * @brief Constructor
+         */
+        IRLearner();
+
+        /**
+         * @brief Start learning a code.
+         * @param name The name to store the code as.
+         * @param captures The number of presses to capture.
+         * @return true on success, false if the arguments are invalid.
+         */
+        bool start(const char *name, uint8_t captures);
+
+        /**
+         * @brief Stop learning without storing a code.
+         */
+        void cancel(void);
+
+        /**
+         * @brief Check if learning is ongoing.
+         * @return true while waiting for captures.
+         */
+        bool isActive(void) const;
+
+        /**
+         * @brief Process a capture.
+         * Has to be called before the receive buffer is released.
+         * @param results The decode results holding the raw timings.
+         */
+        void capture(const decode_results *results);
+
+        /**
+         * @brief Find a learned code by its name.
+         * @param name The name of the code.
+         * @return The index of the code, -1 if not found.
+         */
+        int8_t find(const char *name) const;
+
+        /**
+         * @brief Get a learned code by its index.
+         * @param idx The index of the code.
+         * @return Pointer to the code, nullptr if the slot is empty.
+         */
+        const LearnedCode_t* get(int8_t idx) const;
+
+        /**
+         * @brief Expand a learned code to raw timings.
+         * A trailing gap is appended to separate repeated frames.
+         * @param idx The index of the code.
+         * @param buf The buffer to store the timings in microseconds.
+         * @param size The size of the buffer, at least LEARN_MAX_TIMINGS + 1.
+         * @return The number of timings, 0 if the code does not exist.
+         */
+        uint16_t expand(int8_t idx, uint16_t *buf, uint16_t size) const;
+
+        /**
+         * @brief Delete a learned code.
+         * @param name The name of the code.
+         * @return true on success, false if not found.
+         */
+        bool remove(const char *name);
+
+        /**
+         * @brief Get the learning status as text.
+         * @return The status message.
+         */
+        String getStatusString(void) const;
+
+        /**
+         * @brief Get the learned codes and their storage size as text.
+         * @return One line per learned code.
+         */
+        String getListString(void) const;
+
+    private:
+
+        /**
+         * @brief Print the status on the console, unless the binary protocol
+         * is active.
+         */
+        void report(void);
+
+        /**
+         * @brief Quantize the averaged timings and store the code.
+         */
+        void finish(void);
+
+        /**
+         * @brief Find the shift of a capture against the first capture with
+         * the most matching timings.
+         * @param results The decode results holding the raw timings.
+         * @param len The number of timings of the capture.
+         * @param pMatches Stores the number of matching timings.
+         * @return The shift in timings, added to the index of the first capture.
+         */
+        int16_t align(const decode_results *results, uint16_t len, uint16_t *pMatches) const;
+
+        /**
+         * @brief Check if a timing is within the tolerance of the average.
+         * @param idx The index of the timing of the first capture.
+         * @param usec The timing in microseconds.
+         * @return true if the timing matches.
+         */
+        bool matchTiming(uint16_t idx, uint32_t usec) const;
+
+        /**
+         * @brief The name of the code being learned.
+         */
+        char name[16];
+
+        /**
+         * @brief The number of captures to take.
+         */
+        uint8_t wanted;
+
+        /**
+         * @brief The number of captures taken so far.
+         */
+        uint8_t captured;
+
+        /**
+         * @brief The number of timings of the first capture.
+         */
+        uint16_t length;
+
+        /**
+         * @brief Sum of the timings of all captures.
+         */
+        uint32_t sum[LEARN_MAX_TIMINGS];
+
+        /**
+         * @brief Number of captures summed up per timing.
+         */
+        uint8_t hits[LEARN_MAX_TIMINGS];
+
+        /**
+         * @brief Result of the last learning step.
+         */
+        String status;
+};
@@ -0,0 +1,70 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "irsenddriver.hpp"
+
+IRSendDriver::IRSendDriver(uint8_t pin) :
+      irSend(pin)
+#if IRGW_AC
+    , irAc(pin)
+#endif
+{
+
+}
+
+void IRSendDriver::begin(void) {
+    irSend.begin();
+}
+
+bool IRSendDriver::send(decode_type_t type, uint64_t code, uint16_t bits, uint16_t frames) {
+    if (bits == 0) {
+        bits = IRsend::defaultBits(type);
+    }
+
+    do {
+        if (!irSend.send(type, code, bits, 0)) {
+            return false;
+        }
+        if (frames > 0) {
+            frames--;
+        }
+    } while (frames > 0);
+
+    return true;
+}
+
+bool IRSendDriver::sendState(decode_type_t type, const uint8_t *state, uint16_t nbytes) {
+    return irSend.send(type, state, nbytes);
+}
+
+void IRSendDriver::sendRaw(const uint16_t *buf, uint16_t len, uint16_t khz) {
+    irSend.sendRaw(buf, len, khz);
+}
+
+#if IRGW_AC
+bool IRSendDriver::sendAc(const stdAc::state_t &state, const stdAc::state_t *prev) {
+    return irAc.sendAc(state, prev);
+}
+#endif
+
+bool IRSendDriver::isBusy(void) {
+    return false;
+}
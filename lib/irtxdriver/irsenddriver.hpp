@@ -0,0 +1,70 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <IRsend.h>
+#include <IRac.h>
+
+#include "irtxdriver.hpp"
+
+/**
+ * @brief IR transmit driver based on IRsend.
+ * The carrier is generated in software, hence the CPU is blocked for the 
+ * whole transmission. Supports all protocols of the IRremoteESP8266 library.
+ */
+class IRSendDriver : public IRTxDriver {
+    public:
+
+        /**
+         * @brief Constructor
+         * @param pin The output pin.
+         */
+        IRSendDriver(uint8_t pin);
+
+        void begin(void) override;
+
+        bool send(decode_type_t type, uint64_t code, uint16_t bits, uint16_t frames) override;
+
+        bool sendState(decode_type_t type, const uint8_t *state, uint16_t nbytes) override;
+
+        void sendRaw(const uint16_t *buf, uint16_t len, uint16_t khz) override;
+
+#if IRGW_AC
+        bool sendAc(const stdAc::state_t &state, const stdAc::state_t *prev) override;
+#endif
+
+        bool isBusy(void) override;
+
+    private:
+
+        /**
+         * IR send object.
+         */
+        IRsend irSend;
+
+#if IRGW_AC
+        /**
+         * Air conditioner object, encodes the state based protocols.
+         */
+        IRac irAc;
+#endif
+};
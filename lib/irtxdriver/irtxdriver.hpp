@@ -0,0 +1,92 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRremoteESP8266.h>
+#include <IRsend.h>
+#include "common.hpp"
+
+/**
+ * @brief Interface of a IR transmit driver.
+ * A driver generates the modulated IR signal of complete frames on a single 
+ * output pin. Drivers may transmit asynchronously, in this case isBusy() 
+ * reports if the last transmission is still ongoing.
+ */
+class IRTxDriver {
+    public:
+
+        /**
+         * @brief Destructor
+         */
+        virtual ~IRTxDriver() {}
+
+        /**
+         * @brief Initialize the driver and the output pin.
+         */
+        virtual void begin(void) = 0;
+
+        /**
+         * @brief Transmit a IR code.
+         * @param type The IR protocol.
+         * @param code The code to transmit.
+         * @param bits The number of bits of the code, 0 for the default of 
+         *        the protocol.
+         * @param frames The number of complete frames to send, at least one.
+         * @return true on success, false if the protocol is not supported.
+         */
+        virtual bool send(decode_type_t type, uint64_t code, uint16_t bits, uint16_t frames) = 0;
+
+        /**
+         * @brief Transmit the state of a state based protocol.
+         * @param type The IR protocol.
+         * @param state The state bytes.
+         * @param nbytes The number of bytes.
+         * @return true on success, false if the protocol is not supported.
+         */
+        virtual bool sendState(decode_type_t type, const uint8_t *state, uint16_t nbytes) = 0;
+
+        /**
+         * @brief Transmit raw mark and space timings.
+         * @param buf The timings in microseconds, starting with a mark.
+         * @param len The number of timings.
+         * @param khz The carrier frequency in kHz.
+         */
+        virtual void sendRaw(const uint16_t *buf, uint16_t len, uint16_t khz) = 0;
+
+#if IRGW_AC
+        /**
+         * @brief Transmit the state of an air conditioner.
+         * @param state The state to send, including protocol and model.
+         * @param prev The state sent last, used by protocols which send 
+         *        toggles, nullptr if unknown.
+         * @return true on success, false if the protocol is not supported.
+         */
+        virtual bool sendAc(const stdAc::state_t &state, const stdAc::state_t *prev) = 0;
+#endif
+
+        /**
+         * @brief Check if a transmission is ongoing.
+         * @return true if the driver is still transmitting.
+         */
+        virtual bool isBusy(void) = 0;
+};
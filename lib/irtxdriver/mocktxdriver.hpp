@@ -0,0 +1,152 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "irtxdriver.hpp"
+#include "pulseencoder.hpp"
+
+/**
+ * @brief IR transmit driver which records transmissions instead of sending 
+ * them, used by the host tests.
+ * Pulse distance protocols are encoded into the same timings as sent by 
+ * RmtTxDriver, raw timings are recorded as given. All other protocols are 
+ * only recorded by their code or state.
+ */
+class MockTxDriver : public IRTxDriver, private PulseEncoder {
+    public:
+
+        /**
+         * @brief A recorded mark or space.
+         */
+        typedef struct {
+            bool level;
+            uint32_t usec;
+        } Pulse_t;
+
+        /**
+         * @brief A recorded transmission.
+         */
+        typedef struct {
+            decode_type_t type;
+            uint64_t code;
+            uint16_t bits;
+            uint16_t frames;
+            uint16_t khz;
+            std::vector<uint8_t> state;
+            std::vector<Pulse_t> pulses;
+        } Tx_t;
+
+        /**
+         * @brief Constructor
+         */
+        MockTxDriver() :
+              initialized(false)
+            , busy(false)
+        {
+
+        }
+
+        void begin(void) override {
+            initialized = true;
+        }
+
+        bool send(decode_type_t type, uint64_t code, uint16_t bits, uint16_t frames) override {
+            const Timing_t *timing = getTiming(type);
+
+            if (bits == 0) {
+                bits = IRsend::defaultBits(type);
+            }
+
+            record(type, 0);
+            sent.back().code = code;
+            sent.back().bits = bits;
+            sent.back().frames = frames;
+            if (timing != nullptr && bits != 0 && bits <= 32) {
+                encode(*timing, code, bits, frames);
+            }
+
+            return true;
+        }
+
+        bool sendState(decode_type_t type, const uint8_t *state, uint16_t nbytes) override {
+            record(type, 0);
+            sent.back().state.assign(state, state + nbytes);
+
+            return true;
+        }
+
+        void sendRaw(const uint16_t *buf, uint16_t len, uint16_t khz) override {
+            record(decode_type_t::RAW, khz);
+            encodeRaw(buf, len);
+        }
+
+#if IRGW_AC
+        bool sendAc(const stdAc::state_t &state, const stdAc::state_t *prev) override {
+            record(state.protocol, 0);
+
+            return true;
+        }
+#endif
+
+        bool isBusy(void) override {
+            return busy;
+        }
+
+        /**
+         * @brief The recorded transmissions, the oldest first.
+         */
+        std::vector<Tx_t> sent;
+
+        /**
+         * @brief True after begin() has been called.
+         */
+        bool initialized;
+
+        /**
+         * @brief The value returned by isBusy().
+         */
+        bool busy;
+
+    protected:
+
+        void pulse(bool level, uint32_t usec) override {
+            sent.back().pulses.push_back({level, usec});
+        }
+
+    private:
+
+        /**
+         * @brief Start recording a transmission.
+         * @param type The IR protocol.
+         * @param khz The carrier frequency in kHz, 0 if given by the protocol.
+         */
+        void record(decode_type_t type, uint16_t khz) {
+            sent.push_back(Tx_t());
+            sent.back().type = type;
+            sent.back().code = 0;
+            sent.back().bits = 0;
+            sent.back().frames = 0;
+            sent.back().khz = khz;
+        }
+};
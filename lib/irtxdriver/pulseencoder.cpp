@@ -0,0 +1,94 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "pulseencoder.hpp"
+
+const PulseEncoder::Timing_t PulseEncoder::necTiming = {
+    8960, 4480, 560, 1680, 560, 22400, 108000
+};
+
+const PulseEncoder::Timing_t PulseEncoder::samsungTiming = {
+    4480, 4480, 560, 1680, 560, 11200, 108000
+};
+
+const PulseEncoder::Timing_t* PulseEncoder::getTiming(decode_type_t type) {
+    switch (type) {
+        case decode_type_t::NEC:
+        case decode_type_t::NEC_LIKE:
+            return &necTiming;
+
+        case decode_type_t::SAMSUNG:
+            return &samsungTiming;
+
+        default:
+            return nullptr;
+    }
+}
+
+void PulseEncoder::encode(const Timing_t &timing, uint64_t code, uint16_t bits, uint16_t frames) {
+    do {
+        uint32_t length = timing.hdrMark + timing.hdrSpace + timing.bitMark;
+        uint32_t gap = 0;
+
+        pulse(true, timing.hdrMark);
+        pulse(false, timing.hdrSpace);
+        for (uint64_t mask = 1ULL << (bits - 1); mask != 0; mask >>= 1) {
+            uint16_t space = (code & mask) ? timing.oneSpace : timing.zeroSpace;
+
+            pulse(true, timing.bitMark);
+            pulse(false, space);
+            length += timing.bitMark + space;
+        }
+        pulse(true, timing.bitMark);
+
+        gap = length < timing.frameLength ? timing.frameLength - length : 0;
+        pulse(false, max(gap, (uint32_t) timing.minGap));
+
+        if (frames > 0) {
+            frames--;
+        }
+    } while (frames > 0);
+}
+
+void PulseEncoder::encodeRaw(const uint16_t *buf, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        pulse((i & 1) == 0, buf[i]);
+    }
+}
+
+PulseCounter::PulseCounter(uint32_t maxDuration) :
+      maxDuration(maxDuration)
+    , count(0)
+{
+
+}
+
+uint32_t PulseCounter::getCount(void) const {
+    return count;
+}
+
+void PulseCounter::pulse(bool level, uint32_t usec) {
+    if (usec == 0) {
+        return;
+    }
+
+    count += maxDuration == 0 ? 1 : (usec + maxDuration - 1) / maxDuration;
+}
@@ -0,0 +1,133 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRremoteESP8266.h>
+
+/**
+ * @brief Encodes frames of pulse distance protocols into mark and space 
+ * timings.
+ * The encoding does not depend on the hardware, derived classes store the 
+ * timings passed to pulse(). This allows to check the size of a transmission
+ * before anything is sent and to record the timings in host tests.
+ */
+class PulseEncoder {
+    public:
+
+        /**
+         * @brief Timings of a pulse distance protocol in microseconds.
+         */
+        typedef struct {
+            uint16_t hdrMark;
+            uint16_t hdrSpace;
+            uint16_t bitMark;
+            uint16_t oneSpace;
+            uint16_t zeroSpace;
+            uint16_t minGap;
+            uint32_t frameLength;
+        } Timing_t;
+
+        /**
+         * @brief Timings of the NEC protocol.
+         */
+        static const Timing_t necTiming;
+
+        /**
+         * @brief Timings of the Samsung protocol.
+         */
+        static const Timing_t samsungTiming;
+
+        /**
+         * @brief Get the timings of a protocol.
+         * @param type The IR protocol.
+         * @return Pointer to the timings, nullptr if not supported.
+         */
+        static const Timing_t* getTiming(decode_type_t type);
+
+        /**
+         * @brief Destructor
+         */
+        virtual ~PulseEncoder() {}
+
+        /**
+         * @brief Encode complete frames of a code.
+         * @param timing The timings of the protocol.
+         * @param code The code, the most significant bit is sent first.
+         * @param bits The number of bits, 1 to 32.
+         * @param frames The number of frames, at least one is encoded.
+         */
+        void encode(const Timing_t &timing, uint64_t code, uint16_t bits, uint16_t frames);
+
+        /**
+         * @brief Encode raw timings.
+         * @param buf The timings in microseconds, starting with a mark.
+         * @param len The number of timings.
+         */
+        void encodeRaw(const uint16_t *buf, uint16_t len);
+
+    protected:
+
+        /**
+         * @brief Called for each mark and space.
+         * @param level true for a mark, false for a space.
+         * @param usec The duration in microseconds.
+         */
+        virtual void pulse(bool level, uint32_t usec) = 0;
+};
+
+/**
+ * @brief Counts the pulses of a transmission without storing them.
+ */
+class PulseCounter : public PulseEncoder {
+    public:
+
+        /**
+         * @brief Constructor
+         * @param maxDuration The longest duration of a single pulse, longer 
+         *        marks and spaces are counted as several pulses. 0 for no 
+         *        limit.
+         */
+        PulseCounter(uint32_t maxDuration = 0);
+
+        /**
+         * @brief Get the number of pulses counted so far.
+         * @return The number of pulses.
+         */
+        uint32_t getCount(void) const;
+
+    protected:
+
+        void pulse(bool level, uint32_t usec) override;
+
+    private:
+
+        /**
+         * @brief The longest duration of a single pulse, 0 for no limit.
+         */
+        uint32_t maxDuration;
+
+        /**
+         * @brief The number of pulses.
+         */
+        uint32_t count;
+};
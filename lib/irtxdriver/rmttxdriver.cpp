@@ -0,0 +1,196 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "common.hpp"
+
+#if IRTX_USE_RMT
+
+#include "rmttxdriver.hpp"
+
+/**
+ * @brief APB clock cycles per microsecond, used as RMT tick.
+ */
+#define RMTTX_CLK_DIV               80
+
+/**
+ * @brief Longest duration of a single RMT item half in ticks.
+ */
+#define RMTTX_MAX_DURATION          32767
+
+/**
+ * @brief Carrier duty cycle in percent.
+ */
+#define RMTTX_DUTY                  33
+
+RmtTxDriver::RmtTxDriver(uint8_t pin, rmt_channel_t channel, IRTxDriver &fallback) :
+      pin(pin)
+    , channel(channel)
+    , fallback(fallback)
+    , attached(false)
+    , carrier(0)
+    , numItems(0)
+    , half(false)
+{
+
+}
+
+void RmtTxDriver::begin(void) {
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t) pin, channel);
+
+    config.clk_div = RMTTX_CLK_DIV;
+    config.tx_config.carrier_en = true;
+    config.tx_config.carrier_freq_hz = 38000;
+    config.tx_config.carrier_duty_percent = RMTTX_DUTY;
+    config.tx_config.carrier_level = RMT_CARRIER_LEVEL_HIGH;
+    config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+    config.tx_config.idle_output_en = true;
+
+    fallback.begin();
+    rmt_config(&config);
+    rmt_driver_install(channel, 0, 0);
+    attached = true;
+    carrier = 38;
+}
+
+bool RmtTxDriver::send(decode_type_t type, uint64_t code, uint16_t bits, uint16_t frames) {
+    const Timing_t *timing = getTiming(type);
+    PulseCounter counter(RMTTX_MAX_DURATION);
+
+    if (bits == 0) {
+        bits = IRsend::defaultBits(type);
+    }
+
+    if (timing == nullptr || bits == 0 || bits > 32) {
+        return useFallback().send(type, code, bits, frames);
+    }
+
+    counter.encode(*timing, code, bits, frames);
+    if (!fits(counter)) {
+        return useFallback().send(type, code, bits, frames);
+    }
+
+    prepare(38);
+    encode(*timing, code, bits, frames);
+    start();
+
+    return true;
+}
+
+bool RmtTxDriver::sendState(decode_type_t type, const uint8_t *state, uint16_t nbytes) {
+    return useFallback().sendState(type, state, nbytes);
+}
+
+void RmtTxDriver::sendRaw(const uint16_t *buf, uint16_t len, uint16_t khz) {
+    PulseCounter counter(RMTTX_MAX_DURATION);
+
+    counter.encodeRaw(buf, len);
+    if (!fits(counter)) {
+        useFallback().sendRaw(buf, len, khz);
+        return;
+    }
+
+    prepare(khz);
+    encodeRaw(buf, len);
+    start();
+}
+
+#if IRGW_AC
+bool RmtTxDriver::sendAc(const stdAc::state_t &state, const stdAc::state_t *prev) {
+    return useFallback().sendAc(state, prev);
+}
+#endif
+
+bool RmtTxDriver::isBusy(void) {
+    return rmt_wait_tx_done(channel, 0) != ESP_OK;
+}
+
+bool RmtTxDriver::fits(const PulseCounter &counter) {
+    /* Two pulses per item, one item is kept free for the end marker */
+    return (counter.getCount() + 1) / 2 <= RMTTX_MAX_ITEMS - 1;
+}
+
+IRTxDriver& RmtTxDriver::useFallback(void) {
+    /* The fallback needs the pin as plain GPIO */
+    rmt_wait_tx_done(channel, portMAX_DELAY);
+    if (attached) {
+        fallback.begin();
+        attached = false;
+    }
+
+    return fallback;
+}
+
+void RmtTxDriver::prepare(uint16_t khz) {
+    rmt_wait_tx_done(channel, portMAX_DELAY);
+
+    if (!attached) {
+        rmt_set_gpio(channel, RMT_MODE_TX, (gpio_num_t) pin, false);
+        attached = true;
+    }
+
+    if (khz != carrier && khz != 0) {
+        uint32_t period = (APB_CLK_FREQ / 1000) / khz;
+        uint32_t high = (period * RMTTX_DUTY) / 100;
+
+        rmt_set_tx_carrier(channel, true, high, period - high, RMT_CARRIER_LEVEL_HIGH);
+        carrier = khz;
+    }
+
+    numItems = 0;
+    half = false;
+}
+
+void RmtTxDriver::pulse(bool level, uint32_t usec) {
+    while (usec > 0) {
+        uint16_t duration = min(usec, (uint32_t) RMTTX_MAX_DURATION);
+
+        if (numItems >= RMTTX_MAX_ITEMS - 1) {
+            return;
+        }
+
+        if (!half) {
+            items[numItems].level0 = level;
+            items[numItems].duration0 = duration;
+            half = true;
+        } else {
+            items[numItems].level1 = level;
+            items[numItems].duration1 = duration;
+            numItems++;
+            half = false;
+        }
+        usec -= duration;
+    }
+}
+
+void RmtTxDriver::start(void) {
+    if (half) {
+        items[numItems].level1 = 0;
+        items[numItems].duration1 = 0;
+        numItems++;
+        half = false;
+    }
+
+    if (numItems > 0) {
+        rmt_write_items(channel, items, numItems, false);
+    }
+}
+
+#endif /* IRTX_USE_RMT */
@@ -0,0 +1,143 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <driver/rmt.h>
+
+#include "irtxdriver.hpp"
+#include "pulseencoder.hpp"
+
+/**
+ * @brief The maximum number of RMT items of a single transmission.
+ * Each item holds one mark and one space.
+ */
+#define RMTTX_MAX_ITEMS             512
+
+/**
+ * @brief IR transmit driver based on the ESP32 RMT peripheral.
+ * Frames are encoded into mark/space items in advance which are then streamed
+ * by the RMT peripheral including the carrier modulation. The transmission
+ * runs in the background, the CPU is free after send() returned. 
+ * Protocols which can't be encoded and transmissions which exceed the item 
+ * buffer are passed to the fallback driver, a frame is never truncated.
+ */
+class RmtTxDriver : public IRTxDriver, private PulseEncoder {
+    public:
+
+        /**
+         * @brief Constructor
+         * @param pin The output pin.
+         * @param channel The RMT channel to use.
+         * @param fallback The driver used for protocols not supported here.
+         */
+        RmtTxDriver(uint8_t pin, rmt_channel_t channel, IRTxDriver &fallback);
+
+        void begin(void) override;
+
+        bool send(decode_type_t type, uint64_t code, uint16_t bits, uint16_t frames) override;
+
+        bool sendState(decode_type_t type, const uint8_t *state, uint16_t nbytes) override;
+
+        void sendRaw(const uint16_t *buf, uint16_t len, uint16_t khz) override;
+
+#if IRGW_AC
+        bool sendAc(const stdAc::state_t &state, const stdAc::state_t *prev) override;
+#endif
+
+        bool isBusy(void) override;
+
+    private:
+
+        /**
+         * @brief Check if a transmission fits into the item buffer.
+         * @param counter The counted pulses of the transmission.
+         * @return true if it fits, including the end marker.
+         */
+        static bool fits(const PulseCounter &counter);
+
+        /**
+         * @brief Wait for the ongoing transmission and hand the pin over to 
+         * the fallback driver.
+         * @return The fallback driver.
+         */
+        IRTxDriver& useFallback(void);
+
+        /**
+         * @brief Wait for the ongoing transmission and take over the pin.
+         * @param khz The carrier frequency in kHz.
+         */
+        void prepare(uint16_t khz);
+
+        /**
+         * @brief Append a mark or space to the item buffer.
+         * The size has to be checked by fits() in advance, pulses which 
+         * don't fit are dropped.
+         * @param level true for a mark, false for a space.
+         * @param usec The duration in microseconds.
+         */
+        void pulse(bool level, uint32_t usec) override;
+
+        /**
+         * @brief Terminate the item buffer and start the transmission.
+         */
+        void start(void);
+
+        /**
+         * @brief The output pin.
+         */
+        uint8_t pin;
+
+        /**
+         * @brief The RMT channel.
+         */
+        rmt_channel_t channel;
+
+        /**
+         * @brief Driver for protocols which can't be encoded.
+         */
+        IRTxDriver &fallback;
+
+        /**
+         * @brief True if the pin is connected to the RMT channel.
+         */
+        bool attached;
+
+        /**
+         * @brief The current carrier frequency in kHz.
+         */
+        uint16_t carrier;
+
+        /**
+         * @brief The item buffer, has to stay valid during the transmission.
+         */
+        rmt_item32_t items[RMTTX_MAX_ITEMS];
+
+        /**
+         * @brief Number of complete items in the buffer.
+         */
+        uint16_t numItems;
+
+        /**
+         * @brief True if the last item only holds the first half.
+         */
+        bool half;
+};
@@ -0,0 +1,50 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "txchannel.hpp"
+
+TxChannel::TxChannel(uint8_t pin, uint8_t index) :
+      pin(pin)
+    , sendDriver(pin)
+#if IRTX_USE_RMT
+    , rmtDriver(pin, (rmt_channel_t) index, sendDriver)
+#endif
+{
+
+}
+
+void TxChannel::begin(void) {
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, false);
+    getDriver().begin();
+}
+
+IRTxDriver& TxChannel::getDriver(void) {
+#if IRTX_USE_RMT
+    return rmtDriver;
+#else
+    return sendDriver;
+#endif
+}
+
+uint8_t TxChannel::getPin(void) const {
+    return pin;
+}
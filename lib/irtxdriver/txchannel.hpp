@@ -0,0 +1,82 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "common.hpp"
+#include "irsenddriver.hpp"
+#if IRTX_USE_RMT
+#include "rmttxdriver.hpp"
+#endif
+
+/**
+ * @brief A IR transmit channel.
+ * Each channel drives its own IR LED, channels using the RMT driver transmit 
+ * in parallel.
+ */
+class TxChannel {
+    public:
+
+        /**
+         * @brief Constructor
+         * @param pin The output pin.
+         * @param index The index of the channel, selects the RMT channel.
+         */
+        TxChannel(uint8_t pin, uint8_t index);
+
+        /**
+         * @brief Initialize the transmit driver.
+         */
+        void begin(void);
+
+        /**
+         * @brief Get the transmit driver of the channel.
+         * @return The driver in use.
+         */
+        IRTxDriver& getDriver(void);
+
+        /**
+         * @brief Get the output pin.
+         * @return The pin number.
+         */
+        uint8_t getPin(void) const;
+
+    private:
+
+        /**
+         * The output pin.
+         */
+        uint8_t pin;
+
+        /**
+         * Software transmit driver, used as fallback by the RMT driver.
+         */ 
+        IRSendDriver sendDriver;
+
+#if IRTX_USE_RMT
+        /**
+         * RMT transmit driver.
+         */ 
+        RmtTxDriver rmtDriver;
+#endif
+};
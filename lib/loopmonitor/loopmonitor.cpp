@@ -0,0 +1,170 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "loopmonitor.hpp"
+#include "parameter.hpp"
+#include "serialproto.hpp"
+
+#include <esp_task_wdt.h>
+
+extern SerialProto serialProto;
+
+/**
+ * @brief Names of the call sites, indexed by LoopSite_t.
+ */
+static const char *siteNames[LOOP_SITES] = {
+    "loop", "network", "timer", "receive", "scheduler", "ac", "server", "uptime", "cli"
+};
+
+LoopMonitor::LoopMonitor() :
+    wdtEnabled(false),
+    current(LOOP_SITE_LOOP) {
+    reset();
+}
+
+void LoopMonitor::begin(void) {
+    uint32_t timeout = Parameter.data.loop.wdt;
+
+    if (timeout == 0) {
+        if (wdtEnabled && esp_task_wdt_delete(nullptr) == ESP_OK) {
+            wdtEnabled = false;
+            if (!serialProto.isActive()) {
+                Serial.printf("Loop watchdog: off\n");
+            }
+        }
+        return;
+    }
+
+    /* A running watchdog only gets the new timeout */
+    timeout = max(timeout, (uint32_t) LOOPMON_WDT_MIN);
+    if (esp_task_wdt_init(timeout, true) == ESP_OK && 
+        (wdtEnabled || esp_task_wdt_add(nullptr) == ESP_OK)) {
+        wdtEnabled = true;
+        if (!serialProto.isActive()) {
+            Serial.printf("Loop watchdog: %us\n", timeout);
+        }
+    }
+}
+
+const char *LoopMonitor::getSiteName(LoopSite_t site) {
+    return siteNames[site];
+}
+
+void LoopMonitor::end(LoopSite_t site, uint32_t start) {
+    uint32_t duration = micros() - start;
+    Stats_t *s = &stats[site];
+    uint8_t bucket = 0;
+
+    current = LOOP_SITE_LOOP;
+    while (bucket < LOOPMON_BUCKETS - 1 && duration >= (1UL << bucket)) {
+        bucket++;
+    }
+
+    s->hist[bucket]++;
+    s->count++;
+    s->max = max(s->max, duration);
+
+    if (site != LOOP_SITE_LOOP && duration >= worstTime) {
+        worstSite = site;
+        worstTime = duration;
+    }
+}
+
+void LoopMonitor::endLoop(uint32_t start) {
+    uint32_t duration = micros() - start;
+    uint32_t threshold = Parameter.data.loop.stall;
+
+    end(LOOP_SITE_LOOP, start);
+
+    if (threshold == 0) {
+        threshold = LOOPMON_STALL_DEFAULT;
+    }
+
+    if (duration >= threshold * 1000) {
+        Stall_t *stall = &stalls[numStalls++ % LOOPMON_STALLS];
+
+        stall->time = millis();
+        stall->duration = duration;
+        stall->site = worstSite;
+    }
+
+    worstSite = LOOP_SITE_LOOP;
+    worstTime = 0;
+    feed();
+}
+
+void LoopMonitor::feed(void) {
+    if (wdtEnabled) {
+        esp_task_wdt_reset();
+    }
+}
+
+void LoopMonitor::reset(void) {
+    memset(stats, 0, sizeof(stats));
+    memset(stalls, 0, sizeof(stalls));
+    numStalls = 0;
+    worstSite = LOOP_SITE_LOOP;
+    worstTime = 0;
+}
+
+LoopMonitor::Stats_t LoopMonitor::getStats(LoopSite_t site) const {
+    return stats[site];
+}
+
+String LoopMonitor::getStatsString(void) const {
+    String data;
+    uint32_t threshold = Parameter.data.loop.stall;
+
+    for (uint8_t i = 0; i < LOOP_SITES; i++) {
+        const Stats_t *s = &stats[i];
+        uint8_t p99 = 0;
+        uint32_t sum = 0;
+
+        if (s->count == 0) {
+            continue;
+        }
+
+        /* The upper bound of the bucket holding the 99th percentile */
+        for (p99 = 0; p99 < LOOPMON_BUCKETS - 1; p99++) {
+            sum += s->hist[p99];
+            if (sum >= s->count - s->count / 100) {
+                break;
+            }
+        }
+
+        data += String(siteNames[i]) + "; count " + String(s->count) + "; p99 < " + 
+                String(1UL << p99) + "us; max " + String(s->max) + "us\n";
+    }
+
+    data += "stalls " + String(numStalls) + " (>= " + 
+            String(threshold == 0 ? LOOPMON_STALL_DEFAULT : threshold) + "ms)";
+    data += wdtEnabled ? "; watchdog " + String(max((uint32_t) Parameter.data.loop.wdt, 
+            (uint32_t) LOOPMON_WDT_MIN)) + "s\n" : "; watchdog off\n";
+
+    for (uint8_t i = 0; i < min(numStalls, (uint32_t) LOOPMON_STALLS); i++) {
+        const Stall_t *stall = &stalls[(numStalls - 1 - i) % LOOPMON_STALLS];
+
+        data += "  at " + String(stall->time) + "ms; " + String(stall->duration / 1000) + 
+                "ms; in " + siteNames[stall->site] + "\n";
+    }
+
+    return data;
+}
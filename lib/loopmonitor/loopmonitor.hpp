@@ -0,0 +1,215 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief The number of histogram buckets, bucket n counts durations below 
+ * 2^n us, the last one all longer ones.
+ */
+#define LOOPMON_BUCKETS             24
+
+/**
+ * @brief The number of stalls kept.
+ */
+#define LOOPMON_STALLS              8
+
+/**
+ * @brief The stall threshold in ms used if none has been configured.
+ */
+#define LOOPMON_STALL_DEFAULT       50
+
+/**
+ * @brief The minimum watchdog timeout in seconds, leaves a margin for flash 
+ * writes and frames sent by software. Handlers must not wait for queued 
+ * commands, the web server parks such requests instead.
+ */
+#define LOOPMON_WDT_MIN             10
+
+/**
+ * @brief Measure the duration of a call of the main loop using the global
+ * loopMonitor.
+ * @param _site_ The LoopSite_t of the call.
+ * @param _call_ The call.
+ */
+#define LOOPMON_CALL(_site_, _call_) \
+    do { \
+        uint32_t _start_ = micros(); \
+        loopMonitor.enter(_site_); \
+        _call_; \
+        loopMonitor.end(_site_, _start_); \
+    } while (0)
+
+/**
+ * @brief The call sites of the main loop.
+ */
+typedef enum {
+    LOOP_SITE_LOOP = 0,
+    LOOP_SITE_NETWORK,
+    LOOP_SITE_TIMER,
+    LOOP_SITE_RECEIVE,
+    LOOP_SITE_SCHEDULER,
+    LOOP_SITE_AC,
+    LOOP_SITE_SERVER,
+    LOOP_SITE_UPTIME,
+    LOOP_SITE_CLI,
+    LOOP_SITES
+} LoopSite_t;
+
+/**
+ * @brief Main loop stall detector.
+ * Measures each loop iteration and each call of the loop into a duration 
+ * histogram per call site. Iterations longer than the stall threshold are
+ * recorded together with the slowest call. Optionally the loop task is 
+ * subscribed to the task watchdog, which resets the CPU if the loop does not
+ * complete within the configured time.
+ */
+class LoopMonitor {
+    public:
+
+        /**
+         * @brief Statistics of a call site.
+         */
+        typedef struct {
+            uint32_t count;
+            uint32_t max;
+            uint32_t hist[LOOPMON_BUCKETS];
+        } Stats_t;
+
+        /**
+         * @brief A recorded stall.
+         */
+        typedef struct {
+            uint32_t time;
+            uint32_t duration;
+            uint8_t site;
+        } Stall_t;
+
+        /**
+         * @brief Constructor
+         */
+        LoopMonitor();
+
+        /**
+         * @brief Apply the configured watchdog timeout, may be called again 
+         * after the wdt parameter has changed.
+         */
+        void begin(void);
+
+        /**
+         * @brief Mark the start of a call.
+         * @param site The call site.
+         */
+        void enter(LoopSite_t site) {
+            current = site;
+        }
+
+        /**
+         * @brief Returns the call site being executed, LOOP_SITE_LOOP if none.
+         */
+        LoopSite_t getSite(void) const {
+            return current;
+        }
+
+        /**
+         * @brief Returns the name of a call site.
+         * @param site The call site.
+         */
+        static const char *getSiteName(LoopSite_t site);
+
+        /**
+         * @brief Record the duration of a call and mark its end.
+         * @param site The call site.
+         * @param start The micros() timestamp of the start of the call.
+         */
+        void end(LoopSite_t site, uint32_t start);
+
+        /**
+         * @brief Record the duration of a loop iteration, check for a stall
+         * and feed the watchdog.
+         * @param start The micros() timestamp of the start of the iteration.
+         */
+        void endLoop(uint32_t start);
+
+        /**
+         * @brief Feed the watchdog while the loop waits on purpose, e.g. for
+         * user input.
+         */
+        void feed(void);
+
+        /**
+         * @brief Reset the statistics and the recorded stalls.
+         */
+        void reset(void);
+
+        /**
+         * @brief Get the statistics of a call site.
+         * @param site The call site.
+         * @return The statistics.
+         */
+        Stats_t getStats(LoopSite_t site) const;
+
+        /**
+         * @brief Get the statistics and the recorded stalls as text.
+         * @return One line per call site followed by the stalls.
+         */
+        String getStatsString(void) const;
+
+    private:
+
+        /**
+         * @brief The statistics per call site.
+         */
+        Stats_t stats[LOOP_SITES];
+
+        /**
+         * @brief The recorded stalls.
+         */
+        Stall_t stalls[LOOPMON_STALLS];
+
+        /**
+         * @brief The total number of stalls, the next one is stored at 
+         * numStalls % LOOPMON_STALLS.
+         */
+        uint32_t numStalls;
+
+        /**
+         * @brief The slowest call of the current iteration.
+         */
+        uint8_t worstSite;
+
+        /**
+         * @brief The duration of the slowest call of the current iteration.
+         */
+        uint32_t worstTime;
+
+        /**
+         * @brief True if the loop task is subscribed to the watchdog.
+         */
+        bool wdtEnabled;
+
+        /**
+         * @brief The call site being executed.
+         */
+        volatile LoopSite_t current;
+};
@@ -20,11 +20,108 @@
  */
 
 #include <Arduino.h>
+#include <stddef.h>
+#include <WiFi.h>
+#include <param/param.hpp>
 #include "parameter.hpp"
+#include "loopmonitor.hpp"
 
 #define readStringParameter(_param_)        readString().toCharArray(_param_, sizeof(_param_))
 
-Param<Parameter_t> Parameter;
+#define importParameter(_field_)            memcpy(&Parameter.data._field_, &legacy.data._field_, \
+                                                sizeof(Parameter.data._field_))
+
+extern LoopMonitor loopMonitor;
+
+#define PARAM_SECTION(_key_, _field_, _version_) \
+    {_key_, offsetof(Parameter_t, _field_), \
+        sizeof(((Parameter_t *) 0)->_field_), 1, _version_}
+
+#define PARAM_ARRAY(_key_, _field_, _version_) \
+    {_key_, offsetof(Parameter_t, _field_), \
+        sizeof(((Parameter_t *) 0)->_field_[0]), \
+        sizeof(((Parameter_t *) 0)->_field_) / \
+        sizeof(((Parameter_t *) 0)->_field_[0]), _version_}
+
+/**
+ * @brief The key table of the parameters, new keys have to be appended, see
+ * ParamKeyIdx_t. The version of a key has to be increased if its fields 
+ * change in any other way than appending new ones.
+ */
+const ParamKey_t parameterKeys[] = {
+    PARAM_SECTION("wifi", wifi, 1),
+    PARAM_SECTION("ip", ip, 1),
+    PARAM_SECTION("ntp", ntp, 1),
+    PARAM_SECTION("tx", tx, 1),
+    PARAM_SECTION("relay", relay, 1),
+    PARAM_SECTION("rx", rx, 1),
+    PARAM_SECTION("loop", loop, 1),
+    PARAM_ARRAY("dev", devices, 1),
+    PARAM_ARRAY("cat", catalog, 1),
+    PARAM_ARRAY("lrn", learned, 1),
+    PARAM_ARRAY("rule", rules, 1),
+    PARAM_ARRAY("ac", acUnits, 1),
+    PARAM_ARRAY("tmr", timers, 1),
+};
+
+static_assert(sizeof(parameterKeys) / sizeof(parameterKeys[0]) == PARAM_KEY_COUNT, 
+    "ParamKeyIdx_t does not match the key table");
+
+/**
+ * @brief Sets the initial defaults of a record, all fields not set here 
+ * are 0.
+ */
+static void param_record_defaults(const ParamKey_t *pKey, uint8_t idx, void *pRec) {
+    if (pKey == &parameterKeys[PARAM_KEY_IP]) {
+        decltype(Parameter_t::ip) *ip = (decltype(Parameter_t::ip) *) pRec;
+
+        sprintf(ip->hostname, "ir-gateway");
+        ip->dhcp = true;
+    } else if (pKey == &parameterKeys[PARAM_KEY_NTP]) {
+        decltype(Parameter_t::ntp) *ntp = (decltype(Parameter_t::ntp) *) pRec;
+
+        sprintf(ntp->server, "pool.ntp.org");
+        /* Vienna shall be the default */
+        sprintf(ntp->timezone, "CET-1CEST,M3.5.0,M10.5.0/3");
+    }
+}
+
+Parameters::Parameters() : 
+    ParamStore(&data, sizeof(data), parameterKeys, 
+        sizeof(parameterKeys) / sizeof(parameterKeys[0]), param_record_defaults) {
+}
+
+Device_t* Parameters::devices(void) {
+    load(PARAM_KEY_DEVICES);
+    return data.devices;
+}
+
+CatalogEntry_t* Parameters::catalog(void) {
+    load(PARAM_KEY_CATALOG);
+    return data.catalog;
+}
+
+LearnedCode_t* Parameters::learned(void) {
+    load(PARAM_KEY_LEARNED);
+    return data.learned;
+}
+
+RelayRule_t* Parameters::rules(void) {
+    load(PARAM_KEY_RULES);
+    return data.rules;
+}
+
+AcUnit_t* Parameters::acUnits(void) {
+    load(PARAM_KEY_AC);
+    return data.acUnits;
+}
+
+Timer_t* Parameters::timers(void) {
+    load(PARAM_KEY_TIMERS);
+    return data.timers;
+}
+
+Parameters Parameter;
 
 const char parameterNames[] = 
     "  ssid\n"
@@ -35,14 +132,22 @@ const char parameterNames[] =
     "  netmask\n"
     "  gateway\n"
     "  ntp-server\n"
-    "  timezone\n";
+    "  timezone\n"
+    "  coalesce\n"
+    "  coalesce-sum\n"
+    "  relay-url\n"
+    "  stall-ms\n"
+    "  wdt\n";
 
 String readString(bool secret = false) {
     String ret;
     char c = 0;
 
     while(1) {
-        while(!Serial.available());
+        /* Waiting for input is no stall the watchdog shall act on */
+        while(!Serial.available()) {
+            loopMonitor.feed();
+        }
         c = Serial.read();    
 
         if (c == '\r') {
@@ -67,19 +172,73 @@ String readString(bool secret = false) {
     return ret;
 }
 
-int8_t param_clear(void) {
+/**
+ * @brief The parameter image stored by libparam up to v1.2.0.
+ */
+typedef struct {
+    struct {
+        char ssid[32];
+        char pass[32];
+    }wifi;
+
+    struct {
+        char hostname[32];
+        bool dhcp;
+        char ipaddr[16];
+        char netmask[16];
+        char gateway[16];
+    }ip;
+
+    struct {
+        char server[16];
+        char timezone[32];
+    }ntp;
+
+} LegacyParameter_t;
+
+/**
+ * @brief Clears the parameters and sets the initial defaults, see 
+ * param_record_defaults().
+ */
+static void param_defaults(void) {
     Parameter.clear();
-        
-    sprintf(Parameter.data.ip.hostname, "ir-gateway");
-    Parameter.data.ip.dhcp = true;
-    sprintf(Parameter.data.ntp.server, "pool.ntp.org");
-    /* Vienna shall be the default */
-    sprintf(Parameter.data.ntp.timezone, "CET-1CEST,M3.5.0,M10.5.0/3");
+}
+
+int8_t param_clear(void) {
+    param_defaults();
     
     Serial.printf("Parameter cleared and set to initial defaults.\n");
     return 0;
 }
 
+int8_t param_import(void) {
+    Param<LegacyParameter_t> legacy;
+
+    if (legacy.begin() != true) {
+        return -1;
+    }
+
+    /* Only WiFi, IP and NTP existed, all others start with defaults */
+    param_defaults();
+    importParameter(wifi.ssid);
+    importParameter(wifi.pass);
+    importParameter(ip.hostname);
+    importParameter(ip.dhcp);
+    importParameter(ip.ipaddr);
+    importParameter(ip.netmask);
+    importParameter(ip.gateway);
+    importParameter(ntp.server);
+    importParameter(ntp.timezone);
+
+    /* The legacy image is left as is, it is ignored once the store exists */
+    if (Parameter.write() < 0) {
+        return -1;
+    }
+
+    Serial.printf("Parameter imported from the previous version.\n");
+    return 0;
+}
+
 int8_t param_write(void) {
     Serial.printf("Enter Parameters in the following order:\n");
     Serial.printf("%s", parameterNames);
@@ -93,76 +252,183 @@ int8_t param_write(void) {
     readStringParameter(Parameter.data.ip.gateway);
     readStringParameter(Parameter.data.ntp.server);
     readStringParameter(Parameter.data.ntp.timezone);
+    Parameter.data.tx.coalesce = constrain(readString().toInt(), 0, 10000);
+    Parameter.data.tx.sumRepeat = readString().equals("true");
+    readStringParameter(Parameter.data.relay.url);
+    Parameter.data.loop.stall = constrain(readString().toInt(), 0, 10000);
+    Parameter.data.loop.wdt = constrain(readString().toInt(), 0, 60);
     return 0;
 }
 
-int8_t param_set(const char *pName) {
-    if(pName == 0) {
-        Serial.printf("Error, no parameter name given. Valid names are:\n");
-        Serial.printf("%s", parameterNames);
-        return 0;
-    }
+/**
+ * @brief The prompts of the interactive parameter input.
+ */
+static const struct {
+    const char *pName;
+    const char *pPrompt;
+    bool secret;
+} parameterPrompts[] = {
+    {"ssid", "Enter WiFi SSID: ", false},
+    {"wifi-passwd", "Enter WiFi password: ", true},
+    {"hostname", "Enter hostname: ", false},
+    {"dhcp", "Enable DHCP? [yes|no]: ", false},
+    {"ipaddr", "Enter IPv4 address: ", false},
+    {"netmask", "Enter IPv4 netmask: ", false},
+    {"gateway", "Enter IPv4 gateway: ", false},
+    {"ntp-server", "Enter IPv4 ntp server adress: ", false},
+    {"timezone", "Enter the timezone, see https://github.com/nayarsystems/posix_tz_db/blob/master/zones.csv for your zone: ", false},
+    {"coalesce", "Enter the TX coalescing window in ms, 0 to disable: ", false},
+    {"coalesce-sum", "Add coalesced repeats to the queued command? [yes|no]: ", false},
+    {"relay-url", "Enter the URL relay events are sent to, empty to disable: ", false},
+    {"stall-ms", "Enter the loop stall threshold in ms, 0 for the default: ", false},
+    {"wdt", "Enter the loop watchdog timeout in s, 0 to disable: ", false},
+};
 
-    if (strcmp(pName, "ssid") == 0) {
-        Serial.printf("Enter WiFi SSID: ");
-        readStringParameter(Parameter.data.wifi.ssid);
-        return 0;
+static bool setString(char *pDst, size_t size, const char *pValue) {
+    if (strlen(pValue) >= size) {
+        return false;
     }
 
-    if (strcmp(pName, "wifi-passwd") == 0) {
-        Serial.printf("Enter WiFi password: ");
-        readString(true).toCharArray(Parameter.data.wifi.pass, 
-                sizeof(Parameter.data.wifi.pass));
-        return 0;
-    }
+    strcpy(pDst, pValue);
+    return true;
+}
 
-    if (strcmp(pName, "hostname") == 0) {
-        Serial.printf("Enter hostname: ");
-        readStringParameter(Parameter.data.ip.hostname);
-        return 0;
-    }
+static bool setIpString(char *pDst, size_t size, const char *pValue) {
+    IPAddress addr;
 
-    if (strcmp(pName, "dhcp") == 0) {
-        Serial.printf("Enable DHCP? [yes|no]: ");
-        Parameter.data.ip.dhcp = readString().equals("yes");
-        return 0;
+    if (pValue[0] != 0 && !addr.fromString(pValue)) {
+        return false;
     }
 
-    if (strcmp(pName, "ipaddr") == 0) {
-        Serial.printf("Enter IPv4 address: ");
-        readStringParameter(Parameter.data.ip.ipaddr);
-        return 0;
+    return setString(pDst, size, pValue);
+}
+
+static bool setBool(bool *pDst, const char *pValue) {
+    if (strcmp(pValue, "yes") == 0 || strcmp(pValue, "true") == 0 || 
+        strcmp(pValue, "1") == 0) {
+        *pDst = true;
+    } else if (strcmp(pValue, "no") == 0 || strcmp(pValue, "false") == 0 || 
+        strcmp(pValue, "0") == 0) {
+        *pDst = false;
+    } else {
+        return false;
     }
 
-    if (strcmp(pName, "netmask") == 0) {
-        Serial.printf("Enter IPv4 netmask: ");
-        readStringParameter(Parameter.data.ip.netmask);
-        return 0;
+    return true;
+}
+
+static bool setNumber(uint32_t *pDst, const char *pValue, uint32_t max) {
+    char *pEnd = nullptr;
+    unsigned long value = strtoul(pValue, &pEnd, 10);
+
+    if (pValue[0] == 0 || *pEnd != 0 || value > max) {
+        return false;
     }
 
-    if (strcmp(pName, "gateway") == 0) {
-        Serial.printf("Enter IPv4 gateway: ");
-        readStringParameter(Parameter.data.ip.gateway);
+    *pDst = value;
+    return true;
+}
+
+int8_t param_set_value(const char *pName, const char *pValue) {
+    Parameter_t *p = &Parameter.data;
+    uint32_t num = 0;
+    bool ok = false;
 
-        return 0;
+    if (strcmp(pName, "ssid") == 0) {
+        ok = setString(p->wifi.ssid, sizeof(p->wifi.ssid), pValue);
+    } else if (strcmp(pName, "wifi-passwd") == 0) {
+        ok = setString(p->wifi.pass, sizeof(p->wifi.pass), pValue);
+    } else if (strcmp(pName, "hostname") == 0) {
+        ok = pValue[0] != 0 && setString(p->ip.hostname, sizeof(p->ip.hostname), pValue);
+    } else if (strcmp(pName, "dhcp") == 0) {
+        ok = setBool(&p->ip.dhcp, pValue);
+    } else if (strcmp(pName, "ipaddr") == 0) {
+        ok = setIpString(p->ip.ipaddr, sizeof(p->ip.ipaddr), pValue);
+    } else if (strcmp(pName, "netmask") == 0) {
+        ok = setIpString(p->ip.netmask, sizeof(p->ip.netmask), pValue);
+    } else if (strcmp(pName, "gateway") == 0) {
+        ok = setIpString(p->ip.gateway, sizeof(p->ip.gateway), pValue);
+    } else if (strcmp(pName, "ntp-server") == 0) {
+        ok = setString(p->ntp.server, sizeof(p->ntp.server), pValue);
+    } else if (strcmp(pName, "timezone") == 0) {
+        ok = setString(p->ntp.timezone, sizeof(p->ntp.timezone), pValue);
+    } else if (strcmp(pName, "coalesce") == 0) {
+        ok = setNumber(&num, pValue, 10000);
+        if (ok) {
+            p->tx.coalesce = num;
+        }
+    } else if (strcmp(pName, "coalesce-sum") == 0) {
+        ok = setBool(&p->tx.sumRepeat, pValue);
+    } else if (strcmp(pName, "relay-url") == 0) {
+        ok = setString(p->relay.url, sizeof(p->relay.url), pValue);
+    } else if (strcmp(pName, "stall-ms") == 0) {
+        ok = setNumber(&num, pValue, 10000);
+        if (ok) {
+            p->loop.stall = num;
+        }
+    } else if (strcmp(pName, "wdt") == 0) {
+        ok = setNumber(&num, pValue, 60);
+        if (ok) {
+            p->loop.wdt = num;
+        }
+    } else {
+        return -1;
     }
 
-    if (strcmp(pName, "ntp-server") == 0) {
-        Serial.printf("Enter IPv4 ntp server adress: ");
-        readStringParameter(Parameter.data.ntp.server);
-    
+    return ok ? 0 : -2;
+}
+
+String param_get_string(void) {
+    const Parameter_t *p = &Parameter.data;
+    String ret;
+
+    ret += "ssid=" + String(p->wifi.ssid) + "\n";
+    ret += "wifi-passwd=" + String(p->wifi.pass[0] != 0 ? "***" : "") + "\n";
+    ret += "hostname=" + String(p->ip.hostname) + "\n";
+    ret += "dhcp=" + String(p->ip.dhcp ? "yes" : "no") + "\n";
+    ret += "ipaddr=" + String(p->ip.ipaddr) + "\n";
+    ret += "netmask=" + String(p->ip.netmask) + "\n";
+    ret += "gateway=" + String(p->ip.gateway) + "\n";
+    ret += "ntp-server=" + String(p->ntp.server) + "\n";
+    ret += "timezone=" + String(p->ntp.timezone) + "\n";
+    ret += "coalesce=" + String(p->tx.coalesce) + "\n";
+    ret += "coalesce-sum=" + String(p->tx.sumRepeat ? "yes" : "no") + "\n";
+    ret += "relay-url=" + String(p->relay.url) + "\n";
+    ret += "stall-ms=" + String(p->loop.stall) + "\n";
+    ret += "wdt=" + String(p->loop.wdt) + "\n";
+
+    return ret;
+}
+
+int8_t param_set(const char *pName, const char *pValue) {
+    int8_t ret = -1;
+
+    if(pName == 0) {
+        Serial.printf("Error, no parameter name given. Valid names are:\n");
+        Serial.printf("%s", parameterNames);
         return 0;
     }
 
-    if (strcmp(pName, "timezone") == 0) {
-        Serial.printf("Enter the timezone, see https://github.com/nayarsystems/posix_tz_db/blob/master/zones.csv for your zone: ");
-        readStringParameter(Parameter.data.ntp.timezone);
-        return 0;
+    if (pValue != 0) {
+        ret = param_set_value(pName, pValue);
+    } else {
+        for (const auto &prompt : parameterPrompts) {
+            if (strcmp(pName, prompt.pName) == 0) {
+                Serial.printf("%s", prompt.pPrompt);
+                ret = param_set_value(pName, readString(prompt.secret).c_str());
+                break;
+            }
+        }
     }
 
-    Serial.printf("Error: Invalid parameter!\n");
+    if (ret == -1) {
+        Serial.printf("Error: Invalid parameter!\n");
+    } else if (ret == -2) {
+        Serial.printf("Error: Invalid value for %s!\n", pName);
+        return -1;
+    }
 
-    return -1;
+    return ret;
 }
 
 CLI_COMMAND(param) {
@@ -175,13 +441,33 @@ CLI_COMMAND(param) {
     }
 
     if (strcmp(argv[0], "save") == 0) {
-        Parameter.write();
-        Serial.printf("Parameter saved\n");
+        int16_t cnt = Parameter.write();
+        if (cnt < 0) {
+            return -1;
+        }
+        Serial.printf("Parameter saved, %d records written, %u groups applied\n", 
+            cnt, Parameter.apply());
+        return 0;
+    }
+
+    if (strcmp(argv[0], "stats") == 0) {
+        Serial.printf("Parameter store:\n");
+        Serial.print(Parameter.getStatsString());
         return 0;
     }
 
     if (strcmp(argv[0], "set") == 0) {
-        return param_set(argv[1]);
+        return param_set(argv[1], argc > 2 ? argv[2] : 0);
+    }
+
+    if (strcmp(argv[0], "get") == 0) {
+        Serial.print(param_get_string());
+        return 0;
+    }
+
+    if (strcmp(argv[0], "apply") == 0) {
+        Serial.printf("Applied %u changed parameter groups\n", Parameter.apply());
+        return 0;
     }
 
     Serial.printf("Error: Invalid command!\n");
@@ -21,9 +21,202 @@
 
 #pragma once
 
-#include <param/param.hpp>
+#include "paramstore.hpp"
 #include <cli/cli.hpp>
 
+/**
+ * @brief The maximum number of devices which can be configured.
+ */
+#define PARAM_MAX_DEVICES           8
+
+/**
+ * @brief Device configuration.
+ * A device is identified by the IR protocol and the masked code, e.g. the
+ * NEC address in the upper 16 bits of the code. The timing values are used by
+ * the transmit scheduler to space out commands sent to the same device, 
+ * channel selects the IR LED the device is reached by.
+ */
+typedef struct {
+    char name[16];
+    int16_t protocol;
+    uint64_t match;
+    uint64_t mask;
+    uint16_t gap;
+    uint16_t settle;
+    uint16_t coalesce;
+    uint8_t channel;
+} Device_t;
+
+/**
+ * @brief The maximum number of catalog entries.
+ */
+#define PARAM_MAX_CATALOG           32
+
+/**
+ * @brief The state change caused by a catalog command.
+ */
+typedef enum {
+    CATALOG_EFFECT_NONE = 0,
+    CATALOG_EFFECT_POWER_ON,
+    CATALOG_EFFECT_POWER_OFF,
+    CATALOG_EFFECT_POWER_TOGGLE,
+    CATALOG_EFFECT_INPUT
+} CatalogEffect_t;
+
+/**
+ * @brief Catalog entry.
+ * Names a IR command and describes the effect it has on the device state.
+ * channel overrides the transmit channel of the device if not -1.
+ */
+typedef struct {
+    char name[16];
+    int16_t protocol;
+    uint8_t effect;
+    uint8_t value;
+    uint64_t code;
+    int8_t channel;
+} CatalogEntry_t;
+
+/**
+ * @brief The maximum number of learned codes.
+ */
+#define PARAM_MAX_LEARNED           8
+
+/**
+ * @brief The maximum number of mark and space timings of a learned code.
+ */
+#define LEARN_MAX_TIMINGS           256
+
+/**
+ * @brief The maximum number of unique durations of a learned code.
+ * Limited by the 4 bit indices.
+ */
+#define LEARN_MAX_DURATIONS         16
+
+/**
+ * @brief A learned IR code.
+ * The timings are stored as stream of 4 bit indices into a table of unique
+ * durations in microseconds, two indices per byte with the first in the low
+ * nibble. The first timing is a mark.
+ */
+typedef struct {
+    char name[16];
+    uint16_t count;
+    uint8_t numDurations;
+    uint8_t khz;
+    uint16_t durations[LEARN_MAX_DURATIONS];
+    uint8_t indices[LEARN_MAX_TIMINGS / 2];
+} LearnedCode_t;
+
+/**
+ * @brief The maximum number of relay rules.
+ */
+#define PARAM_MAX_RULES             8
+
+/**
+ * @brief The maximum number of commands sent by a relay rule.
+ */
+#define RELAY_MAX_STEPS             4
+
+/**
+ * @brief The action of a relay rule.
+ */
+typedef enum {
+    RELAY_ACTION_NONE = 0,
+    RELAY_ACTION_TRANSMIT,
+    RELAY_ACTION_MACRO,
+    RELAY_ACTION_EVENT
+} RelayAction_t;
+
+/**
+ * @brief A stored command, sent by relay rules and timers.
+ * pause is the time in ms before the next command of a macro, bits is 0 for
+ * the default of the protocol.
+ */
+typedef struct {
+    int16_t protocol;
+    uint8_t repeat;
+    int8_t channel;
+    uint16_t pause;
+    uint16_t bits;
+    uint64_t code;
+} TxStep_t;
+
+/**
+ * @brief Relay rule.
+ * Translates a received command, identified by protocol and code, into 
+ * transmitted commands or a HTTP event. Matches within debounce ms after the
+ * last one are dropped, if hold is set repeat frames of a held button 
+ * trigger the rule again.
+ */
+typedef struct {
+    int16_t protocol;
+    uint8_t action;
+    uint8_t numSteps;
+    uint64_t code;
+    uint16_t debounce;
+    bool hold;
+    char event[16];
+    TxStep_t steps[RELAY_MAX_STEPS];
+} RelayRule_t;
+
+/**
+ * @brief The maximum number of air conditioners.
+ */
+#define PARAM_MAX_AC                4
+
+/**
+ * @brief Air conditioner configuration.
+ * protocol and model select the state based encoding of IRac.
+ */
+typedef struct {
+    char name[16];
+    int16_t protocol;
+    int16_t model;
+    uint8_t channel;
+} AcUnit_t;
+
+/**
+ * @brief The maximum number of timers.
+ */
+#define PARAM_MAX_TIMERS            8
+
+/**
+ * @brief The maximum number of commands sent by a timer.
+ */
+#define TIMER_MAX_STEPS             4
+
+/**
+ * @brief The schedule of a timer.
+ */
+typedef enum {
+    TIMER_MODE_NONE = 0,
+    TIMER_MODE_ONCE,
+    TIMER_MODE_DAILY,
+    TIMER_MODE_INTERVAL
+} TimerMode_t;
+
+/**
+ * @brief Timer.
+ * time is the UTC epoch for TIMER_MODE_ONCE, the local time of day in 
+ * seconds for TIMER_MODE_DAILY and the period in seconds for 
+ * TIMER_MODE_INTERVAL. days is a bitmask of the weekdays a daily timer 
+ * fires, bit 0 is Sunday.
+ */
+typedef struct {
+    uint8_t mode;
+    uint8_t days;
+    uint8_t numSteps;
+    uint32_t time;
+    TxStep_t steps[TIMER_MAX_STEPS];
+} Timer_t;
+
+/**
+ * @brief The maximum number of protocols of the receive allowlist, stored as
+ * a sorted set.
+ */
+#define PARAM_MAX_RX_PROTOCOLS      8
+
 /**
  * @brief Parameter structure for the ir-gateway.
  * This structure holds all the parameters used by the application.
@@ -47,13 +240,110 @@ typedef struct {
         char timezone[32];
     }ntp;
 
+    struct {
+        uint16_t coalesce;
+        bool sumRepeat;
+    }tx;
+
+    struct {
+        char url[64];
+    }relay;
+
+    struct {
+        int16_t protocols[PARAM_MAX_RX_PROTOCOLS];
+    }rx;
+
+    struct {
+        uint16_t stall;
+        uint8_t wdt;
+    }loop;
+
+    Device_t devices[PARAM_MAX_DEVICES];
+    CatalogEntry_t catalog[PARAM_MAX_CATALOG];
+    LearnedCode_t learned[PARAM_MAX_LEARNED];
+    RelayRule_t rules[PARAM_MAX_RULES];
+    AcUnit_t acUnits[PARAM_MAX_AC];
+    Timer_t timers[PARAM_MAX_TIMERS];
+
 } Parameter_t;
 
+/**
+ * @brief The indices of the keys of the parameter store, in the order of 
+ * the key table.
+ */
+typedef enum {
+    PARAM_KEY_WIFI = 0,
+    PARAM_KEY_IP,
+    PARAM_KEY_NTP,
+    PARAM_KEY_TX,
+    PARAM_KEY_RELAY,
+    PARAM_KEY_RX,
+    PARAM_KEY_LOOP,
+    PARAM_KEY_DEVICES,
+    PARAM_KEY_CATALOG,
+    PARAM_KEY_LEARNED,
+    PARAM_KEY_RULES,
+    PARAM_KEY_AC,
+    PARAM_KEY_TIMERS,
+    PARAM_KEY_COUNT
+} ParamKeyIdx_t;
+
+/**
+ * @brief Parameter object binding the parameter structure to its store.
+ * Only the fields which have been changed are written by write(). The 
+ * sections are loaded at boot, the tables are only accessed through the 
+ * accessors below which load them on first use.
+ */
+class Parameters : public ParamStore {
+
+    public:
+
+        /**
+         * @brief Construct a new Parameters object.
+         */
+        Parameters();
+
+        /**
+         * @brief Returns the device table, PARAM_MAX_DEVICES entries.
+         */
+        Device_t* devices(void);
+
+        /**
+         * @brief Returns the command catalog, PARAM_MAX_CATALOG entries.
+         */
+        CatalogEntry_t* catalog(void);
+
+        /**
+         * @brief Returns the learned codes, PARAM_MAX_LEARNED entries.
+         */
+        LearnedCode_t* learned(void);
+
+        /**
+         * @brief Returns the relay rules, PARAM_MAX_RULES entries.
+         */
+        RelayRule_t* rules(void);
+
+        /**
+         * @brief Returns the air conditioner units, PARAM_MAX_AC entries.
+         */
+        AcUnit_t* acUnits(void);
+
+        /**
+         * @brief Returns the timers, PARAM_MAX_TIMERS entries.
+         */
+        Timer_t* timers(void);
+
+        /**
+         * @brief The parameters, use the accessors above for the tables.
+         */
+        Parameter_t data;
+};
+
 /**
  * @brief Global parameter object.
  * This object is used to access and modify the parameters of the application.
  */
-extern Param<Parameter_t> Parameter;
+extern Parameters Parameter;
 
 /**
  * @brief Clears the parameters and sets them to default values.
@@ -63,3 +353,32 @@ extern Param<Parameter_t> Parameter;
  * @return int8_t Returns 0 on success.
  */
 int8_t param_clear(void);
+
+/**
+ * @brief Imports the parameters stored by libparam up to v1.2.0.
+ * 
+ * Called once if the parameter store is empty. WiFi, IP and NTP settings are
+ * taken over and written to the store, all others get their defaults.
+ * 
+ * @return int8_t 0 on success, -1 if there is no valid legacy image.
+ */
+int8_t param_import(void);
+
+/**
+ * @brief Sets a parameter by name, the names are the ones of param set.
+ * 
+ * The change is neither saved nor applied, see Parameter.write() and 
+ * Parameter.apply().
+ * 
+ * @param pName The name of the parameter.
+ * @param pValue The new value.
+ * @return int8_t 0 on success, -1 for an unknown name and -2 for an invalid
+ * value.
+ */
+int8_t param_set_value(const char *pName, const char *pValue);
+
+/**
+ * @brief Returns all parameters of param set as name=value lines, the WiFi
+ * password is masked.
+ */
+String param_get_string(void);
@@ -0,0 +1,521 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "paramstore.hpp"
+
+#include <Preferences.h>
+
+ParamStore::ParamStore(void *pData, size_t size, const ParamKey_t *pKeys, 
+    uint8_t numKeys, ParamDefaults_t defaults) :
+    pData((uint8_t *) pData),
+    size(size),
+    pKeys(pKeys),
+    numKeys(numKeys),
+    defaults(defaults),
+    numRecords(0),
+    loaded(0),
+    stored(false),
+    usedValid(false),
+    numSubscribers(0) {
+
+    for (uint8_t k = 0; k < numKeys; k++) {
+        numRecords += pKeys[k].count;
+    }
+
+    memset(hashes, 0, sizeof(hashes));
+    memset(schema, 0, sizeof(schema));
+    memset(used, 0, sizeof(used));
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief Returns the lowest count bits set, e.g. the records of a key.
+ */
+static uint32_t recordMask(uint8_t count) {
+    return count >= PARAMSTORE_MAX_COUNT ? 0xFFFFFFFFUL : (1UL << count) - 1;
+}
+
+bool ParamStore::begin(void) {
+    Preferences prefs;
+    size_t len;
+    uint32_t start = micros();
+
+    memset(hashes, 0, sizeof(hashes));
+    memset(schema, 0, sizeof(schema));
+    memset(used, 0, sizeof(used));
+    stats.loadKeys = 0;
+    stats.loadRecords = 0;
+    stats.loadBytes = 0;
+    stats.grown = 0;
+    stats.dropped = 0;
+    stored = false;
+    usedValid = false;
+
+    if (!isValid()) {
+        Serial.printf("Error: Too many parameter records (%u).\n", numRecords);
+        return false;
+    }
+
+    /* All records start with their defaults, stored ones are loaded over */
+    clear();
+    if (!prefs.begin(PARAMSTORE_NAMESPACE, true)) {
+        return false;
+    }
+
+    /* Keys appended since the schema has been written read as version 0 */
+    len = prefs.getBytesLength(PARAMSTORE_SCHEMA_KEY);
+    if (len == 0) {
+        prefs.end();
+        stats.loadTime = micros() - start;
+        return false;
+    }
+    prefs.getBytes(PARAMSTORE_SCHEMA_KEY, schema, sizeof(schema));
+    stored = true;
+
+    /* Stores written before the bitmap existed are probed record by record */
+    len = prefs.getBytesLength(PARAMSTORE_USED_KEY);
+    if (len != 0 && len % sizeof(uint32_t) == 0 && len <= sizeof(used)) {
+        prefs.getBytes(PARAMSTORE_USED_KEY, used, len);
+        usedValid = (len == numKeys * sizeof(uint32_t));
+    } else {
+        for (uint8_t k = 0; k < numKeys; k++) {
+            used[k] = recordMask(pKeys[k].count);
+        }
+    }
+
+    /* Arrays are loaded on their first access */
+    loaded = 0;
+    for (uint8_t k = 0; k < numKeys; k++) {
+        if (pKeys[k].count == 1) {
+            loadKey(k, &prefs);
+        }
+    }
+
+    prefs.end();
+    stats.loadTime = micros() - start;
+    return true;
+}
+
+bool ParamStore::load(uint8_t key) {
+    Preferences prefs;
+    uint32_t start = 0;
+
+    if (key >= numKeys) {
+        return false;
+    }
+
+    if ((loaded & (1UL << key)) != 0) {
+        return true;
+    }
+
+    start = micros();
+    /* Not marked as loaded, write() must not replace the stored records */
+    if (!prefs.begin(PARAMSTORE_NAMESPACE, true)) {
+        return false;
+    }
+
+    loadKey(key, &prefs);
+    prefs.end();
+    stats.loadTime += micros() - start;
+    return true;
+}
+
+void ParamStore::loadKey(uint8_t key, Preferences *pPrefs) {
+    const ParamKey_t *pKey = &pKeys[key];
+    uint16_t record = 0;
+    size_t len;
+    char name[16];
+
+    for (uint8_t k = 0; k < key; k++) {
+        record += pKeys[k].count;
+    }
+
+    loaded |= 1UL << key;
+    stats.loadKeys++;
+
+    for (uint8_t i = 0; i < pKey->count; i++, record++) {
+        uint8_t *pRec = pData + pKey->offset + i * pKey->size;
+        bool present = (used[key] & (1UL << i)) != 0;
+
+        /* Stored fields are loaded over the defaults, appended ones keep them */
+        setDefaults(pKey, i, pRec);
+        hashes[record] = 0;
+
+        /* Records of another layout are rewritten with their defaults */
+        if (schema[key] != pKey->version) {
+            stats.dropped += present ? 1 : 0;
+            continue;
+        }
+
+        /* Records equal to their defaults are not stored, hence not read */
+        if (!present) {
+            hashes[record] = hash(pRec, pKey->size);
+            continue;
+        }
+
+        recordKey(pKey, i, name);
+        len = pPrefs->getBytesLength(name);
+        if (len == 0) {
+            used[key] &= ~(1UL << i);
+            usedValid = false;
+            hashes[record] = hash(pRec, pKey->size);
+            continue;
+        }
+
+        if (len > pKey->size || pPrefs->getBytes(name, pRec, len) != len) {
+            setDefaults(pKey, i, pRec);
+            stats.dropped++;
+            continue;
+        }
+
+        stats.loadRecords++;
+        stats.loadBytes += len;
+
+        /* A record grown by appended fields has to be written again */
+        if (len == pKey->size) {
+            hashes[record] = hash(pRec, pKey->size);
+        } else {
+            stats.grown++;
+        }
+    }
+}
+
+int16_t ParamStore::write(void) {
+    return writeKeys(-1);
+}
+
+int16_t ParamStore::write(const char *pKey) {
+    int16_t key = findKey(pKey);
+
+    if (key < 0) {
+        return -1;
+    }
+
+    /* Nothing is stored yet, the defaults of all other keys are written too */
+    return writeKeys(stored ? key : -1);
+}
+
+int16_t ParamStore::writeKeys(int16_t only) {
+    Preferences prefs;
+    uint8_t versions[PARAMSTORE_MAX_KEYS];
+    uint16_t record = 0;
+    uint16_t written = 0;
+    uint16_t bytes = 0;
+    char key[16];
+    uint32_t start = micros();
+
+    if (!isValid()) {
+        return -1;
+    }
+
+    if (!prefs.begin(PARAMSTORE_NAMESPACE, false)) {
+        Serial.printf("Error: Failed to open the parameter store.\n");
+        return -1;
+    }
+
+    /* Bits of new records are stored before the records, a bit without a 
+     * record is dropped by the next begin() but a record without a bit 
+     * would be lost */
+    for (uint8_t k = 0; k < numKeys; k++) {
+        const ParamKey_t *pKey = &pKeys[k];
+
+        for (uint8_t i = 0; i < pKey->count; i++, record++) {
+            uint8_t *pRec = pData + pKey->offset + i * pKey->size;
+
+            /* Records of keys which have not been loaded are unchanged */
+            if ((only >= 0 && k != only) || (loaded & (1UL << k)) == 0) {
+                continue;
+            }
+
+            if ((used[k] & (1UL << i)) == 0 && hash(pRec, pKey->size) != hashes[record] && 
+                    !isDefault(pKey, i, pRec)) {
+                used[k] |= 1UL << i;
+                usedValid = false;
+            }
+        }
+    }
+    bytes += writeUsed(&prefs);
+
+    record = 0;
+    memcpy(versions, schema, sizeof(versions));
+    for (uint8_t k = 0; k < numKeys; k++) {
+        const ParamKey_t *pKey = &pKeys[k];
+
+        if ((only >= 0 && k != only) || (loaded & (1UL << k)) == 0) {
+            record += pKey->count;
+            continue;
+        }
+
+        versions[k] = pKey->version;
+        for (uint8_t i = 0; i < pKey->count; i++, record++) {
+            uint8_t *pRec = pData + pKey->offset + i * pKey->size;
+            uint32_t h = hash(pRec, pKey->size);
+
+            if (h == hashes[record]) {
+                continue;
+            }
+
+            recordKey(pKey, i, key);
+            if (isDefault(pKey, i, pRec)) {
+                /* Defaults are removed instead of stored */
+                if ((used[k] & (1UL << i)) != 0) {
+                    prefs.remove(key);
+                    used[k] &= ~(1UL << i);
+                    usedValid = false;
+                    written++;
+                }
+            } else if (prefs.putBytes(key, pRec, pKey->size) != pKey->size) {
+                Serial.printf("Error: Failed to write parameter %s.\n", key);
+                continue;
+            } else {
+                bytes += pKey->size;
+                written++;
+            }
+
+            hashes[record] = h;
+        }
+
+        /* Records left behind by a table which has been shrunk */
+        for (uint8_t i = pKey->count; i < PARAMSTORE_MAX_COUNT; i++) {
+            if ((used[k] & (1UL << i)) != 0) {
+                snprintf(key, sizeof(key), "%s%u", pKey->key, i);
+                prefs.remove(key);
+                used[k] &= ~(1UL << i);
+                usedValid = false;
+            }
+        }
+    }
+
+    bytes += writeUsed(&prefs);
+
+    /* The schema is written last, an interrupted first write is redone */
+    if (!stored || memcmp(versions, schema, numKeys) != 0) {
+        if (prefs.putBytes(PARAMSTORE_SCHEMA_KEY, versions, numKeys) == numKeys) {
+            memcpy(schema, versions, sizeof(schema));
+            stored = true;
+            bytes += numKeys;
+        }
+    }
+
+    prefs.end();
+
+    stats.saveRecords = written;
+    stats.saveBytes = bytes;
+    stats.saveTime = micros() - start;
+    stats.saves++;
+    stats.totalRecords += written;
+    stats.totalBytes += bytes;
+
+    return written;
+}
+
+uint16_t ParamStore::writeUsed(Preferences *pPrefs) {
+    size_t len = numKeys * sizeof(uint32_t);
+
+    if (usedValid) {
+        return 0;
+    }
+
+    if (pPrefs->putBytes(PARAMSTORE_USED_KEY, used, len) != len) {
+        Serial.printf("Error: Failed to write parameter %s.\n", PARAMSTORE_USED_KEY);
+        return 0;
+    }
+
+    usedValid = true;
+    return len;
+}
+
+void ParamStore::clear(void) {
+    memset(pData, 0, size);
+
+    for (uint8_t k = 0; k < numKeys; k++) {
+        const ParamKey_t *pKey = &pKeys[k];
+
+        for (uint8_t i = 0; i < pKey->count; i++) {
+            setDefaults(pKey, i, pData + pKey->offset + i * pKey->size);
+        }
+    }
+
+    /* The defaults replace whatever is stored */
+    loaded = recordMask(numKeys);
+}
+
+bool ParamStore::subscribe(const char *pKey, ParamCallback_t callback) {
+    if (numSubscribers >= PARAMSTORE_MAX_SUBSCRIBERS) {
+        return false;
+    }
+
+    int16_t key = findKey(pKey);
+    Subscriber_t *pSub = nullptr;
+
+    if (key < 0) {
+        return false;
+    }
+
+    pSub = &subscribers[numSubscribers++];
+    pSub->key = key;
+    pSub->hash = keyHash(key);
+    pSub->callback = callback;
+    return true;
+}
+
+uint8_t ParamStore::apply(void) {
+    uint8_t cnt = 0;
+
+    for (uint8_t i = 0; i < numSubscribers; i++) {
+        Subscriber_t *pSub = &subscribers[i];
+        uint32_t h = keyHash(pSub->key);
+
+        if (h != pSub->hash) {
+            pSub->hash = h;
+            pSub->callback();
+            cnt++;
+        }
+    }
+
+    return cnt;
+}
+
+uint16_t ParamStore::getDirty(void) {
+    uint16_t record = 0;
+    uint16_t dirty = 0;
+
+    for (uint8_t k = 0; k < numKeys; k++) {
+        const ParamKey_t *pKey = &pKeys[k];
+
+        if ((loaded & (1UL << k)) == 0) {
+            record += pKey->count;
+            continue;
+        }
+
+        for (uint8_t i = 0; i < pKey->count; i++, record++) {
+            uint8_t *pRec = pData + pKey->offset + i * pKey->size;
+
+            if (hash(pRec, pKey->size) != hashes[record]) {
+                dirty++;
+            }
+        }
+    }
+
+    return dirty;
+}
+
+const ParamStore::Stats_t &ParamStore::getStats(void) {
+    return stats;
+}
+
+String ParamStore::getStatsString(void) {
+    char buf[96];
+    String ret;
+
+    snprintf(buf, sizeof(buf), "  Records:       %u in %u keys, %u bytes\n",
+        numRecords, numKeys, (unsigned) size);
+    ret += buf;
+    snprintf(buf, sizeof(buf), "  Load:          %u of %u keys, %u records, %u bytes in %lu us\n",
+        stats.loadKeys, numKeys, stats.loadRecords, stats.loadBytes, 
+        (unsigned long) stats.loadTime);
+    ret += buf;
+    snprintf(buf, sizeof(buf), "  Schema:        %u records grown, %u dropped\n",
+        stats.grown, stats.dropped);
+    ret += buf;
+    snprintf(buf, sizeof(buf), "  Last save:     %u records, %u bytes in %lu us\n",
+        stats.saveRecords, stats.saveBytes, (unsigned long) stats.saveTime);
+    ret += buf;
+    snprintf(buf, sizeof(buf), "  Total saves:   %lu, %lu records, %lu bytes\n",
+        (unsigned long) stats.saves, (unsigned long) stats.totalRecords, 
+        (unsigned long) stats.totalBytes);
+    ret += buf;
+    /* Not measured, the size of the structure written on each save */
+    snprintf(buf, sizeof(buf), "  Full image:    %lu bytes estimated, %u per save\n",
+        (unsigned long) (stats.saves * size), (unsigned) size);
+    ret += buf;
+    snprintf(buf, sizeof(buf), "  Dirty:         %u records\n", getDirty());
+    ret += buf;
+
+    return ret;
+}
+
+bool ParamStore::isValid(void) const {
+    if (numKeys > PARAMSTORE_MAX_KEYS || numRecords > PARAMSTORE_MAX_RECORDS) {
+        return false;
+    }
+
+    for (uint8_t k = 0; k < numKeys; k++) {
+        if (pKeys[k].count > PARAMSTORE_MAX_COUNT || pKeys[k].size > PARAMSTORE_MAX_RECORD_SIZE) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int16_t ParamStore::findKey(const char *pKey) const {
+    for (uint8_t k = 0; k < numKeys; k++) {
+        if (strcmp(pKeys[k].key, pKey) == 0) {
+            return k;
+        }
+    }
+
+    return -1;
+}
+
+uint32_t ParamStore::keyHash(uint8_t key) {
+    const ParamKey_t *pKey = &pKeys[key];
+
+    load(key);
+
+    return hash(pData + pKey->offset, pKey->size * pKey->count);
+}
+
+void ParamStore::setDefaults(const ParamKey_t *pKey, uint8_t idx, uint8_t *pRec) {
+    memset(pRec, 0, pKey->size);
+
+    if (defaults != nullptr) {
+        defaults(pKey, idx, pRec);
+    }
+}
+
+bool ParamStore::isDefault(const ParamKey_t *pKey, uint8_t idx, const uint8_t *pRec) {
+    uint8_t rec[PARAMSTORE_MAX_RECORD_SIZE];
+
+    setDefaults(pKey, idx, rec);
+    return memcmp(rec, pRec, pKey->size) == 0;
+}
+
+void ParamStore::recordKey(const ParamKey_t *pKey, uint8_t idx, char *pBuf) {
+    if (pKey->count > 1) {
+        snprintf(pBuf, 16, "%s%u", pKey->key, idx);
+    } else {
+        snprintf(pBuf, 16, "%s", pKey->key);
+    }
+}
+
+uint32_t ParamStore::hash(const uint8_t *pData, size_t size) {
+    uint32_t h = 2166136261UL;
+
+    for (size_t i = 0; i < size; i++) {
+        h ^= pData[i];
+        h *= 16777619UL;
+    }
+
+    /* 0 marks a record which has to be written */
+    return h == 0 ? 1 : h;
+}
@@ -0,0 +1,365 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class Preferences;
+
+/**
+ * @brief The NVS namespace used by the parameter store.
+ */
+#define PARAMSTORE_NAMESPACE        "params"
+
+/**
+ * @brief The NVS key holding the record schema versions.
+ */
+#define PARAMSTORE_SCHEMA_KEY       "schema"
+
+/**
+ * @brief The NVS key holding the bitmaps of the stored records.
+ */
+#define PARAMSTORE_USED_KEY         "used"
+
+/**
+ * @brief The maximum number of keys.
+ */
+#define PARAMSTORE_MAX_KEYS         32
+
+/**
+ * @brief The maximum number of records, a record is either a section or a 
+ * single element of an array of the parameter structure.
+ */
+#define PARAMSTORE_MAX_RECORDS      96
+
+/**
+ * @brief The maximum count of an array key, the stored records of a key are
+ * tracked by a 32 bit mask.
+ */
+#define PARAMSTORE_MAX_COUNT        32
+
+/**
+ * @brief The maximum size of a record, defaults are built on the stack to 
+ * compare records against them.
+ */
+#define PARAMSTORE_MAX_RECORD_SIZE  256
+
+/**
+ * @brief The maximum number of subscribers.
+ */
+#define PARAMSTORE_MAX_SUBSCRIBERS  8
+
+/**
+ * @brief Callback applying changed parameters of a key.
+ */
+typedef void (*ParamCallback_t)(void);
+
+struct ParamKey;
+
+/**
+ * @brief Callback setting the defaults of a record.
+ * @param pKey The key of the record.
+ * @param idx The index of the record within the key.
+ * @param pRec The record, pKey->size bytes.
+ */
+typedef void (*ParamDefaults_t)(const struct ParamKey *pKey, uint8_t idx, void *pRec);
+
+/**
+ * @brief Descriptor of one key of the parameter store.
+ * 
+ * A key with a count greater than one is stored as count records named 
+ * key0, key1, ... Fields may only be appended to a section, a record stored
+ * with a shorter size is loaded over its defaults, the new fields keep their
+ * defaults. Any other change of a section requires a new version, records 
+ * with another version are dropped, they get their defaults and are 
+ * rewritten on the next write(). The count may change, records beyond a 
+ * reduced count are removed by the next write().
+ */
+typedef struct ParamKey {
+    const char *key;
+    uint16_t offset;
+    uint16_t size;
+    uint8_t count;
+    uint8_t version;
+} ParamKey_t;
+
+/**
+ * @brief Versioned key value store of a parameter structure.
+ * 
+ * Every section and every array element of the structure is kept in an own 
+ * NVS record. A hash of each record is taken when it is loaded or written,
+ * write() only puts the records whose hash has changed. Records equal to 
+ * their defaults are not stored. A bitmap of the stored records is kept, 
+ * only those are read instead of probing every table entry. begin() loads 
+ * the sections, keys with a count of one, arrays are loaded by load() on 
+ * their first access. NVS itself takes care of wear leveling and writes each
+ * record atomically.
+ */
+class ParamStore {
+
+    public:
+
+        /**
+         * @brief Statistics of the parameter store.
+         */
+        typedef struct {
+            uint32_t loadTime;
+            uint8_t loadKeys;
+            uint16_t loadRecords;
+            uint16_t loadBytes;
+            uint16_t grown;
+            uint16_t dropped;
+            uint16_t saveRecords;
+            uint16_t saveBytes;
+            uint32_t saveTime;
+            uint32_t saves;
+            uint32_t totalRecords;
+            uint32_t totalBytes;
+        } Stats_t;
+
+        /**
+         * @brief Construct a new parameter store.
+         * @param pData The structure to store.
+         * @param size The size of the structure.
+         * @param pKeys The key table of the structure.
+         * @param numKeys The number of entries of the key table.
+         * @param defaults Sets the defaults of a record, nullptr if all 
+         *        defaults are 0.
+         */
+        ParamStore(void *pData, size_t size, const ParamKey_t *pKeys, 
+            uint8_t numKeys, ParamDefaults_t defaults = nullptr);
+
+        /**
+         * @brief Loads the stored records of the sections, the records of 
+         * arrays are loaded by load(). Records which are not stored get 
+         * their defaults.
+         * @return false if no parameters have been stored so far, all 
+         * records have their defaults then.
+         */
+        bool begin(void);
+
+        /**
+         * @brief Loads the stored records of a key unless done before, has 
+         * to be called before the records of an array are accessed.
+         * @param key The index of the key in the key table.
+         * @return false if the key is unknown or could not be read, its 
+         * records keep their defaults and are not written then.
+         */
+        bool load(uint8_t key);
+
+        /**
+         * @brief Writes all records which have changed since they have been
+         * loaded or written the last time.
+         * @return The number of records written, -1 on error.
+         */
+        int16_t write(void);
+
+        /**
+         * @brief Writes the changed records of a single key, pending changes
+         * of all other keys are kept for the next write(). As long as
+         * nothing has been stored, all keys are written.
+         * @param pKey The name of the key.
+         * @return The number of records written, -1 on error or if the key
+         * is unknown.
+         */
+        int16_t write(const char *pKey);
+
+        /**
+         * @brief Sets all records to their defaults, write() has to be 
+         * called to store them.
+         */
+        void clear(void);
+
+        /**
+         * @brief Subscribes a callback to the changes of a key.
+         * @param pKey The name of the key.
+         * @param callback The callback, called by apply().
+         * @return false if the key is unknown or there are too many 
+         * subscribers.
+         */
+        bool subscribe(const char *pKey, ParamCallback_t callback);
+
+        /**
+         * @brief Calls the subscribers of all keys which have changed since 
+         * they have been subscribed or applied the last time.
+         * @return The number of subscribers called.
+         */
+        uint8_t apply(void);
+
+        /**
+         * @brief Returns the number of records which would be written by 
+         * write().
+         */
+        uint16_t getDirty(void);
+
+        /**
+         * @brief Returns the statistics.
+         */
+        const Stats_t &getStats(void);
+
+        /**
+         * @brief Returns the statistics as human readable text.
+         */
+        String getStatsString(void);
+
+    private:
+
+        /**
+         * @brief A subscriber of a key.
+         */
+        typedef struct {
+            uint8_t key;
+            uint32_t hash;
+            ParamCallback_t callback;
+        } Subscriber_t;
+
+        /**
+         * @brief Checks the key table against the limits of the store.
+         */
+        bool isValid(void) const;
+
+        /**
+         * @brief Loads the records of a key.
+         * @param key The index of the key.
+         * @param pPrefs The opened NVS namespace.
+         */
+        void loadKey(uint8_t key, Preferences *pPrefs);
+
+        /**
+         * @brief Sets the defaults of a record.
+         */
+        void setDefaults(const ParamKey_t *pKey, uint8_t idx, uint8_t *pRec);
+
+        /**
+         * @brief Returns true if a record equals its defaults.
+         */
+        bool isDefault(const ParamKey_t *pKey, uint8_t idx, const uint8_t *pRec);
+
+        /**
+         * @brief Writes the changed records.
+         * @param only The index of the key to write, -1 for all keys.
+         * @return The number of records written, -1 on error.
+         */
+        int16_t writeKeys(int16_t only);
+
+        /**
+         * @brief Returns the index of a key, -1 if unknown.
+         */
+        int16_t findKey(const char *pKey) const;
+
+        /**
+         * @brief Writes the bitmap of the stored records if it has changed.
+         * @return The number of bytes written.
+         */
+        uint16_t writeUsed(Preferences *pPrefs);
+
+        /**
+         * @brief Returns the hash of all records of a key.
+         */
+        uint32_t keyHash(uint8_t key);
+
+        /**
+         * @brief Returns the NVS key of a record.
+         */
+        void recordKey(const ParamKey_t *pKey, uint8_t idx, char *pBuf);
+
+        /**
+         * @brief Returns the FNV-1a hash of a record.
+         */
+        static uint32_t hash(const uint8_t *pData, size_t size);
+
+        /**
+         * @brief The structure to store.
+         */
+        uint8_t *pData;
+
+        /**
+         * @brief The size of the structure.
+         */
+        size_t size;
+
+        /**
+         * @brief The key table.
+         */
+        const ParamKey_t *pKeys;
+
+        /**
+         * @brief The number of keys.
+         */
+        uint8_t numKeys;
+
+        /**
+         * @brief Sets the defaults of a record, nullptr if all are 0.
+         */
+        ParamDefaults_t defaults;
+
+        /**
+         * @brief The number of records.
+         */
+        uint16_t numRecords;
+
+        /**
+         * @brief The bitmap of the loaded keys.
+         */
+        uint32_t loaded;
+
+        /**
+         * @brief True if the schema has been stored.
+         */
+        bool stored;
+
+        /**
+         * @brief The versions of the keys as stored in the schema.
+         */
+        uint8_t schema[PARAMSTORE_MAX_KEYS];
+
+        /**
+         * @brief The hash of each record as found in NVS, 0 if it has to be
+         * written.
+         */
+        uint32_t hashes[PARAMSTORE_MAX_RECORDS];
+
+        /**
+         * @brief The bitmap of the stored records per key.
+         */
+        uint32_t used[PARAMSTORE_MAX_KEYS];
+
+        /**
+         * @brief True if the stored bitmap matches used.
+         */
+        bool usedValid;
+
+        /**
+         * @brief The subscribers.
+         */
+        Subscriber_t subscribers[PARAMSTORE_MAX_SUBSCRIBERS];
+
+        /**
+         * @brief The number of subscribers.
+         */
+        uint8_t numSubscribers;
+
+        /**
+         * @brief The statistics.
+         */
+        Stats_t stats;
+};
@@ -0,0 +1,375 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "relay.hpp"
+#include "ircontrol.hpp"
+#include "txscheduler.hpp"
+#include "txtrace.hpp"
+
+#include <WiFi.h>
+#include <HTTPClient.h>
+
+extern IRControl irControl;
+extern TxScheduler txScheduler;
+extern RelayEngine relayEngine;
+extern TxTrace txTrace;
+
+static const char *actionNames[] = {"none", "tx", "macro", "event"};
+
+RelayEngine::RelayEngine() :
+      holdRule(-1)
+    , holdLast(0)
+    , latencyMax(0)
+    , events(nullptr)
+    , eventErrors(0)
+{
+    memset(buckets, -1, sizeof(buckets));
+    memset(lastMatch, 0, sizeof(lastMatch));
+    memset(stats, 0, sizeof(stats));
+    memset(latency, 0, sizeof(latency));
+}
+
+void RelayEngine::begin(void) {
+    rebuild();
+
+    if (events == nullptr) {
+        events = xQueueCreate(RELAY_EVENT_QUEUE, sizeof(uint8_t));
+        xTaskCreate(eventTask, "relay", 4096, this, 1, nullptr);
+    }
+}
+
+void RelayEngine::rebuild(void) {
+    const RelayRule_t *rules = Parameter.rules();
+
+    memset(buckets, -1, sizeof(buckets));
+
+    for (int8_t i = 0; i < PARAM_MAX_RULES; i++) {
+        const RelayRule_t *rule = &rules[i];
+        uint8_t bucket = hash(rule->protocol, rule->code);
+
+        if (rule->action == RELAY_ACTION_NONE) {
+            continue;
+        }
+
+        /* Linear probing, there are always free buckets left */
+        while (buckets[bucket] != -1) {
+            bucket = (bucket + 1) & (RELAY_BUCKETS - 1);
+        }
+        buckets[bucket] = i;
+    }
+
+    holdRule = -1;
+}
+
+int8_t RelayEngine::find(decode_type_t type, uint64_t code) const {
+    uint8_t bucket = hash(type, code);
+
+    while (buckets[bucket] != -1) {
+        const RelayRule_t *rule = &Parameter.rules()[buckets[bucket]];
+
+        if (rule->protocol == type && rule->code == code) {
+            return buckets[bucket];
+        }
+        bucket = (bucket + 1) & (RELAY_BUCKETS - 1);
+    }
+
+    return -1;
+}
+
+bool RelayEngine::handle(decode_type_t type, uint64_t code, bool repeat, uint32_t origin) {
+    uint32_t now = millis();
+    int8_t idx = -1;
+
+    if (repeat) {
+        /* Repeat frames carry no code, they belong to the last command if 
+         * the button has been held since then */
+        if (holdRule < 0 || now - holdLast > RELAY_HOLD_TIMEOUT) {
+            holdRule = -1;
+            return false;
+        }
+        holdLast = now;
+        idx = holdRule;
+
+        if (!Parameter.rules()[idx].hold) {
+            return true;
+        }
+    } else {
+        idx = find(type, code);
+        holdRule = idx;
+        holdLast = now;
+
+        if (idx < 0) {
+            return false;
+        }
+    }
+
+    if (stats[idx].hits != 0 && now - lastMatch[idx] < Parameter.rules()[idx].debounce) {
+        stats[idx].dropped++;
+        return true;
+    }
+
+    lastMatch[idx] = now;
+    stats[idx].hits++;
+    trigger(idx, origin);
+
+    return true;
+}
+
+void RelayEngine::addLatency(uint32_t usec) {
+    uint8_t bucket = 0;
+
+    while (bucket < RELAY_LATENCY_BUCKETS - 1 && usec >= (1UL << bucket)) {
+        bucket++;
+    }
+
+    latency[bucket]++;
+    latencyMax = max(latencyMax, usec);
+}
+
+RelayEngine::Stats_t RelayEngine::getStats(uint8_t idx) const {
+    return stats[idx];
+}
+
+void RelayEngine::resetStats(uint8_t idx) {
+    memset(&stats[idx], 0, sizeof(Stats_t));
+    lastMatch[idx] = 0;
+}
+
+String RelayEngine::getStatsString(void) const {
+    String data;
+    uint32_t total = 0;
+    const RelayRule_t *rules = Parameter.rules();
+
+    for (uint8_t i = 0; i < PARAM_MAX_RULES; i++) {
+        if (rules[i].action == RELAY_ACTION_NONE) {
+            continue;
+        }
+
+        data += "rule " + String(i) + "; hits " + String(stats[i].hits) + 
+                "; dropped " + String(stats[i].dropped) + "\n";
+    }
+    data += "events failed " + String(eventErrors) + "\n";
+
+    data += "latency RX to TX:\n";
+    for (uint8_t i = 0; i < RELAY_LATENCY_BUCKETS; i++) {
+        if (latency[i] == 0) {
+            continue;
+        }
+        total += latency[i];
+        data += "  < " + String(1UL << i) + "us: " + String(latency[i]) + "\n";
+    }
+    data += "  total " + String(total) + "; max " + String(latencyMax) + "us\n";
+
+    return data;
+}
+
+uint8_t RelayEngine::hash(int16_t type, uint64_t code) {
+    uint32_t folded = (uint32_t) code ^ (uint32_t) (code >> 32);
+
+    return (((folded ^ ((uint32_t) type << 24)) * 0x9E3779B1) >> 28) & (RELAY_BUCKETS - 1);
+}
+
+void RelayEngine::trigger(uint8_t idx, uint32_t origin) {
+    TxTrace::Stamp_t start = TxTrace::now();
+    const RelayRule_t *rule = &Parameter.rules()[idx];
+    TxJob_t jobs[RELAY_MAX_STEPS];
+    uint16_t traceId = txTrace.getId();
+
+    if (rule->action == RELAY_ACTION_EVENT) {
+        if (events == nullptr || xQueueSend(events, &idx, 0) != pdTRUE) {
+            stats[idx].dropped++;
+        }
+        return;
+    }
+
+    TxScheduler::toJobs(rule->steps, rule->numSteps, jobs);
+    /* The latency is measured up to the first command only */
+    jobs[0].origin = origin;
+
+    /* Each match is traced as a request of its own */
+    txTrace.begin();
+    if (!txScheduler.enqueue(jobs, rule->numSteps)) {
+        stats[idx].dropped++;
+    }
+    txTrace.add(TRACE_RELAY, txTrace.getId(), 0, start);
+    txTrace.setId(traceId);
+}
+
+void RelayEngine::eventTask(void *arg) {
+    RelayEngine *engine = (RelayEngine*) arg;
+    uint8_t idx = 0;
+
+    while (1) {
+        HTTPClient http;
+        String url;
+        int rc = 0;
+
+        if (xQueueReceive(engine->events, &idx, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        if (Parameter.data.relay.url[0] == 0 || WiFi.status() != WL_CONNECTED) {
+            engine->eventErrors++;
+            continue;
+        }
+
+        url = String(Parameter.data.relay.url) + "?event=" + 
+                String(Parameter.rules()[idx].event);
+        http.setTimeout(RELAY_EVENT_TIMEOUT);
+        if (http.begin(url)) {
+            rc = http.GET();
+            http.end();
+        }
+
+        if (rc < 200 || rc >= 300) {
+            engine->eventErrors++;
+        }
+    }
+}
+
+int8_t relay_list(void) {
+    const RelayRule_t *rules = Parameter.rules();
+
+    Serial.printf("  #  Type       Code                Action  Debounce Hold  Hits    Target\n");
+    for (uint8_t i = 0; i < PARAM_MAX_RULES; i++) {
+        const RelayRule_t *rule = &rules[i];
+
+        if (rule->action == RELAY_ACTION_NONE) {
+            continue;
+        }
+
+        Serial.printf("  %u  %-9s  %-18s  %-6s  %-7u  %-4s  %-6u  ", i, 
+                typeToString((decode_type_t) rule->protocol).c_str(), codeToString(rule->code).c_str(),
+                actionNames[rule->action], rule->debounce, rule->hold ? "yes" : "no",
+                relayEngine.getStats(i).hits);
+
+        if (rule->action == RELAY_ACTION_EVENT) {
+            Serial.printf("%s\n", rule->event);
+            continue;
+        }
+
+        Serial.printf("%s\n", TxScheduler::stepsToString(rule->steps, rule->numSteps).c_str());
+    }
+
+    return 0;
+}
+
+int8_t relay_set(int argc, char *argv[]) {
+    RelayRule_t rule;
+    int idx = 0;
+
+    if (argc < 6 || argc > 8) {
+        Serial.printf("Error: Usage: relay set idx type code tx|macro|event target [debounce] [hold]\n");
+        return -1;
+    }
+
+    idx = atoi(argv[1]);
+    if (idx < 0 || idx >= PARAM_MAX_RULES) {
+        Serial.printf("Error: Invalid index, valid range is 0 to %u\n", PARAM_MAX_RULES - 1);
+        return -1;
+    }
+
+    memset(&rule, 0, sizeof(rule));
+    rule.protocol = irControl.stringToIRType(argv[2]);
+    if (rule.protocol == decode_type_t::UNKNOWN) {
+        Serial.printf("Error: Unknown type.\n");
+        return -1;
+    }
+    if (parseCode(argv[3], rule.code) == nullptr) {
+        Serial.printf("Error: Invalid code.\n");
+        return -1;
+    }
+
+    for (uint8_t i = RELAY_ACTION_TRANSMIT; i <= RELAY_ACTION_EVENT; i++) {
+        if (strcmp(argv[4], actionNames[i]) == 0) {
+            rule.action = i;
+        }
+    }
+
+    if (rule.action == RELAY_ACTION_NONE) {
+        Serial.printf("Error: Invalid action, valid actions are tx, macro and event.\n");
+        return -1;
+    }
+
+    if (rule.action == RELAY_ACTION_EVENT) {
+        strncpy(rule.event, argv[5], sizeof(rule.event) - 1);
+    } else {
+        /* Macros are parsed once here, not on each match */
+        String message;
+        int8_t count = TxScheduler::parseSteps(argv[5], rule.steps, 
+                rule.action == RELAY_ACTION_TRANSMIT ? 1 : RELAY_MAX_STEPS, message);
+
+        if (count < 0) {
+            Serial.print(message);
+            return -1;
+        }
+        rule.numSteps = count;
+    }
+
+    if (argc > 6) {
+        rule.debounce = constrain(atoi(argv[6]), 0, 10000);
+    }
+    if (argc > 7) {
+        rule.hold = strcmp(argv[7], "1") == 0 || strcmp(argv[7], "hold") == 0;
+    }
+
+    Parameter.rules()[idx] = rule;
+    relayEngine.resetStats(idx);
+    relayEngine.rebuild();
+
+    return 0;
+}
+
+int8_t relay_del(const char *pIdx) {
+    int idx = pIdx == nullptr ? -1 : atoi(pIdx);
+
+    if (idx < 0 || idx >= PARAM_MAX_RULES) {
+        Serial.printf("Error: Invalid index, valid range is 0 to %u\n", PARAM_MAX_RULES - 1);
+        return -1;
+    }
+
+    memset(&Parameter.rules()[idx], 0, sizeof(RelayRule_t));
+    relayEngine.resetStats(idx);
+    relayEngine.rebuild();
+    return 0;
+}
+
+CLI_COMMAND(relay) {
+    if (argc == 0 || strcmp(argv[0], "list") == 0) {
+        return relay_list();
+    }
+
+    if (strcmp(argv[0], "set") == 0) {
+        return relay_set(argc, argv);
+    }
+
+    if (strcmp(argv[0], "del") == 0) {
+        return relay_del(argv[1]);
+    }
+
+    if (strcmp(argv[0], "stats") == 0) {
+        Serial.print(relayEngine.getStatsString());
+        return 0;
+    }
+
+    Serial.printf("Error: Invalid command!\n");
+    return -1;
+}
@@ -0,0 +1,202 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRremoteESP8266.h>
+
+#include "parameter.hpp"
+
+/**
+ * @brief The number of hash buckets of the rule index, a power of 2 and at 
+ * least twice the number of rules.
+ */
+#define RELAY_BUCKETS               16
+
+/**
+ * @brief Repeat frames received later than this time in ms after the last 
+ * frame do not belong to a held button.
+ */
+#define RELAY_HOLD_TIMEOUT          250
+
+/**
+ * @brief The number of latency histogram buckets, bucket n counts latencies 
+ * below 2^n us.
+ */
+#define RELAY_LATENCY_BUCKETS       20
+
+/**
+ * @brief The maximum number of pending HTTP events.
+ */
+#define RELAY_EVENT_QUEUE           8
+
+/**
+ * @brief Timeout of a HTTP event request in ms.
+ */
+#define RELAY_EVENT_TIMEOUT         2000
+
+/**
+ * @brief Relay rules engine.
+ * Translates received commands into transmitted commands, macros or HTTP 
+ * events without a round trip to a home automation hub. Rules are looked up 
+ * by a hash index over protocol and code. Transmissions are queued on the 
+ * transmit scheduler and HTTP events are sent by a worker task, hence 
+ * reception is never blocked by a triggered action.
+ */
+class RelayEngine {
+    public:
+
+        /**
+         * @brief Statistics of a rule.
+         */
+        typedef struct {
+            uint32_t hits;
+            uint32_t dropped;
+        } Stats_t;
+
+        /**
+         * @brief Constructor
+         */
+        RelayEngine();
+
+        /**
+         * @brief Build the rule index and start the event worker.
+         */
+        void begin(void);
+
+        /**
+         * @brief Rebuild the rule index, has to be called after the rules 
+         * have been changed.
+         */
+        void rebuild(void);
+
+        /**
+         * @brief Find the rule of a received command.
+         * @param type The protocol.
+         * @param code The code.
+         * @return The rule index or -1 if there is none.
+         */
+        int8_t find(decode_type_t type, uint64_t code) const;
+
+        /**
+         * @brief Process a received command.
+         * @param type The protocol.
+         * @param code The code.
+         * @param repeat true for a repeat frame of a held button.
+         * @param origin The micros() timestamp of the reception.
+         * @return true if a rule matched.
+         */
+        bool handle(decode_type_t type, uint64_t code, bool repeat, uint32_t origin);
+
+        /**
+         * @brief Add a reception to transmission latency to the histogram.
+         * @param usec The latency in microseconds.
+         */
+        void addLatency(uint32_t usec);
+
+        /**
+         * @brief Get the statistics of a rule.
+         * @param idx The rule index.
+         * @return The statistics.
+         */
+        Stats_t getStats(uint8_t idx) const;
+
+        /**
+         * @brief Reset the statistics of a rule.
+         * @param idx The rule index.
+         */
+        void resetStats(uint8_t idx);
+
+        /**
+         * @brief Get the rule statistics and the latency histogram as text.
+         * @return One line per configured rule followed by the histogram.
+         */
+        String getStatsString(void) const;
+
+    private:
+
+        /**
+         * @brief Calculate the hash bucket of a command.
+         * @param type The protocol.
+         * @param code The code.
+         * @return The bucket index.
+         */
+        static uint8_t hash(int16_t type, uint64_t code);
+
+        /**
+         * @brief Execute the action of a rule.
+         * @param idx The rule index.
+         * @param origin The micros() timestamp of the reception.
+         */
+        void trigger(uint8_t idx, uint32_t origin);
+
+        /**
+         * @brief Worker task sending the queued HTTP events.
+         * @param arg The relay engine.
+         */
+        static void eventTask(void *arg);
+
+        /**
+         * @brief Rule index per bucket, -1 if empty.
+         */
+        int8_t buckets[RELAY_BUCKETS];
+
+        /**
+         * @brief The millis() timestamp of the last accepted match per rule.
+         */
+        uint32_t lastMatch[PARAM_MAX_RULES];
+
+        /**
+         * @brief The statistics per rule.
+         */
+        Stats_t stats[PARAM_MAX_RULES];
+
+        /**
+         * @brief The rule of the last received command, -1 if none matched.
+         */
+        int8_t holdRule;
+
+        /**
+         * @brief The millis() timestamp of the last frame of the held button.
+         */
+        uint32_t holdLast;
+
+        /**
+         * @brief Latency histogram.
+         */
+        uint32_t latency[RELAY_LATENCY_BUCKETS];
+
+        /**
+         * @brief The maximum latency in microseconds.
+         */
+        uint32_t latencyMax;
+
+        /**
+         * @brief Queue of rule indices whose HTTP event has to be sent.
+         */
+        QueueHandle_t events;
+
+        /**
+         * @brief Number of failed HTTP events.
+         */
+        uint32_t eventErrors;
+};
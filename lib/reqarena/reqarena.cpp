@@ -0,0 +1,195 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "reqarena.hpp"
+
+ReqArena::ReqArena() :
+    top(0),
+    open(0),
+    isOpen(false),
+    truncated(false) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void *ReqArena::alloc(size_t size) {
+    size_t start = (top + 3) & ~((size_t) 3);
+
+    if (isOpen || start + size > REQARENA_SIZE) {
+        stats.overflows++;
+        return nullptr;
+    }
+
+    top = start + size;
+    stats.allocs++;
+    stats.peak = max((size_t) stats.peak, top);
+
+    return &buffer[start];
+}
+
+const char *ReqArena::printf(const char *pFmt, ...) {
+    va_list args;
+
+    begin();
+    va_start(args, pFmt);
+    vcat(pFmt, args);
+    va_end(args);
+
+    return end();
+}
+
+void ReqArena::begin(void) {
+    if (isOpen) {
+        end();
+    }
+
+    truncated = top >= REQARENA_SIZE;
+    isOpen = true;
+    open = top;
+    if (!truncated) {
+        buffer[top++] = 0;
+    }
+}
+
+bool ReqArena::cat(const char *pFmt, ...) {
+    va_list args;
+    bool ok = false;
+
+    va_start(args, pFmt);
+    ok = vcat(pFmt, args);
+    va_end(args);
+
+    return ok;
+}
+
+bool ReqArena::vcat(const char *pFmt, va_list args) {
+    size_t avail = 0;
+    int len = 0;
+
+    if (!isOpen || truncated) {
+        return false;
+    }
+
+    /* The terminator of the string so far is overwritten */
+    avail = REQARENA_SIZE - top + 1;
+    len = vsnprintf((char *) &buffer[top - 1], avail, pFmt, args);
+    if (len < 0 || (size_t) len >= avail) {
+        truncated = true;
+        top = REQARENA_SIZE;
+        return false;
+    }
+
+    top += len;
+    return true;
+}
+
+bool ReqArena::catJson(const char *pStr) {
+    if (!isOpen || truncated) {
+        return false;
+    }
+
+    /* The opening quote replaces the terminator of the string so far, an 
+     * escaped character takes up to 6 bytes, the end 2 more */
+    buffer[top - 1] = '"';
+    for (; *pStr != 0 && top + 8 <= REQARENA_SIZE; pStr++) {
+        char c = *pStr;
+
+        if (c == '"' || c == '\\') {
+            buffer[top++] = '\\';
+            buffer[top++] = c;
+        } else if ((uint8_t) c < 0x20) {
+            top += snprintf((char *) &buffer[top], 7, "\\u%04x", c);
+        } else {
+            buffer[top++] = c;
+        }
+    }
+
+    if (*pStr != 0 || top + 2 > REQARENA_SIZE) {
+        truncated = true;
+        top = REQARENA_SIZE;
+        return false;
+    }
+
+    buffer[top++] = '"';
+    buffer[top++] = 0;
+
+    return true;
+}
+
+const char *ReqArena::end(size_t *pLen) {
+    const char *pStr = nullptr;
+
+    if (!isOpen) {
+        return nullptr;
+    }
+
+    if (truncated) {
+        stats.overflows++;
+    } else {
+        pStr = (const char *) &buffer[open];
+        stats.allocs++;
+        if (pLen != nullptr) {
+            *pLen = top - open - 1;
+        }
+    }
+
+    stats.peak = max((size_t) stats.peak, top);
+    isOpen = false;
+    truncated = false;
+
+    return pStr;
+}
+
+void ReqArena::reset(void) {
+    if (top != 0) {
+        stats.requests++;
+    }
+
+    top = 0;
+    isOpen = false;
+    truncated = false;
+}
+
+void ReqArena::rewind(size_t used) {
+    if (used < top) {
+        top = used;
+    }
+
+    isOpen = false;
+    truncated = false;
+}
+
+size_t ReqArena::getUsed(void) const {
+    return top;
+}
+
+const ReqArena::Stats_t &ReqArena::getStats(void) const {
+    return stats;
+}
+
+String ReqArena::getStatsString(void) const {
+    char buf[128];
+
+    snprintf(buf, sizeof(buf), "  Arena:         %u bytes, peak %u, %lu requests, %lu allocs, %lu overflows\n",
+        (unsigned) REQARENA_SIZE, stats.peak, (unsigned long) stats.requests, 
+        (unsigned long) stats.allocs, (unsigned long) stats.overflows);
+
+    return String(buf);
+}
@@ -0,0 +1,166 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+/**
+ * @brief The size of the arena in bytes.
+ */
+#define REQARENA_SIZE               4096
+
+/**
+ * @brief Request scoped bump allocator.
+ * 
+ * Temporaries of a request are allocated by advancing a pointer through a 
+ * static buffer and released all at once by reset() after the response has
+ * been sent. Nothing touches the heap, so building responses does not 
+ * fragment it. One string may be open at a time, it is built by cat() 
+ * calls. Allocations failing for lack of space are counted, the caller has
+ * to fall back to the heap.
+ */
+class ReqArena {
+
+    public:
+
+        /**
+         * @brief Statistics of the arena.
+         */
+        typedef struct {
+            uint32_t requests;
+            uint32_t allocs;
+            uint32_t overflows;
+            uint16_t peak;
+        } Stats_t;
+
+        /**
+         * @brief Construct a new ReqArena object.
+         */
+        ReqArena();
+
+        /**
+         * @brief Allocates memory, aligned to 4 bytes.
+         * @param size The size in bytes.
+         * @return The memory, nullptr if the arena is full.
+         */
+        void *alloc(size_t size);
+
+        /**
+         * @brief Formats a string into the arena.
+         * @param pFmt The printf format.
+         * @return The string, nullptr if the arena is full.
+         */
+        const char *printf(const char *pFmt, ...) __attribute__((format(printf, 2, 3)));
+
+        /**
+         * @brief Opens a string built by cat().
+         */
+        void begin(void);
+
+        /**
+         * @brief Appends formatted text to the open string.
+         * @param pFmt The printf format.
+         * @return false if the arena is full, the string is truncated then.
+         */
+        bool cat(const char *pFmt, ...) __attribute__((format(printf, 2, 3)));
+
+        /**
+         * @brief Appends a string to the open string as JSON string, quoted
+         * and escaped.
+         * @param pStr The string.
+         * @return false if the arena is full, the string is truncated then.
+         */
+        bool catJson(const char *pStr);
+
+        /**
+         * @brief Closes the open string.
+         * @param pLen Returns the length of the string if not nullptr.
+         * @return The string, nullptr if it did not fit into the arena.
+         */
+        const char *end(size_t *pLen = nullptr);
+
+        /**
+         * @brief Releases all allocations, called once a request has been 
+         * answered.
+         */
+        void reset(void);
+
+        /**
+         * @brief Releases the allocations made after getUsed() returned 
+         * used, allows to reuse the memory for each chunk of a response.
+         * @param used The number of bytes to keep.
+         */
+        void rewind(size_t used);
+
+        /**
+         * @brief Returns the number of bytes in use.
+         */
+        size_t getUsed(void) const;
+
+        /**
+         * @brief Returns the statistics.
+         */
+        const Stats_t &getStats(void) const;
+
+        /**
+         * @brief Returns the statistics as human readable text.
+         */
+        String getStatsString(void) const;
+
+    private:
+
+        /**
+         * @brief Appends formatted text to the open string.
+         */
+        bool vcat(const char *pFmt, va_list args);
+
+        /**
+         * @brief The memory of the arena.
+         */
+        uint8_t buffer[REQARENA_SIZE] __attribute__((aligned(4)));
+
+        /**
+         * @brief The offset of the next allocation.
+         */
+        size_t top;
+
+        /**
+         * @brief The offset of the open string.
+         */
+        size_t open;
+
+        /**
+         * @brief Set while a string is open.
+         */
+        bool isOpen;
+
+        /**
+         * @brief Set if the open string did not fit.
+         */
+        bool truncated;
+
+        /**
+         * @brief The statistics.
+         */
+        Stats_t stats;
+};
@@ -0,0 +1,147 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @brief The number of retries a reader spins before it yields to let a 
+ * preempted writer finish.
+ */
+#define SEQLOCK_SPIN_RETRIES        8
+
+/**
+ * @brief Publishes a value of a single writer task to readers in any task 
+ * without locks.
+ * The writer never waits, it increments the sequence number to an odd value,
+ * stores the value and increments it to an even value again. Readers copy the
+ * value and retry if the sequence number was odd or has changed meanwhile, 
+ * hence they always get a consistent snapshot. The value is stored as words 
+ * with relaxed atomic accesses, so the copies of a racing reader are well 
+ * defined and only discarded.
+ * @tparam T The value, has to be trivially copyable.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "T has to be trivially copyable");
+
+    public:
+
+        /**
+         * @brief Constructor, publishes a zeroed value.
+         */
+        SeqLock() : seq(0) {
+            for (size_t i = 0; i < WORDS; i++) {
+                data[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Publish a new value, only one task may write.
+         * @param value The value.
+         */
+        void write(const T &value) {
+            uint32_t words[WORDS] = {0};
+            uint32_t s = seq.load(std::memory_order_relaxed);
+
+            memcpy(words, &value, sizeof(T));
+            seq.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < WORDS; i++) {
+                data[i].store(words[i], std::memory_order_relaxed);
+            }
+            seq.store(s + 2, std::memory_order_release);
+        }
+
+        /**
+         * @brief Read a consistent snapshot of the value.
+         * Retries while the writer is active, which only takes the time of 
+         * the copy. After SEQLOCK_SPIN_RETRIES the reader yields on each 
+         * retry, a writer preempted by the reader on the same core could 
+         * not finish otherwise.
+         * @param value Returns the value.
+         * @return The number of retries.
+         */
+        uint32_t read(T &value) const {
+            uint32_t words[WORDS];
+            uint32_t retries = 0;
+
+            while (!tryRead(words)) {
+                retries++;
+                if (retries >= SEQLOCK_SPIN_RETRIES) {
+                    taskYIELD();
+                }
+            }
+            memcpy(&value, words, sizeof(T));
+
+            return retries;
+        }
+
+        /**
+         * @brief Get the number of values published so far.
+         * @return The number of values.
+         */
+        uint32_t getVersion(void) const {
+            return seq.load(std::memory_order_acquire) >> 1;
+        }
+
+    private:
+
+        /**
+         * @brief The number of words to store the value.
+         */
+        static constexpr size_t WORDS = (sizeof(T) + 3) / 4;
+
+        /**
+         * @brief Copy the value once.
+         * @param words Returns the words of the value.
+         * @return true if the copy is consistent.
+         */
+        bool tryRead(uint32_t *words) const {
+            uint32_t s1 = seq.load(std::memory_order_acquire);
+            uint32_t s2 = 0;
+
+            if (s1 & 1) {
+                return false;
+            }
+
+            for (size_t i = 0; i < WORDS; i++) {
+                words[i] = data[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            s2 = seq.load(std::memory_order_relaxed);
+
+            return s1 == s2;
+        }
+
+        /**
+         * @brief The sequence number, odd while the writer is active.
+         */
+        std::atomic<uint32_t> seq;
+
+        /**
+         * @brief The value as words.
+         */
+        std::atomic<uint32_t> data[WORDS];
+};
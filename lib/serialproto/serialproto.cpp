@@ -0,0 +1,362 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "serialproto.hpp"
+#include "ircontrol.hpp"
+#include "txscheduler.hpp"
+#include "txtrace.hpp"
+
+#include <cli/cli.hpp>
+
+extern IRControl irControl;
+extern TxScheduler txScheduler;
+extern TxTrace txTrace;
+extern SerialProto serialProto;
+
+/**
+ * @brief Store a value little endian.
+ */
+static void putLE(uint8_t *buf, uint64_t value, uint8_t size) {
+    for (uint8_t i = 0; i < size; i++) {
+        buf[i] = (uint8_t) (value >> (8 * i));
+    }
+}
+
+SerialProto::SerialProto(HardwareSerial &port) :
+      port(port)
+    , active(false)
+    , synced(false)
+    , rxPos(0)
+    , rxLast(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool SerialProto::begin(uint32_t baud) {
+    if (baud != 0 && !isValidBaud(baud)) {
+        return false;
+    }
+
+    if (baud != 0) {
+        port.printf("Binary protocol at %lu baud, EXIT returns to the CLI\n", 
+                (unsigned long) baud);
+        port.flush();
+        port.updateBaudRate(baud);
+    } else {
+        port.printf("Binary protocol, EXIT returns to the CLI\n");
+        port.flush();
+    }
+
+    /* Text output would only slow down the host */
+    irControl.setEcho(false);
+    synced = false;
+    rxPos = 0;
+    active = true;
+
+    return true;
+}
+
+void SerialProto::end(void) {
+    /* The host may have switched the baud rate, the CLI always uses its own */
+    port.flush();
+    port.updateBaudRate(SERPROTO_CLI_BAUD);
+    irControl.setEcho(true);
+    active = false;
+}
+
+void SerialProto::loop(void) {
+    uint32_t now = millis();
+    int avail = 0;
+
+    if (!active) {
+        return;
+    }
+
+    avail = port.available();
+    if (avail == 0) {
+        if (synced && now - rxLast > SERPROTO_TIMEOUT) {
+            synced = false;
+            stats.dropped++;
+        }
+        return;
+    }
+
+    rxLast = now;
+    while (avail-- > 0 && active) {
+        parse((uint8_t) port.read());
+    }
+}
+
+void SerialProto::parse(uint8_t c) {
+    uint16_t len = 0;
+
+    if (!synced) {
+        synced = c == SERPROTO_SYNC;
+        rxPos = 0;
+        return;
+    }
+
+    rxBuf[rxPos++] = c;
+    while (synced && rxPos >= SERPROTO_HEADER_SIZE) {
+        len = rxBuf[3] | (rxBuf[4] << 8);
+        if (len <= SERPROTO_MAX_PAYLOAD) {
+            uint16_t crc = 0;
+
+            if (rxPos < SERPROTO_HEADER_SIZE + len + 2) {
+                return;
+            }
+
+            crc = rxBuf[rxPos - 2] | (rxBuf[rxPos - 1] << 8);
+            if (crc == crc16(rxBuf, SERPROTO_HEADER_SIZE + len)) {
+                synced = false;
+                stats.rxFrames++;
+                dispatch(rxBuf[0], rxBuf[1] | (rxBuf[2] << 8), &rxBuf[SERPROTO_HEADER_SIZE], len);
+                return;
+            }
+        }
+
+        stats.dropped++;
+        resync();
+    }
+}
+
+void SerialProto::resync(void) {
+    /* The next frame may start within the bytes of the damaged one */
+    uint8_t *next = (uint8_t *) memchr(rxBuf, SERPROTO_SYNC, rxPos);
+
+    if (next == nullptr) {
+        synced = false;
+        rxPos = 0;
+        return;
+    }
+
+    rxPos -= next + 1 - rxBuf;
+    memmove(rxBuf, next + 1, rxPos);
+}
+
+void SerialProto::dispatch(uint8_t type, uint16_t id, const uint8_t *payload, uint16_t len) {
+    IRControl::Snapshot_t ir;
+    uint8_t data[22];
+    uint16_t pending = 0;
+    uint32_t baud = 0;
+
+    switch (type) {
+        case PROTO_PING:
+            send(PROTO_ACK, id, payload, len);
+            break;
+
+        case PROTO_TX:
+            handleTx(id, payload, len);
+            break;
+
+        case PROTO_STATUS:
+            for (uint8_t i = 0; i < IRTX_CHANNELS; i++) {
+                pending += txScheduler.getStats(i).pending;
+            }
+            irControl.getSnapshot(ir);
+            putLE(&data[0], ir.numTx, 4);
+            putLE(&data[4], ir.numRx, 4);
+            putLE(&data[8], millis(), 4);
+            putLE(&data[12], pending, 2);
+            putLE(&data[14], stats.rxFrames, 4);
+            putLE(&data[18], stats.dropped, 4);
+            send(PROTO_ACK, id, data, sizeof(data));
+            break;
+
+        case PROTO_BAUD:
+            for (int8_t i = min(len, (uint16_t) 4) - 1; i >= 0; i--) {
+                baud = (baud << 8) | payload[i];
+            }
+            if (len != 4 || !isValidBaud(baud)) {
+                sendNak(id, PROTO_ERR_INVALID, 0xFF, "Invalid baud rate");
+                break;
+            }
+            send(PROTO_ACK, id, nullptr, 0);
+            port.flush();
+            port.updateBaudRate(baud);
+            break;
+
+        case PROTO_EXIT:
+            send(PROTO_ACK, id, nullptr, 0);
+            end();
+            break;
+
+        default:
+            sendNak(id, PROTO_ERR_TYPE, 0xFF, "Unknown frame type");
+            break;
+    }
+}
+
+void SerialProto::handleTx(uint16_t id, const uint8_t *payload, uint16_t len) {
+    TxTrace::Stamp_t start = TxTrace::now();
+    const char *error = nullptr;
+    uint8_t idx = 0xFF;
+    uint8_t count = 0;
+
+    /* The same path as POST /tx/batch */
+    txTrace.begin();
+    batch.begin(TxBatch::FORMAT_BINARY);
+    batch.feed(payload, len);
+    txTrace.add(TRACE_PARSE, txTrace.getId(), 0, start);
+
+    if (!batch.finish()) {
+        error = batch.getError(&idx);
+        sendNak(id, PROTO_ERR_INVALID, idx, error != nullptr ? error : "Invalid batch");
+    } else if (!txScheduler.enqueue(batch.getJobs(), batch.getCount())) {
+        sendNak(id, PROTO_ERR_BUSY, 0xFF, "Transmit queue full");
+    } else {
+        count = batch.getCount();
+        send(PROTO_ACK, id, &count, 1);
+    }
+
+    txTrace.setId(0);
+}
+
+void SerialProto::send(uint8_t type, uint16_t id, const uint8_t *payload, uint16_t len) {
+    uint8_t header[1 + SERPROTO_HEADER_SIZE];
+    uint8_t trailer[2];
+    uint16_t crc = 0;
+
+    header[0] = SERPROTO_SYNC;
+    header[1] = type;
+    putLE(&header[2], id, 2);
+    putLE(&header[4], len, 2);
+    crc = crc16(&header[1], SERPROTO_HEADER_SIZE);
+    crc = crc16(payload, len, crc);
+    putLE(trailer, crc, 2);
+
+    port.write(header, sizeof(header));
+    if (len > 0) {
+        port.write(payload, len);
+    }
+    port.write(trailer, sizeof(trailer));
+    stats.txFrames++;
+}
+
+void SerialProto::sendNak(uint16_t id, ProtoError_t error, uint8_t idx, const char *text) {
+    uint8_t data[2 + 48];
+    size_t len = min(strlen(text), sizeof(data) - 2);
+
+    data[0] = error;
+    data[1] = idx;
+    memcpy(&data[2], text, len);
+    send(PROTO_NAK, id, data, 2 + len);
+    stats.naks++;
+}
+
+void SerialProto::event(decode_type_t type, uint64_t code, uint16_t bits, bool repeat) {
+    uint8_t data[TXBATCH_RECORD_SIZE];
+
+    if (!active) {
+        return;
+    }
+
+    if (port.availableForWrite() < (int) (1 + SERPROTO_HEADER_SIZE + sizeof(data) + 2)) {
+        stats.eventsDropped++;
+        return;
+    }
+
+    putLE(&data[0], (uint16_t) type, 2);
+    data[2] = (uint8_t) bits;
+    data[3] = repeat ? 0x01 : 0x00;
+    putLE(&data[4], code, 8);
+    putLE(&data[12], millis(), 4);
+    send(PROTO_RX, 0, data, sizeof(data));
+    stats.events++;
+}
+
+void SerialProto::notice(const char *text) {
+    size_t len = min(strlen(text), (size_t) SERPROTO_NOTICE_SIZE);
+
+    if (!active) {
+        return;
+    }
+
+    if (port.availableForWrite() < (int) (1 + SERPROTO_HEADER_SIZE + len + 2)) {
+        stats.eventsDropped++;
+        return;
+    }
+
+    send(PROTO_NOTICE, 0, (const uint8_t *) text, len);
+    stats.events++;
+}
+
+const SerialProto::Stats_t &SerialProto::getStats(void) const {
+    return stats;
+}
+
+String SerialProto::getStatsString(void) const {
+    char buf[64];
+    String data;
+
+    snprintf(buf, sizeof(buf), "  Active:        %s\n", active ? "yes" : "no");
+    data += buf;
+    snprintf(buf, sizeof(buf), "  RX frames:     %lu\n", (unsigned long) stats.rxFrames);
+    data += buf;
+    snprintf(buf, sizeof(buf), "  TX frames:     %lu\n", (unsigned long) stats.txFrames);
+    data += buf;
+    snprintf(buf, sizeof(buf), "  Dropped:       %lu\n", (unsigned long) stats.dropped);
+    data += buf;
+    snprintf(buf, sizeof(buf), "  NAKs:          %lu\n", (unsigned long) stats.naks);
+    data += buf;
+    snprintf(buf, sizeof(buf), "  Events:        %lu, %lu dropped\n", 
+            (unsigned long) stats.events, (unsigned long) stats.eventsDropped);
+    data += buf;
+
+    return data;
+}
+
+uint16_t SerialProto::crc16(const uint8_t *data, size_t len, uint16_t crc) {
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t) data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+
+    return crc;
+}
+
+bool SerialProto::isValidBaud(uint32_t baud) {
+    return baud >= SERPROTO_MIN_BAUD && baud <= SERPROTO_MAX_BAUD;
+}
+
+CLI_COMMAND(proto) {
+    uint32_t baud = 0;
+
+    if (argc > 0 && strcmp(argv[0], "stats") == 0) {
+        Serial.printf("Binary protocol:\n");
+        Serial.print(serialProto.getStatsString());
+        return 0;
+    }
+
+    if (argc > 0) {
+        baud = strtoul(argv[0], 0, 0);
+    }
+
+    if (!serialProto.begin(baud)) {
+        Serial.printf("Error: Invalid baud rate, %u to %u is supported.\n", 
+                SERPROTO_MIN_BAUD, SERPROTO_MAX_BAUD);
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,306 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRremoteESP8266.h>
+
+#include "txbatch.hpp"
+
+/**
+ * @brief The first byte of each frame.
+ */
+#define SERPROTO_SYNC               0xA5
+
+/**
+ * @brief The size of the frame header after the sync byte: type, id and 
+ * payload length.
+ */
+#define SERPROTO_HEADER_SIZE        5
+
+/**
+ * @brief The maximum payload size, a full batch of transmit records.
+ */
+#define SERPROTO_MAX_PAYLOAD        (TXBATCH_MAX_ITEMS * TXBATCH_RECORD_SIZE)
+
+/**
+ * @brief The size of the UART receive buffer, set before Serial.begin().
+ * Holds several frames in case the loop is busy.
+ */
+#define SERPROTO_RX_BUFFER          2048
+
+/**
+ * @brief A partial frame is dropped if no byte has been received for this 
+ * time in ms.
+ */
+#define SERPROTO_TIMEOUT            100
+
+/**
+ * @brief The baud rate of the CLI, restored when leaving the binary protocol.
+ */
+#define SERPROTO_CLI_BAUD           115200
+
+/**
+ * @brief The lowest and highest supported baud rates.
+ */
+#define SERPROTO_MIN_BAUD           9600
+#define SERPROTO_MAX_BAUD           5000000
+
+/**
+ * @brief The maximum length of the text of a NOTICE frame.
+ */
+#define SERPROTO_NOTICE_SIZE        64
+
+/**
+ * @brief Frame types, requests of the host below 0x80, frames of the 
+ * gateway from 0x80.
+ */
+typedef enum {
+    PROTO_PING = 0x01,
+    PROTO_TX = 0x02,
+    PROTO_STATUS = 0x03,
+    PROTO_BAUD = 0x04,
+    PROTO_EXIT = 0x05,
+    PROTO_ACK = 0x80,
+    PROTO_NAK = 0x81,
+    PROTO_RX = 0x82,
+    PROTO_NOTICE = 0x83
+} ProtoFrame_t;
+
+/**
+ * @brief Error codes of a NAK frame.
+ */
+typedef enum {
+    PROTO_ERR_TYPE = 1,
+    PROTO_ERR_INVALID,
+    PROTO_ERR_BUSY
+} ProtoError_t;
+
+/**
+ * @brief Framed binary protocol on the serial console.
+ * Replaces the CLI while active, for host automation at high rates. All 
+ * values are little endian. A frame is:
+ * 
+ *     0xA5 | type u8 | id u16 | len u16 | payload | crc u16
+ * 
+ * The CRC-16/CCITT-FALSE covers type to payload. Frames with a wrong CRC are 
+ * dropped and the search for the next frame continues after their sync byte,
+ * the host retries after a timeout. Each request is answered with an
+ * ACK or NAK frame with the id of the request:
+ * - PING: ACK echoes the payload.
+ * - TX: The payload are transmit records in the binary format of TxBatch,
+ *   queued like POST /tx/batch. ACK has the number of queued commands as u8. 
+ * - STATUS: ACK has tx count u32, rx count u32, uptime ms u32, pending 
+ *   commands u16, received frames u32 and dropped frames u32.
+ * - BAUD: u32 baud rate, ACK is sent before switching.
+ * - EXIT: ACK, then the CLI takes over again.
+ * NAK has the error code u8, the index of the invalid command u8 (0xFF for 
+ * none) and an error text. Received codes are reported by RX frames with
+ * id 0: type i16, bits u8, flags u8 (bit 0 repeat), code u64 and the time of
+ * reception in ms u32. Errors which the CLI prints as text, e.g. a queued
+ * command which fails when it is sent, are reported by NOTICE frames with id 
+ * 0 and the text as payload. No other output is sent while active.
+ */
+class SerialProto {
+    public:
+
+        /**
+         * @brief Statistics of the protocol.
+         */
+        typedef struct {
+            uint32_t rxFrames;
+            uint32_t txFrames;
+            uint32_t dropped;
+            uint32_t naks;
+            uint32_t events;
+            uint32_t eventsDropped;
+        } Stats_t;
+
+        /**
+         * @brief Constructor
+         * @param port The serial port shared with the CLI.
+         */
+        SerialProto(HardwareSerial &port = Serial);
+
+        /**
+         * @brief Switch from the CLI to the binary protocol.
+         * @param baud The baud rate to switch to, 0 to keep the current one.
+         * @return false if the baud rate is not supported.
+         */
+        bool begin(uint32_t baud = 0);
+
+        /**
+         * @brief Switch back to the CLI at SERPROTO_CLI_BAUD.
+         */
+        void end(void);
+
+        /**
+         * @brief Check if the binary protocol is active.
+         * @return true if active.
+         */
+        bool isActive(void) const {
+            return active;
+        }
+
+        /**
+         * @brief Receive and process the pending frames. Has to be called 
+         * cyclically instead of the CLI while active.
+         */
+        void loop(void);
+
+        /**
+         * @brief Report a received code to the host, if active.
+         * Dropped if the UART transmit buffer is full, the loop never waits 
+         * for the host.
+         * @param type The protocol.
+         * @param code The code.
+         * @param bits The number of bits.
+         * @param repeat true for a repeat frame of a held button.
+         */
+        void event(decode_type_t type, uint64_t code, uint16_t bits, bool repeat);
+
+        /**
+         * @brief Report a message to the host, if active.
+         * Dropped like events if the UART transmit buffer is full.
+         * @param text The message, truncated to SERPROTO_NOTICE_SIZE 
+         *        characters.
+         */
+        void notice(const char *text);
+
+        /**
+         * @brief Get the statistics.
+         * @return The statistics.
+         */
+        const Stats_t &getStats(void) const;
+
+        /**
+         * @brief Get the statistics as text.
+         * @return The statistics, one value per line.
+         */
+        String getStatsString(void) const;
+
+        /**
+         * @brief Calculate the CRC-16/CCITT-FALSE of a buffer.
+         * @param data The buffer.
+         * @param len The length of the buffer.
+         * @param crc The CRC so far, to continue over several buffers.
+         * @return The CRC.
+         */
+        static uint16_t crc16(const uint8_t *data, size_t len, uint16_t crc = 0xFFFF);
+
+    private:
+
+        /**
+         * @brief Process a single received byte.
+         * @param c The byte.
+         */
+        void parse(uint8_t c);
+
+        /**
+         * @brief Drop a damaged frame and continue at the next sync byte in
+         * the bytes received so far.
+         */
+        void resync(void);
+
+        /**
+         * @brief Process a complete frame with a valid CRC.
+         * @param type The frame type.
+         * @param id The request id.
+         * @param payload The payload.
+         * @param len The length of the payload.
+         */
+        void dispatch(uint8_t type, uint16_t id, const uint8_t *payload, uint16_t len);
+
+        /**
+         * @brief Queue the commands of a TX frame.
+         * @param id The request id.
+         * @param payload The transmit records.
+         * @param len The length of the payload.
+         */
+        void handleTx(uint16_t id, const uint8_t *payload, uint16_t len);
+
+        /**
+         * @brief Send a frame.
+         * @param type The frame type.
+         * @param id The request id.
+         * @param payload The payload.
+         * @param len The length of the payload.
+         */
+        void send(uint8_t type, uint16_t id, const uint8_t *payload, uint16_t len);
+
+        /**
+         * @brief Send a NAK frame.
+         * @param id The request id.
+         * @param error The error code.
+         * @param idx The index of the invalid command, 0xFF for none.
+         * @param text The error text.
+         */
+        void sendNak(uint16_t id, ProtoError_t error, uint8_t idx, const char *text);
+
+        /**
+         * @brief Check if a baud rate is supported.
+         * @param baud The baud rate.
+         * @return true if supported.
+         */
+        static bool isValidBaud(uint32_t baud);
+
+        /**
+         * @brief The serial port.
+         */
+        HardwareSerial &port;
+
+        /**
+         * @brief true while the binary protocol replaces the CLI.
+         */
+        bool active;
+
+        /**
+         * @brief true once a sync byte has been received, the frame is 
+         * collected in rxBuf.
+         */
+        bool synced;
+
+        /**
+         * @brief The number of bytes in rxBuf.
+         */
+        uint16_t rxPos;
+
+        /**
+         * @brief millis() of the last received byte.
+         */
+        uint32_t rxLast;
+
+        /**
+         * @brief The frame being received, without the sync byte.
+         */
+        uint8_t rxBuf[SERPROTO_HEADER_SIZE + SERPROTO_MAX_PAYLOAD + 2];
+
+        /**
+         * @brief Parser of the transmit records of a TX frame.
+         */
+        TxBatch batch;
+
+        /**
+         * @brief The statistics.
+         */
+        Stats_t stats;
+};
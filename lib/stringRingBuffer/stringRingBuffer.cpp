@@ -21,28 +21,42 @@
 
 #include "stringRingBuffer.hpp"
 
-StringRingBuffer::StringRingBuffer(int size) : 
-      bufferSize(size)
-    , buffer(new String[size])
+StringRingBuffer::StringRingBuffer(String *slots, uint8_t size) : 
+      mask(size - 1)
+    , buffer(slots)
     , head(0)
     , tail(0)
     , itemCount(0) 
+    , seq(0)
 {
 
 }
-
-StringRingBuffer::~StringRingBuffer() {
-    delete[] buffer;
-}
    
 void StringRingBuffer::push(const String& data) {
-    if (itemCount == bufferSize) {
-        pop();
+    push(data.c_str());
+}
+
+void StringRingBuffer::push(const char *data) {
+    /* The oldest string is overwritten in place, no copy is popped */
+    if (itemCount == mask + 1) {
+        tail = (tail + 1) & mask;
+        itemCount--;
     }
 
     buffer[head] = data;
-    head = (head+1) % bufferSize;
+    head = (head + 1) & mask;
     itemCount++;
+    seq++;
+}
+
+void StringRingBuffer::update(const String& data) {
+    if (itemCount == 0) {
+        push(data);
+        return;
+    }
+
+    buffer[(head - 1) & mask] = data;
+    seq++;
 }
 
 String StringRingBuffer::pop() {
@@ -51,20 +65,21 @@ String StringRingBuffer::pop() {
     }
 
     String value = buffer[tail];
-    tail = (tail + 1) % bufferSize;
+    tail = (tail + 1) & mask;
     itemCount--;
+    seq++;
 
     return value;
 }
 
-String StringRingBuffer::peek() const {
-    String data("none");
+const String &StringRingBuffer::peek() const {
+    static const String none("none");
 
-    if (itemCount != 0) {
-        data = buffer[head-1];
+    if (itemCount == 0) {
+        return none;
     }
 
-    return data;
+    return buffer[(head - 1) & mask];
 }
 
 String StringRingBuffer::dump() const {
@@ -76,7 +91,7 @@ String StringRingBuffer::dump() const {
 
         do {
             data += buffer[pos] + "\n";
-            pos = (pos + 1) % bufferSize;
+            pos = (pos + 1) & mask;
 
         } while(pos != head);    
     }
@@ -25,28 +25,33 @@
 /**
  * @brief A ring buffer for storing strings.
  * This class provides a fixed-size buffer to store strings in a circular manner.
+ * The slots are provided by StaticStringRingBuffer, their number is a power 
+ * of 2 so indices wrap with a mask.
  */
 class StringRingBuffer 
 {
     public:
 
         /**
-         * @brief Constructor for StringRingBuffer.
-         * @param size The size of the buffer.
+         * @brief Push a string into the buffer.
+         * @param data The string to be pushed into the buffer.
          */
-        StringRingBuffer(int size);
+        void push(const String& data);
 
         /**
-         * @brief Destructor for StringRingBuffer.
-         * Cleans up the resources used by the buffer.
+         * @brief Push a string into the buffer.
+         * The slot keeps its allocation if it is large enough, so pushing
+         * formatted text this way does not allocate a temporary String.
+         * @param data The string to be pushed into the buffer.
          */
-        ~StringRingBuffer();
+        void push(const char *data);
 
         /**
-         * @brief Push a string into the buffer.
-         * @param data The string to be pushed into the buffer.
+         * @brief Replace the newest string in the buffer.
+         * Pushes the string if the buffer is empty.
+         * @param data The string replacing the newest one.
          */
-        void push(const String& data);
+        void update(const String& data);
         
         /**
          * @brief Pop a string from the buffer.
@@ -56,11 +61,20 @@ class StringRingBuffer
         String pop();
         
         /**
-         * @brief Peek at the next string in the buffer without removing it.
-         * @return The next string in the buffer.
-         * If the buffer is empty, it returns an empty string.
+         * @brief Peek at the newest string in the buffer without removing it.
+         * @return The newest string in the buffer, valid until the next push.
+         * If the buffer is empty, it returns "none".
          */
-        String peek(void) const;
+        const String &peek(void) const;
+
+        /**
+         * @brief Get a string of the buffer.
+         * @param idx The index, 0 is the oldest string.
+         * @return The string, valid until the next push.
+         */
+        const String &get(int idx) const {
+            return buffer[(tail + idx) & mask];
+        }
 
         /**
          * @brief Dump the contents of the buffer as a string.
@@ -81,7 +95,7 @@ class StringRingBuffer
          * @return true if the buffer is full, false otherwise.
          */
         bool isFull() const {
-            return itemCount == bufferSize;
+            return itemCount == mask + 1;
         }
 
         /**
@@ -92,17 +106,36 @@ class StringRingBuffer
             return itemCount;
         }
 
+        /**
+         * @brief Get the sequence number of the buffer.
+         * It is incremented by every change, so readers can detect changes
+         * without comparing the contents.
+         * @return The sequence number.
+         */
+        uint32_t getSeq() const {
+            return seq;
+        }
+
+    protected:
+
+        /**
+         * @brief Constructor for StringRingBuffer.
+         * @param slots The slots of the buffer, not accessed until the first
+         * push.
+         * @param size The number of slots, a power of 2.
+         */
+        StringRingBuffer(String *slots, uint8_t size);
+
     private:
 
         /**
-         * @brief The size of the buffer.
-         * This is the maximum number of items that can be stored in the buffer.
+         * @brief The size of the buffer minus 1, masks the indices.
+         * The size is the maximum number of items that can be stored.
          */
-        uint8_t bufferSize;
+        uint8_t mask;
 
         /**
          * @brief Pointer to the buffer that stores the strings.
-         * This is a dynamically allocated array of strings.
          */
         String* buffer;
         
@@ -123,4 +156,34 @@ class StringRingBuffer
          * This is used to keep track of how many items are currently stored.
          */
         uint8_t itemCount;
+
+        /**
+         * @brief The sequence number, incremented by every change.
+         */
+        uint32_t seq;
+};
+
+/**
+ * @brief A string ring buffer with statically allocated slots.
+ * @tparam SIZE The number of slots, a power of 2 up to 128.
+ */
+template <uint8_t SIZE>
+class StaticStringRingBuffer : public StringRingBuffer
+{
+    static_assert(SIZE != 0 && SIZE <= 128 && (SIZE & (SIZE - 1)) == 0, 
+            "SIZE has to be a power of 2 up to 128");
+
+    public:
+
+        /**
+         * @brief Constructor for StaticStringRingBuffer.
+         */
+        StaticStringRingBuffer() : StringRingBuffer(slots, SIZE) {}
+
+    private:
+
+        /**
+         * @brief The slots.
+         */
+        String slots[SIZE];
 };
@@ -0,0 +1,482 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "timerwheel.hpp"
+#include "txscheduler.hpp"
+#include "txtrace.hpp"
+
+#include <cli/cli.hpp>
+
+extern TxScheduler txScheduler;
+extern TimerWheel timerWheel;
+extern TxTrace txTrace;
+
+/**
+ * @brief The mask of the slot index of a level.
+ */
+#define TIMER_WHEEL_MASK            (TIMER_WHEEL_SLOTS - 1)
+
+/**
+ * @brief The longest delay which can be armed, longer ones are cascaded 
+ * again when the top level wraps.
+ */
+#define TIMER_WHEEL_SPAN            ((1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+/**
+ * @brief Names of the timer modes, indexed by TimerMode_t.
+ */
+static const char *modeNames[] = {"none", "once", "daily", "every"};
+
+TimerWheel::TimerWheel() :
+    current(0),
+    armed(0),
+    fired(0),
+    dropped(0) {
+    memset(heads, -1, sizeof(heads));
+    memset(next, -1, sizeof(next));
+    memset(prev, -1, sizeof(prev));
+    memset(slots, -1, sizeof(slots));
+    memset(expiry, 0, sizeof(expiry));
+}
+
+void TimerWheel::tick(void) {
+    uint32_t now = time(nullptr);
+
+    if (!isSynced()) {
+        return;
+    }
+
+    /* Armed at the first valid time and whenever the clock has been set */
+    if (current == 0 || now < current || now - current > TIMER_MAX_CATCHUP) {
+        rebuild(now);
+        return;
+    }
+
+    while (current != now) {
+        uint8_t slot = 0;
+        int8_t idx = -1;
+
+        if (armed == 0) {
+            current = now;
+            break;
+        }
+
+        current++;
+        for (uint8_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if (current & ((1UL << (TIMER_WHEEL_BITS * level)) - 1)) {
+                break;
+            }
+            cascade(level, (current >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+        }
+
+        slot = current & TIMER_WHEEL_MASK;
+        idx = heads[0][slot];
+        heads[0][slot] = -1;
+        while (idx != -1) {
+            int8_t following = next[idx];
+
+            slots[idx] = -1;
+            armed--;
+            if (expiry[idx] > current) {
+                link(idx);
+            } else {
+                expire(idx);
+            }
+            idx = following;
+        }
+    }
+}
+
+int8_t TimerWheel::set(uint8_t idx, const Timer_t &timer) {
+    uint32_t now = time(nullptr);
+
+    if (timer.mode == TIMER_MODE_ONCE && timer.time <= now) {
+        return -1;
+    }
+
+    if (slots[idx] >= 0) {
+        unlink(idx);
+    }
+
+    Parameter.timers()[idx] = timer;
+    Parameter.write("tmr");
+
+    if (current != 0) {
+        expiry[idx] = nextExpiry(timer, current);
+        if (expiry[idx] != 0) {
+            link(idx);
+        }
+    }
+
+    return 0;
+}
+
+void TimerWheel::cancel(uint8_t idx) {
+    if (slots[idx] >= 0) {
+        unlink(idx);
+    }
+
+    memset(&Parameter.timers()[idx], 0, sizeof(Timer_t));
+    Parameter.write("tmr");
+}
+
+int8_t TimerWheel::findFree(void) const {
+    const Timer_t *timers = Parameter.timers();
+
+    for (uint8_t i = 0; i < PARAM_MAX_TIMERS; i++) {
+        if (timers[i].mode == TIMER_MODE_NONE) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool TimerWheel::isSynced(void) {
+    return time(nullptr) >= TIMER_EPOCH_VALID;
+}
+
+uint32_t TimerWheel::nextExpiry(const Timer_t &timer, uint32_t now) {
+    time_t start = now;
+    struct tm today;
+
+    switch (timer.mode) {
+        case TIMER_MODE_ONCE:
+            return timer.time;
+
+        case TIMER_MODE_INTERVAL:
+            return now + max(timer.time, (uint32_t) 1);
+
+        case TIMER_MODE_DAILY:
+            localtime_r(&start, &today);
+            /* mktime() normalizes the day and applies the DST offset */
+            for (uint8_t day = 0; day <= 7; day++) {
+                struct tm candidate = today;
+                time_t epoch = 0;
+
+                candidate.tm_mday += day;
+                candidate.tm_hour = timer.time / 3600;
+                candidate.tm_min = (timer.time / 60) % 60;
+                candidate.tm_sec = timer.time % 60;
+                candidate.tm_isdst = -1;
+                epoch = mktime(&candidate);
+
+                if (epoch > start && (timer.days & (1 << candidate.tm_wday))) {
+                    return epoch;
+                }
+            }
+            return 0;
+
+        default:
+            return 0;
+    }
+}
+
+String TimerWheel::getListString(void) const {
+    String data;
+    const Timer_t *timers = Parameter.timers();
+
+    for (uint8_t i = 0; i < PARAM_MAX_TIMERS; i++) {
+        const Timer_t *timer = &timers[i];
+        char buf[24];
+
+        if (timer->mode == TIMER_MODE_NONE) {
+            continue;
+        }
+
+        data += "timer " + String(i) + "; " + modeNames[timer->mode];
+        if (timer->mode == TIMER_MODE_DAILY) {
+            snprintf(buf, sizeof(buf), " %02u:%02u", timer->time / 3600, (timer->time / 60) % 60);
+            data += buf;
+            if ((timer->days & 0x7F) != 0x7F) {
+                data += " days ";
+                for (uint8_t day = 0; day < 7; day++) {
+                    if (timer->days & (1 << day)) {
+                        data += String(day);
+                    }
+                }
+            }
+        } else if (timer->mode == TIMER_MODE_INTERVAL) {
+            data += " " + String(timer->time) + "s";
+        }
+
+        if (slots[i] >= 0) {
+            time_t epoch = expiry[i];
+            struct tm timeinfo;
+
+            localtime_r(&epoch, &timeinfo);
+            strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &timeinfo);
+            data += "; next " + String(buf);
+        } else {
+            data += "; not armed";
+        }
+        data += "; " + TxScheduler::stepsToString(timer->steps, timer->numSteps) + "\n";
+    }
+    data += "fired " + String(fired) + "; dropped " + String(dropped) + "\n";
+
+    return data;
+}
+
+void TimerWheel::link(uint8_t idx) {
+    uint32_t when = expiry[idx];
+    uint32_t delta = when - current;
+    uint8_t level = 0;
+    uint8_t slot = 0;
+
+    if (delta > TIMER_WHEEL_SPAN) {
+        when = current + TIMER_WHEEL_SPAN;
+        delta = TIMER_WHEEL_SPAN;
+    }
+
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1UL << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    slot = (when >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+
+    prev[idx] = -1;
+    next[idx] = heads[level][slot];
+    if (next[idx] != -1) {
+        prev[next[idx]] = idx;
+    }
+    heads[level][slot] = idx;
+    slots[idx] = level * TIMER_WHEEL_SLOTS + slot;
+    armed++;
+}
+
+void TimerWheel::unlink(uint8_t idx) {
+    uint8_t level = slots[idx] / TIMER_WHEEL_SLOTS;
+    uint8_t slot = slots[idx] % TIMER_WHEEL_SLOTS;
+
+    if (prev[idx] != -1) {
+        next[prev[idx]] = next[idx];
+    } else {
+        heads[level][slot] = next[idx];
+    }
+    if (next[idx] != -1) {
+        prev[next[idx]] = prev[idx];
+    }
+
+    slots[idx] = -1;
+    armed--;
+}
+
+void TimerWheel::cascade(uint8_t level, uint8_t slot) {
+    int8_t idx = heads[level][slot];
+
+    heads[level][slot] = -1;
+    while (idx != -1) {
+        int8_t following = next[idx];
+
+        slots[idx] = -1;
+        armed--;
+        link(idx);
+        idx = following;
+    }
+}
+
+void TimerWheel::expire(uint8_t idx) {
+    Timer_t *timer = &Parameter.timers()[idx];
+    TxJob_t jobs[TIMER_MAX_STEPS];
+
+    TxScheduler::toJobs(timer->steps, timer->numSteps, jobs);
+    txTrace.begin();
+    if (txScheduler.enqueue(jobs, timer->numSteps)) {
+        fired++;
+    } else {
+        dropped++;
+    }
+    txTrace.setId(0);
+
+    if (timer->mode == TIMER_MODE_ONCE) {
+        memset(timer, 0, sizeof(Timer_t));
+        Parameter.write("tmr");
+        return;
+    }
+
+    expiry[idx] = nextExpiry(*timer, current);
+    if (expiry[idx] != 0) {
+        link(idx);
+    }
+}
+
+void TimerWheel::rebuild(uint32_t now) {
+    bool changed = false;
+    Timer_t *timers = Parameter.timers();
+
+    memset(heads, -1, sizeof(heads));
+    memset(slots, -1, sizeof(slots));
+    armed = 0;
+    current = now;
+
+    for (uint8_t i = 0; i < PARAM_MAX_TIMERS; i++) {
+        Timer_t *timer = &timers[i];
+
+        if (timer->mode == TIMER_MODE_NONE) {
+            continue;
+        }
+
+        if (timer->mode == TIMER_MODE_ONCE && timer->time <= now) {
+            if (now - timer->time > TIMER_GRACE) {
+                memset(timer, 0, sizeof(Timer_t));
+                changed = true;
+                dropped++;
+                continue;
+            }
+            /* Missed while the time was unknown, executed on the next tick */
+            expiry[i] = now + 1;
+        } else {
+            expiry[i] = nextExpiry(*timer, now);
+        }
+
+        if (expiry[i] != 0) {
+            link(i);
+        }
+    }
+
+    if (changed) {
+        Parameter.write("tmr");
+    }
+}
+
+/**
+ * @brief Parse a time of day.
+ * @param str The time in the format HH:MM.
+ * @param seconds Reference to store the seconds since midnight.
+ * @return true on success.
+ */
+static bool parseTimeOfDay(const char *str, uint32_t &seconds) {
+    unsigned int hour = 0;
+    unsigned int minute = 0;
+    char end = 0;
+
+    if (sscanf(str, "%u:%u%c", &hour, &minute, &end) != 2 || hour > 23 || minute > 59) {
+        return false;
+    }
+    seconds = hour * 3600 + minute * 60;
+
+    return true;
+}
+
+int8_t timer_set(int argc, char *argv[]) {
+    Timer_t timer;
+    String message;
+    int8_t count = 0;
+    int idx = 0;
+
+    if (argc < 5 || argc > 6) {
+        Serial.printf("Error: Usage: timer set idx in|at|daily|every time target [days]\n");
+        return -1;
+    }
+
+    idx = atoi(argv[1]);
+    if (idx < 0 || idx >= PARAM_MAX_TIMERS) {
+        Serial.printf("Error: Invalid index, valid range is 0 to %u\n", PARAM_MAX_TIMERS - 1);
+        return -1;
+    }
+
+    if (!TimerWheel::isSynced()) {
+        Serial.printf("Error: Time not synchronized.\n");
+        return -1;
+    }
+
+    memset(&timer, 0, sizeof(timer));
+    if (strcmp(argv[2], "in") == 0 || strcmp(argv[2], "every") == 0) {
+        timer.mode = argv[2][0] == 'i' ? TIMER_MODE_ONCE : TIMER_MODE_INTERVAL;
+        timer.time = strtoul(argv[3], nullptr, 10);
+        if (timer.time == 0) {
+            Serial.printf("Error: Invalid number of seconds.\n");
+            return -1;
+        }
+        if (timer.mode == TIMER_MODE_ONCE) {
+            timer.time += time(nullptr);
+        }
+    } else if (strcmp(argv[2], "at") == 0 || strcmp(argv[2], "daily") == 0) {
+        timer.mode = TIMER_MODE_DAILY;
+        timer.days = 0x7F;
+        if (!parseTimeOfDay(argv[3], timer.time)) {
+            Serial.printf("Error: Invalid time, expected HH:MM.\n");
+            return -1;
+        }
+        if (argc > 5) {
+            timer.days = 0;
+            for (const char *day = argv[5]; *day; day++) {
+                if (*day < '0' || *day > '6') {
+                    Serial.printf("Error: Invalid days, expected weekday digits, 0 is Sunday.\n");
+                    return -1;
+                }
+                timer.days |= 1 << (*day - '0');
+            }
+        }
+        /* A one shot at a time of day is the next occurrence of that time */
+        if (argv[2][0] == 'a') {
+            timer.time = TimerWheel::nextExpiry(timer, time(nullptr));
+            timer.mode = TIMER_MODE_ONCE;
+            timer.days = 0;
+        }
+    } else {
+        Serial.printf("Error: Invalid mode, valid modes are in, at, daily and every.\n");
+        return -1;
+    }
+
+    count = TxScheduler::parseSteps(argv[4], timer.steps, TIMER_MAX_STEPS, message);
+    if (count < 0) {
+        Serial.print(message);
+        return -1;
+    }
+    timer.numSteps = count;
+
+    if (timerWheel.set(idx, timer) != 0) {
+        Serial.printf("Error: The time has already passed.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int8_t timer_del(const char *pIdx) {
+    int idx = pIdx == nullptr ? -1 : atoi(pIdx);
+
+    if (idx < 0 || idx >= PARAM_MAX_TIMERS) {
+        Serial.printf("Error: Invalid index, valid range is 0 to %u\n", PARAM_MAX_TIMERS - 1);
+        return -1;
+    }
+
+    timerWheel.cancel(idx);
+    return 0;
+}
+
+CLI_COMMAND(timer) {
+    if (argc == 0 || strcmp(argv[0], "list") == 0) {
+        Serial.print(timerWheel.getListString());
+        return 0;
+    }
+
+    if (strcmp(argv[0], "set") == 0) {
+        return timer_set(argc, argv);
+    }
+
+    if (strcmp(argv[0], "del") == 0) {
+        return timer_del(argv[1]);
+    }
+
+    Serial.printf("Error: Invalid command!\n");
+    return -1;
+}
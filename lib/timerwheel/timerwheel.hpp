@@ -0,0 +1,203 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "parameter.hpp"
+
+/**
+ * @brief The number of levels of the timer wheel.
+ */
+#define TIMER_WHEEL_LEVELS          4
+
+/**
+ * @brief log2 of the number of slots per level.
+ */
+#define TIMER_WHEEL_BITS            6
+
+/**
+ * @brief The number of slots per level, level n covers 64^(n+1) seconds.
+ */
+#define TIMER_WHEEL_SLOTS           (1 << TIMER_WHEEL_BITS)
+
+/**
+ * @brief The oldest epoch which is accepted as synchronized time.
+ */
+#define TIMER_EPOCH_VALID           1704067200
+
+/**
+ * @brief One shot timers missed by up to this time in seconds, e.g. during a 
+ * reboot, are still executed.
+ */
+#define TIMER_GRACE                 300
+
+/**
+ * @brief The wheel is rebuilt instead of stepped if the time jumps by more
+ * than this number of seconds.
+ */
+#define TIMER_MAX_CATCHUP           600
+
+/**
+ * @brief Scheduler of delayed and recurring commands.
+ * Timers are kept in a hierarchical timer wheel with a resolution of one 
+ * second, arming and expiring a timer is O(1). The wheel is advanced by 
+ * tick() once per second and only runs once the time has been synchronized 
+ * via NTP. Timers are stored in the parameters and are armed again after a 
+ * reboot, one shot timers missed by up to TIMER_GRACE seconds are executed.
+ */
+class TimerWheel {
+    public:
+
+        /**
+         * @brief Constructor
+         */
+        TimerWheel();
+
+        /**
+         * @brief Advance the wheel to the current time and execute the 
+         * expired timers. Has to be called once per second.
+         */
+        void tick(void);
+
+        /**
+         * @brief Store and arm a timer.
+         * @param idx The timer index.
+         * @param timer The timer.
+         * @return 0 on success, -1 if the timer already expired.
+         */
+        int8_t set(uint8_t idx, const Timer_t &timer);
+
+        /**
+         * @brief Cancel and remove a timer.
+         * @param idx The timer index.
+         */
+        void cancel(uint8_t idx);
+
+        /**
+         * @brief Find an unused timer.
+         * @return The timer index or -1 if all are in use.
+         */
+        int8_t findFree(void) const;
+
+        /**
+         * @brief Check if the time has been synchronized.
+         * @return true if the current time is valid.
+         */
+        static bool isSynced(void);
+
+        /**
+         * @brief Calculate the next expiry of a timer.
+         * @param timer The timer.
+         * @param now The current epoch.
+         * @return The epoch of the next expiry after now, 0 if none.
+         */
+        static uint32_t nextExpiry(const Timer_t &timer, uint32_t now);
+
+        /**
+         * @brief Get all timers and their next expiry as text.
+         * @return One line per timer.
+         */
+        String getListString(void) const;
+
+    private:
+
+        /**
+         * @brief Add a timer to the slot of its expiry.
+         * @param idx The timer index.
+         */
+        void link(uint8_t idx);
+
+        /**
+         * @brief Remove a timer from its slot.
+         * @param idx The timer index.
+         */
+        void unlink(uint8_t idx);
+
+        /**
+         * @brief Move the timers of a slot to the lower levels.
+         * @param level The level.
+         * @param slot The slot.
+         */
+        void cascade(uint8_t level, uint8_t slot);
+
+        /**
+         * @brief Send the commands of an expired timer and arm it again if it
+         * is a recurring one.
+         * @param idx The timer index.
+         */
+        void expire(uint8_t idx);
+
+        /**
+         * @brief Arm all stored timers at the current time.
+         * @param now The current epoch.
+         */
+        void rebuild(uint32_t now);
+
+        /**
+         * @brief The first timer per slot, -1 if empty.
+         */
+        int8_t heads[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+
+        /**
+         * @brief The next timer in the slot, -1 if none.
+         */
+        int8_t next[PARAM_MAX_TIMERS];
+
+        /**
+         * @brief The previous timer in the slot, -1 if none.
+         */
+        int8_t prev[PARAM_MAX_TIMERS];
+
+        /**
+         * @brief The slot of each timer as level * TIMER_WHEEL_SLOTS + slot,
+         * -1 if not armed.
+         */
+        int16_t slots[PARAM_MAX_TIMERS];
+
+        /**
+         * @brief The epoch of the next expiry of each timer.
+         */
+        uint32_t expiry[PARAM_MAX_TIMERS];
+
+        /**
+         * @brief The epoch the wheel has been advanced to, 0 until the time
+         * has been synchronized.
+         */
+        uint32_t current;
+
+        /**
+         * @brief The number of armed timers.
+         */
+        uint8_t armed;
+
+        /**
+         * @brief The number of executed timers.
+         */
+        uint32_t fired;
+
+        /**
+         * @brief The number of timers dropped because the transmit queue was
+         * full or they have been missed.
+         */
+        uint32_t dropped;
+};
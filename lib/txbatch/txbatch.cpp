@@ -0,0 +1,445 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "txbatch.hpp"
+#include "ircontrol.hpp"
+#include "irdb.hpp"
+
+#include <IRutils.h>
+
+extern IRControl irControl;
+extern IRDb irDb;
+
+/**
+ * @brief Parse a decimal JSON number within a range.
+ * @param str The number.
+ * @param min The minimum value.
+ * @param max The maximum value.
+ * @param value Reference to store the value.
+ * @return true if the whole string is a number within the range.
+ */
+static bool parseNumber(const char *str, long min, long max, long &value) {
+    char *end = nullptr;
+
+    value = strtol(str, &end, 10);
+    return end != str && *end == 0 && value >= min && value <= max;
+}
+
+TxBatch::TxBatch() {
+    begin(FORMAT_JSON);
+}
+
+void TxBatch::begin(Format_t format) {
+    this->format = format;
+    state = STATE_START;
+    tokenType = TOKEN_ITEM;
+    escape = false;
+    tokenLen = 0;
+    key[0] = 0;
+    code[0] = 0;
+    db = false;
+    recordLen = 0;
+    count = 0;
+    error = nullptr;
+    offset = 0;
+}
+
+void TxBatch::feed(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len && error == nullptr; i++) {
+        if (format == FORMAT_BINARY) {
+            record[recordLen++] = data[i];
+            if (recordLen == TXBATCH_RECORD_SIZE) {
+                parseRecord();
+                recordLen = 0;
+            }
+        } else {
+            parseJson(data[i]);
+        }
+
+        if (error == nullptr) {
+            offset++;
+        }
+    }
+}
+
+bool TxBatch::finish(void) {
+    if (error != nullptr) {
+        return false;
+    }
+
+    if (format == FORMAT_BINARY && recordLen != 0) {
+        setError("Truncated record");
+    } else if (format == FORMAT_JSON && state != STATE_DONE) {
+        setError("Unexpected end of body");
+    } else if (count == 0) {
+        setError("Empty batch");
+    }
+
+    if (error != nullptr) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (errors[i] != nullptr) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint8_t TxBatch::getCount(void) const {
+    return count;
+}
+
+const TxJob_t* TxBatch::getJobs(void) const {
+    return jobs;
+}
+
+String TxBatch::getResultString(bool queued, const char *error) const {
+    String data = "{\"queued\":" + String(queued ? count : 0);
+
+    if (this->error != nullptr) {
+        data += ",\"error\":\"" + String(this->error) + "\",\"offset\":" + String(offset);
+    } else if (error != nullptr) {
+        data += ",\"error\":\"" + String(error) + "\"";
+    }
+
+    data += ",\"items\":[";
+    for (uint8_t i = 0; i < count; i++) {
+        data += i == 0 ? "{" : ",{";
+        if (errors[i] != nullptr) {
+            data += "\"status\":\"error\",\"error\":\"" + String(errors[i]) + "\"}";
+        } else {
+            data += queued ? "\"status\":\"queued\"}" : "\"status\":\"valid\"}";
+        }
+    }
+    data += "]}\n";
+
+    return data;
+}
+
+const char *TxBatch::getError(uint8_t *pIdx) const {
+    uint8_t idx = 0xFF;
+    const char *first = error;
+
+    for (uint8_t i = 0; i < count && first == nullptr; i++) {
+        if (errors[i] != nullptr) {
+            idx = i;
+            first = errors[i];
+        }
+    }
+
+    if (pIdx != nullptr) {
+        *pIdx = idx;
+    }
+
+    return first;
+}
+
+void TxBatch::parseJson(char c) {
+    bool space = c == ' ' || c == '\t' || c == '\r' || c == '\n';
+
+    switch (state) {
+        case STATE_START:
+            if (c == '[') {
+                state = STATE_ITEM;
+            } else if (!space) {
+                setError("Expected '['");
+            }
+            break;
+
+        case STATE_ITEM:
+            if (c == '{' || c == '"') {
+                if (beginItem()) {
+                    tokenType = TOKEN_ITEM;
+                    tokenLen = 0;
+                    state = c == '{' ? STATE_KEY : STATE_STRING;
+                }
+            } else if (c == ']' && count == 0) {
+                state = STATE_DONE;
+            } else if (!space) {
+                setError("Expected object or string");
+            }
+            break;
+
+        case STATE_KEY:
+            if (c == '"') {
+                tokenType = TOKEN_KEY;
+                tokenLen = 0;
+                state = STATE_STRING;
+            } else if (c == '}') {
+                endItem();
+                state = STATE_AFTER_ITEM;
+            } else if (!space) {
+                setError("Expected key");
+            }
+            break;
+
+        case STATE_STRING:
+            if (!escape && c == '\\') {
+                escape = true;
+                break;
+            }
+            if (escape || c != '"') {
+                escape = false;
+                if (tokenLen == TXBATCH_TOKEN_SIZE - 1) {
+                    setItemError("Value too long");
+                } else {
+                    token[tokenLen++] = c;
+                }
+                break;
+            }
+
+            token[tokenLen] = 0;
+            if (tokenType == TOKEN_KEY) {
+                strncpy(key, token, sizeof(key) - 1);
+                key[sizeof(key) - 1] = 0;
+                state = STATE_COLON;
+            } else if (tokenType == TOKEN_VALUE) {
+                setField(true);
+                state = STATE_AFTER_VALUE;
+            } else {
+                String message;
+                const char *end = TxScheduler::parseJob(token, jobs[count], message);
+
+                if (end == nullptr || *end != 0) {
+                    setItemError("Invalid command");
+                }
+                count++;
+                state = STATE_AFTER_ITEM;
+            }
+            break;
+
+        case STATE_COLON:
+            if (c == ':') {
+                state = STATE_VALUE;
+            } else if (!space) {
+                setError("Expected ':'");
+            }
+            break;
+
+        case STATE_VALUE:
+            if (c == '"') {
+                tokenType = TOKEN_VALUE;
+                tokenLen = 0;
+                state = STATE_STRING;
+            } else if (isalnum(c) || c == '-') {
+                token[0] = c;
+                tokenLen = 1;
+                state = STATE_LITERAL;
+            } else if (!space) {
+                setError("Expected value");
+            }
+            break;
+
+        case STATE_LITERAL:
+            if (isalnum(c) || c == '-' || c == '+' || c == '.') {
+                if (tokenLen == TXBATCH_TOKEN_SIZE - 1) {
+                    setItemError("Value too long");
+                } else {
+                    token[tokenLen++] = c;
+                }
+                break;
+            }
+            token[tokenLen] = 0;
+            setField(false);
+            /* The delimiter belongs to the next state */
+            state = STATE_AFTER_VALUE;
+            parseJson(c);
+            break;
+
+        case STATE_AFTER_VALUE:
+            if (c == ',') {
+                state = STATE_KEY;
+            } else if (c == '}') {
+                endItem();
+                state = STATE_AFTER_ITEM;
+            } else if (!space) {
+                setError("Expected ',' or '}'");
+            }
+            break;
+
+        case STATE_AFTER_ITEM:
+            if (c == ',') {
+                state = STATE_ITEM;
+            } else if (c == ']') {
+                state = STATE_DONE;
+            } else if (!space) {
+                setError("Expected ',' or ']'");
+            }
+            break;
+
+        case STATE_DONE:
+            if (!space) {
+                setError("Unexpected data after the array");
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void TxBatch::parseRecord(void) {
+    TxJob_t *job = &jobs[count];
+    int16_t type = record[0] | (record[1] << 8);
+    uint16_t pause = record[12] | (record[13] << 8);
+
+    if (!beginItem()) {
+        return;
+    }
+
+    job->type = (decode_type_t) type;
+    job->bits = record[2];
+    job->repeat = record[3];
+    job->code = 0;
+    for (int8_t i = 7; i >= 0; i--) {
+        job->code = (job->code << 8) | record[4 + i];
+    }
+    job->pause = pause;
+    job->channel = (int8_t) record[14];
+    job->force = record[15] & 0x01;
+
+    if (type <= decode_type_t::UNUSED || type > decode_type_t::kLastDecodeType) {
+        setItemError("Unknown type");
+    } else if (hasACState(job->type)) {
+        setItemError("State based protocols can't be queued");
+    } else if (job->type == decode_type_t::RAW && irDb.findRef(job->code) == nullptr && 
+            (job->code >= PARAM_MAX_LEARNED || Parameter.learned()[job->code].name[0] == 0)) {
+        setItemError("Unknown learned code");
+    } else if (job->bits > 64) {
+        setItemError("Invalid bits");
+    } else if (job->repeat > 15) {
+        setItemError("Invalid repeat");
+    } else if (job->pause != TXSCHED_PAUSE_DEFAULT && job->pause > 5000) {
+        setItemError("Invalid pause");
+    } else if (job->channel < -1 || job->channel >= IRTX_CHANNELS) {
+        setItemError("Invalid channel");
+    }
+    count++;
+}
+
+bool TxBatch::beginItem(void) {
+    TxJob_t *job = &jobs[count];
+
+    if (count == TXBATCH_MAX_ITEMS) {
+        setError("Too many commands");
+        return false;
+    }
+
+    TxScheduler::initJob(*job, decode_type_t::NEC, 0);
+    errors[count] = nullptr;
+    code[0] = 0;
+    db = false;
+
+    return true;
+}
+
+void TxBatch::setField(bool isString) {
+    TxJob_t *job = &jobs[count];
+    long value = 0;
+
+    if (strcmp(key, "type") == 0) {
+        decode_type_t type = decode_type_t::UNKNOWN;
+        uint16_t bits = 0;
+        const char *end = nullptr;
+
+        if (isString && strcasecmp(token, "db") == 0) {
+            db = true;
+            return;
+        }
+
+        end = irControl.parseType(token, type, bits);
+        if (!isString || end == nullptr || *end != 0) {
+            setItemError("Unknown type");
+            return;
+        }
+        job->type = type;
+        job->bits = bits != 0 ? bits : job->bits;
+    } else if (strcmp(key, "code") == 0) {
+        strcpy(code, token);
+    } else if (strcmp(key, "bits") == 0) {
+        if (isString || !parseNumber(token, 0, 64, value)) {
+            setItemError("Invalid bits");
+            return;
+        }
+        job->bits = value;
+    } else if (strcmp(key, "repeat") == 0) {
+        if (isString || !parseNumber(token, 0, 15, value)) {
+            setItemError("Invalid repeat");
+            return;
+        }
+        job->repeat = value;
+    } else if (strcmp(key, "pause") == 0) {
+        if (isString || !parseNumber(token, 0, 5000, value)) {
+            setItemError("Invalid pause");
+            return;
+        }
+        job->pause = value;
+    } else if (strcmp(key, "channel") == 0) {
+        if (isString || !parseNumber(token, -1, IRTX_CHANNELS - 1, value)) {
+            setItemError("Invalid channel");
+            return;
+        }
+        job->channel = value;
+    } else if (strcmp(key, "force") == 0) {
+        if (isString || (strcmp(token, "true") != 0 && strcmp(token, "false") != 0)) {
+            setItemError("Invalid force");
+            return;
+        }
+        job->force = token[0] == 't';
+    } else {
+        setItemError("Unknown field");
+    }
+}
+
+void TxBatch::endItem(void) {
+    TxJob_t *job = &jobs[count];
+
+    if (hasACState(job->type)) {
+        setItemError("State based protocols can't be queued");
+    } else if (code[0] == 0) {
+        setItemError("Missing code");
+    } else if (db) {
+        if (!irDb.resolve(code, job->type, job->code, job->bits)) {
+            setItemError("Unknown database code");
+        }
+    } else {
+        const char *end = TxScheduler::parseCode(job->type, code, job->code);
+
+        if (end == nullptr || *end != 0) {
+            setItemError("Invalid code");
+        }
+    }
+    count++;
+}
+
+void TxBatch::setItemError(const char *error) {
+    if (errors[count] == nullptr) {
+        errors[count] = error;
+    }
+}
+
+void TxBatch::setError(const char *error) {
+    this->error = error;
+    state = STATE_ERROR;
+}
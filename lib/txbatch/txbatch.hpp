@@ -0,0 +1,272 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "txscheduler.hpp"
+
+/**
+ * @brief The maximum number of commands of a batch.
+ */
+#define TXBATCH_MAX_ITEMS           TXSCHED_QUEUE_SIZE
+
+/**
+ * @brief The maximum length of a JSON key or value, fits the names of the
+ * code database.
+ */
+#define TXBATCH_TOKEN_SIZE          64
+
+/**
+ * @brief The size of a command in the binary format.
+ */
+#define TXBATCH_RECORD_SIZE         16
+
+/**
+ * @brief Streaming parser of transmit batches.
+ * The request body is passed in chunks as received, it is never buffered as 
+ * a whole. Two formats are supported:
+ * - JSON: An array of objects with the fields type, code, bits, repeat, 
+ *   pause, channel and force, or of strings in the sequence format 
+ *   type[/bits]:code:repeat[:pause][@channel].
+ * - Binary: Little endian records of TXBATCH_RECORD_SIZE bytes, int16 type,
+ *   uint8 bits, uint8 repeat, uint64 code, uint16 pause (0xFFFF for the 
+ *   default), int8 channel (-1 to route by device) and uint8 flags (bit 0 
+ *   force). Repeat is 0 to 15, pause 0 to 5000 ms like in JSON.
+ * Each command is validated on its own, the batch is only valid if all are.
+ */
+class TxBatch {
+    public:
+
+        /**
+         * @brief The format of the request body.
+         */
+        typedef enum {
+            FORMAT_JSON,
+            FORMAT_BINARY
+        } Format_t;
+
+        /**
+         * @brief Constructor
+         */
+        TxBatch();
+
+        /**
+         * @brief Start parsing a new batch.
+         * @param format The format of the batch.
+         */
+        void begin(Format_t format);
+
+        /**
+         * @brief Parse the next chunk of the batch.
+         * @param data The chunk.
+         * @param len The length of the chunk.
+         */
+        void feed(const uint8_t *data, size_t len);
+
+        /**
+         * @brief Finish parsing at the end of the body.
+         * @return true if the batch is complete and all commands are valid.
+         */
+        bool finish(void);
+
+        /**
+         * @brief Get the number of parsed commands.
+         * @return The number of commands.
+         */
+        uint8_t getCount(void) const;
+
+        /**
+         * @brief Get the parsed commands.
+         * @return The commands, valid up to getCount().
+         */
+        const TxJob_t* getJobs(void) const;
+
+        /**
+         * @brief Get the result of the batch as JSON.
+         * @param queued true if the commands have been queued.
+         * @param error An error which applies to the whole batch, nullptr if
+         *        none.
+         * @return A JSON object with the number of queued commands and the 
+         *         status of each command.
+         */
+        String getResultString(bool queued, const char *error = nullptr) const;
+
+        /**
+         * @brief Get the first error of the batch.
+         * @param pIdx Returns the index of the invalid command, 0xFF if the
+         *        error applies to the whole batch. May be nullptr.
+         * @return The error, nullptr if the batch is valid.
+         */
+        const char *getError(uint8_t *pIdx = nullptr) const;
+
+    private:
+
+        /**
+         * @brief States of the JSON parser.
+         */
+        typedef enum {
+            STATE_START,
+            STATE_ITEM,
+            STATE_KEY,
+            STATE_STRING,
+            STATE_COLON,
+            STATE_VALUE,
+            STATE_LITERAL,
+            STATE_AFTER_VALUE,
+            STATE_AFTER_ITEM,
+            STATE_DONE,
+            STATE_ERROR
+        } State_t;
+
+        /**
+         * @brief What a completed string token is.
+         */
+        typedef enum {
+            TOKEN_KEY,
+            TOKEN_VALUE,
+            TOKEN_ITEM
+        } Token_t;
+
+        /**
+         * @brief Parse a single character of a JSON batch.
+         * @param c The character.
+         */
+        void parseJson(char c);
+
+        /**
+         * @brief Parse a complete binary record.
+         */
+        void parseRecord(void);
+
+        /**
+         * @brief Start a new command.
+         * @return true if there is space left for it.
+         */
+        bool beginItem(void);
+
+        /**
+         * @brief Store a JSON field of the current command.
+         * @param isString true if the value has been quoted.
+         */
+        void setField(bool isString);
+
+        /**
+         * @brief Validate the current JSON object and complete the command.
+         */
+        void endItem(void);
+
+        /**
+         * @brief Record an error of the current command, only the first one 
+         * is kept.
+         * @param error The error.
+         */
+        void setItemError(const char *error);
+
+        /**
+         * @brief Record a syntax error, parsing stops.
+         * @param error The error.
+         */
+        void setError(const char *error);
+
+        /**
+         * @brief The format of the batch.
+         */
+        Format_t format;
+
+        /**
+         * @brief The state of the JSON parser.
+         */
+        State_t state;
+
+        /**
+         * @brief The kind of the string token being parsed.
+         */
+        Token_t tokenType;
+
+        /**
+         * @brief true if the last character was a backslash in a string.
+         */
+        bool escape;
+
+        /**
+         * @brief The token being parsed.
+         */
+        char token[TXBATCH_TOKEN_SIZE];
+
+        /**
+         * @brief The length of the token.
+         */
+        uint8_t tokenLen;
+
+        /**
+         * @brief The key of the field being parsed.
+         */
+        char key[8];
+
+        /**
+         * @brief The code of the current JSON object, it is parsed once the
+         * type is known.
+         */
+        char code[TXBATCH_TOKEN_SIZE];
+
+        /**
+         * @brief true if the type of the current JSON object is db, the code
+         * is the name of a code database command.
+         */
+        bool db;
+
+        /**
+         * @brief The binary record being received.
+         */
+        uint8_t record[TXBATCH_RECORD_SIZE];
+
+        /**
+         * @brief The number of bytes of the record received so far.
+         */
+        uint8_t recordLen;
+
+        /**
+         * @brief The parsed commands.
+         */
+        TxJob_t jobs[TXBATCH_MAX_ITEMS];
+
+        /**
+         * @brief The error per command, nullptr if valid.
+         */
+        const char *errors[TXBATCH_MAX_ITEMS];
+
+        /**
+         * @brief The number of commands.
+         */
+        uint8_t count;
+
+        /**
+         * @brief The syntax error of the batch, nullptr if none.
+         */
+        const char *error;
+
+        /**
+         * @brief The number of bytes parsed, used to locate syntax errors.
+         */
+        size_t offset;
+};
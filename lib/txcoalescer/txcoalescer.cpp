@@ -0,0 +1,115 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "txcoalescer.hpp"
+
+TxCoalescer::TxCoalescer() :
+    coalesced(0)
+{
+    memset(entries, 0, sizeof(entries));
+}
+
+bool TxCoalescer::check(decode_type_t type, uint64_t code, uint8_t channel, Result_t &result) {
+    Entry_t *entry = find(type, code, channel, millis());
+
+    result.count = 0;
+    result.ticket = 0;
+
+    if (entry == nullptr) {
+        return false;
+    }
+
+    entry->result.count++;
+    result = entry->result;
+    coalesced++;
+
+    return true;
+}
+
+void TxCoalescer::add(decode_type_t type, uint64_t code, uint8_t channel, uint16_t ticket, 
+        uint16_t window) {
+    uint32_t now = millis();
+    uint8_t idx = hash(type, code, channel);
+    Entry_t *victim = nullptr;
+
+    if (window == 0 || find(type, code, channel, now) != nullptr) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < TXCOALESCE_PROBES; i++) {
+        Entry_t *entry = &entries[(idx + i) & (TXCOALESCE_SIZE - 1)];
+        bool expired = entry->window == 0 || (now - entry->time) >= entry->window;
+
+        /* Reuse expired entries first, the oldest one otherwise */
+        if (expired) {
+            entry->window = 0;
+            if (victim == nullptr || victim->window != 0) {
+                victim = entry;
+            }
+        } else if (victim == nullptr || (victim->window != 0 && 
+                (now - entry->time) > (now - victim->time))) {
+            victim = entry;
+        }
+    }
+
+    victim->type = type;
+    victim->code = code;
+    victim->channel = channel;
+    victim->time = now;
+    victim->window = window;
+    victim->result.count = 0;
+    victim->result.ticket = ticket;
+}
+
+void TxCoalescer::remove(decode_type_t type, uint64_t code, uint8_t channel) {
+    Entry_t *entry = find(type, code, channel, millis());
+
+    if (entry != nullptr) {
+        entry->window = 0;
+    }
+}
+
+uint32_t TxCoalescer::getCoalescedCount(void) const {
+    return coalesced;
+}
+
+uint8_t TxCoalescer::hash(decode_type_t type, uint64_t code, uint8_t channel) {
+    uint32_t h = ((uint32_t) code ^ (uint32_t) (code >> 32) ^ ((uint32_t) type << 24) ^ 
+            ((uint32_t) channel << 16)) * 0x9E3779B1;
+
+    return (h >> 24) & (TXCOALESCE_SIZE - 1);
+}
+
+TxCoalescer::Entry_t* TxCoalescer::find(decode_type_t type, uint64_t code, uint8_t channel, 
+        uint32_t now) {
+    uint8_t idx = hash(type, code, channel);
+
+    for (uint8_t i = 0; i < TXCOALESCE_PROBES; i++) {
+        Entry_t *entry = &entries[(idx + i) & (TXCOALESCE_SIZE - 1)];
+        bool expired = entry->window == 0 || (now - entry->time) >= entry->window;
+
+        if (!expired && entry->type == type && entry->code == code && entry->channel == channel) {
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,142 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRremoteESP8266.h>
+
+/**
+ * @brief The number of entries of the coalescing table, must be a power of two.
+ */
+#define TXCOALESCE_SIZE             16
+
+/**
+ * @brief The number of entries checked for a single lookup.
+ */
+#define TXCOALESCE_PROBES           4
+
+/**
+ * @brief Detects duplicate transmit requests.
+ * Recently transmitted (protocol, code, channel) triples are kept in a small
+ * fixed size hash table. Identical requests to the same channel received 
+ * within the coalescing window of the first one are merged into its 
+ * transmission, the same code sent to another channel is not. Commands are
+ * only added once queued and removed again if they have not been sent. The
+ * ticket of the queued command is kept, so merged repeats can be added to it
+ * while it is pending, see TxScheduler::addRepeat().
+ */
+class TxCoalescer {
+    public:
+
+        /**
+         * @brief Result of a coalescing check.
+         */
+        typedef struct {
+            uint16_t count;
+            uint16_t ticket;
+        } Result_t;
+
+        /**
+         * @brief Constructor
+         */
+        TxCoalescer();
+
+        /**
+         * @brief Check if a request is a duplicate of a recent transmission.
+         * @param type The IR protocol.
+         * @param code The IR code.
+         * @param channel The transmit channel the request is routed to.
+         * @param result Number of merged requests of the window and the 
+         *        ticket of the command which opened it.
+         * @return true if the request has been merged and must not be sent.
+         */
+        bool check(decode_type_t type, uint64_t code, uint8_t channel, Result_t &result);
+
+        /**
+         * @brief Record a queued command as the start of a new window.
+         * Nothing is recorded if the window of the command is still open.
+         * @param type The IR protocol.
+         * @param code The IR code.
+         * @param channel The transmit channel of the command.
+         * @param ticket The ticket of the queued command.
+         * @param window The coalescing window in milliseconds, 0 disables it.
+         */
+        void add(decode_type_t type, uint64_t code, uint8_t channel, uint16_t ticket, 
+                uint16_t window);
+
+        /**
+         * @brief Close the window of a command which has not been sent.
+         * @param type The IR protocol.
+         * @param code The IR code.
+         * @param channel The transmit channel of the command.
+         */
+        void remove(decode_type_t type, uint64_t code, uint8_t channel);
+
+        /**
+         * @brief Get the total number of merged requests.
+         * @return The number of requests which have not been transmitted.
+         */
+        uint32_t getCoalescedCount(void) const;
+
+    private:
+
+        /**
+         * @brief A recently transmitted command.
+         */
+        typedef struct {
+            int16_t type;
+            uint8_t channel;
+            uint16_t window;
+            uint64_t code;
+            uint32_t time;
+            Result_t result;
+        } Entry_t;
+
+        /**
+         * @brief Calculate the hash table index of a command.
+         * @param type The IR protocol.
+         * @param code The IR code.
+         * @param channel The transmit channel.
+         * @return The index of the first entry to probe.
+         */
+        static uint8_t hash(decode_type_t type, uint64_t code, uint8_t channel);
+
+        /**
+         * @brief Find the open window of a command.
+         * @param type The IR protocol.
+         * @param code The IR code.
+         * @param channel The transmit channel.
+         * @param now The current time in milliseconds.
+         * @return The entry, nullptr if there is none.
+         */
+        Entry_t* find(decode_type_t type, uint64_t code, uint8_t channel, uint32_t now);
+
+        /**
+         * @brief The hash table.
+         */
+        Entry_t entries[TXCOALESCE_SIZE];
+
+        /**
+         * @brief Total number of merged requests.
+         */
+        uint32_t coalesced;
+};
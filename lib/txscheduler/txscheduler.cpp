@@ -0,0 +1,600 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "txscheduler.hpp"
+#include "ircontrol.hpp"
+#include "devices.hpp"
+#include "irlearner.hpp"
+#include "irdb.hpp"
+#include "relay.hpp"
+#include "txtrace.hpp"
+
+extern IRControl irControl;
+extern DeviceTable deviceTable;
+extern IRLearner irLearner;
+extern IRDb irDb;
+extern RelayEngine relayEngine;
+extern TxTrace txTrace;
+
+TxScheduler::TxScheduler() :
+      skipped(0)
+    , lastTicket(0)
+{
+    memset(channels, 0, sizeof(channels));
+    memset(slots, 0, sizeof(slots));
+    memset(tickets, 0, sizeof(tickets));
+}
+
+bool TxScheduler::enqueue(const TxJob_t *jobs, uint8_t num, uint16_t *ticket) {
+    TxTrace::Stamp_t start = TxTrace::now();
+    uint8_t needed[IRTX_CHANNELS] = {0};
+    Ticket_t *entry = nullptr;
+    TxJob_t job;
+
+    for (uint8_t i = 0; i < num; i++) {
+        job = jobs[i];
+        job.device = deviceTable.find(job.type, job.code);
+        needed[route(job)]++;
+    }
+
+    for (uint8_t i = 0; i < IRTX_CHANNELS; i++) {
+        if (needed[i] > TXSCHED_QUEUE_SIZE - channels[i].count) {
+            return false;
+        }
+    }
+
+    if (ticket != nullptr) {
+        entry = findTicket(0);
+        if (entry == nullptr) {
+            return false;
+        }
+
+        /* 0 marks free entries */
+        if (++lastTicket == 0) {
+            lastTicket++;
+        }
+        memset(entry, 0, sizeof(Ticket_t));
+        entry->id = lastTicket;
+        entry->result.pending = num;
+        *ticket = lastTicket;
+    }
+
+    for (uint8_t i = 0; i < num; i++) {
+        Channel_t *ch = nullptr;
+
+        job = jobs[i];
+        job.device = deviceTable.find(job.type, job.code);
+        job.channel = route(job);
+        job.trace = txTrace.getId();
+        job.queued = start.usec;
+        job.ticket = entry != nullptr ? entry->id : 0;
+
+        ch = &channels[job.channel];
+        ch->queue[ch->count++] = job;
+        ch->stats.peak = max(ch->stats.peak, ch->count);
+    }
+    txTrace.add(TRACE_ENQUEUE, txTrace.getId(), 0, start);
+
+    return true;
+}
+
+void TxScheduler::loop(void) {
+    for (uint8_t i = 0; i < IRTX_CHANNELS; i++) {
+        loopChannel(i);
+    }
+}
+
+bool TxScheduler::isIdle(void) const {
+    for (uint8_t i = 0; i < IRTX_CHANNELS; i++) {
+        if (!isIdle(i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TxScheduler::isIdle(uint8_t channel) const {
+    return channels[channel].count == 0 && !channels[channel].active;
+}
+
+const TxScheduler::Result_t* TxScheduler::getResult(uint16_t ticket) const {
+    for (uint8_t i = 0; i < TXSCHED_MAX_TICKETS; i++) {
+        if (ticket != 0 && tickets[i].id == ticket) {
+            return &tickets[i].result;
+        }
+    }
+
+    return nullptr;
+}
+
+bool TxScheduler::addRepeat(uint16_t ticket, uint16_t repeat, uint16_t &total) {
+    for (uint8_t i = 0; i < IRTX_CHANNELS && ticket != 0; i++) {
+        Channel_t *ch = &channels[i];
+
+        for (uint8_t j = 0; j < ch->count; j++) {
+            if (ch->queue[j].ticket == ticket) {
+                ch->queue[j].repeat = min(ch->queue[j].repeat + repeat, 15);
+                total = ch->queue[j].repeat;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void TxScheduler::release(uint16_t ticket) {
+    Ticket_t *entry = ticket != 0 ? findTicket(ticket) : nullptr;
+
+    if (entry != nullptr) {
+        entry->id = 0;
+    }
+}
+
+TxScheduler::Ticket_t* TxScheduler::findTicket(uint16_t id) {
+    for (uint8_t i = 0; i < TXSCHED_MAX_TICKETS; i++) {
+        if (tickets[i].id == id) {
+            return &tickets[i];
+        }
+    }
+
+    return nullptr;
+}
+
+uint32_t TxScheduler::getAirtime(void) const {
+    uint32_t airtime = 0;
+
+    for (uint8_t i = 0; i < IRTX_CHANNELS; i++) {
+        airtime += channels[i].stats.airtime;
+    }
+
+    return airtime;
+}
+
+uint32_t TxScheduler::getSkipCount(void) const {
+    return skipped;
+}
+
+TxScheduler::Stats_t TxScheduler::getStats(uint8_t channel) const {
+    Stats_t stats = channels[channel].stats;
+
+    stats.pending = channels[channel].count;
+    return stats;
+}
+
+String TxScheduler::getStatsString(void) const {
+    const uint8_t pins[IRTX_CHANNELS] = IRTX_PINS;
+    String data;
+
+    for (uint8_t i = 0; i < IRTX_CHANNELS; i++) {
+        Stats_t stats = getStats(i);
+        char line[96];
+
+        snprintf(line, sizeof(line), "ch%u; pin %u; sent %u; airtime %ums; pending %u; peak %u\n",
+                i, pins[i], stats.sent, stats.airtime, stats.pending, stats.peak);
+        data += line;
+    }
+
+    return data;
+}
+
+uint8_t TxScheduler::route(const TxJob_t &job) const {
+    const CatalogEntry_t *entry = nullptr;
+    const Device_t *dev = nullptr;
+
+    if (job.channel >= 0 && job.channel < IRTX_CHANNELS) {
+        return job.channel;
+    }
+
+    entry = deviceTable.findCatalog(job.type, job.code);
+    if (entry != nullptr && entry->channel >= 0 && entry->channel < IRTX_CHANNELS) {
+        return entry->channel;
+    }
+
+    dev = deviceTable.get(job.device);
+    if (dev != nullptr && dev->channel < IRTX_CHANNELS) {
+        return dev->channel;
+    }
+
+    return 0;
+}
+
+void TxScheduler::loopChannel(uint8_t idx) {
+    Channel_t *ch = &channels[idx];
+    uint32_t now = millis();
+    uint16_t seen = 0;
+    int16_t next = -1;
+    uint32_t wait = 0;
+    Ticket_t *ticket = nullptr;
+
+    /* The transmission may still be ongoing in the background */
+    if (ch->active) {
+        if (irControl.isBusy(idx)) {
+            return;
+        }
+
+        now = millis();
+        slots[ch->activeSlot].lastEnd = now;
+        ch->stats.airtime += now - ch->activeStart;
+        ch->active = false;
+        txTrace.add(TRACE_AIRTIME, ch->activeTrace, idx + 1, ch->activeStamp);
+
+        ticket = ch->activeTicket != 0 ? findTicket(ch->activeTicket) : nullptr;
+        if (ticket != nullptr) {
+            ticket->result.airtime += now - ch->activeStart;
+            ticket->result.pending--;
+        }
+    }
+
+    /* State based codes are sent directly, the channel may still be busy */
+    if (ch->count == 0 || irControl.isBusy(idx)) {
+        return;
+    }
+
+    /* Only the first queued command of each device is a candidate */
+    for (uint8_t i = 0; i < ch->count; i++) {
+        uint8_t slot = getSlot(ch->queue[i]);
+        uint32_t delta = 0;
+
+        if (seen & (1 << slot)) {
+            continue;
+        }
+        seen |= 1 << slot;
+
+        delta = readyIn(ch->queue[i], now);
+        if (next == -1 || delta < wait) {
+            next = i;
+            wait = delta;
+        }
+    }
+
+    if (wait > 0) {
+        return;
+    }
+
+    TxJob_t job = ch->queue[next];
+    ch->count--;
+    memmove(&ch->queue[next], &ch->queue[next + 1], (ch->count - next) * sizeof(TxJob_t));
+
+    ticket = job.ticket != 0 ? findTicket(job.ticket) : nullptr;
+    if (!job.force && deviceTable.skip(job.type, job.code)) {
+        skipped++;
+        if (ticket != nullptr) {
+            ticket->result.skipped++;
+            ticket->result.pending--;
+        }
+        return;
+    }
+
+    txTrace.addSince(TRACE_QUEUE, job.trace, idx + 1, job.queued);
+    ch->activeSlot = getSlot(job);
+    ch->activeStart = millis();
+    ch->active = true;
+    ch->stats.sent++;
+    if (job.origin != 0) {
+        relayEngine.addLatency(micros() - job.origin);
+    }
+
+    /* The transmission is traced as part of the request which queued it */
+    uint16_t traceId = txTrace.getId();
+    txTrace.setId(job.trace);
+    irControl.transmit(job.type, job.code, job.repeat, idx, job.bits);
+    txTrace.setId(traceId);
+    ch->activeTrace = job.trace;
+    ch->activeTicket = job.ticket;
+    if (ticket != nullptr) {
+        snprintf(ticket->result.lastTx, sizeof(ticket->result.lastTx), "%s", 
+                irControl.getLastTx().c_str());
+        ticket->result.sent++;
+    }
+    ch->activeStamp = TxTrace::now();
+
+    Slot_t *slot = &slots[ch->activeSlot];
+    slot->lastType = job.type;
+    slot->lastCode = job.code;
+    if (job.pause != TXSCHED_PAUSE_DEFAULT) {
+        slot->lastPause = job.pause;
+    } else {
+        slot->lastPause = job.device < 0 ? TXSCHED_PAUSE_LEGACY : 0;
+    }
+}
+
+uint8_t TxScheduler::getSlot(const TxJob_t &job) const {
+    return job.device < 0 ? PARAM_MAX_DEVICES + job.channel : job.device;
+}
+
+uint32_t TxScheduler::readyIn(const TxJob_t &job, uint32_t now) const {
+    const Slot_t *slot = &slots[getSlot(job)];
+    const Device_t *dev = deviceTable.get(job.device);
+    uint32_t wait = slot->lastPause;
+    uint32_t elapsed = now - slot->lastEnd;
+
+    if (dev != nullptr) {
+        /* Repeating the same command only needs the gap, any other command 
+         * has to wait until the device has settled. */
+        if (job.type == slot->lastType && job.code == slot->lastCode) {
+            wait = max(wait, (uint32_t) dev->gap);
+        } else {
+            wait = max(wait, (uint32_t) dev->settle);
+        }
+    }
+
+    return elapsed >= wait ? 0 : wait - elapsed;
+}
+
+/**
+ * @brief Get a command of a sequence for error messages.
+ * @param str The start of the command.
+ * @return The command up to the next ',' or the end of the string.
+ */
+static String commandToString(const char *str) {
+    String command;
+
+    for (; *str != 0 && *str != ','; str++) {
+        command += *str;
+    }
+
+    return command;
+}
+
+/**
+ * @brief Resolve a code database command of a sequence.
+ * @param str The name as device/function, it ends at ':', ',', '@' or the 
+ *        end of the string.
+ * @param type Reference to store the protocol.
+ * @param code Reference to store the code.
+ * @param bits Reference to store the number of bits.
+ * @return Pointer to the first character after the name, nullptr if the 
+ *         command is not found.
+ */
+static const char* parseDbCode(const char *str, decode_type_t &type, uint64_t &code, 
+        uint16_t &bits) {
+    char name[IRDB_MAX_NAME];
+    uint8_t len = 0;
+
+    while (str[len] != 0 && str[len] != ':' && str[len] != ',' && str[len] != '@') {
+        if (len == sizeof(name) - 1) {
+            return nullptr;
+        }
+        name[len] = str[len];
+        len++;
+    }
+    name[len] = 0;
+
+    if (!irDb.resolve(name, type, code, bits)) {
+        return nullptr;
+    }
+
+    return str + len;
+}
+
+void TxScheduler::initJob(TxJob_t &job, decode_type_t type, uint64_t code) {
+    job.type = type;
+    job.code = code;
+    job.bits = 0;
+    job.repeat = 0;
+    job.pause = TXSCHED_PAUSE_DEFAULT;
+    job.device = -1;
+    job.force = false;
+    job.channel = -1;
+    job.origin = 0;
+    job.trace = 0;
+    job.queued = 0;
+    job.ticket = 0;
+}
+
+const char* TxScheduler::parseJob(const char *str, TxJob_t& job, String& errorMessage) {
+    const char *pos = str;
+    char *end = nullptr;
+    decode_type_t type = decode_type_t::UNKNOWN;
+    uint16_t bits = 0;
+    uint64_t code = 0;
+    uint32_t repeat = 0;
+    uint32_t pause = TXSCHED_PAUSE_DEFAULT;
+    int32_t channel = -1;
+
+    while (*pos == ' ') {
+        pos++;
+    }
+
+    if (strncasecmp(pos, "db:", 3) == 0) {
+        pos = parseDbCode(pos + 3, type, code, bits);
+        if (pos == nullptr || *pos != ':') {
+            errorMessage = "ERROR: Unknown database code: " + commandToString(str) + "\n";
+            return nullptr;
+        }
+    } else {
+        pos = irControl.parseType(pos, type, bits);
+        if (pos == nullptr || *pos != ':') {
+            errorMessage = "ERROR: Unknown type: " + commandToString(str) + "\n";
+            return nullptr;
+        }
+
+        if (hasACState(type)) {
+            errorMessage = "ERROR: State based protocols can't be queued: " + commandToString(str) + "\n";
+            return nullptr;
+        }
+
+        pos = parseCode(type, pos + 1, code);
+        if (pos == nullptr || *pos != ':') {
+            errorMessage = "ERROR: Invalid code: " + commandToString(str) + "\n";
+            return nullptr;
+        }
+    }
+
+    repeat = strtoul(++pos, &end, 10);
+    if (end == pos) {
+        errorMessage = "ERROR: Invalid repeat: " + commandToString(str) + "\n";
+        return nullptr;
+    }
+    repeat = constrain(repeat, 0, 15);
+    pos = end;
+
+    if (*pos == ':') {
+        pause = strtoul(++pos, &end, 10);
+        if (end == pos) {
+            errorMessage = "ERROR: Invalid pause: " + commandToString(str) + "\n";
+            return nullptr;
+        }
+        pause = constrain(pause, 0, 5000);
+        pos = end;
+    }
+
+    if (*pos == '@') {
+        channel = strtol(++pos, &end, 10);
+        if (end == pos || channel < 0 || channel >= IRTX_CHANNELS) {
+            errorMessage = "ERROR: Invalid channel: " + commandToString(str) + "\n";
+            return nullptr;
+        }
+        pos = end;
+    }
+
+    while (*pos == ' ') {
+        pos++;
+    }
+
+    if (*pos != ',' && *pos != 0) {
+        errorMessage = "ERROR: Invalid command format: " + commandToString(str) + "\n";
+        errorMessage += "Expected: type[/bits]:code:repeat[:pause][@channel]\n";
+        return nullptr;
+    }
+
+    initJob(job, type, code);
+    job.bits = bits;
+    job.repeat = repeat;
+    job.pause = pause;
+    job.channel = channel;
+
+    return pos;
+}
+
+const char* TxScheduler::parseCode(decode_type_t type, const char *str, uint64_t& code) {
+    char name[sizeof(LearnedCode_t::name)];
+    uint8_t len = 0;
+    int8_t idx = -1;
+
+    if (type != decode_type_t::RAW) {
+        return ::parseCode(str, code);
+    }
+
+    /* Learned codes are addressed by name */
+    while (str[len] != 0 && str[len] != ':' && str[len] != ',' && str[len] != '@') {
+        if (len == sizeof(name) - 1) {
+            return nullptr;
+        }
+        name[len] = str[len];
+        len++;
+    }
+    name[len] = 0;
+
+    idx = irLearner.find(name);
+    if (idx < 0) {
+        return nullptr;
+    }
+    code = idx;
+
+    return str + len;
+}
+
+int8_t TxScheduler::parseSteps(const char *str, TxStep_t *steps, uint8_t max, String& errorMessage) {
+    const char *pos = str;
+    uint8_t count = 0;
+
+    while (*pos) {
+        TxJob_t job;
+
+        if (*pos == ',' || *pos == ' ') {
+            pos++;
+            continue;
+        }
+        if (count == max) {
+            errorMessage = "ERROR: Too many commands.\n";
+            return -1;
+        }
+
+        pos = parseJob(pos, job, errorMessage);
+        if (pos == nullptr) {
+            return -1;
+        }
+
+        steps[count].protocol = job.type;
+        steps[count].code = job.code;
+        steps[count].bits = job.bits;
+        steps[count].repeat = job.repeat;
+        steps[count].pause = job.pause;
+        steps[count].channel = job.channel;
+        count++;
+    }
+
+    if (count == 0) {
+        errorMessage = "ERROR: No command given.\n";
+        return -1;
+    }
+
+    return count;
+}
+
+void TxScheduler::toJobs(const TxStep_t *steps, uint8_t count, TxJob_t *jobs) {
+    for (uint8_t i = 0; i < count; i++) {
+        initJob(jobs[i], (decode_type_t) steps[i].protocol, steps[i].code);
+        jobs[i].bits = steps[i].bits;
+        jobs[i].repeat = steps[i].repeat;
+        jobs[i].pause = steps[i].pause;
+        jobs[i].channel = steps[i].channel;
+    }
+}
+
+String TxScheduler::stepsToString(const TxStep_t *steps, uint8_t count) {
+    String data;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const TxStep_t *step = &steps[i];
+        const IRDbEntry_t *command = step->protocol == decode_type_t::RAW ? 
+                irDb.findRef(step->code) : nullptr;
+
+        if (i != 0) {
+            data += ",";
+        }
+        if (command != nullptr) {
+            data += "db:" + irDb.getName(command);
+        } else {
+            data += typeToString((decode_type_t) step->protocol);
+            if (step->bits) {
+                data += "/" + String(step->bits);
+            }
+            if (step->protocol == decode_type_t::RAW && step->code < PARAM_MAX_LEARNED) {
+                data += ":" + String(Parameter.learned()[step->code].name);
+            } else {
+                data += ":" + codeToString(step->code);
+            }
+        }
+        data += ":" + String(step->repeat);
+        if (step->pause != TXSCHED_PAUSE_DEFAULT) {
+            data += ":" + String(step->pause);
+        }
+        if (step->channel >= 0) {
+            data += "@" + String(step->channel);
+        }
+    }
+
+    return data;
+}
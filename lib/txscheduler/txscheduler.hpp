@@ -0,0 +1,355 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRremoteESP8266.h>
+
+#include "common.hpp"
+#include "parameter.hpp"
+#include "txtrace.hpp"
+
+/**
+ * @brief The maximum number of commands which can be queued per channel.
+ */
+#define TXSCHED_QUEUE_SIZE          32
+
+/**
+ * @brief Pause value used if no pause has been specified for a command.
+ */
+#define TXSCHED_PAUSE_DEFAULT       0xFFFF
+
+/**
+ * @brief The pause applied after a command to an unconfigured device if no
+ * pause has been specified, matches the former fixed sequence pause.
+ */
+#define TXSCHED_PAUSE_LEGACY        100
+
+/**
+ * @brief The maximum number of requests whose outcome is tracked at the same
+ * time, see TxScheduler::getResult().
+ */
+#define TXSCHED_MAX_TICKETS         8
+
+/**
+ * @brief A single IR command as processed by the scheduler.
+ * bits is 0 for the default of the protocol. channel is -1 to route the 
+ * command by its catalog entry or device. origin is the micros() timestamp of
+ * the reception which triggered the command, 0 if it has not been triggered 
+ * by a relay rule. trace is the id of the request which queued the command,
+ * queued the micros() timestamp it has been queued and ticket the ticket of 
+ * the request, 0 if not tracked. These are set by TxScheduler::enqueue().
+ */
+typedef struct {
+    decode_type_t type;
+    uint64_t code;
+    uint16_t bits;
+    uint16_t repeat;
+    uint16_t pause;
+    int8_t device;
+    bool force;
+    int8_t channel;
+    uint32_t origin;
+    uint16_t trace;
+    uint32_t queued;
+    uint16_t ticket;
+} TxJob_t;
+
+/**
+ * @brief Transmit scheduler.
+ * Each transmit channel has its own queue. Queued commands are transmitted as
+ * soon as the device they are addressed to is ready. Waits are only enforced 
+ * between commands to the same device, hence commands to other devices are 
+ * packed into these idle gaps. The order of the commands per device is kept. 
+ * Commands which would not change the tracked device state are skipped 
+ * unless forced.
+ */
+class TxScheduler {
+    public:
+
+        /**
+         * @brief Statistics of a transmit channel.
+         */
+        typedef struct {
+            uint32_t sent;
+            uint32_t airtime;
+            uint8_t pending;
+            uint8_t peak;
+        } Stats_t;
+
+        /**
+         * @brief Outcome of the commands of a request.
+         * lastTx is the log entry of the last command sent.
+         */
+        typedef struct {
+            uint8_t pending;
+            uint8_t sent;
+            uint8_t skipped;
+            uint32_t airtime;
+            char lastTx[IRSTATS_ENTRY_SIZE];
+        } Result_t;
+
+        /**
+         * @brief Constructor
+         */
+        TxScheduler();
+
+        /**
+         * @brief Queue a list of commands.
+         * Either all or none of the commands are queued.
+         * @param jobs The commands to queue.
+         * @param count The number of commands.
+         * @param ticket Returns the ticket to track the outcome of the 
+         *        commands, nullptr if not needed. It has to be released.
+         * @return true on success, false if there is not enough space left
+         *         or no ticket is available.
+         */
+        bool enqueue(const TxJob_t *jobs, uint8_t count, uint16_t *ticket = nullptr);
+
+        /**
+         * @brief Get the outcome of the commands of a request.
+         * @param ticket The ticket returned by enqueue().
+         * @return The outcome, the commands are done once pending is 0. 
+         *         nullptr if the ticket is not known.
+         */
+        const Result_t* getResult(uint16_t ticket) const;
+
+        /**
+         * @brief Add repeats to the command of a request which is still
+         * queued, e.g. for the repeats of merged duplicate requests.
+         * @param ticket The ticket returned by enqueue().
+         * @param repeat The number of repeats to add, the total is limited
+         *        to 15.
+         * @param total Returns the number of repeats the command is sent with.
+         * @return true if added, false if the command is not queued anymore.
+         */
+        bool addRepeat(uint16_t ticket, uint16_t repeat, uint16_t &total);
+
+        /**
+         * @brief Release a ticket, pending commands are still sent.
+         * @param ticket The ticket returned by enqueue().
+         */
+        void release(uint16_t ticket);
+
+        /**
+         * @brief Transmits the next command of each channel if its device is 
+         * ready. Has to be called cyclically.
+         */
+        void loop(void);
+
+        /**
+         * @brief Check if all queued commands have been transmitted.
+         * @return true if the queues of all channels are empty.
+         */
+        bool isIdle(void) const;
+
+        /**
+         * @brief Check if all commands queued for a channel have been 
+         * transmitted.
+         * @param channel The transmit channel.
+         * @return true if the queue of the channel is empty.
+         */
+        bool isIdle(uint8_t channel) const;
+
+        /**
+         * @brief Select the channel of a command, as done when it is queued.
+         * @param job The command, the device has to be resolved already.
+         * @return The channel index.
+         */
+        uint8_t route(const TxJob_t &job) const;
+
+        /**
+         * @brief Get the accumulated IR airtime of all channels.
+         * @return The time spent transmitting in milliseconds.
+         */
+        uint32_t getAirtime(void) const;
+
+        /**
+         * @brief Get the number of skipped commands.
+         * @return The number of commands which have not been sent because 
+         *         the device already was in the target state.
+         */
+        uint32_t getSkipCount(void) const;
+
+        /**
+         * @brief Get the statistics of a channel.
+         * @param channel The transmit channel.
+         * @return The statistics.
+         */
+        Stats_t getStats(uint8_t channel) const;
+
+        /**
+         * @brief Get the statistics of all channels as text.
+         * @return One line per channel.
+         */
+        String getStatsString(void) const;
+
+        /**
+         * @brief Initialize a command with the defaults of all fields, the
+         * protocol default bits, no repeat, the default pause and routed by
+         * device. Fields are assigned by name, never rely on their order.
+         * @param job The command to initialize.
+         * @param type The IR protocol.
+         * @param code The IR code.
+         */
+        static void initJob(TxJob_t &job, decode_type_t type, uint64_t code);
+
+        /**
+         * @brief Parse a command in the format 
+         * type[/bits]:code:repeat[:pause][@channel] in a single pass. Code 
+         * database commands are given as db:device/function instead of 
+         * type and code.
+         * @param str The command to parse, it ends at ',' or the end of the 
+         *        string.
+         * @param job Reference to store the parsed command.
+         * @param errorMessage Reference to store error messages.
+         * @return Pointer to the end of the command, nullptr on error.
+         */
+        static const char* parseJob(const char *str, TxJob_t& job, String& errorMessage);
+
+        /**
+         * @brief Parse a code argument.
+         * @param type The protocol of the code, RAW expects a learned code name.
+         * @param str The code to parse.
+         * @param code Reference to store the code or learned code index.
+         * @return Pointer to the first character after the code, nullptr on 
+         *         error.
+         */
+        static const char* parseCode(decode_type_t type, const char *str, uint64_t& code);
+
+        /**
+         * @brief Parse a comma separated list of commands into stored 
+         * commands, see parseJob() for the format.
+         * @param str The commands to parse.
+         * @param steps Array to store the commands.
+         * @param max The size of the array.
+         * @param errorMessage Reference to store error messages.
+         * @return The number of commands, -1 on error.
+         */
+        static int8_t parseSteps(const char *str, TxStep_t *steps, uint8_t max, String& errorMessage);
+
+        /**
+         * @brief Convert stored commands into scheduler commands.
+         * @param steps The stored commands.
+         * @param count The number of commands.
+         * @param jobs Array to store the scheduler commands.
+         */
+        static void toJobs(const TxStep_t *steps, uint8_t count, TxJob_t *jobs);
+
+        /**
+         * @brief Format stored commands as accepted by parseSteps().
+         * @param steps The stored commands.
+         * @param count The number of commands.
+         * @return The comma separated commands.
+         */
+        static String stepsToString(const TxStep_t *steps, uint8_t count);
+
+    private:
+
+        /**
+         * @brief Transmit state of a device.
+         */
+        typedef struct {
+            decode_type_t lastType;
+            uint64_t lastCode;
+            uint32_t lastEnd;
+            uint16_t lastPause;
+        } Slot_t;
+
+        /**
+         * @brief Queue and state of a transmit channel.
+         */
+        typedef struct {
+            TxJob_t queue[TXSCHED_QUEUE_SIZE];
+            uint8_t count;
+            bool active;
+            uint8_t activeSlot;
+            uint32_t activeStart;
+            uint16_t activeTrace;
+            uint16_t activeTicket;
+            TxTrace::Stamp_t activeStamp;
+            Stats_t stats;
+        } Channel_t;
+
+        /**
+         * @brief The outcome of a request.
+         */
+        typedef struct {
+            uint16_t id;
+            Result_t result;
+        } Ticket_t;
+
+        /**
+         * @brief Find the outcome of a request.
+         * @param id The ticket, 0 for none.
+         * @return The ticket, nullptr if not known.
+         */
+        Ticket_t* findTicket(uint16_t id);
+
+        /**
+         * @brief Run the scheduler of a single channel.
+         * @param idx The channel index.
+         */
+        void loopChannel(uint8_t idx);
+
+        /**
+         * @brief Get the slot used for a command.
+         * All commands to unconfigured devices share a single slot per channel.
+         * @param job The command.
+         * @return The slot index.
+         */
+        uint8_t getSlot(const TxJob_t &job) const;
+
+        /**
+         * @brief Calculate the time until a command may be sent.
+         * @param job The command.
+         * @param now The current time in milliseconds.
+         * @return The remaining time in milliseconds, 0 if ready.
+         */
+        uint32_t readyIn(const TxJob_t &job, uint32_t now) const;
+
+        /**
+         * @brief The transmit channels.
+         */
+        Channel_t channels[IRTX_CHANNELS];
+
+        /**
+         * @brief The transmit state per device plus one per channel for 
+         * unknown devices.
+         */
+        Slot_t slots[PARAM_MAX_DEVICES + IRTX_CHANNELS];
+
+        /**
+         * @brief Number of skipped commands.
+         */
+        uint32_t skipped;
+
+        /**
+         * @brief The tracked requests, an id of 0 marks a free entry.
+         */
+        Ticket_t tickets[TXSCHED_MAX_TICKETS];
+
+        /**
+         * @brief The id of the last ticket handed out.
+         */
+        uint16_t lastTicket;
+};
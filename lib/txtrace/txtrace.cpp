@@ -0,0 +1,84 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "txtrace.hpp"
+
+/**
+ * @brief Names of the stages, indexed by TraceStage_t.
+ */
+static const char *stageNames[TRACE_STAGES] = {
+    "server", "handler", "parse", "coalesce", "enqueue", "queue", "transmit", 
+    "send", "log", "airtime", "relay"
+};
+
+TxTrace::TxTrace() :
+    head(0),
+    lastId(0),
+    current(0) {
+    memset(events, 0, sizeof(events));
+}
+
+uint16_t TxTrace::begin(void) {
+    if (++lastId == 0) {
+        lastId = 1;
+    }
+    current = lastId;
+
+    return current;
+}
+
+void TxTrace::add(TraceStage_t stage, uint16_t id, uint8_t lane, const Stamp_t &start) {
+    store(stage, id, lane, start.usec, ESP.getCycleCount() - start.cycles, false);
+}
+
+void TxTrace::addSince(TraceStage_t stage, uint16_t id, uint8_t lane, uint32_t usec) {
+    store(stage, id, lane, usec, micros() - usec, true);
+}
+
+void TxTrace::clear(void) {
+    head = 0;
+}
+
+uint16_t TxTrace::getCount(void) const {
+    return min(head, (uint32_t) TXTRACE_SIZE);
+}
+
+String TxTrace::getEventJson(uint16_t idx) const {
+    const Event_t *event = &events[(head - getCount() + idx) & (TXTRACE_SIZE - 1)];
+    float duration = event->inUsec ? (float) event->duration : 
+            (float) event->duration / ESP.getCpuFreqMHz();
+
+    return "{\"name\":\"" + String(stageNames[event->stage]) + 
+            "\",\"cat\":\"tx\",\"ph\":\"X\",\"pid\":1,\"tid\":" + String(event->lane) + 
+            ",\"ts\":" + String(event->usec) + ",\"dur\":" + String(duration, 3) + 
+            ",\"args\":{\"id\":" + String(event->id) + "}}";
+}
+
+void TxTrace::store(TraceStage_t stage, uint16_t id, uint8_t lane, uint32_t usec, uint32_t duration, bool inUsec) {
+    Event_t *event = &events[head++ & (TXTRACE_SIZE - 1)];
+
+    event->usec = usec;
+    event->duration = duration;
+    event->id = id;
+    event->stage = stage;
+    event->inUsec = inUsec;
+    event->lane = lane;
+}
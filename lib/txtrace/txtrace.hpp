@@ -0,0 +1,190 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief The number of trace events kept, a power of 2.
+ */
+#define TXTRACE_SIZE                256
+
+/**
+ * @brief The stages of the transmit path.
+ */
+typedef enum {
+    TRACE_SERVER = 0,
+    TRACE_HANDLER,
+    TRACE_PARSE,
+    TRACE_COALESCE,
+    TRACE_ENQUEUE,
+    TRACE_QUEUE,
+    TRACE_TRANSMIT,
+    TRACE_SEND,
+    TRACE_LOG,
+    TRACE_AIRTIME,
+    TRACE_RELAY,
+    TRACE_STAGES
+} TraceStage_t;
+
+/**
+ * @brief Always on trace of the transmit path.
+ * Spans of each stage are recorded into a ring buffer, tagged with the id of
+ * the request or relay rule match which caused them. Start times are taken 
+ * from micros(), durations from the CPU cycle counter, which wraps after 
+ * 17.9 s at 240 MHz, or from micros() for long spans. Recording a span only
+ * reads the timers and stores 12 bytes, hence tracing stays enabled. Spans 
+ * have to be recorded from the loop task only.
+ */
+class TxTrace {
+    public:
+
+        /**
+         * @brief The start of a span.
+         */
+        typedef struct {
+            uint32_t usec;
+            uint32_t cycles;
+        } Stamp_t;
+
+        /**
+         * @brief Constructor
+         */
+        TxTrace();
+
+        /**
+         * @brief Take the start of a span.
+         * @return The current time and cycle count.
+         */
+        static inline Stamp_t now(void) {
+            Stamp_t stamp = {(uint32_t) micros(), ESP.getCycleCount()};
+            return stamp;
+        }
+
+        /**
+         * @brief Start tracing a new request.
+         * @return The id of the request, which is also the current id.
+         */
+        uint16_t begin(void);
+
+        /**
+         * @brief Get the id of the request being processed.
+         * @return The id, 0 if none.
+         */
+        uint16_t getId(void) const {
+            return current;
+        }
+
+        /**
+         * @brief Set the id of the request being processed.
+         * @param id The id, 0 if none.
+         */
+        void setId(uint16_t id) {
+            current = id;
+        }
+
+        /**
+         * @brief Record a span which ends now.
+         * @param stage The stage.
+         * @param id The request id.
+         * @param lane 0 for the loop task, 1 + channel for transmit channels.
+         * @param start The start of the span.
+         */
+        void add(TraceStage_t stage, uint16_t id, uint8_t lane, const Stamp_t &start);
+
+        /**
+         * @brief Record a span which ends now and which may be longer than 
+         * the cycle counter wraps, the duration is stored in microseconds.
+         * @param stage The stage.
+         * @param id The request id.
+         * @param lane 0 for the loop task, 1 + channel for transmit channels.
+         * @param usec The micros() timestamp of the start.
+         */
+        void addSince(TraceStage_t stage, uint16_t id, uint8_t lane, uint32_t usec);
+
+        /**
+         * @brief Remove all recorded spans.
+         */
+        void clear(void);
+
+        /**
+         * @brief Get the number of recorded spans.
+         * @return The number of spans, at most TXTRACE_SIZE.
+         */
+        uint16_t getCount(void) const;
+
+        /**
+         * @brief Get a recorded span as Chrome trace event.
+         * @param idx The span, 0 is the oldest one.
+         * @return The span as JSON object.
+         */
+        String getEventJson(uint16_t idx) const;
+
+    private:
+
+        /**
+         * @brief A recorded span, the duration is in CPU cycles or in 
+         * microseconds if inUsec is set.
+         */
+        typedef struct {
+            uint32_t usec;
+            uint32_t duration;
+            uint16_t id;
+            uint8_t stage : 7;
+            uint8_t inUsec : 1;
+            uint8_t lane;
+        } Event_t;
+
+        /**
+         * @brief Store a span, the oldest one is overwritten if the buffer 
+         * is full.
+         * @param stage The stage.
+         * @param id The request id.
+         * @param lane The lane.
+         * @param usec The micros() timestamp of the start.
+         * @param duration The duration.
+         * @param inUsec true if the duration is in microseconds, false for 
+         *        CPU cycles.
+         */
+        void store(TraceStage_t stage, uint16_t id, uint8_t lane, uint32_t usec, uint32_t duration, bool inUsec);
+
+        /**
+         * @brief The ring buffer of spans.
+         */
+        Event_t events[TXTRACE_SIZE];
+
+        /**
+         * @brief The total number of recorded spans, the next one is stored 
+         * at head % TXTRACE_SIZE.
+         */
+        uint32_t head;
+
+        /**
+         * @brief The last assigned request id.
+         */
+        uint16_t lastId;
+
+        /**
+         * @brief The id of the request being processed, 0 if none.
+         */
+        uint16_t current;
+};
@@ -23,10 +23,41 @@
 #include <WiFi.h>
 #include "parameter.hpp"
 #include "ircontrol.hpp"
+#include "txscheduler.hpp"
+#include "txcoalescer.hpp"
+#include "devices.hpp"
+#include "irlearner.hpp"
+#include "relay.hpp"
+#include "timerwheel.hpp"
+#include "accontrol.hpp"
+#include "irdb.hpp"
+#include "txtrace.hpp"
+#include "loopmonitor.hpp"
+#include "bootprofile.hpp"
+#include "heapmonitor.hpp"
+#include "serialproto.hpp"
+#include "webui.hpp"
 #include <generic/uptime.hpp>
 #include <version/version.h>
 
+#if IRGW_WEB
+
 extern IRControl irControl;
+extern TxScheduler txScheduler;
+extern TxCoalescer txCoalescer;
+extern DeviceTable deviceTable;
+extern IRLearner irLearner;
+extern RelayEngine relayEngine;
+extern TimerWheel timerWheel;
+#if IRGW_AC
+extern AcControl acControl;
+#endif
+extern IRDb irDb;
+extern TxTrace txTrace;
+extern LoopMonitor loopMonitor;
+extern BootProfile bootProfile;
+extern HeapMonitor heapMonitor;
+extern SerialProto serialProto;
 extern UpTime upTime;
 
 WebServerControl::WebServerControl(int port) : 
@@ -34,6 +65,19 @@ WebServerControl::WebServerControl(int port) :
     , Port(port)
 {
     Enabled = false;
+    applyPending = false;
+    memset(&uiStats, 0, sizeof(uiStats));
+    memset(&pollStats, 0, sizeof(pollStats));
+    numWaiters = 0;
+    numTxWaiters = 0;
+    bootId = esp_random();
+
+    for (uint8_t i = 0; i < WEB_MAX_WAITERS; i++) {
+        waiters[i].log = nullptr;
+    }
+    for (uint8_t i = 0; i < WEB_MAX_TX_WAITERS; i++) {
+        txWaiters[i].kind = TXWAIT_NONE;
+    }
 }
 
 WebServerControl::~WebServerControl() {
@@ -41,34 +85,110 @@ WebServerControl::~WebServerControl() {
 }
 
 void WebServerControl::begin() {
+    const char *headers[] = {"Content-Type", "Accept", "Accept-Encoding", "If-None-Match"};
+
     if (!Enabled) {
         setupRoutes();
+        Server.collectHeaders(headers, sizeof(headers) / sizeof(headers[0]));
         Server.begin();
         Enabled = true;
-        Serial.printf("WebServer started on port %d\n", Port);
+        if (!serialProto.isActive()) {
+            Serial.printf("WebServer started on port %d\n", Port);
+        }
     }
 }
 
 void WebServerControl::stop() {
     if (Enabled) {
+        for (uint8_t i = 0; i < WEB_MAX_WAITERS; i++) {
+            if (waiters[i].log != nullptr) {
+                waiters[i].client.stop();
+                waiters[i].client = WiFiClient();
+                waiters[i].log = nullptr;
+            }
+        }
+        numWaiters = 0;
+        for (uint8_t i = 0; i < WEB_MAX_TX_WAITERS; i++) {
+            if (txWaiters[i].kind != TXWAIT_NONE) {
+                txWaiters[i].client.stop();
+                txWaiters[i].client = WiFiClient();
+                txScheduler.release(txWaiters[i].ticket);
+                txWaiters[i].kind = TXWAIT_NONE;
+            }
+        }
+        numTxWaiters = 0;
         Server.stop();
         Enabled = false;
-        Serial.println("WebServer stopped");
+        if (!serialProto.isActive()) {
+            Serial.println("WebServer stopped");
+        }
     }
 }
 
 void WebServerControl::handleClient() {
     if (Enabled) {
+        TxTrace::Stamp_t start = TxTrace::now();
+
         Server.handleClient();
+
+        if (numWaiters != 0) {
+            serviceWaiters();
+        }
+        if (numTxWaiters != 0) {
+            serviceTxWaiters();
+        }
+
+        /* Includes receiving and parsing the request if it has been traced */
+        if (txTrace.getId() != 0) {
+            txTrace.add(TRACE_SERVER, txTrace.getId(), 0, start);
+            txTrace.setId(0);
+        }
+
+        /* A reconnect must not cut off the response of the request */
+        if (applyPending) {
+            applyPending = false;
+            Parameter.apply();
+        }
+
+        /* The response has been sent, its temporaries are released */
+        arena.reset();
     }
 }
 
 void WebServerControl::setupRoutes() {
     Server.on("/", [this]() { handleRoot(); });
-    Server.on("/tx", [this]() { handleTx(); });
-    Server.on("/txseq", [this]() { handleTxSequence(); });
+    Server.on("/status", [this]() { handleStatus(); });
+    Server.on("/api/status", [this]() { handleApiStatus(); });
+    Server.on("/api/catalog", [this]() { handleApiCatalog(); });
+    Server.on("/api/log", [this]() { handleApiLog(); });
+
+    /* The UI itself is served by handleRoot() */
+    for (uint8_t i = 0; i < WebUI::getCount(); i++) {
+        const WebAsset_t *asset = WebUI::get(i);
+
+        if (strcmp(asset->path, "/") != 0) {
+            Server.on(asset->path, HTTP_GET, [this, asset]() { sendAsset(asset); });
+        }
+    }
+    Server.on("/tx", [this]() { traceHandler(&WebServerControl::handleTx); });
+    Server.on("/txseq", [this]() { traceHandler(&WebServerControl::handleTxSequence); });
+    Server.on("/tx/batch", HTTP_POST, [this]() { traceHandler(&WebServerControl::handleTxBatch); }, 
+            [this]() { handleTxBatchBody(); });
+    Server.on("/trace", [this]() { handleTrace(); });
+    Server.on("/loop", [this]() { handleLoop(); });
+    Server.on("/config", [this]() { handleConfig(); });
+    Server.on("/heap", [this]() { handleHeap(); });
     Server.on("/txlog", [this]() { handleTxLog(); });
     Server.on("/rxlog", [this]() { handleRxLog(); });
+    Server.on("/state", [this]() { handleState(); });
+    Server.on("/channels", [this]() { handleChannels(); });
+    Server.on("/learn", [this]() { handleLearn(); });
+    Server.on("/relay", [this]() { handleRelay(); });
+    Server.on("/irdb", [this]() { handleIrDb(); });
+#if IRGW_AC
+    Server.on("/ac", [this]() { handleAc(); });
+#endif
+    Server.on("/timers", [this]() { handleTimers(); });
     Server.onNotFound([this]() { handleNotFound(); });
 }
 
@@ -77,58 +197,256 @@ void WebServerControl::handleNotFound() {
 }
 
 void WebServerControl::handleRoot() {
-    String data = getVersionString() + "\n";
-    String hostname(Parameter.data.ip.hostname);
-    
-    data += "Date:          " + getTimeStamp() + "\n";
-    data += "Uptime:        " + upTime.toString() + "\n";
-    data += "WiFi RSSI:     " + String(WiFi.RSSI()) + "dBm\n";
-    data += "\n";
-    data += "Tx Data:\n";
-    data += "  Count:  " + String(irControl.getTxCount()) + "\n";
-    data += "  Last:   " + irControl.getLastTx() + "\n";
-    data += "  Log:    http://" + hostname + ".local/txlog\n";
-    data += "\n";
-    data += "Rx Data:\n";
-    data += "  Count:  " + String(irControl.getRxCount()) + "\n";
-    data += "  Last:   " + irControl.getLastRx() + "\n";
-    data += "  Log:    http://" + hostname + ".local/rxlog\n";
-    data += "\n";
-    data += "Trigger IR transmission via:\n";
-    data += "  http://" + hostname + ".local/tx?type=nec&code=0x1234&repeat=1\n";
-    data += "\n";
+    const WebAsset_t *asset = WebUI::find("/");
 
-    Server.send(200, "text/plain", data);
+    /* Browsers get the UI, scripts the plain text status */
+    if (asset != nullptr && Server.header("Accept").indexOf("text/html") >= 0) {
+        sendAsset(asset);
+        return;
+    }
+
+    handleStatus();
+}
+
+void WebServerControl::sendAsset(const WebAsset_t *asset) {
+    uint32_t start = micros();
+    bool notModified = Server.header("If-None-Match") == asset->etag;
+
+    if (!notModified && Server.header("Accept-Encoding").indexOf("gzip") < 0) {
+        Server.send(406, "text/plain", "ERROR: The UI is only available gzip encoded.\n");
+        return;
+    }
+
+    /* Only responses which carry the asset may be cached */
+    Server.sendHeader("ETag", asset->etag);
+    Server.sendHeader("Cache-Control", asset->immutable ?
+            "public, max-age=31536000, immutable" : "no-cache");
+
+    if (notModified) {
+        Server.send(304);
+        uiStats.notModified++;
+    } else {
+        /* Straight from flash, nothing is copied to the heap */
+        Server.sendHeader("Content-Encoding", "gzip");
+        Server.send_P(200, asset->mime, (PGM_P) asset->data, asset->len);
+        uiStats.served++;
+        uiStats.bytes += asset->len;
+    }
+
+    uiStats.lastTime = micros() - start;
+    uiStats.maxTime = max(uiStats.maxTime, uiStats.lastTime);
+}
+
+void WebServerControl::handleApiStatus() {
+    const HeapMonitor::Stats_t &heap = heapMonitor.getStats();
+    IRControl::Snapshot_t ir;
+    size_t len = 0;
+
+    irControl.getSnapshot(ir);
+    arena.begin();
+    arena.cat("{\"hostname\":");
+    arena.catJson(Parameter.data.ip.hostname);
+    arena.cat(",\"version\":");
+    arena.catJson(getVersionString().c_str());
+    arena.cat(",\"uptime\":");
+    arena.catJson(upTime.toString().c_str());
+    arena.cat(",\"tx\":%u,\"rx\":%u,\"rssi\":%d", ir.numTx, ir.numRx, WiFi.RSSI());
+    arena.cat(",\"heap\":{\"free\":%lu,\"largest\":%lu,\"minFree\":%lu,\"frag\":%u}",
+            (unsigned long) heap.free, (unsigned long) heap.largest, 
+            (unsigned long) heap.minFree, heap.frag);
+    arena.cat(",\"loopMax\":%lu", (unsigned long) loopMonitor.getStats(LOOP_SITE_LOOP).max);
+    arena.cat(",\"ui\":{\"served\":%lu,\"notModified\":%lu,\"bytes\":%lu,\"lastUs\":%lu,\"maxUs\":%lu}",
+            (unsigned long) uiStats.served, (unsigned long) uiStats.notModified, 
+            (unsigned long) uiStats.bytes, (unsigned long) uiStats.lastTime, 
+            (unsigned long) uiStats.maxTime);
+    arena.cat(",\"poll\":{\"rendered\":%lu,\"notModified\":%lu,\"parked\":%lu,\"woken\":%lu,\"expired\":%lu,\"waiting\":%u}}",
+            (unsigned long) pollStats.rendered, (unsigned long) pollStats.notModified, 
+            (unsigned long) pollStats.parked, (unsigned long) pollStats.woken,
+            (unsigned long) pollStats.expired, numWaiters);
+    sendJson(arena.end(&len), len, false);
+}
+
+void WebServerControl::handleApiCatalog() {
+    size_t len = 0;
+    bool first = true;
+    const CatalogEntry_t *catalog = Parameter.catalog();
+    const LearnedCode_t *codes = Parameter.learned();
+
+    arena.begin();
+    arena.cat("{\"catalog\":[");
+    for (uint8_t i = 0; i < PARAM_MAX_CATALOG; i++) {
+        const CatalogEntry_t *entry = &catalog[i];
+
+        if (entry->name[0] == 0) {
+            continue;
+        }
+        arena.cat("%s{\"name\":", first ? "" : ",");
+        arena.catJson(entry->name);
+        arena.cat(",\"type\":");
+        arena.catJson(typeToString((decode_type_t) entry->protocol).c_str());
+        arena.cat(",\"code\":\"%s\",\"channel\":%d}", codeToString(entry->code).c_str(), 
+                entry->channel);
+        first = false;
+    }
+    arena.cat("],\"learned\":[");
+    first = true;
+    for (uint8_t i = 0; i < PARAM_MAX_LEARNED; i++) {
+        const LearnedCode_t *learned = &codes[i];
+
+        if (learned->name[0] == 0) {
+            continue;
+        }
+        arena.cat("%s{\"name\":", first ? "" : ",");
+        arena.catJson(learned->name);
+        arena.cat("}");
+        first = false;
+    }
+    arena.cat("]}");
+    sendJson(arena.end(&len), len, false);
+}
+
+void WebServerControl::handleApiLog() {
+    const StringRingBuffer &log = Server.arg("dir") == "rx" ? 
+            irControl.getRxLogBuffer() : irControl.getTxLogBuffer();
+    char etag[WEB_ETAG_SIZE];
+    size_t used = arena.getUsed();
+
+    /* The browser revalidates its cached copy by itself */
+    snprintf(etag, sizeof(etag), "\"%08lx-%lx\"", (unsigned long) bootId, 
+            (unsigned long) log.getSeq());
+    if (checkTag(etag)) {
+        return;
+    }
+
+    /* Sent in chunks, a full log of long entries would not fit into the 
+     * arena, one entry at a time always does */
+    pollStats.rendered++;
+    Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    Server.send(200, "application/json", "");
+    Server.sendContent("[");
+    for (int i = 0; i < log.size(); i++) {
+        const char *data = nullptr;
+        size_t len = 0;
+
+        arena.rewind(used);
+        arena.begin();
+        arena.cat(i == 0 ? "" : ",");
+        arena.catJson(log.get(i).c_str());
+        data = arena.end(&len);
+        if (data != nullptr) {
+            Server.sendContent(data, len);
+        }
+    }
+    Server.sendContent("]");
+    Server.sendContent("");
+}
+
+void WebServerControl::sendJson(const char *data, size_t len, bool cacheable) {
+    if (data == nullptr) {
+        Server.send(500, "application/json", "{\"error\":\"Out of memory\"}");
+        return;
+    }
+
+    if (!cacheable) {
+        Server.sendHeader("Cache-Control", "no-store");
+    }
+    Server.send_P(200, "application/json", data, len);
+}
+
+void WebServerControl::handleStatus() {
+    const char *hostname = Parameter.data.ip.hostname;
+    IRControl::Snapshot_t ir;
+    const char *data = nullptr;
+    char etag[WEB_ETAG_SIZE];
+    size_t len = 0;
+
+    /* Changes with each logged event and after the refresh interval */
+    snprintf(etag, sizeof(etag), "\"%08lx-%lx-%lx-%lx\"", (unsigned long) bootId, 
+            (unsigned long) irControl.getTxLogBuffer().getSeq(),
+            (unsigned long) irControl.getRxLogBuffer().getSeq(),
+            (unsigned long) (millis() / WEB_STATUS_REFRESH));
+    if (checkTag(etag)) {
+        return;
+    }
+
+    pollStats.rendered++;
+    irControl.getSnapshot(ir);
+    arena.begin();
+    arena.cat("%s\n", getVersionString().c_str());
+    arena.cat("Date:          %s\n", getTimeStamp().c_str());
+    arena.cat("Uptime:        %s\n", upTime.toString().c_str());
+    arena.cat("WiFi RSSI:     %ddBm\n", WiFi.RSSI());
+    arena.cat("\n");
+    arena.cat("Tx Data:\n");
+    arena.cat("  Count:  %u\n", ir.numTx);
+    arena.cat("  Last:   %s\n", ir.lastTx);
+    arena.cat("  Log:    http://%s.local/txlog\n", hostname);
+    arena.cat("\n");
+    arena.cat("Rx Data:\n");
+    arena.cat("  Count:  %u\n", ir.numRx);
+    arena.cat("  Last:   %s\n", ir.lastRx);
+    arena.cat("  Log:    http://%s.local/rxlog\n", hostname);
+    arena.cat("\n");
+    arena.cat("Trigger IR transmission via:\n");
+    arena.cat("  http://%s.local/tx?type=nec&code=0x1234&repeat=1\n", hostname);
+    arena.cat("\n");
+    arena.cat("Boot:\n");
+    arena.cat("%s\n", bootProfile.getString().c_str());
+    data = arena.end(&len);
+
+    if (data == nullptr) {
+        Server.send(500, "text/plain", "ERROR: Out of memory.\n");
+        return;
+    }
+    Server.send_P(200, "text/plain", data, len);
+}
+
+void WebServerControl::traceHandler(void (WebServerControl::*handler)()) {
+    TxTrace::Stamp_t start = TxTrace::now();
+    uint16_t id = txTrace.getId() != 0 ? txTrace.getId() : txTrace.begin();
+
+    (this->*handler)();
+    txTrace.add(TRACE_HANDLER, id, 0, start);
 }
 
 void WebServerControl::handleTx() {
+    TxTrace::Stamp_t start = TxTrace::now();
     String message;
     decode_type_t type = decode_type_t::NEC;
-    uint32_t code = 0;
+    String codeStr;
+    uint64_t code = 0;
+    uint16_t bits = 0;
     uint32_t repeat = 0;
+    int32_t channel = -1;
+    bool force = false;
+    bool db = false;
     bool transmit = true;
 
     for (uint8_t i = 0; i < Server.args(); i++) {
-        String tmp = Server.arg(i).c_str();
+        String tmp = Server.arg(i);
         const char *arg = tmp.c_str();
         char *endPtr = 0;
 
         if (Server.argName(i) == "code") {
-            uint32_t base = 10;
-            if (is32BitHex(arg)) {
-                base = 16;    
-            }
-            code = strtoul(arg, &endPtr, base);
-            if (arg == endPtr) {
-                message = "ERROR: Invalid code value.\n";
+            codeStr = tmp;
+        }
+        else if (Server.argName(i) == "type" && strcasecmp(arg, "db") == 0) {
+            db = true;
+        }
+        else if (Server.argName(i) == "type") {
+            uint16_t typeBits = 0;
+            const char *end = irControl.parseType(arg, type, typeBits);
+            if (end == nullptr || *end != 0) {
+                message = "ERROR: Unknown type.\n";
                 transmit = false;
                 break;
             }
+            bits = typeBits != 0 ? typeBits : bits;
         }
-        else if (Server.argName(i) == "type") {
-            type = irControl.stringToIRType(arg);
-            if (type == decode_type_t::UNKNOWN) {
-                message = "ERROR: Unknown type.\n";
+        else if (Server.argName(i) == "bits") {
+            bits = strtoul(arg, &endPtr, 10);
+            if (arg == endPtr || bits > 64) {
+                message = "ERROR: Invalid bits value.\n";
                 transmit = false;
                 break;
             }
@@ -142,139 +460,731 @@ void WebServerControl::handleTx() {
             }
             repeat = constrain(repeat, 0, 15);
         }
+        else if (Server.argName(i) == "force") {
+            force = strcmp(arg, "1") == 0 || strcmp(arg, "true") == 0;
+        }
+        else if (Server.argName(i) == "channel") {
+            channel = strtol(arg, &endPtr, 10);
+            if (arg == endPtr || channel < 0 || channel >= IRTX_CHANNELS) {
+                message = "ERROR: Invalid channel value.\n";
+                transmit = false;
+                break;
+            }
+        }
+    }
+
+    txTrace.add(TRACE_PARSE, txTrace.getId(), 0, start);
+
+    if (transmit && db) {
+        if (!irDb.resolve(codeStr.c_str(), type, code, bits)) {
+            message = "ERROR: Unknown database code.\n";
+            transmit = false;
+        }
+    }
+    else if (transmit && hasACState(type)) {
+        handleTxState(type, codeStr, channel);
+        return;
+    }
+    else if (transmit) {
+        const char *end = TxScheduler::parseCode(type, codeStr.c_str(), code);
+        if (end == nullptr || *end != 0) {
+            message = "ERROR: Invalid code value.\n";
+            transmit = false;
+        }
     }
 
     if (transmit) {
-        irControl.transmit(type, code, repeat);
-        message = irControl.getLastTx();
+        TxJob_t job;
+        TxWaiter_t *waiter = nullptr;
+        const Device_t *dev = nullptr;
+        uint16_t window = Parameter.data.tx.coalesce;
+        uint8_t txChannel = 0;
+        TxCoalescer::Result_t merged;
+
+        TxScheduler::initJob(job, type, code);
+        job.bits = bits;
+        job.repeat = repeat;
+        job.force = force;
+        job.channel = channel;
+        job.device = deviceTable.find(type, code);
+        dev = deviceTable.get(job.device);
+
+        /* Only requests to the same LED are merged */
+        txChannel = txScheduler.route(job);
+
+        if (dev != nullptr && dev->coalesce != 0) {
+            window = dev->coalesce;
+        }
+
+        /* Forced requests are always sent */
+        start = TxTrace::now();
+        bool coalesced = !force && txCoalescer.check(type, code, txChannel, merged);
+        txTrace.add(TRACE_COALESCE, txTrace.getId(), 0, start);
+
+        if (coalesced) {
+            const char *data = nullptr;
+            size_t len = 0;
+            uint16_t total = 0;
+
+            arena.begin();
+            arena.cat("Coalesced: %u", merged.count);
+
+            /* Only a command which has not been sent yet gets the repeats */
+            if (Parameter.data.tx.sumRepeat && 
+                    txScheduler.addRepeat(merged.ticket, repeat, total)) {
+                arena.cat(", repeat sum %u", total);
+            }
+            arena.cat("\n%s; %s\n", typeToString(type).c_str(), codeToString(code).c_str());
+            data = arena.end(&len);
+            if (data == nullptr) {
+                Server.send(500, "text/plain", "ERROR: Out of memory.\n");
+                return;
+            }
+            Server.send_P(200, "text/plain", data, len);
+            return;
+        }
+
+        /* Answered once sent, the other channels and the loop go on */
+        waiter = findTxWaiter();
+        if (waiter == nullptr || !txScheduler.enqueue(&job, 1, &waiter->ticket)) {
+            Server.send(503, "text/plain", "ERROR: Transmit queue full.\n");
+            return;
+        }
+
+        /* The window starts with the queued command, closed if skipped */
+        txCoalescer.add(type, code, txChannel, waiter->ticket, window);
+        waiter->type = type;
+        waiter->code = code;
+        waiter->channel = txChannel;
+        parkTx(waiter, TXWAIT_TX);
+        return;
     }  
 
     Server.send(200, "text/plain", message);
 }
 
+void WebServerControl::handleTxBatch() {
+    if (!txBatch.finish()) {
+        Server.send(400, "application/json", txBatch.getResultString(false));
+    } else if (!txScheduler.enqueue(txBatch.getJobs(), txBatch.getCount())) {
+        Server.send(503, "application/json", 
+                txBatch.getResultString(false, "Transmit queue full"));
+    } else {
+        Server.send(200, "application/json", txBatch.getResultString(true));
+    }
+
+    /* Requests without a raw body, e.g. forms, see an empty batch */
+    txBatch.begin(TxBatch::FORMAT_JSON);
+}
+
+void WebServerControl::handleTxBatchBody() {
+    HTTPRaw &raw = Server.raw();
+
+    if (raw.status == RAW_START) {
+        txTrace.begin();
+        txBatch.begin(Server.header("Content-Type").startsWith("application/octet-stream") ? 
+                TxBatch::FORMAT_BINARY : TxBatch::FORMAT_JSON);
+    } else if (raw.status == RAW_WRITE) {
+        TxTrace::Stamp_t start = TxTrace::now();
+
+        txBatch.feed(raw.buf, raw.currentSize);
+        txTrace.add(TRACE_PARSE, txTrace.getId(), 0, start);
+    }
+}
+
+void WebServerControl::handleTxState(decode_type_t type, const String& codeStr, int8_t channel) {
+    uint8_t state[kStateSizeMax];
+    const char *end = nullptr;
+    int16_t len = parseState(codeStr.c_str(), state, sizeof(state), &end);
+
+    if (len < 0 || *end != 0) {
+        Server.send(400, "text/plain", "ERROR: Invalid state value.\n");
+        return;
+    }
+
+    if (channel < 0) {
+        channel = 0;
+    }
+
+    /* State based codes are not queued, they wait until their channel is idle */
+    if (!txScheduler.isIdle(channel) || irControl.isBusy(channel)) {
+        TxWaiter_t *waiter = findTxWaiter();
+
+        if (waiter == nullptr) {
+            Server.send(503, "text/plain", "ERROR: Transmit queue full.\n");
+            return;
+        }
+        waiter->type = type;
+        waiter->channel = channel;
+        waiter->len = len;
+        memcpy(waiter->state, state, len);
+        waiter->ticket = 0;
+        parkTx(waiter, TXWAIT_STATE);
+        return;
+    }
+
+    if (!irControl.transmitState(type, state, len, channel)) {
+        Server.send(400, "text/plain", "ERROR: Type not supported.\n");
+        return;
+    }
+
+    Server.send(200, "text/plain", irControl.getLastTx());
+}
+
 void WebServerControl::handleTxSequence() {
     String message;
     String sequence;
+    bool force = false;
 
     for (uint8_t i = 0; i < Server.args(); i++) {
         if (Server.argName(i) == "sequence") {
             sequence = Server.arg(i);
-            break;
+        }
+        else if (Server.argName(i) == "force") {
+            force = Server.arg(i) == "1" || Server.arg(i) == "true";
         }
     }
 
     if (sequence.length() == 0) {
         message = "ERROR: Missing sequence parameter.\n";
-        message += "Format: /txseq?sequence=type:code:repeat:pause,type:code:repeat:pause,...\n";
-        message += "Example: /txseq?sequence=nec:0x1234:1:500,nec:0x5678:2:1000\n";
-        message += "Pause is in milliseconds (optional, default=100ms)\n";
+        message += "Format: /txseq?sequence=type[/bits]:code:repeat:pause@channel,type:code:repeat:pause@channel,...\n";
+        message += "Example: /txseq?sequence=nec:0x1234:1:500,nec:0x5678:2:1000@1\n";
+        message += "Pause is in milliseconds (optional, default=100ms or the device timing)\n";
+        message += "Channel is the transmit channel (optional, default=routed by device)\n";
         Server.send(400, "text/plain", message);
         return;
     }
 
-    int executed = executeSequence(sequence, message);
-    
-    if (executed >= 0) {
-        message = "Sequence executed: " + String(executed) + " commands\n" + message;
-        Server.send(200, "text/plain", message);
-    } else {
+    /* The timing report is sent once the sequence has been sent */
+    if (executeSequence(sequence, force, message) < 0) {
         Server.send(400, "text/plain", message);
     }
 }
 
-int WebServerControl::executeSequence(const String& sequence, String& errorMessage) {
-    String command;
+int WebServerControl::executeSequence(const String& sequence, bool force, String& message) {
+    TxTrace::Stamp_t parseStart = TxTrace::now();
+    TxJob_t jobs[TXSCHED_QUEUE_SIZE];
+    const char *pos = sequence.c_str();
     int commandCount = 0;
-    int startPos = 0;
-    int commaPos = 0;
+    uint32_t sequential = 0;
+    TxWaiter_t *waiter = nullptr;
 
-    do {
-        commaPos = sequence.indexOf(',', startPos);
-        if (commaPos == -1) {
-            command = sequence.substring(startPos);
-        } else {
-            command = sequence.substring(startPos, commaPos);
+    /* Parse the whole sequence first, nothing is sent if it is invalid */
+    while (*pos != 0) {
+        if (*pos == ',' || *pos == ' ') {
+            pos++;
+            continue;
         }
 
-        command.trim();
-        if (command.length() == 0) {
-            break;
+        if (commandCount == TXSCHED_QUEUE_SIZE) {
+            message = "ERROR: Too many commands, the limit is " + String(TXSCHED_QUEUE_SIZE) + "\n";
+            return -1;
         }
 
-        if (!executeSequenceCommand(command, errorMessage)) {
+        pos = TxScheduler::parseJob(pos, jobs[commandCount], message);
+        if (pos == nullptr) {
             return -1;
         }
 
+        jobs[commandCount].force = force;
+        sequential += jobs[commandCount].pause == TXSCHED_PAUSE_DEFAULT ? 
+                TXSCHED_PAUSE_LEGACY : jobs[commandCount].pause;
         commandCount++;
-        startPos = commaPos + 1;
-    } while (commaPos != -1);
+    }
+    txTrace.add(TRACE_PARSE, txTrace.getId(), 0, parseStart);
+
+    waiter = findTxWaiter();
+    if (waiter == nullptr || !txScheduler.enqueue(jobs, commandCount, &waiter->ticket)) {
+        message = "ERROR: Transmit queue full.\n";
+        return -1;
+    }
+
+    waiter->commands = commandCount;
+    waiter->sequential = sequential;
+    parkTx(waiter, TXWAIT_SEQUENCE);
 
     return commandCount;
 }
 
-bool WebServerControl::executeSequenceCommand(const String& command, String& errorMessage) {
-    int colonPos1 = command.indexOf(':');
-    int colonPos2 = command.indexOf(':', colonPos1 + 1);
-    int colonPos3 = command.indexOf(':', colonPos2 + 1);
+void WebServerControl::handleLearn() {
+    String message;
+    String name;
+    uint8_t count = 3;
+
+    for (uint8_t i = 0; i < Server.args(); i++) {
+        if (Server.argName(i) == "name") {
+            name = Server.arg(i);
+        }
+        else if (Server.argName(i) == "count") {
+            count = constrain(Server.arg(i).toInt(), 1, LEARN_MAX_CAPTURES);
+        }
+        else if (Server.argName(i) == "cancel") {
+            irLearner.cancel();
+        }
+    }
+
+    if (name.length() != 0 && !irLearner.start(name.c_str(), count)) {
+        Server.send(400, "text/plain", "ERROR: Invalid name, up to 15 characters.\n");
+        return;
+    }
+
+    message = irLearner.getStatusString();
+    message += "\nLearned codes:\n";
+    message += irLearner.getListString();
+    Server.send(200, "text/plain", message);
+}
+
+void WebServerControl::handleTrace() {
+    if (Server.hasArg("clear")) {
+        txTrace.clear();
+    }
 
-    if (colonPos1 == -1 || colonPos2 == -1) {
-        errorMessage = "ERROR: Invalid command format: " + command + "\n";
-        errorMessage += "Expected: type:code:repeat[:pause]\n";
-        return false;
+    /* Sent in chunks, the whole trace would not fit into a single String */
+    Server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    Server.send(200, "application/json", "");
+    Server.sendContent("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (uint16_t i = 0; i < txTrace.getCount(); i++) {
+        Server.sendContent(i == 0 ? txTrace.getEventJson(i) : "," + txTrace.getEventJson(i));
     }
+    Server.sendContent("]}\n");
+    Server.sendContent("");
+}
 
-    String typeStr = command.substring(0, colonPos1);
-    String codeStr = command.substring(colonPos1 + 1, colonPos2);
-    String repeatStr = command.substring(colonPos2 + 1, colonPos3 == -1 ? command.length() : colonPos3);
-    String pauseStr = colonPos3 == -1 ? "100" : command.substring(colonPos3 + 1);
+void WebServerControl::handleLoop() {
+    String data = loopMonitor.getStatsString();
 
-    decode_type_t type = irControl.stringToIRType(typeStr.c_str());
-    if (type == decode_type_t::UNKNOWN) {
-        errorMessage = "ERROR: Unknown type: " + typeStr + "\n";
-        return false;
+    if (Server.hasArg("reset")) {
+        loopMonitor.reset();
     }
+    Server.send(200, "text/plain", data);
+}
+
+void WebServerControl::handleConfig() {
+    /* The sections param_set_value() may change, for all or nothing */
+    auto wifi = Parameter.data.wifi;
+    auto ip = Parameter.data.ip;
+    auto ntp = Parameter.data.ntp;
+    auto tx = Parameter.data.tx;
+    auto relay = Parameter.data.relay;
+    auto loop = Parameter.data.loop;
+    bool save = false;
+
+    for (int i = 0; i < Server.args(); i++) {
+        String name = Server.argName(i);
+        int8_t ret = 0;
+
+        if (name == "save") {
+            save = Server.arg(i) == "1";
+            continue;
+        }
 
-    char* endPtr;
-    uint32_t base = is32BitHex(codeStr.c_str()) ? 16 : 10;
-    uint32_t code = strtoul(codeStr.c_str(), &endPtr, base);
-    if (codeStr.c_str() == endPtr) {
-        errorMessage = "ERROR: Invalid code: " + codeStr + "\n";
-        return false;
+        if (name == "plain") {
+            continue;
+        }
+
+        ret = param_set_value(name.c_str(), Server.arg(i).c_str());
+        if (ret != 0) {
+            Parameter.data.wifi = wifi;
+            Parameter.data.ip = ip;
+            Parameter.data.ntp = ntp;
+            Parameter.data.tx = tx;
+            Parameter.data.relay = relay;
+            Parameter.data.loop = loop;
+            Server.send(400, "text/plain", "ERROR: " + String(ret == -1 ? 
+                "Unknown parameter " : "Invalid value for ") + name + "\n");
+            return;
+        }
     }
 
-    uint32_t repeat = strtoul(repeatStr.c_str(), &endPtr, 10);
-    if (repeatStr.c_str() == endPtr) {
-        errorMessage = "ERROR: Invalid repeat: " + repeatStr + "\n";
-        return false;
+    if (save && Parameter.write() < 0) {
+        Server.send(500, "text/plain", "ERROR: Failed to save parameters.\n");
+        return;
     }
-    repeat = constrain(repeat, 0, 15);
 
-    uint32_t pause = strtoul(pauseStr.c_str(), &endPtr, 10);
-    if (pauseStr.c_str() == endPtr) {
-        errorMessage = "ERROR: Invalid pause: " + pauseStr + "\n";
-        return false;
+    applyPending = true;
+    Server.send(200, "text/plain", param_get_string());
+}
+
+void WebServerControl::handleTimers() {
+    String message;
+
+    if (Server.hasArg("cancel")) {
+        int idx = Server.arg("cancel").toInt();
+
+        if (idx < 0 || idx >= PARAM_MAX_TIMERS) {
+            Server.send(400, "text/plain", "ERROR: Invalid timer.\n");
+            return;
+        }
+        timerWheel.cancel(idx);
     }
-    pause = constrain(pause, 0, 5000);
 
-    irControl.transmit(type, code, repeat);
-    
-    if (pause > 0) {
-        delay(pause);
+    if (Server.hasArg("in")) {
+        Timer_t timer;
+        int8_t idx = timerWheel.findFree();
+        int8_t count = 0;
+
+        if (!TimerWheel::isSynced()) {
+            Server.send(503, "text/plain", "ERROR: Time not synchronized.\n");
+            return;
+        }
+        if (idx < 0) {
+            Server.send(507, "text/plain", "ERROR: All timers in use.\n");
+            return;
+        }
+
+        memset(&timer, 0, sizeof(timer));
+        timer.mode = TIMER_MODE_ONCE;
+        timer.time = time(nullptr) + max(Server.arg("in").toInt(), 1L);
+        count = TxScheduler::parseSteps(Server.arg("sequence").c_str(), timer.steps, 
+                TIMER_MAX_STEPS, message);
+        if (count < 0) {
+            Server.send(400, "text/plain", message);
+            return;
+        }
+        timer.numSteps = count;
+        timerWheel.set(idx, timer);
     }
 
-    return true;
+    Server.send(200, "text/plain", timerWheel.getListString());
+}
+
+WebServerControl::TxWaiter_t* WebServerControl::findTxWaiter(void) {
+    for (uint8_t i = 0; i < WEB_MAX_TX_WAITERS; i++) {
+        if (txWaiters[i].kind == TXWAIT_NONE) {
+            return &txWaiters[i];
+        }
+    }
+
+    return nullptr;
+}
+
+void WebServerControl::parkTx(TxWaiter_t *waiter, TxWait_t kind) {
+    waiter->client = Server.client();
+    waiter->kind = kind;
+    waiter->start = millis();
+    numTxWaiters++;
+}
+
+void WebServerControl::serviceTxWaiters(void) {
+    for (uint8_t i = 0; i < WEB_MAX_TX_WAITERS; i++) {
+        TxWaiter_t *waiter = &txWaiters[i];
+        const TxScheduler::Result_t *result = nullptr;
+        char report[128];
+
+        if (waiter->kind == TXWAIT_NONE) {
+            continue;
+        }
+
+        if (waiter->kind == TXWAIT_STATE) {
+            if (!txScheduler.isIdle(waiter->channel) || irControl.isBusy(waiter->channel)) {
+                continue;
+            }
+
+            /* Sent even if the client gave up waiting, as a queued command */
+            if (!irControl.transmitState(waiter->type, waiter->state, waiter->len, 
+                    waiter->channel)) {
+                snprintf(report, sizeof(report), "ERROR: Type not supported.\n");
+                writeResponse(waiter->client, 400, nullptr, report, strlen(report));
+            } else {
+                const String &entry = irControl.getLastTx();
+
+                writeResponse(waiter->client, 200, nullptr, entry.c_str(), entry.length());
+            }
+        } else {
+            /* Also kept if the client gave up, a skip has to be seen */
+            result = txScheduler.getResult(waiter->ticket);
+            if (result != nullptr && result->pending != 0) {
+                continue;
+            }
+
+            if (result == nullptr) {
+                snprintf(report, sizeof(report), "ERROR: Transmission lost.\n");
+            } else if (waiter->kind == TXWAIT_SEQUENCE) {
+                /* Report the time the former strictly sequential execution 
+                 * would have taken as reference */
+                snprintf(report, sizeof(report), 
+                        "Sequence executed: %u commands in %lums (sequential %lums), %u skipped\n",
+                        waiter->commands, (unsigned long) (millis() - waiter->start), 
+                        (unsigned long) (waiter->sequential + result->airtime), result->skipped);
+            } else if (result->skipped != 0) {
+                txCoalescer.remove(waiter->type, waiter->code, waiter->channel);
+                snprintf(report, sizeof(report), "Skipped: Device already in target state.\n");
+            } else {
+                snprintf(report, sizeof(report), "%s", result->lastTx);
+            }
+            writeResponse(waiter->client, 200, nullptr, report, strlen(report));
+        }
+
+        txScheduler.release(waiter->ticket);
+        waiter->client.stop();
+        waiter->client = WiFiClient();
+        waiter->kind = TXWAIT_NONE;
+        numTxWaiters--;
+    }
 }
 
 void WebServerControl::handleTxLog() {
-    String data = irControl.getTxLog();
-    Server.send(200, "text/plain", data);   
+    sendLog(irControl.getTxLogBuffer());
 }
 
 void WebServerControl::handleRxLog() {
-    String data = irControl.getRxLog();
-    Server.send(200, "text/plain", data);   
+    sendLog(irControl.getRxLogBuffer());
+}
+
+void WebServerControl::sendLog(const StringRingBuffer &log) {
+    char etag[WEB_ETAG_SIZE];
+    uint32_t seq = log.getSeq();
+    long wait = constrain(Server.arg("wait").toInt(), 0, WEB_MAX_WAIT);
+    const char *data = nullptr;
+    size_t len = 0;
+
+    snprintf(etag, sizeof(etag), "\"%08lx-%lx\"", (unsigned long) bootId, 
+            (unsigned long) seq);
+
+    /* Waits for a change of the version the client has, the current one if
+     * it did not send one */
+    if (wait > 0 && (!Server.hasHeader("If-None-Match") || 
+            Server.header("If-None-Match") == etag)) {
+        if (park(log, seq, wait)) {
+            return;
+        }
+    }
+
+    if (checkTag(etag)) {
+        return;
+    }
+
+    pollStats.rendered++;
+    data = renderLog(log, &len);
+
+    /* Logs larger than the arena are built on the heap */
+    if (data == nullptr) {
+        Server.send(200, "text/plain", log.dump());
+        return;
+    }
+    Server.send_P(200, "text/plain", data, len);
+}
+
+const char *WebServerControl::renderLog(const StringRingBuffer &log, size_t *pLen) {
+    arena.begin();
+    if (log.isEmpty()) {
+        arena.cat("empty\n");
+    }
+    for (int i = 0; i < log.size(); i++) {
+        arena.cat("%s\n", log.get(i).c_str());
+    }
+
+    return arena.end(pLen);
+}
+
+bool WebServerControl::checkTag(const char *etag) {
+    Server.sendHeader("ETag", etag);
+    Server.sendHeader("Cache-Control", "no-cache");
+
+    if (Server.header("If-None-Match") == etag) {
+        Server.send(304);
+        pollStats.notModified++;
+        return true;
+    }
+
+    return false;
+}
+
+bool WebServerControl::park(const StringRingBuffer &log, uint32_t seq, uint32_t wait) {
+    for (uint8_t i = 0; i < WEB_MAX_WAITERS; i++) {
+        Waiter_t *waiter = &waiters[i];
+
+        if (waiter->log == nullptr) {
+            waiter->client = Server.client();
+            waiter->log = &log;
+            waiter->seq = seq;
+            waiter->deadline = millis() + wait * 1000;
+            numWaiters++;
+            pollStats.parked++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WebServerControl::serviceWaiters(void) {
+    char etag[WEB_ETAG_SIZE];
+
+    for (uint8_t i = 0; i < WEB_MAX_WAITERS; i++) {
+        Waiter_t *waiter = &waiters[i];
+        uint32_t seq = 0;
+
+        if (waiter->log == nullptr) {
+            continue;
+        }
+
+        seq = waiter->log->getSeq();
+        snprintf(etag, sizeof(etag), "\"%08lx-%lx\"", (unsigned long) bootId, 
+                (unsigned long) seq);
+
+        if (!waiter->client.connected()) {
+            /* Gave up waiting */
+        } else if (seq != waiter->seq) {
+            const char *data = nullptr;
+            size_t len = 0;
+
+            data = renderLog(*waiter->log, &len);
+            if (data != nullptr) {
+                writeResponse(waiter->client, 200, etag, data, len);
+            } else {
+                String dump = waiter->log->dump();
+
+                writeResponse(waiter->client, 200, etag, dump.c_str(), dump.length());
+            }
+            pollStats.rendered++;
+            pollStats.woken++;
+        } else if ((int32_t) (millis() - waiter->deadline) >= 0) {
+            writeResponse(waiter->client, 304, etag, nullptr, 0);
+            pollStats.expired++;
+        } else {
+            continue;
+        }
+
+        waiter->client.stop();
+        waiter->client = WiFiClient();
+        waiter->log = nullptr;
+        numWaiters--;
+    }
 }
 
+void WebServerControl::writeResponse(WiFiClient &client, int code, const char *etag, 
+        const char *data, size_t len) {
+    const char *reason = "OK";
+
+    if (code == 304) {
+        reason = "Not Modified";
+    } else if (code == 400) {
+        reason = "Bad Request";
+    }
+
+    client.printf("HTTP/1.1 %d %s\r\n", code, reason);
+    if (etag != nullptr) {
+        client.printf("ETag: %s\r\nCache-Control: no-cache\r\n", etag);
+    }
+    client.printf("Connection: close\r\n");
+    if (code != 304) {
+        client.printf("Content-Type: text/plain\r\nContent-Length: %u\r\n", (unsigned) len);
+    }
+    client.print("\r\n");
+    if (len > 0) {
+        client.write((const uint8_t *) data, len);
+    }
+}
+
+void WebServerControl::handleHeap() {
+    String data = heapMonitor.getStatsString();
+
+    data += arena.getStatsString();
+    if (Server.hasArg("reset")) {
+        heapMonitor.reset();
+    }
+    Server.send(200, "text/plain", data);
+}
+
+const ReqArena &WebServerControl::getArena(void) const {
+    return arena;
+}
+
+void WebServerControl::handleState() {
+    String data = deviceTable.getStateString();
+    Server.send(200, "text/plain", data);
+}
+
+void WebServerControl::handleChannels() {
+    String data = txScheduler.getStatsString();
+    Server.send(200, "text/plain", data);
+}
+
+void WebServerControl::handleRelay() {
+    String data = relayEngine.getStatsString();
+    Server.send(200, "text/plain", data);
+}
+
+void WebServerControl::handleIrDb() {
+    const IRDbEntry_t *entry = nullptr;
+
+    if (Server.hasArg("name")) {
+        entry = irDb.find(Server.arg("name").c_str());
+        if (entry == nullptr) {
+            Server.send(404, "text/plain", "ERROR: Unknown database code.\n");
+            return;
+        }
+        Server.send(200, "text/plain", irDb.getEntryString(entry));
+        return;
+    }
+
+    if (Server.hasArg("device")) {
+        String data = irDb.getListString(Server.arg("device").c_str());
+        Server.send(200, "text/plain", data);
+        return;
+    }
+
+    String data = irDb.getStatsString();
+    if (irDb.getCount() != 0) {
+        data += irDb.getDeviceString();
+    }
+    Server.send(200, "text/plain", data);
+}
+
+#if IRGW_AC
+void WebServerControl::handleAc() {
+    stdAc::state_t state;
+    bool changed = false;
+    int8_t idx = -1;
+
+    if (!Server.hasArg("unit")) {
+        Server.send(200, "text/plain", acControl.getStateString());
+        return;
+    }
+
+    idx = acControl.find(Server.arg("unit").c_str());
+    if (idx < 0) {
+        Server.send(400, "text/plain", "ERROR: Unknown unit.\n");
+        return;
+    }
+
+    state = acControl.getState(idx);
+    for (uint8_t i = 0; i < Server.args(); i++) {
+        String tmp = Server.arg(i);
+        const char *arg = tmp.c_str();
+
+        if (Server.argName(i) == "power") {
+            state.power = IRac::strToBool(arg, state.power);
+            changed = true;
+        }
+        else if (Server.argName(i) == "mode") {
+            state.mode = IRac::strToOpmode(arg, state.mode);
+            changed = true;
+        }
+        else if (Server.argName(i) == "temp") {
+            state.degrees = constrain(atof(arg), 10.0, 40.0);
+            changed = true;
+        }
+        else if (Server.argName(i) == "fan") {
+            state.fanspeed = IRac::strToFanspeed(arg, state.fanspeed);
+            changed = true;
+        }
+        else if (Server.argName(i) == "swing") {
+            state.swingv = IRac::strToSwingV(arg, state.swingv);
+            changed = true;
+        }
+    }
+
+    /* Sent by the main loop once the state has been stable for a while */
+    if (changed) {
+        acControl.setState(idx, state);
+    }
+
+    Server.send(200, "text/plain", acControl.getStateString(idx));
+}
+#endif
+
 bool WebServerControl::isEnabled() const {
     return Enabled;
 }
@@ -282,3 +1192,5 @@ bool WebServerControl::isEnabled() const {
 int WebServerControl::getPort() const {
     return Port;
 }
+
+#endif /* IRGW_WEB */
@@ -24,6 +24,41 @@
 #include <WebServer.h>
 #include <Arduino.h>
 
+#include "common.hpp"
+#include "txscheduler.hpp"
+#include "txbatch.hpp"
+#include "reqarena.hpp"
+#include "stringRingBuffer.hpp"
+#include "webui.hpp"
+
+/**
+ * @brief The maximum number of long poll requests waiting at the same time.
+ * Each one keeps a socket open, lwIP has 10 by default.
+ */
+#define WEB_MAX_WAITERS             4
+
+/**
+ * @brief The maximum wait time of a long poll request in seconds.
+ */
+#define WEB_MAX_WAIT                60
+
+/**
+ * @brief The maximum number of transmit requests waiting for their commands
+ * at the same time, limited by the sockets as well.
+ */
+#define WEB_MAX_TX_WAITERS          4
+
+/**
+ * @brief Interval in ms after which the status page is rendered again even if
+ * there has been no event, for the uptime, date and RSSI.
+ */
+#define WEB_STATUS_REFRESH          10000
+
+/**
+ * @brief The size of an entity tag including the quotes.
+ */
+#define WEB_ETAG_SIZE               48
+
 /**
  * @brief Web server control class.
  * This class handles the web server functionality for the ir-gateway.
@@ -74,8 +109,52 @@ class WebServerControl {
          */
         int getPort() const;
 
+        /**
+         * @brief Get the request arena.
+         * @return The arena, for its statistics.
+         */
+        const ReqArena &getArena(void) const;
+
     private:
 
+        /**
+         * @brief The kinds of transmit requests waiting for their commands.
+         */
+        typedef enum {
+            TXWAIT_NONE = 0,
+            TXWAIT_TX,
+            TXWAIT_SEQUENCE,
+            TXWAIT_STATE
+        } TxWait_t;
+
+        /**
+         * @brief A transmit request waiting for its commands.
+         */
+        typedef struct {
+            /** @brief The client, keeps the connection open. */
+            WiFiClient client;
+            /** @brief The kind of the request, TXWAIT_NONE if the slot is free. */
+            TxWait_t kind;
+            /** @brief The ticket of the queued commands. */
+            uint16_t ticket;
+            /** @brief When the commands have been queued in ms. */
+            uint32_t start;
+            /** @brief The number of commands of a sequence. */
+            uint8_t commands;
+            /** @brief The time a strictly sequential execution would take in ms. */
+            uint32_t sequential;
+            /** @brief The protocol of a command or state. */
+            decode_type_t type;
+            /** @brief The code of a command. */
+            uint64_t code;
+            /** @brief The transmit channel of a command or state. */
+            uint8_t channel;
+            /** @brief The number of state bytes. */
+            uint16_t len;
+            /** @brief The state bytes. */
+            uint8_t state[kStateSizeMax];
+        } TxWaiter_t;
+
         /**
          * @brief Setup the routes for the web server.
          * This method defines the routes and their corresponding handlers.
@@ -84,15 +163,166 @@ class WebServerControl {
         
         /**
          * @brief Handle the root path.
-         * This method processes requests to the root path ("/").
+         * Browsers get the web UI, all other clients the plain text status.
          */
         void handleRoot();
+
+        /**
+         * @brief Handle the plain text status page.
+         */
+        void handleStatus();
+
+        /**
+         * @brief Send a precompressed asset of the web UI from flash.
+         * Answers 304 if the client already has the current version.
+         * @param asset The asset.
+         */
+        void sendAsset(const WebAsset_t *asset);
+
+        /**
+         * @brief Handle the JSON status request of the web UI.
+         */
+        void handleApiStatus();
+
+        /**
+         * @brief Handle the JSON catalog request of the web UI.
+         * Reports the named catalog entries and learned codes.
+         */
+        void handleApiCatalog();
+
+        /**
+         * @brief Handle the JSON log request of the web UI.
+         * dir=rx selects the reception log, the transmit log otherwise.
+         */
+        void handleApiLog();
+
+        /**
+         * @brief Send a JSON response built in the arena.
+         * @param data The response, nullptr if it did not fit.
+         * @param len The length of the response.
+         * @param cacheable true if the entity tag has been sent, the browser
+         * may keep the response and revalidate it.
+         */
+        void sendJson(const char *data, size_t len, bool cacheable);
         
         /**
          * @brief Handle the transmission of IR signals.
          * This method processes requests to transmit IR signals.
          */
         void handleTx();
+
+        /**
+         * @brief Call a transmit request handler and trace it.
+         * A request id is assigned unless the request already got one while
+         * its body has been received.
+         * @param handler The handler.
+         */
+        void traceHandler(void (WebServerControl::*handler)());
+
+        /**
+         * @brief Handle the trace request.
+         * Sends the recorded spans in the Chrome trace event format, 
+         * clear=1 removes them afterwards.
+         */
+        void handleTrace();
+
+        /**
+         * @brief Handle the loop statistics request.
+         * Reports the duration histogram per call site of the main loop and
+         * the recorded stalls, reset=1 resets them afterwards.
+         */
+        void handleLoop();
+
+        /**
+         * @brief Handle the heap statistics request.
+         * Reports the heap telemetry and the request arena, reset=1 resets
+         * the allocation counts and extremes afterwards.
+         */
+        void handleHeap();
+
+        /**
+         * @brief Send the entries of a log.
+         * The entity tag is derived from the sequence number of the log, an
+         * unchanged log is answered with 304 without rendering it. wait=n 
+         * holds the request for up to n seconds until the log changes.
+         * @param log The log.
+         */
+        void sendLog(const StringRingBuffer &log);
+
+        /**
+         * @brief Render the entries of a log into the arena.
+         * @param log The log.
+         * @param pLen Returns the length.
+         * @return The entries, nullptr if they did not fit.
+         */
+        const char *renderLog(const StringRingBuffer &log, size_t *pLen);
+
+        /**
+         * @brief Send the entity tag of a response and check it against the
+         * one of the client.
+         * Answers 304 if they match.
+         * @param etag The entity tag of the current response.
+         * @return true if 304 has been sent, the response is not needed.
+         */
+        bool checkTag(const char *etag);
+
+        /**
+         * @brief Keep the client of the current request waiting for a change
+         * of a log.
+         * The web server drops its reference to the client after the 
+         * handler, the copy kept here keeps the connection open.
+         * @param log The log.
+         * @param seq The sequence number the client has.
+         * @param wait The wait time in seconds.
+         * @return false if all slots are in use.
+         */
+        bool park(const StringRingBuffer &log, uint32_t seq, uint32_t wait);
+
+        /**
+         * @brief Answer the waiting clients whose log has changed or whose
+         * wait time has expired.
+         */
+        void serviceWaiters(void);
+
+        /**
+         * @brief Get a free slot for a transmit request which has to wait 
+         * for its commands.
+         * @return The slot, nullptr if all slots are in use.
+         */
+        TxWaiter_t* findTxWaiter(void);
+
+        /**
+         * @brief Keep the client of the current transmit request waiting 
+         * until its commands have been sent.
+         * @param waiter The slot returned by findTxWaiter().
+         * @param kind The kind of the request.
+         */
+        void parkTx(TxWaiter_t *waiter, TxWait_t kind);
+
+        /**
+         * @brief Answer the transmit requests whose commands have been sent
+         * and send the waiting states once their channel is idle.
+         */
+        void serviceTxWaiters(void);
+
+        /**
+         * @brief Write a complete plain text response to a waiting client.
+         * @param client The client.
+         * @param code The status code.
+         * @param etag The entity tag, nullptr for none.
+         * @param data The body.
+         * @param len The length of the body.
+         */
+        void writeResponse(WiFiClient &client, int code, const char *etag, 
+                const char *data, size_t len);
+
+        /**
+         * @brief Handle the configuration request.
+         * Sets the parameters given as arguments, saves them if save=1 is 
+         * given and applies them live once the response has been sent. 
+         * Reports all parameters.
+         */
+        void handleConfig();
         
         /**
          * @brief Handle sequence transmission requests.
@@ -101,19 +331,38 @@ class WebServerControl {
         
         /**
          * @brief Execute a sequence of IR commands.
+         * The whole sequence is validated before it is passed to the 
+         * transmit scheduler. The request waits for the timing report until 
+         * the commands have been sent.
          * @param sequence The sequence string to execute.
-         * @param errorMessage Reference to store error messages.
-         * @return Number of executed commands, or -1 on error.
+         * @param force Send commands even if the device is in the target state.
+         * @param message Reference to store the error message.
+         * @return Number of queued commands, or -1 on error.
          */
-        int executeSequence(const String& sequence, String& errorMessage);
+        int executeSequence(const String& sequence, bool force, String& message);
         
         /**
-         * @brief Execute a single command from a sequence.
-         * @param command The command string to execute.
-         * @param errorMessage Reference to store error messages.
-         * @return True on success, false on error.
+         * @brief Handle the end of a batch transmit request.
+         * Queues the commands in a single operation if all are valid and
+         * reports the status of each command as JSON.
+         */
+        void handleTxBatch();
+
+        /**
+         * @brief Handle a chunk of the body of a batch transmit request.
+         * The chunks are parsed as received, the body is never buffered.
+         */
+        void handleTxBatchBody();
+
+        /**
+         * @brief Transmit the state of a state based protocol.
+         * State based codes are not queued, they are sent once the queue of
+         * their channel is empty.
+         * @param type The protocol.
+         * @param codeStr The state as hex string.
+         * @param channel The transmit channel, -1 for the first one.
          */
-        bool executeSequenceCommand(const String& command, String& errorMessage);
+        void handleTxState(decode_type_t type, const String& codeStr, int8_t channel);
 
         /**
          * @brief Handle the reception of IR signals.
@@ -126,6 +375,51 @@ class WebServerControl {
          * This method processes requests to view the reception log.
          */
         void handleRxLog();
+
+        /**
+         * @brief Handle the device state request.
+         * Reports the tracked state and skip counter of each device.
+         */
+        void handleState();
+
+        /**
+         * @brief Handle the transmit channel statistics request.
+         */
+        void handleChannels();
+
+        /**
+         * @brief Handle the learn mode request.
+         * Starts learning if a name is given and reports the learned codes.
+         */
+        void handleLearn();
+
+        /**
+         * @brief Handle the relay statistics request.
+         * Reports the hits per rule and the RX to TX latency histogram.
+         */
+        void handleRelay();
+
+        /**
+         * @brief Handle the code database request.
+         * Reports the devices, the functions of a device or a single code.
+         */
+        void handleIrDb();
+
+#if IRGW_AC
+        /**
+         * @brief Handle the air conditioner request.
+         * Updates the desired state of a unit, which is sent after a short 
+         * debounce time if it differs from the state sent last.
+         */
+        void handleAc();
+#endif
+
+        /**
+         * @brief Handle the timer request.
+         * Lists the timers, cancels one or adds a one shot timer which sends
+         * a sequence after the given number of seconds.
+         */
+        void handleTimers();
         
         /**
          * @brief Handle the configuration of the web server.
@@ -150,4 +444,92 @@ class WebServerControl {
          */
         bool Enabled;
 
+        /**
+         * @brief Set if changed parameters have to be applied once the 
+         * current request has been answered.
+         */
+        bool applyPending;
+
+        /**
+         * @brief Parser of the batch transmit request being received.
+         */
+        TxBatch txBatch;
+
+        /**
+         * @brief Arena for the temporaries of the request being handled, 
+         * reset after each response.
+         */
+        ReqArena arena;
+
+        /**
+         * @brief Statistics of the web UI assets served.
+         */
+        struct {
+            /** @brief Number of assets sent. */
+            uint32_t served;
+            /** @brief Number of 304 responses. */
+            uint32_t notModified;
+            /** @brief Number of compressed bytes sent. */
+            uint32_t bytes;
+            /** @brief Handler time of the last asset request in µs. */
+            uint32_t lastTime;
+            /** @brief Maximum handler time in µs. */
+            uint32_t maxTime;
+        } uiStats;
+
+        /**
+         * @brief The waiting transmit requests.
+         */
+        TxWaiter_t txWaiters[WEB_MAX_TX_WAITERS];
+
+        /**
+         * @brief The number of waiting transmit requests.
+         */
+        uint8_t numTxWaiters;
+
+        /**
+         * @brief A client waiting for a change of a log.
+         */
+        typedef struct {
+            /** @brief The client, keeps the connection open. */
+            WiFiClient client;
+            /** @brief The log, nullptr if the slot is free. */
+            const StringRingBuffer *log;
+            /** @brief The sequence number of the log the client has. */
+            uint32_t seq;
+            /** @brief When the wait time expires in ms. */
+            uint32_t deadline;
+        } Waiter_t;
+
+        /**
+         * @brief The waiting clients.
+         */
+        Waiter_t waiters[WEB_MAX_WAITERS];
+
+        /**
+         * @brief The number of waiting clients.
+         */
+        uint8_t numWaiters;
+
+        /**
+         * @brief Random value making the entity tags unique per boot.
+         */
+        uint32_t bootId;
+
+        /**
+         * @brief Statistics of the conditional and long poll requests.
+         */
+        struct {
+            /** @brief Number of responses rendered. */
+            uint32_t rendered;
+            /** @brief Number of 304 responses. */
+            uint32_t notModified;
+            /** @brief Number of requests which had to wait. */
+            uint32_t parked;
+            /** @brief Number of waiting requests answered with a change. */
+            uint32_t woken;
+            /** @brief Number of waiting requests whose wait time expired. */
+            uint32_t expired;
+        } pollStats;
+
 };
@@ -0,0 +1,55 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include "webui.hpp"
+#include "webassets.h"
+
+uint8_t WebUI::getCount(void) {
+    return sizeof(webAssets) / sizeof(webAssets[0]);
+}
+
+const WebAsset_t *WebUI::get(uint8_t idx) {
+    if (idx >= getCount()) {
+        return nullptr;
+    }
+
+    return &webAssets[idx];
+}
+
+const WebAsset_t *WebUI::find(const char *pPath) {
+    for (uint8_t i = 0; i < getCount(); i++) {
+        if (strcmp(webAssets[i].path, pPath) == 0) {
+            return &webAssets[i];
+        }
+    }
+
+    return nullptr;
+}
+
+uint32_t WebUI::getTotalSize(bool compressed) {
+    uint32_t total = 0;
+
+    for (uint8_t i = 0; i < getCount(); i++) {
+        total += compressed ? webAssets[i].len : webAssets[i].size;
+    }
+
+    return total;
+}
@@ -0,0 +1,72 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief A precompressed static asset of the web UI.
+ * data is the gzipped content in flash, etag the quoted hash of it. Assets 
+ * which are referenced by a versioned URL are immutable and cached forever.
+ */
+typedef struct {
+    const char *path;
+    const char *mime;
+    const uint8_t *data;
+    uint32_t len;
+    uint32_t size;
+    const char *etag;
+    bool immutable;
+} WebAsset_t;
+
+/**
+ * @brief The static assets of the web UI.
+ * The assets are generated from web/ by tools/webassets.py at build time.
+ */
+class WebUI {
+    public:
+
+        /**
+         * @brief Returns the number of assets.
+         */
+        static uint8_t getCount(void);
+
+        /**
+         * @brief Returns an asset.
+         * @param idx The index of the asset.
+         * @return The asset, nullptr if idx is out of range.
+         */
+        static const WebAsset_t *get(uint8_t idx);
+
+        /**
+         * @brief Finds an asset by its path.
+         * @param pPath The path, e.g. "/app.js".
+         * @return The asset, nullptr if there is none.
+         */
+        static const WebAsset_t *find(const char *pPath);
+
+        /**
+         * @brief Returns the total size of all assets.
+         * @param compressed true for the gzipped size.
+         */
+        static uint32_t getTotalSize(bool compressed);
+};
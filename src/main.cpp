@@ -31,22 +31,79 @@
 #include "common.hpp"
 #include "parameter.hpp"
 #include "ircontrol.hpp"
+#include "irdb.hpp"
+#include "devices.hpp"
+#include "txscheduler.hpp"
+#include "txcoalescer.hpp"
+#include "irlearner.hpp"
+#include "relay.hpp"
+#include "accontrol.hpp"
+#include "timerwheel.hpp"
+#include "txtrace.hpp"
+#include "loopmonitor.hpp"
+#include "bootprofile.hpp"
+#include "heapmonitor.hpp"
+#include "serialproto.hpp"
 #include "webservercontrol.hpp"
 
 Task networkTask(30000);
+Task timerTask(1000);
 Cli cli;
 UpTime upTime;
 MDNSResponder mdns;
 IRControl irControl;
+IRDb irDb;
+DeviceTable deviceTable;
+TxScheduler txScheduler;
+TxCoalescer txCoalescer;
+IRLearner irLearner;
+RelayEngine relayEngine;
+#if IRGW_AC
+AcControl acControl;
+#endif
+TimerWheel timerWheel;
+TxTrace txTrace;
+LoopMonitor loopMonitor;
+BootProfile bootProfile;
+HeapMonitor heapMonitor;
+SerialProto serialProto;
+#if IRGW_WEB
 WebServerControl webServerControl;
+#endif
 bool networking_enabled = false;
 
+/**
+ * @brief The time in ms a connect may take before the network task starts 
+ * over.
+ */
+#define WIFI_CONNECT_TIMEOUT        30000
+
+/**
+ * @brief millis() of a pending connect, 0 if there is none.
+ */
+uint32_t wifi_connect = 0;
+
+/**
+ * @brief True if SSID and password are set.
+ */
+bool wifi_credentials = false;
+
+/**
+ * @brief Set by changed WiFi and IP parameters, loop() reconnects once for 
+ * all of them.
+ */
+bool wifi_reconnect = false;
+
 CLI_COMMAND(ver) {
     Serial.printf("\n%s\n", getVersionString().c_str());
     return 0;
 }
 
 CLI_COMMAND(info) {
+    IRControl::Snapshot_t ir;
+    IRControl::RxStats_t &rxStats = ir.rx;
+
+    irControl.getSnapshot(ir);
     Serial.printf("ESP32:\n");
     Serial.printf("  Chip:          %s Rev %d\n", ESP.getChipModel(), ESP.getChipRevision());
     Serial.printf("  CPU's:         %u @ %uMHz\n", ESP.getChipCores(), ESP.getCpuFreqMHz());
@@ -71,20 +128,53 @@ CLI_COMMAND(info) {
     Serial.printf("  NTP:\n");
     Serial.printf("    Server:      %s\n", Parameter.data.ntp.server);
     Serial.printf("    Timezone:    %s\n", Parameter.data.ntp.timezone);
+    Serial.printf("  TX:\n");
+    Serial.printf("    Coalesce:    %ums%s\n", Parameter.data.tx.coalesce, Parameter.data.tx.sumRepeat ? ", sum repeats" : "");
+    Serial.printf("  Relay:\n");
+    Serial.printf("    URL:         %s\n", Parameter.data.relay.url);
+    Serial.printf("  Loop:\n");
+    Serial.printf("    Stall:       %ums%s\n", Parameter.data.loop.stall, 
+            Parameter.data.loop.stall == 0 ? " (default)" : "");
+    Serial.printf("    Watchdog:    %us\n", Parameter.data.loop.wdt);
     Serial.printf("\n");
     Serial.printf("IR:\n");
     Serial.printf("  Tx Data:\n");
-    Serial.printf("    Count:       %u\n", irControl.getTxCount());
-    Serial.printf("    Last:        %s\n", irControl.getLastTx().c_str());
+    Serial.printf("    Count:       %u\n", ir.numTx);
+    Serial.printf("    Coalesced:   %u\n", txCoalescer.getCoalescedCount());
+    Serial.printf("    Last:        %s\n", ir.lastTx);
+    Serial.printf("  Tx Channels:\n");
+    for (uint8_t i = 0; i < IRTX_CHANNELS; i++) {
+        TxScheduler::Stats_t stats = txScheduler.getStats(i);
+        Serial.printf("    Channel %u:   sent %u, airtime %ums, pending %u, peak %u\n", i, 
+                stats.sent, stats.airtime, stats.pending, stats.peak);
+    }
     Serial.printf("  Rx Data:\n");
-    Serial.printf("    Count:       %u\n", irControl.getRxCount());
-    Serial.printf("    Last:        %s\n", irControl.getLastRx().c_str());
+    Serial.printf("    Count:       %u\n", ir.numRx);
+    Serial.printf("    Filtered:    %u\n", rxStats.filtered);
+    Serial.printf("    Decode:      avg %uus, max %uus\n", 
+            rxStats.decoded ? rxStats.decodeTime / rxStats.decoded : 0, rxStats.decodeMax);
+    Serial.printf("    Last:        %s\n", ir.lastRx);
+    Serial.printf("  Code DB:       %s", irDb.getStatsString().c_str());
     Serial.printf("\n");
     Serial.printf("Network:\n");
     Serial.printf("  WiFi Status:   %s\n", WiFi.isConnected() ? "Connected" : "Connecting ...");
     Serial.printf("  WiFi IP:       %s\n", WiFi.localIP().toString().c_str());
     Serial.printf("  WiFi RSSI:     %ddBm\n", WiFi.RSSI());
+#if IRGW_WEB
     Serial.printf("  Homepage:      http://%s.local\n", Parameter.data.ip.hostname);
+#endif
+    Serial.printf("\n");
+    Serial.printf("Loop:\n");
+    Serial.print(loopMonitor.getStatsString());
+    Serial.printf("\n");
+    Serial.printf("Heap:\n");
+    Serial.print(heapMonitor.getStatsString());
+#if IRGW_WEB
+    Serial.print(webServerControl.getArena().getStatsString());
+#endif
+    Serial.printf("\n");
+    Serial.printf("Boot:\n");
+    Serial.print(bootProfile.getString());
     Serial.printf("\n");
     return 0;
 }
@@ -95,15 +185,98 @@ CLI_COMMAND(help) {
     Serial.printf("  param cmd ...                  Parameter control, supported commands:\n");
     Serial.printf("    clear                        Resets all values to default.\n");
     Serial.printf("    write                        Paste all values at once to the terminal.\n");
-    Serial.printf("    set [name]                   Set a single value. use without a name to\n"); 
+    Serial.printf("    set [name] [value]           Set a single value. use without a name to\n"); 
     Serial.printf("                                 see the list of supported names.\n");
-    Serial.printf("    save                         Write the parameter values to the flash.\n");
+    Serial.printf("    get                          Show all values.\n");
+    Serial.printf("    apply                        Apply changed values without a reboot.\n");
+    Serial.printf("    save                         Write the changed values to the flash and apply them.\n");
+    Serial.printf("    stats                        Show load and write statistics of the store.\n");
+    Serial.printf("  dev cmd ...                    Device control, supported commands:\n");
+    Serial.printf("    list                         Lists all configured devices.\n");
+    Serial.printf("    set idx name type match mask gap settle [coalesce]\n");
+    Serial.printf("                                 Configures a device, commands match if\n");
+    Serial.printf("                                 (code & mask) == match. gap is the min.\n");
+    Serial.printf("                                 time in ms between identical commands,\n");
+    Serial.printf("                                 settle between different commands.\n");
+    Serial.printf("                                 coalesce overrides the TX coalescing\n");
+    Serial.printf("                                 window of the device in ms.\n");
+    Serial.printf("    route idx channel            Sets the transmit channel of a device.\n");
+    Serial.printf("    del idx                      Removes a device.\n");
+    Serial.printf("    state                        Shows the tracked device states.\n");
+    Serial.printf("  cat cmd ...                    Catalog control, supported commands:\n");
+    Serial.printf("    list                         Lists all catalog entries.\n");
+    Serial.printf("    set idx name type code [effect] [value]\n");
+    Serial.printf("                                 Adds a command to the catalog. effect is\n");
+    Serial.printf("                                 none, on, off, toggle or input, the input\n");
+    Serial.printf("                                 effect requires the input number as value.\n");
+    Serial.printf("    route idx channel|device     Sets the transmit channel of a command.\n");
+    Serial.printf("    del idx                      Removes a catalog entry.\n");
+    Serial.printf("  relay cmd ...                  Relay rules, supported commands:\n");
+    Serial.printf("    list                         Lists all rules and their hits.\n");
+    Serial.printf("    set idx type code action target [debounce] [hold]\n");
+    Serial.printf("                                 Relays a received command. action is tx\n");
+    Serial.printf("                                 or macro with type:code:repeat[:pause]\n");
+    Serial.printf("                                 [@ch] commands as target, separated by\n");
+    Serial.printf("                                 comma, or event with an event name sent\n");
+    Serial.printf("                                 to relay-url. debounce in ms, hold 1 to\n");
+    Serial.printf("                                 repeat while the button is held.\n");
+    Serial.printf("    del idx                      Removes a rule.\n");
+    Serial.printf("    stats                        Shows hits and the RX to TX latency.\n");
+#if IRGW_AC
+    Serial.printf("  ac cmd ...                     Air conditioner control, supported commands:\n");
+    Serial.printf("    list                         Lists all configured units.\n");
+    Serial.printf("    set idx name type [model] [ch]\n");
+    Serial.printf("                                 Configures a unit using a state based\n");
+    Serial.printf("                                 protocol supported by IRac.\n");
+    Serial.printf("    del idx                      Removes a unit.\n");
+    Serial.printf("    state                        Shows the state of all units.\n");
+#endif
+    Serial.printf("  timer cmd ...                  Timers, supported commands:\n");
+    Serial.printf("    list                         Lists all timers and their next expiry.\n");
+    Serial.printf("    set idx mode time target [days]\n");
+    Serial.printf("                                 Sends the commands of target, in the\n");
+    Serial.printf("                                 format of relay macros, in time seconds,\n");
+    Serial.printf("                                 at or daily at time HH:MM or every time\n");
+    Serial.printf("                                 seconds. days limits daily timers to the\n");
+    Serial.printf("                                 given weekdays, e.g. 12345, 0 is Sunday.\n");
+    Serial.printf("    del idx                      Cancels a timer.\n");
+    Serial.printf("  learn cmd ...                  Learn mode, supported commands:\n");
+    Serial.printf("    name [count]                 Learns a code by averaging count presses\n");
+    Serial.printf("                                 of a button, default is 3. Send it via\n");
+    Serial.printf("                                 tx raw name.\n");
+    Serial.printf("    list                         Shows the status and learned codes.\n");
+    Serial.printf("    del name                     Removes a learned code.\n");
+    Serial.printf("    cancel                       Stops learning.\n");
+    Serial.printf("  irdb cmd ...                   Code database, supported commands:\n");
+    Serial.printf("    stats                        Shows the size and lookup counters.\n");
+    Serial.printf("    list [device]                Lists the devices or their commands.\n");
+    Serial.printf("    find device/function         Shows a command, send it via tx db name.\n");
+    Serial.printf("    code type code               Finds the name of a code.\n");
     Serial.printf("  networking [1/0/on/off]        Disables or Enables networking at all.\n");
     Serial.printf("  reset                          Resets the CPU.\n");
-    Serial.printf("  tx [type] code [repeat]        Transmits a IR Code \n");
+    Serial.printf("  tx [type] code [repeat] [ch] [force]\n");
+    Serial.printf("                                 Queues a IR Code like /tx.\n");
     Serial.printf("                                 type .. optional, ir code, default = NEC\n");
     Serial.printf("                                 code .. the code to send, hex or dec.\n");
     Serial.printf("                                 repeat .. optional, number of Repetitions\n");
+    Serial.printf("                                 ch .. optional, transmit channel\n");
+    Serial.printf("                                 force .. send even if the device state\n");
+    Serial.printf("                                 would not change.\n");
+    Serial.printf("                                 type db sends device/function of the\n");
+    Serial.printf("                                 code database.\n");
+    Serial.printf("  tx type:code:repeat[:pause][@ch] [force]\n");
+    Serial.printf("                                 Queues a command in the sequence format,\n");
+    Serial.printf("                                 e.g. to a channel via @ch.\n");
+    Serial.printf("  rx [allow type ...|all]        Shows the receive filter and decode time\n");
+    Serial.printf("                                 or sets the protocols which are processed\n");
+    Serial.printf("                                 when received, unknown allows unknown\n");
+    Serial.printf("                                 codes as needed for learning.\n");
+    Serial.printf("                                 Filtered codes are dropped after\n");
+    Serial.printf("                                 decoding, decode time is unchanged.\n");
+    Serial.printf("                                 The order of the types does not matter.\n");
+    Serial.printf("  proto [baud|stats]             Switches the console to the framed binary\n");
+    Serial.printf("                                 protocol, optionally at another baud rate\n");
+    Serial.printf("                                 up to 5000000. stats shows its counters.\n");
     Serial.printf("  help                           Prints this text.\n"); 
     Serial.printf("\n");
     return 0;
@@ -140,15 +313,136 @@ CLI_COMMAND(networking) {
 }
 
 CLI_COMMAND(tx) {
-    if (argc == 1) {
-        return irControl.transmit("nec", argv[0], "1");
-    } else if (argc == 2) {
-        return irControl.transmit(argv[0], argv[1], "1");
-    } else if (argc == 3) {
-        return irControl.transmit(argv[0], argv[1], argv[2]);
-    } else {
+    char command[128];
+    const char *end = nullptr;
+    decode_type_t type = decode_type_t::UNKNOWN;
+    uint16_t bits = 0;
+    bool force = argc > 1 && strcmp(argv[argc - 1], "force") == 0;
+    TxJob_t job;
+    String message;
+
+    if (force) {
+        argc--;
+    }
+
+    if (argc < 1 || argc > 4) {
+        Serial.printf("Error: Usage: tx [type] code [repeat] [ch] [force]\n");
         return -1;
     }
+
+    /* State based codes can't be queued, they are sent once the channel is idle */
+    if (argc >= 2 && irControl.parseType(argv[0], type, bits) != nullptr && hasACState(type)) {
+        int ch = argc == 4 ? atoi(argv[3]) : 0;
+
+        if (ch < 0 || ch >= IRTX_CHANNELS) {
+            Serial.printf("Error: Invalid channel, valid range is 0 to %u\n", IRTX_CHANNELS - 1);
+            return -1;
+        }
+        if (!txScheduler.isIdle(ch) || irControl.isBusy(ch)) {
+            Serial.printf("Error: Channel %d is busy.\n", ch);
+            return -1;
+        }
+        return irControl.transmit(argv[0], argv[1], argc >= 3 ? argv[2] : "1", 
+                argc == 4 ? argv[3] : nullptr);
+    }
+
+    /* Either a single command in the sequence format or its parts */
+    if (argc == 1 && strchr(argv[0], ':') != nullptr) {
+        snprintf(command, sizeof(command), "%s", argv[0]);
+    } else if (snprintf(command, sizeof(command), "%s:%s:%s%s%s", argc >= 2 ? argv[0] : "nec", 
+            argv[argc >= 2 ? 1 : 0], argc >= 3 ? argv[2] : "1", argc == 4 ? "@" : "", 
+            argc == 4 ? argv[3] : "") >= (int) sizeof(command)) {
+        Serial.printf("Error: Command too long.\n");
+        return -1;
+    }
+
+    end = TxScheduler::parseJob(command, job, message);
+    if (end == nullptr) {
+        Serial.print(message);
+        return -1;
+    }
+    if (*end != 0) {
+        Serial.printf("Error: Only one command, use a macro for sequences.\n");
+        return -1;
+    }
+
+    /* Queued like /tx, with the device timing, state skip and channel queue */
+    job.force = force;
+    if (!txScheduler.enqueue(&job, 1)) {
+        Serial.printf("Error: Transmit queue full.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int8_t rx_allow(int argc, char *argv[]) {
+    int16_t protocols[PARAM_MAX_RX_PROTOCOLS] = {0};
+    uint8_t count = 0;
+
+    if (argc > PARAM_MAX_RX_PROTOCOLS + 1) {
+        Serial.printf("Error: Up to %u protocols are supported.\n", PARAM_MAX_RX_PROTOCOLS);
+        return -1;
+    }
+
+    for (uint8_t i = 1; i < argc; i++) {
+        int16_t type = decode_type_t::UNKNOWN;
+        uint8_t pos = 0;
+
+        if (strcasecmp(argv[i], "all") == 0) {
+            memset(protocols, 0, sizeof(protocols));
+            count = 0;
+            break;
+        }
+
+        if (strcasecmp(argv[i], "unknown") != 0) {
+            type = irControl.stringToIRType(argv[i]);
+            if (type == decode_type_t::UNKNOWN) {
+                Serial.printf("Error: Unknown type %s.\n", argv[i]);
+                return -1;
+            }
+        }
+
+        /* A set, the order does not matter as all decoders run anyway */
+        while (pos < count && protocols[pos] < type) {
+            pos++;
+        }
+        if (pos < count && protocols[pos] == type) {
+            continue;
+        }
+        memmove(&protocols[pos + 1], &protocols[pos], (count - pos) * sizeof(protocols[0]));
+        protocols[pos] = type;
+        count++;
+    }
+
+    memcpy(Parameter.data.rx.protocols, protocols, sizeof(protocols));
+    irControl.setRxFilter(protocols, PARAM_MAX_RX_PROTOCOLS);
+    return 0;
+}
+
+CLI_COMMAND(rx) {
+    IRControl::RxStats_t stats = irControl.getRxStats();
+
+    if (argc > 1 && strcmp(argv[0], "allow") == 0) {
+        return rx_allow(argc, argv);
+    }
+
+    Serial.printf("Allowed:  ");
+    if (Parameter.data.rx.protocols[0] == decode_type_t::UNUSED) {
+        Serial.printf("all");
+    }
+    for (uint8_t i = 0; i < PARAM_MAX_RX_PROTOCOLS; i++) {
+        if (Parameter.data.rx.protocols[i] == decode_type_t::UNUSED) {
+            break;
+        }
+        Serial.printf("%s ", typeToString((decode_type_t) Parameter.data.rx.protocols[i]).c_str());
+    }
+    Serial.printf("\n");
+    Serial.printf("Decoded:  %u, filtered %u, repeats %u\n", stats.decoded, stats.filtered, 
+            stats.repeats);
+    Serial.printf("Decode:   avg %uus, max %uus\n", 
+            stats.decoded ? stats.decodeTime / stats.decoded : 0, stats.decodeMax);
+    return 0;
 }
 
 CLI_COMMAND(txlog) {
@@ -162,8 +456,13 @@ CLI_COMMAND(rxlog) {
 }
 
 bool setup_mdns(void) {
+    /* Restarted in place if the hostname changes */
+    mdns.end();
     if (mdns.begin(Parameter.data.ip.hostname)) {
+#if IRGW_WEB
         mdns.addService("http", "tcp", 80);
+#endif
+        bootProfile.mark(BOOT_PHASE_MDNS);
     }
 
     return true;
@@ -173,52 +472,109 @@ bool setup_ntp(void) {
     configTime(0, 0, Parameter.data.ntp.server);
     setenv("TZ", Parameter.data.ntp.timezone, 1);
     tzset();
+    bootProfile.mark(BOOT_PHASE_NTP);
 
     return true;
 }
 
-bool setup_wifi(void) {
-    const uint8_t timeout_sec = 5;
-    uint32_t start = 0;
-    uint32_t ms = 0;
-
-    WIFILED_OFF;
-    Serial.printf("WiFi: Connecting to %s, ", Parameter.data.wifi.ssid);
-    WiFi.mode(WIFI_STA);
+bool config_wifi(void) {
+    IPAddress ipaddr, gateway, netmask, dns1, dns2;
 
-    start = millis(); 
+    if (Parameter.data.ip.dhcp == true) {
+        /* An all zero address switches back to DHCP */
+        return WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    }
 
-    if (Parameter.data.ip.dhcp == false) {
-        IPAddress ipaddr, gateway, netmask, dns1, dns2;
-        ipaddr.fromString((const char*) Parameter.data.ip.ipaddr);
-        gateway.fromString((const char*) Parameter.data.ip.gateway);
-        netmask.fromString((const char*) Parameter.data.ip.netmask);
-        dns1 = gateway; 
-        dns2 = gateway; 
+    ipaddr.fromString((const char*) Parameter.data.ip.ipaddr);
+    gateway.fromString((const char*) Parameter.data.ip.gateway);
+    netmask.fromString((const char*) Parameter.data.ip.netmask);
+    dns1 = gateway; 
+    dns2 = gateway; 
 
-        if (!WiFi.config(ipaddr, gateway, netmask, dns1, dns2)) {
+    if (!WiFi.config(ipaddr, gateway, netmask, dns1, dns2)) {
+        if (!serialProto.isActive()) {
             Serial.println("STA Failed to configure");
-            return false;
         }
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Starts connecting with the current WiFi and IP parameters without 
+ * blocking, loop() finishes the setup once connected.
+ */
+bool setup_wifi(void) {
+    WIFILED_OFF;
+    if (!serialProto.isActive()) {
+        Serial.printf("WiFi: Connecting to %s\n", Parameter.data.wifi.ssid);
+    }
+    /* Taken by the DHCP client when the station starts */
+    WiFi.setHostname(Parameter.data.ip.hostname);
+    WiFi.mode(WIFI_STA);
+
+    if (!config_wifi()) {
+        return false;
     }
    
     WiFi.begin(Parameter.data.wifi.ssid, Parameter.data.wifi.pass);
-    while (WiFi.status() != WL_CONNECTED) {
-        ms = millis() - start;
-        if(ms > (timeout_sec * 1000)) {
-            Serial.printf("Timeout(%u sec)\n", timeout_sec);
-            return false;
-        }
-    }
+    wifi_connect = millis() | 1;
+
+    return true;
+}
 
-    ms = millis() - start;
-    Serial.printf("%s (%ums)\n", WiFi.localIP().toString().c_str(), ms);
+/**
+ * @brief Sets up the services depending on the network once connected.
+ */
+void finish_wifi(void) {
+    if (!serialProto.isActive()) {
+        Serial.printf("WiFi: %s (%lums)\n", WiFi.localIP().toString().c_str(), 
+            (unsigned long) (millis() - wifi_connect));
+    }
+    wifi_connect = 0;
+    bootProfile.mark(BOOT_PHASE_WIFI);
     setup_mdns();
     setup_ntp();
     randomSeed(micros()); 
     WIFILED_ON;
+}
 
-    return true;
+/**
+ * @brief Reconnects with changed WiFi and IP parameters.
+ * The station is restarted, the DHCP client only sends the hostname on start.
+ */
+void reconnect_wifi(void) {
+    WiFi.disconnect();
+    WiFi.mode(WIFI_OFF);
+    setup_wifi();
+}
+
+void apply_wifi(void) {
+    bool valid = Parameter.data.wifi.ssid[0] != 0 && Parameter.data.wifi.pass[0] != 0;
+
+    /* Networking has been off for lack of credentials so far */
+    if (valid && !wifi_credentials) {
+        networking_enabled = true;
+    }
+    wifi_credentials = valid;
+    wifi_reconnect = true;
+}
+
+void apply_ip(void) {
+    wifi_reconnect = true;
+}
+
+void apply_ntp(void) {
+    setup_ntp();
+    if (!serialProto.isActive()) {
+        Serial.printf("NTP: %s, %s\n", Parameter.data.ntp.server, 
+            Parameter.data.ntp.timezone);
+    }
+}
+
+void apply_loop(void) {
+    loopMonitor.begin();
 }
 
 void setup(void) {
@@ -229,38 +585,92 @@ void setup(void) {
     pinMode(WIFILED_PIN, OUTPUT);
     WIFILED_OFF;
 
-    Serial.begin(115200);
+    /* Room for several frames of the binary protocol */
+    Serial.setRxBufferSize(SERPROTO_RX_BUFFER);
+    Serial.begin(SERPROTO_CLI_BAUD);
     Serial.println();
     cmd_ver(Serial, 0, 0);
 
-    if(Parameter.begin() != true) {
+    if(Parameter.begin() != true && param_import() != 0) {
         Serial.printf("Error: Invalid parameters.\n");
         param_clear();
     }
+    bootProfile.mark(BOOT_PHASE_PARAM);
+
+    Parameter.subscribe("wifi", apply_wifi);
+    Parameter.subscribe("ip", apply_ip);
+    Parameter.subscribe("ntp", apply_ntp);
+    Parameter.subscribe("loop", apply_loop);
 
-    if (Parameter.data.wifi.ssid[0] != 0 && Parameter.data.wifi.pass[0] != 0) {
+    /* IR and the CLI first, the network comes up in the background */
+    heapMonitor.begin();
+    loopMonitor.begin();
+    upTime.begin();
+    relayEngine.begin();
+    irDb.begin();
+    irControl.begin();
+    bootProfile.mark(BOOT_PHASE_IR);
+    cli.begin();
+    bootProfile.mark(BOOT_PHASE_CLI);
+
+    wifi_credentials = Parameter.data.wifi.ssid[0] != 0 && Parameter.data.wifi.pass[0] != 0;
+    if (wifi_credentials) {
         networking_enabled = true;
         setup_wifi();
     }
+    bootProfile.mark(BOOT_PHASE_NETWORK);
 
+#if IRGW_WEB
     webServerControl.begin();
-    upTime.begin();
-    irControl.begin();
-    cli.begin();
+#endif
+    bootProfile.mark(BOOT_PHASE_SERVER);
+    bootProfile.mark(BOOT_PHASE_SETUP);
 }
 
 void loop(void) {
+    uint32_t start = micros();
     uint32_t now = millis();
 
+    if (wifi_reconnect) {
+        wifi_reconnect = false;
+        if (networking_enabled) {
+            LOOPMON_CALL(LOOP_SITE_NETWORK, reconnect_wifi());
+        }
+    }
+
+    if (wifi_connect != 0 && WiFi.isConnected()) {
+        LOOPMON_CALL(LOOP_SITE_NETWORK, finish_wifi());
+    }
+
     if (networkTask.isScheduled(now) && networking_enabled) {
-        if (WiFi.status() != WL_CONNECTED) {
+        if (WiFi.status() != WL_CONNECTED && (wifi_connect == 0 || 
+            now - wifi_connect > WIFI_CONNECT_TIMEOUT)) {
             WiFi.disconnect();
-            setup_wifi();
+            LOOPMON_CALL(LOOP_SITE_NETWORK, setup_wifi());
         }
     }
 
-    irControl.handleReceive();
-    webServerControl.handleClient();
-    upTime.loop();
-    cli.loop();
+    if (timerTask.isScheduled(now)) {
+        LOOPMON_CALL(LOOP_SITE_TIMER, timerWheel.tick());
+        heapMonitor.sample();
+        if (!bootProfile.reached(BOOT_PHASE_TIME) && timerWheel.isSynced()) {
+            bootProfile.mark(BOOT_PHASE_TIME);
+        }
+    }
+
+    LOOPMON_CALL(LOOP_SITE_RECEIVE, irControl.handleReceive());
+    LOOPMON_CALL(LOOP_SITE_SCHEDULER, txScheduler.loop());
+#if IRGW_AC
+    LOOPMON_CALL(LOOP_SITE_AC, acControl.loop());
+#endif
+#if IRGW_WEB
+    LOOPMON_CALL(LOOP_SITE_SERVER, webServerControl.handleClient());
+#endif
+    LOOPMON_CALL(LOOP_SITE_UPTIME, upTime.loop());
+    if (serialProto.isActive()) {
+        LOOPMON_CALL(LOOP_SITE_CLI, serialProto.loop());
+    } else {
+        LOOPMON_CALL(LOOP_SITE_CLI, cli.loop());
+    }
+    loopMonitor.endLoop(start);
 }
@@ -0,0 +1,143 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+/*
+ * Minimal host replacement of the Arduino core for the native unit tests, 
+ * only what the tested libraries use.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <strings.h>
+#include <time.h>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#define HEX                 16
+#define DEC                 10
+#define INPUT               1
+#define OUTPUT              2
+#define LOW                 0
+#define HIGH                1
+#define PROGMEM
+#define IRAM_ATTR
+
+using std::min;
+using std::max;
+
+class String {
+    public:
+
+        String() {}
+        String(const char *str) : s(str != nullptr ? str : "") {}
+        String(const std::string &str) : s(str) {}
+        String(char c) : s(1, c) {}
+        String(int val) : s(std::to_string(val)) {}
+        String(unsigned int val) : s(std::to_string(val)) {}
+        String(long val) : s(std::to_string(val)) {}
+        String(unsigned long val) : s(std::to_string(val)) {}
+
+        const char* c_str() const { return s.c_str(); }
+        unsigned int length() const { return s.size(); }
+        void clear() { s.clear(); }
+        bool reserve(unsigned int size) { s.reserve(size); return true; }
+        bool concat(const char *str, unsigned int len) { s.append(str, len); return true; }
+        String& operator+=(const String &str) { s += str.s; return *this; }
+        String& operator+=(const char *str) { s += str; return *this; }
+        String& operator+=(char c) { s += c; return *this; }
+        bool operator==(const char *str) const { return s == str; }
+        bool operator==(const String &str) const { return s == str.s; }
+        bool operator!=(const char *str) const { return s != str; }
+        char operator[](unsigned int idx) const { return s[idx]; }
+
+        std::string s;
+};
+
+inline String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+inline String operator+(const String &a, const char *b) { return String(a.s + b); }
+inline String operator+(const char *a, const String &b) { return String(a + b.s); }
+
+class Stream {
+    public:
+
+        int printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+            va_list args;
+            va_start(args, fmt);
+            int ret = vprintf(fmt, args);
+            va_end(args);
+            return ret;
+        }
+        size_t print(const char *str) { return fputs(str, stdout) >= 0 ? strlen(str) : 0; }
+        size_t print(const String &str) { return print(str.c_str()); }
+        size_t println(const char *str = "") { return print(str) + print("\n"); }
+        size_t write(const uint8_t *buf, size_t len) { return fwrite(buf, 1, len, stdout); }
+        int available() { return 0; }
+        int read() { return -1; }
+        void flush() { fflush(stdout); }
+};
+
+class HardwareSerial : public Stream {
+    public:
+
+        void begin(unsigned long baud) { (void) baud; }
+        void updateBaudRate(unsigned long baud) { (void) baud; }
+};
+
+inline HardwareSerial Serial;
+
+inline unsigned long micros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(unsigned int us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+inline void yield() { std::this_thread::yield(); }
+inline void pinMode(uint8_t pin, uint8_t mode) { (void) pin; (void) mode; }
+inline void digitalWrite(uint8_t pin, uint8_t val) { (void) pin; (void) val; }
+inline int digitalRead(uint8_t pin) { (void) pin; return LOW; }
+
+/* Time is never synced on the host */
+inline bool getLocalTime(struct tm *info, uint32_t ms = 5000) { (void) info; (void) ms; return false; }
+
+class EspClass {
+    public:
+
+        uint32_t getCpuFreqMHz() { return 240; }
+        uint32_t getCycleCount() { return micros() * getCpuFreqMHz(); }
+};
+
+inline EspClass ESP;
+
+typedef uint32_t TickType_t;
+
+#define portMAX_DELAY       0xFFFFFFFF
+#define taskYIELD()         std::this_thread::yield()
@@ -0,0 +1,51 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+/*
+ * Host replacement of IRremoteESP8266, the protocol numbers match the 
+ * library, only the protocols used by the tests are listed.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum decode_type_t {
+    UNKNOWN = -1,
+    UNUSED = 0,
+    RC5,
+    RC6,
+    NEC,
+    SONY,
+    PANASONIC,
+    JVC,
+    SAMSUNG,
+    NEC_LIKE = 26,
+    RAW = 30,
+    SAMSUNG36 = 56,
+    kLastDecodeType = 127
+};
+
+const uint16_t kStateSizeMax = 53;
+const uint16_t kNECBits = 32;
+const uint16_t kSamsungBits = 32;
+const uint16_t kSonyBits = 12;
+const uint16_t kNoRepeat = 0;
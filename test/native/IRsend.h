@@ -0,0 +1,60 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+/*
+ * Host replacement of the IRsend class, nothing is sent.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "IRremoteESP8266.h"
+
+class IRsend {
+    public:
+
+        explicit IRsend(uint16_t pin) { (void) pin; }
+        void begin() {}
+        bool send(decode_type_t type, uint64_t code, uint16_t bits, uint16_t repeat = kNoRepeat) {
+            (void) code; (void) bits; (void) repeat;
+            return defaultBits(type) != 0;
+        }
+        bool send(decode_type_t type, const uint8_t *state, uint16_t nbytes) {
+            (void) type; (void) state; (void) nbytes;
+            return false;
+        }
+        void sendRaw(const uint16_t *buf, uint16_t len, uint16_t khz) { (void) buf; (void) len; (void) khz; }
+
+        static uint16_t defaultBits(decode_type_t type) {
+            switch (type) {
+                case NEC:
+                case NEC_LIKE:
+                    return kNECBits;
+                case SAMSUNG:
+                    return kSamsungBits;
+                case SONY:
+                    return kSonyBits;
+                default:
+                    return 0;
+            }
+        }
+};
@@ -0,0 +1,58 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+/*
+ * Host replacement of the IRremoteESP8266 utilities, only the protocols of
+ * IRremoteESP8266.h are known.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <IRremoteESP8266.h>
+
+inline String typeToString(const decode_type_t protocol, const bool isRepeat = false) {
+    static const struct { decode_type_t type; const char *name; } names[] = {
+        {RC5, "RC5"}, {RC6, "RC6"}, {NEC, "NEC"}, {SONY, "SONY"}, {PANASONIC, "PANASONIC"},
+        {JVC, "JVC"}, {SAMSUNG, "SAMSUNG"}, {NEC_LIKE, "NEC_LIKE"}, {RAW, "RAW"}, 
+        {SAMSUNG36, "SAMSUNG36"}
+    };
+
+    for (const auto &entry : names) {
+        if (entry.type == protocol) {
+            return String(entry.name) + (isRepeat ? " (Repeat)" : "");
+        }
+    }
+
+    return "UNKNOWN";
+}
+
+inline decode_type_t strToDecodeType(const char *str) {
+    for (int type = RC5; type <= SAMSUNG36; type++) {
+        String name = typeToString((decode_type_t) type);
+
+        if (name != "UNKNOWN" && strcasecmp(name.c_str(), str) == 0) {
+            return (decode_type_t) type;
+        }
+    }
+
+    return UNKNOWN;
+}
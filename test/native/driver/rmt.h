@@ -0,0 +1,89 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+/*
+ * Host replacement of the ESP-IDF RMT driver, written items are recorded in
+ * rmtMockItems.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+typedef int esp_err_t;
+
+#define ESP_OK              0
+#define ESP_ERR_TIMEOUT     0x107
+#define APB_CLK_FREQ        80000000
+
+typedef enum { RMT_CHANNEL_0, RMT_CHANNEL_1, RMT_CHANNEL_2, RMT_CHANNEL_3 } rmt_channel_t;
+typedef enum { GPIO_NUM_0 } gpio_num_t;
+typedef enum { RMT_MODE_TX, RMT_MODE_RX } rmt_mode_t;
+typedef enum { RMT_CARRIER_LEVEL_LOW, RMT_CARRIER_LEVEL_HIGH } rmt_carrier_level_t;
+typedef enum { RMT_IDLE_LEVEL_LOW, RMT_IDLE_LEVEL_HIGH } rmt_idle_level_t;
+
+typedef struct {
+    uint32_t duration0 :15;
+    uint32_t level0 :1;
+    uint32_t duration1 :15;
+    uint32_t level1 :1;
+} rmt_item32_t;
+
+typedef struct {
+    uint32_t carrier_freq_hz;
+    rmt_carrier_level_t carrier_level;
+    rmt_idle_level_t idle_level;
+    uint8_t carrier_duty_percent;
+    bool carrier_en;
+    bool loop_en;
+    bool idle_output_en;
+} rmt_tx_config_t;
+
+typedef struct {
+    rmt_mode_t rmt_mode;
+    rmt_channel_t channel;
+    gpio_num_t gpio_num;
+    uint8_t clk_div;
+    uint8_t mem_block_num;
+    uint32_t flags;
+    rmt_tx_config_t tx_config;
+} rmt_config_t;
+
+#define RMT_DEFAULT_CONFIG_TX(gpio, channel_id) \
+    { RMT_MODE_TX, channel_id, gpio, 80, 1, 0, {38000, RMT_CARRIER_LEVEL_HIGH, RMT_IDLE_LEVEL_LOW, 33, false, false, true} }
+
+/* Items of all rmt_write_items() calls, the transmission ends immediately */
+inline std::vector<rmt_item32_t> rmtMockItems;
+inline uint32_t rmtMockWrites = 0;
+
+inline esp_err_t rmt_config(const rmt_config_t *config) { (void) config; return ESP_OK; }
+inline esp_err_t rmt_driver_install(rmt_channel_t channel, size_t size, int flags) { (void) channel; (void) size; (void) flags; return ESP_OK; }
+inline esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait) { (void) channel; (void) wait; return ESP_OK; }
+inline esp_err_t rmt_set_gpio(rmt_channel_t channel, rmt_mode_t mode, gpio_num_t pin, bool invert) { (void) channel; (void) mode; (void) pin; (void) invert; return ESP_OK; }
+inline esp_err_t rmt_set_tx_carrier(rmt_channel_t channel, bool en, uint16_t high, uint16_t low, rmt_carrier_level_t level) { (void) channel; (void) en; (void) high; (void) low; (void) level; return ESP_OK; }
+
+inline esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t *items, int num, bool wait) {
+    (void) channel; (void) wait;
+    rmtMockItems.insert(rmtMockItems.end(), items, items + num);
+    rmtMockWrites++;
+    return ESP_OK;
+}
@@ -0,0 +1,93 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+/*
+ * Host replacement of the ESP-IDF partition API, a single data partition 
+ * holds the bytes of partitionMockData and is "mapped" in place.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+typedef int esp_err_t;
+
+#define ESP_OK              0
+#define ESP_FAIL            -1
+
+typedef enum { ESP_PARTITION_TYPE_APP = 0, ESP_PARTITION_TYPE_DATA = 1 } esp_partition_type_t;
+typedef int esp_partition_subtype_t;
+typedef uint32_t spi_flash_mmap_handle_t;
+typedef enum { SPI_FLASH_MMAP_DATA, SPI_FLASH_MMAP_INST } spi_flash_mmap_memory_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+inline std::vector<uint8_t> partitionMockData;
+inline esp_partition_t partitionMock;
+inline uint32_t partitionMockMaps = 0;
+
+inline const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, 
+        esp_partition_subtype_t subtype, const char *label) {
+    if (partitionMockData.empty()) {
+        return nullptr;
+    }
+
+    partitionMock.type = type;
+    partitionMock.subtype = subtype;
+    partitionMock.size = partitionMockData.size();
+    strncpy(partitionMock.label, label, sizeof(partitionMock.label) - 1);
+
+    return &partitionMock;
+}
+
+inline esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t size) {
+    if (offset + size > part->size) {
+        return ESP_FAIL;
+    }
+
+    memcpy(dst, partitionMockData.data() + offset, size);
+    return ESP_OK;
+}
+
+inline esp_err_t esp_partition_mmap(const esp_partition_t *part, size_t offset, size_t size, 
+        spi_flash_mmap_memory_t memory, const void **out, spi_flash_mmap_handle_t *handle) {
+    (void) memory;
+    if (offset + size > part->size) {
+        return ESP_FAIL;
+    }
+
+    *out = partitionMockData.data() + offset;
+    *handle = ++partitionMockMaps;
+    return ESP_OK;
+}
+
+inline void spi_flash_munmap(spi_flash_mmap_handle_t handle) {
+    (void) handle;
+    partitionMockMaps--;
+}
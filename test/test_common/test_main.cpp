@@ -0,0 +1,139 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include <unity.h>
+
+#include <IRremoteESP8266.h>
+
+#include "common.hpp"
+
+static String stateToString(const uint8_t *state, uint16_t len) {
+    String str = "0x";
+
+    for (uint16_t i = 0; i < len; i++) {
+        char buf[3];
+
+        snprintf(buf, sizeof(buf), "%02X", state[i]);
+        str += buf;
+    }
+
+    return str;
+}
+
+void setUp(void) {
+
+}
+
+void tearDown(void) {
+
+}
+
+void test_code_max_width(void) {
+    const char *end = nullptr;
+    uint64_t code = 0;
+
+    TEST_ASSERT_EQUAL_STRING("0xFFFFFFFFFFFFFFFF", codeToString(UINT64_MAX).c_str());
+    end = parseCode("0xFFFFFFFFFFFFFFFF:0", code);
+    TEST_ASSERT_NOT_NULL(end);
+    TEST_ASSERT_EQUAL(':', *end);
+    TEST_ASSERT_TRUE(code == UINT64_MAX);
+
+    /* 17 digits do not fit */
+    TEST_ASSERT_NULL(parseCode("0x1FFFFFFFFFFFFFFFF", code));
+    TEST_ASSERT_NULL(parseCode("0x", code));
+}
+
+void test_code_decimal(void) {
+    uint64_t code = 0;
+
+    TEST_ASSERT_NOT_NULL(parseCode("18446744073709551615", code));
+    TEST_ASSERT_TRUE(code == UINT64_MAX);
+    TEST_ASSERT_NULL(parseCode("18446744073709551616", code));
+    TEST_ASSERT_NULL(parseCode("99999999999999999999", code));
+    TEST_ASSERT_NOT_NULL(parseCode("0", code));
+    TEST_ASSERT_TRUE(code == 0);
+}
+
+void test_code_round_trip(void) {
+    uint64_t value = 0x123456789ABCDEF1ULL;
+
+    TEST_ASSERT_EQUAL_STRING("0x0", codeToString(0).c_str());
+
+    /* Every width from 1 to 64 bit */
+    for (uint8_t bits = 1; bits <= 64; bits++) {
+        uint64_t code = bits == 64 ? value : value & ((1ULL << bits) - 1);
+        uint64_t parsed = ~code;
+        String str = codeToString(code);
+        const char *end = parseCode(str.c_str(), parsed);
+
+        TEST_ASSERT_NOT_NULL(end);
+        TEST_ASSERT_EQUAL(0, *end);
+        TEST_ASSERT_TRUE(parsed == code);
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+}
+
+void test_state_max_width(void) {
+    uint8_t state[kStateSizeMax];
+    uint8_t parsed[kStateSizeMax];
+    const char *end = nullptr;
+    String str;
+
+    for (uint16_t i = 0; i < sizeof(state); i++) {
+        state[i] = 0xFF - i * 7;
+    }
+    str = stateToString(state, sizeof(state));
+
+    memset(parsed, 0, sizeof(parsed));
+    TEST_ASSERT_EQUAL(kStateSizeMax, parseState(str.c_str(), parsed, sizeof(parsed), &end));
+    TEST_ASSERT_EQUAL_MEMORY(state, parsed, sizeof(state));
+    TEST_ASSERT_EQUAL(0, *end);
+    TEST_ASSERT_EQUAL_STRING(str.c_str(), stateToString(parsed, sizeof(parsed)).c_str());
+
+    /* One byte more than the buffer */
+    str += "00";
+    TEST_ASSERT_EQUAL(-1, parseState(str.c_str(), parsed, sizeof(parsed), &end));
+}
+
+void test_state_format(void) {
+    uint8_t state[4];
+    const char *end = nullptr;
+
+    TEST_ASSERT_EQUAL(2, parseState("0xa1B2:3", state, sizeof(state), &end));
+    TEST_ASSERT_EQUAL_HEX8(0xA1, state[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xB2, state[1]);
+    TEST_ASSERT_EQUAL(':', *end);
+
+    /* Odd number of digits, missing prefix, no digits */
+    TEST_ASSERT_EQUAL(-1, parseState("0xA1B", state, sizeof(state)));
+    TEST_ASSERT_EQUAL(-1, parseState("A1B2", state, sizeof(state)));
+    TEST_ASSERT_EQUAL(-1, parseState("0x", state, sizeof(state)));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_code_max_width);
+    RUN_TEST(test_code_decimal);
+    RUN_TEST(test_code_round_trip);
+    RUN_TEST(test_state_max_width);
+    RUN_TEST(test_state_format);
+    return UNITY_END();
+}
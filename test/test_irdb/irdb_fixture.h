@@ -0,0 +1,76 @@
+/* Generated by tools/test_irdb.py from test/test_irdb/data, do not edit. */
+
+#pragma once
+
+#include <stdint.h>
+
+/* 1072 bytes */
+alignas(8) static const uint8_t irdbFixture[] = {
+    0x49, 0x52, 0x44, 0x42, 0x01, 0x00, 0x28, 0x00, 0x30, 0x04, 0x00, 0x00, 0x5a, 0xb7, 0x9f, 0xf5,
+    0x11, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0xc0, 0x01, 0x00, 0x00, 0xe8, 0x01, 0x00, 0x00,
+    0x70, 0x02, 0x00, 0x00, 0x78, 0x03, 0x00, 0x00, 0xf6, 0x09, 0xaa, 0xc1, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00,
+    0x1e, 0x00, 0x06, 0x00, 0x24, 0x00, 0x00, 0x00, 0xdd, 0x22, 0xdf, 0x20, 0x00, 0x00, 0x00, 0x00,
+    0x1d, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xef, 0x10, 0xdf, 0x20, 0x00, 0x00, 0x00, 0x00, 0x1d, 0x00, 0x00, 0x00, 0x2b, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2f, 0xd0, 0xdf, 0x20, 0x00, 0x00, 0x00, 0x00,
+    0x35, 0x00, 0x00, 0x00, 0x3b, 0x00, 0x00, 0x00, 0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x8c, 0x73, 0xdf, 0x20, 0x00, 0x00, 0x00, 0x00, 0x35, 0x00, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0xcc, 0x33, 0xdf, 0x20, 0x00, 0x00, 0x00, 0x00,
+    0x35, 0x00, 0x00, 0x00, 0x54, 0x00, 0x00, 0x00, 0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x68, 0x97, 0xdf, 0x20, 0x00, 0x00, 0x00, 0x00, 0x35, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0xdd, 0x22, 0xdf, 0x20, 0x00, 0x00, 0x00, 0x00,
+    0x35, 0x00, 0x00, 0x00, 0x6c, 0x00, 0x00, 0x00, 0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x5c, 0xa3, 0xdf, 0x20, 0x00, 0x00, 0x00, 0x00, 0x35, 0x00, 0x00, 0x00, 0x6f, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0xdc, 0x23, 0xdf, 0x20, 0x00, 0x00, 0x00, 0x00,
+    0x35, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xef, 0x10, 0xdf, 0x20, 0x00, 0x00, 0x00, 0x00, 0x35, 0x00, 0x00, 0x00, 0x79, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x86, 0x00, 0x00, 0x00, 0x2b, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x64, 0x00, 0x25, 0x00, 0x00, 0x00,
+    0x0c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x00, 0x00, 0x00, 0x2b, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x98, 0x00, 0x00, 0x00, 0xa2, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x06, 0x00, 0x24, 0x00, 0x00, 0x00,
+    0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x98, 0x00, 0x00, 0x00, 0xa8, 0x00, 0x00, 0x00,
+    0x1e, 0x00, 0x12, 0x00, 0x24, 0x00, 0x00, 0x00, 0x90, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xb0, 0x00, 0x00, 0x00, 0x2b, 0x00, 0x00, 0x00, 0x04, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0d, 0x00, 0x03, 0x00, 0x0b, 0x00, 0x02, 0x00, 0x08, 0x00, 0x0a, 0x00, 0x06, 0x00, 0x05, 0x00,
+    0x07, 0x00, 0x09, 0x00, 0x04, 0x00, 0x00, 0x00, 0x10, 0x00, 0x01, 0x00, 0x0c, 0x00, 0x0e, 0x00,
+    0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x23, 0x26, 0xcc, 0x03, 0x03, 0x00, 0x00, 0x00,
+    0xc6, 0xa5, 0x75, 0x24, 0x08, 0x00, 0x00, 0x00, 0xef, 0xed, 0xc4, 0x3b, 0x0c, 0x00, 0x00, 0x00,
+    0xeb, 0xbd, 0xd0, 0x48, 0x09, 0x00, 0x00, 0x00, 0x80, 0x05, 0x87, 0x4a, 0x0d, 0x00, 0x00, 0x00,
+    0x85, 0xbf, 0xac, 0x61, 0x00, 0x00, 0x00, 0x00, 0x5b, 0x18, 0xf3, 0x70, 0x10, 0x00, 0x00, 0x00,
+    0x04, 0xf7, 0x21, 0x77, 0x02, 0x00, 0x00, 0x00, 0x96, 0x60, 0x86, 0x8f, 0x0b, 0x00, 0x00, 0x00,
+    0xe2, 0x57, 0x95, 0x90, 0x0f, 0x00, 0x00, 0x00, 0x3c, 0xd2, 0xb3, 0xa4, 0x07, 0x00, 0x00, 0x00,
+    0xcf, 0xd3, 0xb3, 0xa5, 0x06, 0x00, 0x00, 0x00, 0x62, 0xd5, 0xb3, 0xa6, 0x05, 0x00, 0x00, 0x00,
+    0x29, 0xfd, 0xcd, 0xb9, 0x04, 0x00, 0x00, 0x00, 0xab, 0x75, 0xe9, 0xc0, 0x0e, 0x00, 0x00, 0x00,
+    0x6b, 0xc1, 0x7a, 0xd2, 0x01, 0x00, 0x00, 0x00, 0xc7, 0x75, 0x09, 0xf3, 0x0a, 0x00, 0x00, 0x00,
+    0xbc, 0x01, 0x78, 0x03, 0x34, 0x05, 0xbc, 0x01, 0xbc, 0x01, 0xf9, 0x6e, 0xac, 0x0d, 0xd6, 0x06,
+    0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0x14, 0x05, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01,
+    0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01,
+    0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01,
+    0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0x14, 0x05, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01,
+    0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01,
+    0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0x14, 0x05,
+    0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01,
+    0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01,
+    0xb3, 0x01, 0x14, 0x05, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0x14, 0x05, 0xb3, 0x01, 0x14, 0x05,
+    0xb3, 0x01, 0x14, 0x05, 0xb3, 0x01, 0x14, 0x05, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01,
+    0xb3, 0x01, 0x14, 0x05, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0x14, 0x05, 0xb3, 0x01, 0x14, 0x05,
+    0xb3, 0x01, 0x14, 0x05, 0xb3, 0x01, 0x14, 0x05, 0xb3, 0x01, 0xb3, 0x01, 0xb3, 0x01, 0x14, 0x05,
+    0xb3, 0x01, 0xff, 0xff, 0xe8, 0x03, 0xf4, 0x01, 0xe8, 0x03, 0xf4, 0x01, 0xd0, 0x07, 0x40, 0x9c,
+    0x28, 0x23, 0x94, 0x11, 0x30, 0x02, 0x30, 0x02, 0x30, 0x02, 0x30, 0x02, 0x30, 0x02, 0x30, 0x02,
+    0x30, 0x02, 0x30, 0x02, 0x30, 0x02, 0x30, 0x02, 0x30, 0x02, 0x30, 0x02, 0x30, 0x02, 0x30, 0x02,
+    0x30, 0x02, 0x30, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x45, 0x70, 0x73, 0x6f, 0x6e, 0x5f, 0x42,
+    0x65, 0x61, 0x6d, 0x65, 0x72, 0x00, 0x50, 0x6f, 0x77, 0x65, 0x72, 0x5f, 0x4f, 0x6e, 0x00, 0x57,
+    0x65, 0x69, 0x72, 0x64, 0x00, 0x4c, 0x47, 0x5f, 0x41, 0x4b, 0x42, 0x00, 0x4b, 0x45, 0x59, 0x5f,
+    0x4f, 0x4b, 0x00, 0x4b, 0x45, 0x59, 0x5f, 0x50, 0x4f, 0x57, 0x45, 0x52, 0x00, 0x4c, 0x47, 0x5f,
+    0x54, 0x56, 0x00, 0x49, 0x6e, 0x70, 0x75, 0x74, 0x5f, 0x42, 0x75, 0x74, 0x74, 0x6f, 0x6e, 0x00,
+    0x49, 0x6e, 0x70, 0x75, 0x74, 0x5f, 0x48, 0x44, 0x4d, 0x49, 0x31, 0x00, 0x49, 0x6e, 0x70, 0x75,
+    0x74, 0x5f, 0x48, 0x44, 0x4d, 0x49, 0x32, 0x00, 0x49, 0x6e, 0x70, 0x75, 0x74, 0x5f, 0x48, 0x44,
+    0x4d, 0x49, 0x33, 0x00, 0x4f, 0x4b, 0x00, 0x50, 0x6f, 0x77, 0x65, 0x72, 0x5f, 0x4f, 0x66, 0x66,
+    0x00, 0x50, 0x6f, 0x77, 0x65, 0x72, 0x5f, 0x54, 0x6f, 0x67, 0x67, 0x6c, 0x65, 0x00, 0x70, 0x61,
+    0x6e, 0x61, 0x73, 0x6f, 0x6e, 0x69, 0x63, 0x00, 0x70, 0x68, 0x69, 0x6c, 0x69, 0x70, 0x73, 0x00,
+    0x72, 0x61, 0x77, 0x72, 0x65, 0x6d, 0x6f, 0x74, 0x65, 0x00, 0x4b, 0x45, 0x59, 0x5f, 0x41, 0x00,
+    0x4b, 0x45, 0x59, 0x5f, 0x4e, 0x45, 0x43, 0x00, 0x73, 0x6f, 0x6e, 0x79, 0x5f, 0x74, 0x76, 0x00,
+};
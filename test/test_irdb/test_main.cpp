@@ -0,0 +1,245 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include <unity.h>
+
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <random>
+#include <vector>
+
+#include "irdb.hpp"
+#include "irdb_fixture.h"
+
+/**
+ * @brief Number of randomly mutated databases attached by test_mutated.
+ */
+#define MUTATIONS           20000
+
+/* The commands of test/test_irdb/data */
+static const char *names[] = {
+    "Epson_Beamer/Power_On", "Epson_Beamer/Weird", "LG_AKB/KEY_OK", "LG_AKB/KEY_POWER",
+    "LG_TV/Input_Button", "LG_TV/Input_HDMI1", "LG_TV/Input_HDMI2", "LG_TV/Input_HDMI3",
+    "LG_TV/OK", "LG_TV/Power_Off", "LG_TV/Power_On", "LG_TV/Power_Toggle", 
+    "panasonic/KEY_POWER", "philips/KEY_POWER", "rawremote/KEY_A", "rawremote/KEY_NEC",
+    "sony_tv/KEY_POWER"
+};
+
+IRDb irDb;
+
+static std::vector<uint8_t> fixture(void) {
+    return std::vector<uint8_t>(irdbFixture, irdbFixture + sizeof(irdbFixture));
+}
+
+void setUp(void) {
+    TEST_ASSERT_TRUE(irDb.attach(irdbFixture, sizeof(irdbFixture)));
+}
+
+void tearDown(void) {
+    partitionMockData.clear();
+}
+
+void test_attach(void) {
+    TEST_ASSERT_EQUAL(sizeof(names) / sizeof(names[0]), irDb.getCount());
+    TEST_ASSERT_EQUAL_HEX32(0x2475A5C6, IRDb::hash("LG_TV", "OK"));
+    TEST_ASSERT_EQUAL_HEX32(IRDb::hash("lg_tv", "ok"), IRDb::hash("LG_TV", "OK"));
+}
+
+void test_find(void) {
+    const IRDbEntry_t *entry = irDb.find("lg_tv/POWER_ON");
+
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(NEC, entry->type);
+    TEST_ASSERT_EQUAL(32, entry->bits);
+    TEST_ASSERT_TRUE(entry->code == 0x20DF23DCULL);
+    TEST_ASSERT_TRUE(irDb.find("LG_TV", "Power_On") == entry);
+    TEST_ASSERT_EQUAL_STRING("LG_TV/Power_On", irDb.getName(entry).c_str());
+
+    TEST_ASSERT_NULL(irDb.find("LG_TV/Power"));
+    TEST_ASSERT_NULL(irDb.find("LG_TV"));
+    TEST_ASSERT_NULL(irDb.find("/Power_On"));
+    TEST_ASSERT_NULL(irDb.find("AAA/x"));
+    TEST_ASSERT_NULL(irDb.find("zzz/x"));
+}
+
+void test_all_names(void) {
+    for (const char *name : names) {
+        const IRDbEntry_t *entry = irDb.find(name);
+        decode_type_t type = UNKNOWN;
+        uint64_t code = 0;
+        uint16_t bits = 0;
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(entry, name);
+        TEST_ASSERT_EQUAL_STRING(name, irDb.getName(entry).c_str());
+        TEST_ASSERT_TRUE(irDb.findRef(irDb.getRef(entry)) == entry);
+        TEST_ASSERT_NOT_NULL(irDb.findCode((decode_type_t) entry->type, entry->code));
+        TEST_ASSERT_TRUE(irDb.resolve(name, type, code, bits));
+        TEST_ASSERT_EQUAL(entry->type, type);
+    }
+}
+
+void test_find_code(void) {
+    const IRDbEntry_t *entry = irDb.findCode(NEC, 0x20DF10EFULL);
+
+    /* LG_AKB/KEY_POWER and LG_TV/Power_Toggle share the code */
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_TRUE(entry == irDb.find("LG_AKB/KEY_POWER") || 
+            entry == irDb.find("LG_TV/Power_Toggle"));
+    TEST_ASSERT_TRUE(irDb.findCode(NEC, 0x20DF23DCULL) == irDb.find("LG_TV/Power_On"));
+    TEST_ASSERT_TRUE(irDb.findCode(SONY, 0xA90) == irDb.find("sony_tv/KEY_POWER"));
+    TEST_ASSERT_TRUE(irDb.findCode(RC5, 0xC) == irDb.find("philips/KEY_POWER"));
+
+    TEST_ASSERT_NULL(irDb.findCode(NEC, 0x20DF10EEULL));
+    TEST_ASSERT_NULL(irDb.findCode(SONY, 0x20DF23DCULL));
+    TEST_ASSERT_NULL(irDb.findCode(SAMSUNG, 0));
+}
+
+void test_raw(void) {
+    const IRDbEntry_t *entry = nullptr;
+    decode_type_t type = UNKNOWN;
+    uint16_t buf[257];
+    uint64_t code = 0;
+    uint16_t bits = 1;
+
+    TEST_ASSERT_TRUE(irDb.resolve("panasonic/key_power", type, code, bits));
+    TEST_ASSERT_EQUAL(RAW, type);
+    TEST_ASSERT_EQUAL(0, bits);
+    TEST_ASSERT_TRUE((code & IRDB_REF) != 0);
+
+    entry = irDb.findRef(code);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(37, entry->khz);
+    TEST_ASSERT_EQUAL(100, irDb.expand(entry, buf, 257));
+    TEST_ASSERT_EQUAL(3500, buf[0]);
+    TEST_ASSERT_EQUAL(1750, buf[1]);
+    TEST_ASSERT_EQUAL(435, buf[98]);
+    TEST_ASSERT_EQUAL(0xFFFF, buf[99]);
+
+    TEST_ASSERT_EQUAL(0, irDb.expand(entry, buf, 99));
+    TEST_ASSERT_EQUAL(0, irDb.expand(irDb.find("LG_TV/OK"), buf, 257));
+    TEST_ASSERT_NULL(irDb.findRef(code & ~IRDB_REF));
+    TEST_ASSERT_NULL(irDb.findRef(IRDB_REF | 12345));
+}
+
+void test_strings(void) {
+    String devices = irDb.getDeviceString();
+
+    TEST_ASSERT_TRUE(devices.s.find("LG_TV; 8 commands\n") != std::string::npos);
+    TEST_ASSERT_EQUAL_STRING("rawremote/KEY_A; RAW; 6 timings; 36kHz\n"
+            "rawremote/KEY_NEC; RAW; 18 timings; 36kHz\n", irDb.getListString("RAWREMOTE").c_str());
+    TEST_ASSERT_EQUAL_STRING("none\n", irDb.getListString("LG").c_str());
+    TEST_ASSERT_EQUAL_STRING("LG_TV/OK; NEC/32; 0x20DF22DD\n", 
+            irDb.getEntryString(irDb.find("LG_TV/OK")).c_str());
+}
+
+void test_corrupt(void) {
+    std::vector<uint8_t> data = fixture();
+
+    data[data.size() / 2] ^= 1;
+    TEST_ASSERT_FALSE(irDb.attach(data.data(), data.size()));
+    TEST_ASSERT_EQUAL(0, irDb.getCount());
+    TEST_ASSERT_NULL(irDb.find("LG_TV/OK"));
+    TEST_ASSERT_NULL(irDb.findCode(NEC, 0x20DF22DDULL));
+    TEST_ASSERT_EQUAL_STRING("none\n", irDb.getDeviceString().c_str());
+
+    data = fixture();
+    data[4] = IRDB_VERSION + 1;
+    TEST_ASSERT_FALSE(irDb.attach(data.data(), data.size()));
+    TEST_ASSERT_FALSE(irDb.attach(irdbFixture, sizeof(irdbFixture) - 1));
+    TEST_ASSERT_FALSE(irDb.attach(irdbFixture, 10));
+    TEST_ASSERT_FALSE(irDb.attach(nullptr, 0));
+}
+
+void test_partition(void) {
+    IRDb db;
+
+    TEST_ASSERT_FALSE(db.begin());
+    TEST_ASSERT_EQUAL_STRING("no partition\n", db.getStatsString().c_str());
+
+    /* The database is followed by erased flash */
+    partitionMockData = fixture();
+    partitionMockData.resize(0x10000, 0xFF);
+    TEST_ASSERT_TRUE(db.begin());
+    TEST_ASSERT_EQUAL(1, partitionMockMaps);
+    TEST_ASSERT_NOT_NULL(db.find("LG_TV/OK"));
+
+    partitionMockData[sizeof(irdbFixture) - 8] ^= 1;
+    TEST_ASSERT_FALSE(IRDb().begin());
+    TEST_ASSERT_EQUAL(1, partitionMockMaps);
+}
+
+void test_mutated(void) {
+    std::mt19937 rng(7);
+    uint32_t accepted = 0;
+
+    /* Random bytes with a valid CRC, the lookups must stay within the data */
+    for (uint32_t i = 0; i < MUTATIONS; i++) {
+        std::vector<uint8_t> data = fixture();
+        IRDbHeader_t *head = (IRDbHeader_t*) data.data();
+        uint8_t num = 1 + rng() % 4;
+        IRDb db;
+
+        for (uint8_t k = 0; k < num; k++) {
+            data[(rng() % 2) ? rng() % sizeof(IRDbHeader_t) : rng() % data.size()] = rng();
+        }
+        if (head->size >= sizeof(IRDbHeader_t) && head->size <= data.size()) {
+            head->crc = esp_rom_crc32_le(0, data.data() + sizeof(IRDbHeader_t), 
+                    head->size - sizeof(IRDbHeader_t));
+        }
+
+        if (!db.attach(data.data(), data.size())) {
+            continue;
+        }
+        accepted++;
+
+        for (const char *name : names) {
+            const IRDbEntry_t *entry = db.find(name);
+            uint16_t buf[257];
+
+            db.findCode(NEC, 0x20DF22DDULL);
+            db.findRef(IRDB_REF | IRDb::hash("LG_TV", "OK"));
+            if (entry != nullptr) {
+                db.expand(entry, buf, 257);
+                db.getEntryString(entry);
+                db.findRef(db.getRef(entry));
+            }
+        }
+        db.getDeviceString();
+        db.getListString("LG_TV");
+    }
+
+    printf("%u of %u mutated databases accepted\n", accepted, MUTATIONS);
+    TEST_ASSERT_TRUE(accepted > 0);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_attach);
+    RUN_TEST(test_find);
+    RUN_TEST(test_all_names);
+    RUN_TEST(test_find_code);
+    RUN_TEST(test_raw);
+    RUN_TEST(test_strings);
+    RUN_TEST(test_corrupt);
+    RUN_TEST(test_partition);
+    RUN_TEST(test_mutated);
+    return UNITY_END();
+}
@@ -0,0 +1,185 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include <unity.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "common.hpp"
+#include "reqarena.hpp"
+#include "stringRingBuffer.hpp"
+
+/**
+ * @brief Number of requests of the soak test.
+ */
+#define SOAK_REQUESTS       1000000
+
+/**
+ * @brief Requests after which the heap is expected to be settled.
+ */
+#define SOAK_WARMUP         10000
+
+/**
+ * @brief Size of a chunk of a streamed response.
+ */
+#define SOAK_CHUNK          1024
+
+static ReqArena arena;
+
+void setUp(void) {
+    arena.reset();
+}
+
+void tearDown(void) {
+
+}
+
+void test_alloc(void) {
+    uint8_t *first = (uint8_t*) arena.alloc(3);
+    uint8_t *second = (uint8_t*) arena.alloc(4);
+
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_TRUE(second == first + 4);
+    TEST_ASSERT_EQUAL(8, arena.getUsed());
+    TEST_ASSERT_NULL(arena.alloc(REQARENA_SIZE));
+    TEST_ASSERT_EQUAL(8, arena.getUsed());
+}
+
+void test_strings(void) {
+    const char *str = arena.printf("%u commands", 3);
+    size_t len = 0;
+
+    TEST_ASSERT_EQUAL_STRING("3 commands", str);
+
+    arena.begin();
+    arena.cat("{\"name\":");
+    arena.catJson("a \"b\"\n");
+    arena.cat("}");
+    str = arena.end(&len);
+    TEST_ASSERT_EQUAL_STRING("{\"name\":\"a \\\"b\\\"\\u000a\"}", str);
+    TEST_ASSERT_EQUAL(strlen(str), len);
+
+    /* Nothing can be allocated while a string is open */
+    arena.begin();
+    TEST_ASSERT_NULL(arena.alloc(4));
+    arena.end();
+}
+
+void test_overflow(void) {
+    uint32_t overflows = arena.getStats().overflows;
+
+    arena.begin();
+    for (uint16_t i = 0; i < REQARENA_SIZE / 8; i++) {
+        arena.cat("%08u", i);
+    }
+    TEST_ASSERT_FALSE(arena.cat("x"));
+    TEST_ASSERT_NULL(arena.end());
+    TEST_ASSERT_EQUAL(overflows + 1, arena.getStats().overflows);
+    TEST_ASSERT_EQUAL(REQARENA_SIZE, arena.getStats().peak);
+
+    arena.reset();
+    TEST_ASSERT_EQUAL_STRING("ok", arena.printf("ok"));
+}
+
+void test_rewind(void) {
+    size_t used = 0;
+
+    arena.printf("header");
+    used = arena.getUsed();
+    for (uint8_t i = 0; i < 10; i++) {
+        TEST_ASSERT_NOT_NULL(arena.printf("chunk %u", i));
+        arena.rewind(used);
+        TEST_ASSERT_EQUAL(used, arena.getUsed());
+    }
+}
+
+void test_soak(void) {
+    StaticStringRingBuffer<32> log;
+    ReqArena::Stats_t start = arena.getStats();
+    size_t peak = 0;
+#if defined(__GLIBC__)
+    struct mallinfo2 settled;
+    struct mallinfo2 now;
+#endif
+
+    /* Each request logs a transmission, streams the log in chunks and
+     * answers with a status line, like /tx followed by /api/log */
+    for (uint32_t r = 0; r < SOAK_REQUESTS; r++) {
+        char entry[IRSTATS_ENTRY_SIZE];
+        size_t used = 0;
+
+        snprintf(entry, sizeof(entry), "2026-10-18 12:%02u:%02u; NEC; 0x%X%s", 
+                (unsigned) (r % 60), (unsigned) (r % 59), (unsigned) ((r * 2654435761UL) & 0xFFFFFF),
+                r % 7 ? "" : "; ch1");
+        log.push(entry);
+
+        TEST_ASSERT_NOT_NULL(arena.printf("Sequence executed: %d commands in %lums\n", 
+                3, (unsigned long) r));
+        used = arena.getUsed();
+        arena.begin();
+        for (int i = 0; i < log.size(); i++) {
+            if (arena.getUsed() - used > SOAK_CHUNK) {
+                TEST_ASSERT_NOT_NULL(arena.end());
+                peak = max(peak, arena.getUsed());
+                arena.rewind(used);
+                arena.begin();
+            }
+            arena.cat("{\"entry\":");
+            arena.catJson(log.get(i).c_str());
+            arena.cat("}\n");
+        }
+        TEST_ASSERT_NOT_NULL(arena.end());
+        peak = max(peak, arena.getUsed());
+        arena.reset();
+
+#if defined(__GLIBC__)
+        if (r == SOAK_WARMUP) {
+            settled = mallinfo2();
+        }
+#endif
+    }
+
+    TEST_ASSERT_EQUAL(SOAK_REQUESTS, arena.getStats().requests - start.requests);
+    TEST_ASSERT_EQUAL(start.overflows, arena.getStats().overflows);
+    TEST_ASSERT_TRUE(peak < SOAK_CHUNK + 256);
+
+#if defined(__GLIBC__)
+    /* The heap neither grew nor split up after the warm up */
+    now = mallinfo2();
+    printf("heap %zu bytes, %zu in use, %zu free chunks, arena peak %zu\n", 
+            now.arena, now.uordblks, now.ordblks, peak);
+    TEST_ASSERT_EQUAL(settled.arena, now.arena);
+    TEST_ASSERT_EQUAL(settled.uordblks, now.uordblks);
+    TEST_ASSERT_TRUE(now.ordblks <= settled.ordblks);
+#endif
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_alloc);
+    RUN_TEST(test_strings);
+    RUN_TEST(test_overflow);
+    RUN_TEST(test_rewind);
+    RUN_TEST(test_soak);
+    return UNITY_END();
+}
@@ -0,0 +1,151 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "seqlock.hpp"
+
+/**
+ * @brief A snapshot larger than a word with fields derived from each other, 
+ * a torn copy breaks at least one of the relations.
+ */
+typedef struct {
+    uint32_t seq;
+    uint32_t inverse;
+    uint64_t triple;
+    char text[97];
+} Snapshot_t;
+
+static void fill(Snapshot_t *pSnap, uint32_t seq) {
+    pSnap->seq = seq;
+    pSnap->inverse = ~seq;
+    pSnap->triple = (uint64_t) seq * 3;
+    snprintf(pSnap->text, sizeof(pSnap->text), "%u; NEC; 0x%08X; %0*u", seq, seq, 60, seq);
+}
+
+static bool isConsistent(const Snapshot_t &snap) {
+    Snapshot_t expected;
+
+    memset(&expected, 0, sizeof(expected));
+    if (snap.seq == 0) {
+        return snap.inverse == 0 && snap.triple == 0;
+    }
+    fill(&expected, snap.seq);
+
+    return memcmp(&snap, &expected, sizeof(expected)) == 0;
+}
+
+void setUp(void) {
+
+}
+
+void tearDown(void) {
+
+}
+
+void test_initial_value(void) {
+    SeqLock<Snapshot_t> lock;
+    Snapshot_t snap;
+
+    memset(&snap, 0xFF, sizeof(snap));
+    TEST_ASSERT_EQUAL(0, lock.read(snap));
+    TEST_ASSERT_EQUAL(0, snap.seq);
+    TEST_ASSERT_EQUAL(0, snap.text[0]);
+    TEST_ASSERT_EQUAL(0, lock.getVersion());
+}
+
+void test_write_read(void) {
+    SeqLock<Snapshot_t> lock;
+    Snapshot_t snap;
+
+    memset(&snap, 0, sizeof(snap));
+    for (uint32_t i = 1; i <= 3; i++) {
+        fill(&snap, i);
+        lock.write(snap);
+    }
+
+    memset(&snap, 0, sizeof(snap));
+    TEST_ASSERT_EQUAL(0, lock.read(snap));
+    TEST_ASSERT_TRUE(isConsistent(snap));
+    TEST_ASSERT_EQUAL(3, snap.seq);
+    TEST_ASSERT_EQUAL(3, lock.getVersion());
+}
+
+void test_concurrent_readers(void) {
+    SeqLock<Snapshot_t> lock;
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> reads(0);
+    std::atomic<uint64_t> retries(0);
+    std::atomic<uint64_t> torn(0);
+    std::vector<std::thread> readers;
+    uint32_t writes = 0;
+
+    std::thread writer([&] {
+        Snapshot_t snap;
+
+        memset(&snap, 0, sizeof(snap));
+        while (!stop) {
+            fill(&snap, ++writes);
+            lock.write(snap);
+        }
+    });
+
+    for (int i = 0; i < 3; i++) {
+        readers.emplace_back([&] {
+            Snapshot_t snap;
+            uint32_t last = 0;
+
+            while (!stop) {
+                retries += lock.read(snap);
+                if (!isConsistent(snap) || snap.seq < last) {
+                    torn++;
+                }
+                last = snap.seq;
+                reads++;
+            }
+        });
+    }
+
+    delay(1000);
+    stop = true;
+    writer.join();
+    for (std::thread &reader : readers) {
+        reader.join();
+    }
+
+    printf("%u writes, %llu reads, %llu retries\n", writes, 
+            (unsigned long long) reads, (unsigned long long) retries);
+    TEST_ASSERT_EQUAL(0, torn.load());
+    TEST_ASSERT_TRUE(reads > 0);
+    TEST_ASSERT_EQUAL(writes, lock.getVersion());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_initial_value);
+    RUN_TEST(test_write_read);
+    RUN_TEST(test_concurrent_readers);
+    return UNITY_END();
+}
@@ -0,0 +1,246 @@
+/*
+ * ir-gateway, build to automate ir remote control commands in smart homes.
+ *
+ * Copyright (C) 2026 Julian Friedrich
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ *
+ * You can file issues at https://github.com/fjulian79/ir-gateway/issues
+ */
+
+#include <unity.h>
+
+#include "mocktxdriver.hpp"
+#include "rmttxdriver.hpp"
+
+static uint32_t duration(const std::vector<MockTxDriver::Pulse_t> &pulses, size_t first, size_t num) {
+    uint32_t sum = 0;
+
+    for (size_t i = first; i < first + num; i++) {
+        sum += pulses[i].usec;
+    }
+
+    return sum;
+}
+
+static std::vector<uint32_t> split(const std::vector<MockTxDriver::Pulse_t> &pulses) {
+    std::vector<uint32_t> halves;
+
+    for (const MockTxDriver::Pulse_t &pulse : pulses) {
+        for (uint32_t usec = pulse.usec; usec > 0; usec -= min(usec, (uint32_t) 32767)) {
+            halves.push_back(min(usec, (uint32_t) 32767));
+        }
+    }
+
+    return halves;
+}
+
+void setUp(void) {
+    rmtMockItems.clear();
+    rmtMockWrites = 0;
+}
+
+void tearDown(void) {
+
+}
+
+void test_nec_frame(void) {
+    MockTxDriver mock;
+    uint32_t code = 0x20DF10EF;
+
+    TEST_ASSERT_TRUE(mock.send(decode_type_t::NEC, code, 0, 1));
+    TEST_ASSERT_EQUAL(1, mock.sent.size());
+    TEST_ASSERT_EQUAL(32, mock.sent[0].bits);
+
+    const std::vector<MockTxDriver::Pulse_t> &pulses = mock.sent[0].pulses;
+    TEST_ASSERT_EQUAL(68, pulses.size());
+    TEST_ASSERT_TRUE(pulses[0].level);
+    TEST_ASSERT_EQUAL(8960, pulses[0].usec);
+    TEST_ASSERT_FALSE(pulses[1].level);
+    TEST_ASSERT_EQUAL(4480, pulses[1].usec);
+
+    for (uint8_t i = 0; i < 32; i++) {
+        bool one = (code >> (31 - i)) & 1;
+
+        TEST_ASSERT_TRUE(pulses[2 + i * 2].level);
+        TEST_ASSERT_EQUAL(560, pulses[2 + i * 2].usec);
+        TEST_ASSERT_FALSE(pulses[3 + i * 2].level);
+        TEST_ASSERT_EQUAL(one ? 1680 : 560, pulses[3 + i * 2].usec);
+    }
+
+    TEST_ASSERT_TRUE(pulses[66].level);
+    TEST_ASSERT_EQUAL(560, pulses[66].usec);
+    TEST_ASSERT_FALSE(pulses[67].level);
+    TEST_ASSERT_EQUAL(108000, duration(pulses, 0, pulses.size()));
+}
+
+void test_min_gap(void) {
+    MockTxDriver mock;
+
+    /* All ones make the NEC frame too long for the frame length */
+    mock.send(decode_type_t::NEC, 0xFFFFFFFF, 32, 1);
+    TEST_ASSERT_EQUAL(22400, mock.sent[0].pulses.back().usec);
+
+    mock.send(decode_type_t::SAMSUNG, 0xFFFFFFFF, 32, 1);
+    TEST_ASSERT_EQUAL(4480, mock.sent[1].pulses[0].usec);
+    TEST_ASSERT_EQUAL(108000, duration(mock.sent[1].pulses, 0, mock.sent[1].pulses.size()));
+}
+
+void test_repeated_frames(void) {
+    MockTxDriver mock;
+
+    mock.send(decode_type_t::SAMSUNG, 0xE0E040BF, 32, 3);
+
+    const std::vector<MockTxDriver::Pulse_t> &pulses = mock.sent[0].pulses;
+    TEST_ASSERT_EQUAL(3 * 68, pulses.size());
+    for (size_t i = 0; i < 68; i++) {
+        TEST_ASSERT_EQUAL(pulses[i].usec, pulses[68 + i].usec);
+        TEST_ASSERT_EQUAL(pulses[i].usec, pulses[136 + i].usec);
+    }
+}
+
+void test_raw_and_state(void) {
+    MockTxDriver mock;
+    const uint16_t raw[] = {9000, 4500, 560, 560, 560};
+    const uint8_t state[] = {0x11, 0x22, 0x33};
+
+    mock.sendRaw(raw, 5, 40);
+    TEST_ASSERT_EQUAL(decode_type_t::RAW, mock.sent[0].type);
+    TEST_ASSERT_EQUAL(40, mock.sent[0].khz);
+    TEST_ASSERT_EQUAL(5, mock.sent[0].pulses.size());
+    for (size_t i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL((i & 1) == 0, mock.sent[0].pulses[i].level);
+        TEST_ASSERT_EQUAL(raw[i], mock.sent[0].pulses[i].usec);
+    }
+
+    mock.sendState(decode_type_t::SAMSUNG36, state, 3);
+    TEST_ASSERT_EQUAL(3, mock.sent[1].state.size());
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(state, mock.sent[1].state.data(), 3);
+    TEST_ASSERT_EQUAL(0, mock.sent[1].pulses.size());
+}
+
+void test_pulse_counter(void) {
+    PulseCounter counter(32767);
+    const uint16_t raw[] = {9000, 65535, 560};
+
+    /* The gap of about 40 ms exceeds a single pulse */
+    counter.encode(PulseEncoder::necTiming, 0x20DF10EF, 32, 2);
+    TEST_ASSERT_EQUAL(2 * 69, counter.getCount());
+
+    /* Long spaces need several pulses */
+    counter = PulseCounter(32767);
+    counter.encodeRaw(raw, 3);
+    TEST_ASSERT_EQUAL(1 + 3 + 1, counter.getCount());
+}
+
+void test_rmt_items(void) {
+    MockTxDriver fallback;
+    MockTxDriver mock;
+    RmtTxDriver rmt(4, RMT_CHANNEL_0, fallback);
+
+    rmt.begin();
+    TEST_ASSERT_TRUE(rmt.send(decode_type_t::NEC, 0x20DF10EF, 32, 1));
+    TEST_ASSERT_EQUAL(1, rmtMockWrites);
+    TEST_ASSERT_EQUAL(0, fallback.sent.size());
+
+    /* The items hold the same timings as recorded by the mock, the gap is
+     * split and the last item is completed by the end marker */
+    mock.send(decode_type_t::NEC, 0x20DF10EF, 32, 1);
+    std::vector<uint32_t> halves = split(mock.sent[0].pulses);
+    halves.push_back(0);
+
+    TEST_ASSERT_EQUAL(35, rmtMockItems.size());
+    for (size_t i = 0; i < 34; i++) {
+        TEST_ASSERT_EQUAL(halves[i * 2], rmtMockItems[i].duration0);
+        TEST_ASSERT_EQUAL(1, rmtMockItems[i].level0);
+        TEST_ASSERT_EQUAL(halves[i * 2 + 1], rmtMockItems[i].duration1);
+        TEST_ASSERT_EQUAL(0, rmtMockItems[i].level1);
+    }
+    TEST_ASSERT_EQUAL(halves[68], rmtMockItems[34].duration0);
+    TEST_ASSERT_EQUAL(0, rmtMockItems[34].level0);
+    TEST_ASSERT_EQUAL(0, rmtMockItems[34].duration1);
+}
+
+void test_rmt_overflow(void) {
+    MockTxDriver fallback;
+    RmtTxDriver rmt(4, RMT_CHANNEL_0, fallback);
+
+    rmt.begin();
+
+    /* 14 NEC frames take 483 items and still fit */
+    TEST_ASSERT_TRUE(rmt.send(decode_type_t::NEC, 0x20DF10EF, 32, 14));
+    TEST_ASSERT_EQUAL(1, rmtMockWrites);
+    TEST_ASSERT_EQUAL(483, rmtMockItems.size());
+    TEST_ASSERT_EQUAL(0, fallback.sent.size());
+
+    /* 15 frames need 518 items, no partial frame is written */
+    TEST_ASSERT_TRUE(rmt.send(decode_type_t::NEC, 0x20DF10EF, 32, 15));
+    TEST_ASSERT_EQUAL(1, rmtMockWrites);
+    TEST_ASSERT_EQUAL(1, fallback.sent.size());
+    TEST_ASSERT_EQUAL(decode_type_t::NEC, fallback.sent[0].type);
+    TEST_ASSERT_EQUAL(15, fallback.sent[0].frames);
+
+    /* The largest repeat count of a request */
+    TEST_ASSERT_TRUE(rmt.send(decode_type_t::NEC, 0x20DF10EF, 32, 16));
+    TEST_ASSERT_EQUAL(1, rmtMockWrites);
+    TEST_ASSERT_EQUAL(2, fallback.sent.size());
+    TEST_ASSERT_EQUAL(16, fallback.sent[1].frames);
+    TEST_ASSERT_EQUAL(16 * 68, fallback.sent[1].pulses.size());
+}
+
+void test_rmt_raw_overflow(void) {
+    MockTxDriver fallback;
+    RmtTxDriver rmt(4, RMT_CHANNEL_0, fallback);
+    uint16_t raw[1100];
+
+    for (size_t i = 0; i < 1100; i++) {
+        raw[i] = 560;
+    }
+
+    rmt.begin();
+    rmt.sendRaw(raw, 1000, 38);
+    TEST_ASSERT_EQUAL(1, rmtMockWrites);
+    TEST_ASSERT_EQUAL(500, rmtMockItems.size());
+
+    rmt.sendRaw(raw, 1100, 38);
+    TEST_ASSERT_EQUAL(1, rmtMockWrites);
+    TEST_ASSERT_EQUAL(1, fallback.sent.size());
+    TEST_ASSERT_EQUAL(1100, fallback.sent[0].pulses.size());
+}
+
+void test_rmt_unsupported(void) {
+    MockTxDriver fallback;
+    RmtTxDriver rmt(4, RMT_CHANNEL_0, fallback);
+
+    rmt.begin();
+    TEST_ASSERT_TRUE(rmt.send(decode_type_t::SONY, 0xA90, 0, 3));
+    TEST_ASSERT_EQUAL(0, rmtMockWrites);
+    TEST_ASSERT_EQUAL(1, fallback.sent.size());
+    TEST_ASSERT_EQUAL(12, fallback.sent[0].bits);
+    TEST_ASSERT_TRUE(fallback.initialized);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_nec_frame);
+    RUN_TEST(test_min_gap);
+    RUN_TEST(test_repeated_frames);
+    RUN_TEST(test_raw_and_state);
+    RUN_TEST(test_pulse_counter);
+    RUN_TEST(test_rmt_items);
+    RUN_TEST(test_rmt_overflow);
+    RUN_TEST(test_rmt_raw_overflow);
+    RUN_TEST(test_rmt_unsupported);
+    return UNITY_END();
+}
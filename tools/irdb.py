@@ -0,0 +1,621 @@
+#
+# ir-gateway, build to automate ir remote control commands in smart homes.
+#
+# Copyright (C) 2026 Julian Friedrich
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+# You can file issues at https://github.com/fjulian79/ir-gateway/issues
+
+"""
+Imports IR code databases into the code database of the irdb partition.
+
+Reads LIRC configs (*.conf), Pronto collections (*.txt, *.pronto) and IRDB 
+CSV files (*.csv, functionname,protocol,device,subdevice,function) and 
+writes a sorted binary database, see lib/irdb/irdb.hpp for the format. Codes
+of the NEC, Samsung, Sony and RC5 protocols are stored as such, everything
+else as raw timings. Names are stored as device and function, characters 
+used as separators by the gateway are replaced by '_'.
+
+As PlatformIO script the database is built from irdb/ into the build 
+directory, the uploadirdb target flashes it into the irdb partition:
+
+    pio run -t uploadirdb
+
+Standalone it builds and queries databases on the host:
+
+    python3 tools/irdb.py build -o irdb.bin irdb/ lircd.conf
+    python3 tools/irdb.py list irdb.bin [device]
+    python3 tools/irdb.py find irdb.bin LG_TV/Power_On
+    python3 tools/irdb.py code irdb.bin nec 0x20DF10EF
+"""
+
+import argparse
+import binascii
+import csv
+import os
+import re
+import struct
+import sys
+
+MAGIC = 0x42445249
+VERSION = 1
+HEADER = struct.Struct("<IHHIIIIIIII")
+ENTRY = struct.Struct("<QIIhHHH")
+HASH = struct.Struct("<II")
+
+# decode_type_t of IRremoteESP8266
+TYPES = {"rc5": 1, "rc6": 2, "nec": 3, "sony": 4, "samsung": 7, "raw": 30}
+RC5, NEC, SONY, SAMSUNG, RAW = 1, 3, 4, 7, 30
+
+# IRDB_MAX_NAME, "device/function" including the terminating zero
+MAX_NAME = 64
+# Size of the transmit buffer of IRControl, LEARN_MAX_TIMINGS + 1
+MAX_TIMINGS = 257
+DEFAULT_GAP = 40000
+
+
+def warn(message):
+    print("irdb: %s" % message, file=sys.stderr)
+
+
+def type_name(value):
+    for name, number in TYPES.items():
+        if number == value:
+            return name.upper()
+    return str(value)
+
+
+def fnv1a(name):
+    """IRDb::hash() of "device/function" in lower case."""
+    value = 2166136261
+    for byte in name.lower().encode("ascii"):
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def clean_name(name):
+    name = re.sub(r"[\s/:,@]+", "_", name.strip()).strip("_")
+    return name.encode("ascii", "replace").decode().replace("?", "_")
+
+
+def reverse8(value):
+    return int("{:08b}".format(value & 0xFF)[::-1], 2)
+
+
+def near(value, target):
+    return abs(value - target) <= target // 4
+
+
+# Space encoded protocols, MSB first: header, one and zero as (mark, space)
+SPACE_PROTOCOLS = [
+    (NEC, (9000, 4500), (560, 1690), (560, 560), (32,)),
+    (SAMSUNG, (4500, 4500), (560, 1690), (560, 560), (32,)),
+    (SONY, (2400, 600), (1200, 600), (600, 600), (12, 15, 20)),
+]
+
+
+def classify(timings):
+    """Decode timings of a known protocol, returns (type, bits, code) or None."""
+    for proto, header, one, zero, lengths in SPACE_PROTOCOLS:
+        if len(timings) < 4 or not near(timings[0], header[0]) or \
+                not near(timings[1], header[1]):
+            continue
+        value, bits, pos = 0, 0, 2
+        pulse = one[0] != zero[0]
+        while pos < len(timings):
+            mark = timings[pos]
+            space = timings[pos + 1] if pos + 1 < len(timings) else DEFAULT_GAP
+            if pulse and near(mark, one[0]):
+                bit = 1
+            elif pulse and near(mark, zero[0]):
+                bit = 0
+            elif not pulse and near(mark, one[0]) and near(space, one[1]):
+                bit = 1
+            elif not pulse and near(mark, zero[0]) and near(space, zero[1]):
+                bit = 0
+            else:
+                break
+            value = (value << 1) | bit
+            bits += 1
+            pos += 2
+            # Pulse width codes end with the gap after the last mark
+            if pulse and not near(space, zero[1]):
+                break
+        if bits in lengths:
+            return proto, bits, value
+    return None
+
+
+def make_code(device, function, timings=None, khz=38, proto=None, bits=0, code=0):
+    """A code of the database, timings are classified if possible."""
+    if timings is not None:
+        known = classify(timings)
+        if known is not None:
+            proto, bits, code = known
+        else:
+            timings = [min(int(round(t)), 0xFFFF) for t in timings]
+            if len(timings) % 2:
+                timings.append(DEFAULT_GAP)
+            if len(timings) > MAX_TIMINGS:
+                warn("%s/%s: %u timings, at most %u are supported" % (
+                    device, function, len(timings), MAX_TIMINGS))
+                return None
+            return {"device": device, "function": function, "type": RAW, 
+                    "bits": len(timings), "timings": timings, "khz": khz}
+    return {"device": device, "function": function, "type": proto, "bits": bits, 
+            "code": code, "khz": 0}
+
+
+def lirc_timings(remote, code):
+    """Timings of a space encoded LIRC code."""
+    bits = remote["pre_data_bits"] + remote["bits"] + remote["post_data_bits"]
+    value = (((remote["pre_data"] << remote["bits"]) | code) << 
+             remote["post_data_bits"]) | remote["post_data"]
+    timings = []
+    if remote["header"]:
+        timings += remote["header"]
+    if remote["plead"]:
+        timings.append(remote["plead"])
+    for pos in reversed(range(bits)):
+        mark, space = remote["one"] if value >> pos & 1 else remote["zero"]
+        if timings and len(timings) % 2:
+            timings[-1] += mark
+            timings.append(space)
+        else:
+            timings += [mark, space]
+    if remote["ptrail"]:
+        timings.append(remote["ptrail"])
+    if len(timings) % 2:
+        timings.append(remote["gap"] or DEFAULT_GAP)
+    else:
+        timings[-1] = max(timings[-1], remote["gap"] or DEFAULT_GAP)
+    return timings, bits, value
+
+
+def lirc_codes(remote):
+    device = clean_name(remote["name"])
+    khz = int(round(remote["frequency"] / 1000.0)) or 38
+    flags = remote["flags"]
+    for name, code in remote["codes"]:
+        function = clean_name(name)
+        if "RC5" in flags:
+            bits = remote["pre_data_bits"] + remote["bits"]
+            value = (remote["pre_data"] << remote["bits"]) | code
+            # The field bit is 0 for the extended commands of RC5X
+            if bits >= 13 and not value >> 12 & 1:
+                warn("%s/%s: RC5X is not supported" % (device, function))
+                continue
+            yield make_code(device, function, proto=RC5, bits=12, code=value & 0x7FF)
+        elif "SHIFT_ENC" in flags or "RC6" in flags:
+            warn("%s/%s: bi-phase encoding is not supported" % (device, function))
+        else:
+            timings, _, _ = lirc_timings(remote, code)
+            yield make_code(device, function, timings, khz)
+    for name, timings in remote["raw_codes"]:
+        yield make_code(device, clean_name(name), timings, khz)
+
+
+def parse_lirc(path):
+    """Remotes of a lircd.conf file."""
+    remote = None
+    section = None
+    raw_name = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            words = line.split("#", 1)[0].split()
+            if not words:
+                continue
+            key = words[0].lower()
+            if key == "begin" and len(words) > 1:
+                if words[1] == "remote":
+                    remote = {"name": os.path.splitext(os.path.basename(path))[0], 
+                              "bits": 0, "flags": "", "header": None, "one": (0, 0), 
+                              "zero": (0, 0), "plead": 0, "ptrail": 0, "gap": 0,
+                              "pre_data_bits": 0, "pre_data": 0, "post_data_bits": 0, 
+                              "post_data": 0, "frequency": 38000, "codes": [], 
+                              "raw_codes": []}
+                else:
+                    section = words[1]
+                continue
+            if key == "end" and len(words) > 1:
+                if words[1] == "remote" and remote is not None:
+                    yield from lirc_codes(remote)
+                    remote = None
+                section = raw_name = None
+                continue
+            if remote is None:
+                continue
+            if section == "codes" and len(words) > 1:
+                remote["codes"].append((words[0], int(words[1], 0)))
+            elif section == "raw_codes":
+                if key == "name" and len(words) > 1:
+                    raw_name = words[1]
+                    remote["raw_codes"].append((raw_name, []))
+                elif raw_name is not None:
+                    remote["raw_codes"][-1][1].extend(int(w) for w in words)
+            elif key == "flags":
+                remote["flags"] = " ".join(words[1:]).upper()
+            elif key in ("header", "one", "zero") and len(words) > 2:
+                remote[key] = (int(words[1]), int(words[2]))
+            elif key in ("bits", "plead", "ptrail", "gap", "pre_data_bits", 
+                         "post_data_bits", "frequency") and len(words) > 1:
+                remote[key] = int(words[1])
+            elif key in ("pre_data", "post_data") and len(words) > 1:
+                remote[key] = int(words[1], 0)
+            elif key == "name" and len(words) > 1:
+                remote["name"] = " ".join(words[1:])
+
+
+PRONTO_LINE = re.compile(r"^(.+?)\s*(?:[:=\t]|\s{2,})\s*((?:[0-9a-fA-F]{4}\s+){4,}[0-9a-fA-F]{4})\s*$")
+
+
+def pronto_timings(words):
+    """Timings and carrier in kHz of a learned Pronto code, None if unsupported."""
+    if len(words) < 6 or words[0] != 0 or words[1] == 0:
+        return None, 0
+    period = words[1] * 0.241246
+    once, repeat = words[2] * 2, words[3] * 2
+    burst = words[4:4 + once] if once else words[4 + once:4 + once + repeat]
+    if not burst:
+        return None, 0
+    return [w * period for w in burst], int(round(1000 / period))
+
+
+def parse_pronto(path):
+    """Pronto collection, "function: hex" lines grouped by [device] sections."""
+    device = clean_name(os.path.splitext(os.path.basename(path))[0])
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.strip()
+            section = re.match(r"^\[(.+)\]$", line)
+            if section:
+                device = clean_name(section.group(1))
+                continue
+            match = PRONTO_LINE.match(line)
+            if not match:
+                continue
+            function = clean_name(match.group(1))
+            timings, khz = pronto_timings([int(w, 16) for w in match.group(2).split()])
+            if timings is None:
+                warn("%s/%s: only learned Pronto codes (0000) are supported" % (
+                    device, function))
+                continue
+            yield make_code(device, function, timings, khz)
+
+
+def irdb_code(protocol, device, subdevice, function):
+    """(type, bits, code) of a IRDB protocol, None if unsupported."""
+    protocol = protocol.lower()
+    if protocol in ("nec", "nec1", "nec2", "necx1", "necx2"):
+        if subdevice < 0:
+            subdevice = device if protocol.startswith("necx") else ~device & 0xFF
+        code = reverse8(device) << 24 | reverse8(subdevice) << 16 | \
+            reverse8(function) << 8 | reverse8(~function)
+        return (SAMSUNG if protocol.startswith("necx") else NEC), 32, code
+    if protocol in ("sony12", "sony15", "sony20"):
+        bits = int(protocol[4:])
+        stream = [(function >> i) & 1 for i in range(7)]
+        stream += [(device >> i) & 1 for i in range(5 if bits != 15 else 8)]
+        if bits == 20:
+            stream += [(max(subdevice, 0) >> i) & 1 for i in range(8)]
+        code = 0
+        for bit in stream:
+            code = (code << 1) | bit
+        return SONY, bits, code
+    if protocol == "rc5" and function < 64:
+        return RC5, 12, (device & 0x1F) << 6 | function
+    return None
+
+
+def parse_irdb(path):
+    """IRDB CSV, the device is named by the file or by brand and type."""
+    stem = os.path.splitext(os.path.basename(path))[0]
+    device = stem
+    # IRDB names the files by device and subdevice, e.g. LG/TV/4,-1.csv
+    if re.match(r"^-?\d+,-?\d+$", stem):
+        parts = os.path.normpath(os.path.abspath(path)).split(os.sep)
+        device = "_".join(parts[-3:-1])
+    device = clean_name(device)
+    with open(path, newline="", errors="replace") as f:
+        for row in csv.DictReader(f):
+            try:
+                function = clean_name(row["functionname"])
+                code = irdb_code(row["protocol"], int(row["device"]), 
+                                 int(row["subdevice"]), int(row["function"]))
+            except (KeyError, TypeError, ValueError):
+                warn("%s: invalid row %s" % (path, dict(row)))
+                continue
+            if code is None:
+                warn("%s/%s: protocol %s is not supported" % (
+                    device, function, row["protocol"]))
+                continue
+            yield make_code(device, function, proto=code[0], bits=code[1], code=code[2])
+
+
+PARSERS = {".conf": parse_lirc, ".lircd": parse_lirc, ".txt": parse_pronto,
+           ".pronto": parse_pronto, ".csv": parse_irdb}
+
+
+def source_files(paths):
+    for path in paths:
+        if os.path.isdir(path):
+            for root, dirs, files in os.walk(path):
+                dirs.sort()
+                for name in sorted(files):
+                    if os.path.splitext(name)[1].lower() in PARSERS:
+                        yield os.path.join(root, name)
+        else:
+            yield path
+
+
+def import_codes(paths):
+    """All codes of the sources, the first one of a name wins."""
+    codes = {}
+    devices = {}
+    for path in source_files(paths):
+        parser = PARSERS.get(os.path.splitext(path)[1].lower())
+        if parser is None:
+            warn("%s: unknown format" % path)
+            continue
+        for code in parser(path):
+            if code is None:
+                continue
+            if not code["device"] or not code["function"]:
+                warn("%s: empty name" % path)
+                continue
+            # Devices are matched ignoring the case, the first spelling is kept
+            code["device"] = devices.setdefault(code["device"].lower(), code["device"])
+            name = "%s/%s" % (code["device"], code["function"])
+            if len(name) >= MAX_NAME:
+                warn("%s: name longer than %u characters" % (name, MAX_NAME - 1))
+                continue
+            if name.lower() in codes:
+                warn("%s: duplicate, skipped" % name)
+                continue
+            codes[name.lower()] = code
+    return list(codes.values())
+
+
+def align(data):
+    data.extend(b"\0" * (-len(data) % 8))
+    return len(data)
+
+
+def build(codes):
+    """The binary database of a list of codes."""
+    codes = sorted(codes, key=lambda c: (c["device"].lower(), c["function"].lower()))
+    if len(codes) > 0xFFFF:
+        raise SystemExit("irdb: %u codes, at most 65535 are supported" % len(codes))
+
+    strings = bytearray(b"\0")
+    offsets = {}
+    timings = []
+    entries = []
+    hashes = []
+
+    def string(text):
+        if text not in offsets:
+            offsets[text] = len(strings)
+            strings.extend(text.encode("ascii") + b"\0")
+        return offsets[text]
+
+    for index, code in enumerate(codes):
+        value = code.get("code", 0)
+        if code["type"] == RAW:
+            value = len(timings)
+            timings.extend(code["timings"])
+        entries.append(ENTRY.pack(value, string(code["device"]), string(code["function"]),
+                                  code["type"], code["bits"], code["khz"], 0))
+        hashes.append((fnv1a("%s/%s" % (code["device"], code["function"])), index))
+
+    hashes.sort()
+    for (first, a), (second, b) in zip(hashes, hashes[1:]):
+        if first == second:
+            raise SystemExit("irdb: hash collision of %s/%s and %s/%s, rename one" % (
+                codes[a]["device"], codes[a]["function"], 
+                codes[b]["device"], codes[b]["function"]))
+
+    by_code = sorted(range(len(codes)), key=lambda i: (codes[i]["type"], 
+                                                         codes[i].get("code", 0)))
+
+    data = bytearray(HEADER.size)
+    sections = [align(data)]
+    data += b"".join(entries)
+    sections.append(align(data))
+    data += struct.pack("<%uH" % len(by_code), *by_code)
+    sections.append(align(data))
+    data += b"".join(HASH.pack(h, i) for h, i in hashes)
+    sections.append(align(data))
+    data += struct.pack("<%uH" % len(timings), *timings)
+    sections.append(align(data))
+    data += strings
+
+    crc = binascii.crc32(bytes(data[HEADER.size:])) & 0xFFFFFFFF
+    data[:HEADER.size] = HEADER.pack(MAGIC, VERSION, HEADER.size, len(data), crc, 
+                                     len(codes), *sections)
+    return bytes(data)
+
+
+class Database:
+    """Read access to a database, the same lookups as IRDb."""
+
+    def __init__(self, data):
+        (magic, version, header_size, size, crc, self.count, entries, codes, hashes, 
+         timings, strings) = HEADER.unpack_from(data)
+        if magic != MAGIC or version != VERSION or header_size != HEADER.size or \
+                size > len(data) or binascii.crc32(data[HEADER.size:size]) != crc:
+            raise SystemExit("irdb: invalid database")
+        self.data = data
+        self.entries = [ENTRY.unpack_from(data, entries + i * ENTRY.size) 
+                        for i in range(self.count)]
+        self.codes = struct.unpack_from("<%uH" % self.count, data, codes)
+        self.hashes = [HASH.unpack_from(data, hashes + i * HASH.size) 
+                       for i in range(self.count)]
+        self.timings = timings
+        self.strings = strings
+
+    def string(self, offset):
+        start = self.strings + offset
+        return self.data[start:self.data.index(b"\0", start)].decode("ascii")
+
+    def name(self, entry):
+        return self.string(entry[1]), self.string(entry[2])
+
+    def key(self, index):
+        device, function = self.name(self.entries[index])
+        return device.lower(), function.lower()
+
+    def lower_bound(self, count, less):
+        low, high = 0, count
+        while low < high:
+            mid = (low + high) // 2
+            if less(mid):
+                low = mid + 1
+            else:
+                high = mid
+        return low
+
+    def find(self, name):
+        device, _, function = name.partition("/")
+        key = (device.lower(), function.lower())
+        index = self.lower_bound(self.count, lambda i: self.key(i) < key)
+        if index < self.count and self.key(index) == key:
+            return self.entries[index]
+        return None
+
+    def find_code(self, proto, code):
+        entry = lambda i: self.entries[self.codes[i]]
+        index = self.lower_bound(self.count, lambda i: (entry(i)[3], entry(i)[0]) < (proto, code))
+        if index < self.count and (entry(index)[3], entry(index)[0]) == (proto, code):
+            return entry(index)
+        return None
+
+    def find_ref(self, name):
+        value = fnv1a(name)
+        index = self.lower_bound(self.count, lambda i: self.hashes[i][0] < value)
+        if index < self.count and self.hashes[index][0] == value:
+            return self.entries[self.hashes[index][1]]
+        return None
+
+    def describe(self, entry):
+        code, _, _, proto, bits, khz, _ = entry
+        device, function = self.name(entry)
+        if proto == RAW:
+            return "%s/%s; RAW; %u timings; %ukHz" % (device, function, bits, khz)
+        return "%s/%s; %s/%u; 0x%X" % (device, function, type_name(proto), bits, code)
+
+
+def generate(sources, out_file):
+    codes = import_codes(sources)
+    data = build(codes)
+    old = None
+    if os.path.exists(out_file):
+        with open(out_file, "rb") as f:
+            old = f.read()
+
+    # Unchanged output keeps the timestamp, nothing is flashed again
+    if data != old:
+        with open(out_file, "wb") as f:
+            f.write(data)
+
+    raw = sum(1 for c in codes if c["type"] == RAW)
+    print("IR DB: %u codes, %u raw, %u bytes" % (len(codes), raw, len(data)))
+
+
+def partition_offset(csv_file, label="irdb"):
+    with open(csv_file) as f:
+        for line in f:
+            fields = [field.strip() for field in line.split("#", 1)[0].split(",")]
+            if fields[0] == label and len(fields) > 3:
+                return fields[3]
+    raise SystemExit("irdb: no %s partition in %s" % (label, csv_file))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+    cmd = sub.add_parser("build", help="import sources into a database")
+    cmd.add_argument("-o", "--output", default="irdb.bin")
+    cmd.add_argument("sources", nargs="+", help="files or directories")
+    cmd = sub.add_parser("list", help="list devices or the codes of a device")
+    cmd.add_argument("database")
+    cmd.add_argument("device", nargs="?")
+    cmd = sub.add_parser("find", help="find a code by device/function")
+    cmd.add_argument("database")
+    cmd.add_argument("name")
+    cmd = sub.add_parser("code", help="find a code by protocol and code")
+    cmd.add_argument("database")
+    cmd.add_argument("type")
+    cmd.add_argument("code")
+    args = parser.parse_args()
+
+    if args.command == "build":
+        generate(args.sources, args.output)
+        return 0
+
+    with open(args.database, "rb") as f:
+        db = Database(f.read())
+
+    if args.command == "list":
+        devices = {}
+        for entry in db.entries:
+            device, _ = db.name(entry)
+            devices[device] = devices.get(device, 0) + 1
+            if args.device and device.lower() == args.device.lower():
+                print(db.describe(entry))
+        if not args.device:
+            for device, count in devices.items():
+                print("%s; %u commands" % (device, count))
+        return 0
+
+    if args.command == "find":
+        entry = db.find(args.name)
+        if entry is not None and db.find_ref(args.name) != entry:
+            raise SystemExit("irdb: hash index does not match %s" % args.name)
+    else:
+        proto = TYPES[args.type.lower()] if args.type.lower() in TYPES else int(args.type, 0)
+        entry = db.find_code(proto, int(args.code, 0))
+    if entry is None:
+        print("not found")
+        return 1
+    print(db.describe(entry))
+    return 0
+
+
+try:
+    Import("env")  # noqa: F821
+except NameError:
+    env = None
+
+if env is not None:
+    project_dir = env["PROJECT_DIR"]
+    source_dir = os.path.join(project_dir, "irdb")
+    out_file = os.path.join(env.subst("$BUILD_DIR"), "irdb.bin")
+    os.makedirs(os.path.dirname(out_file), exist_ok=True)
+    generate([source_dir] if os.path.isdir(source_dir) else [], out_file)
+    offset = partition_offset(os.path.join(project_dir, 
+                              env.GetProjectOption("board_build.partitions")))
+    env.AddCustomTarget(
+        name="uploadirdb",
+        dependencies=None,
+        actions=[
+            env.VerboseAction(env.AutodetectUploadPort, "Looking for upload port..."),
+            '"$PYTHONEXE" "$UPLOADER" --chip esp32 --port "$UPLOAD_PORT" '
+            '--baud $UPLOAD_SPEED write_flash %s "%s"' % (offset, out_file),
+        ],
+        title="Upload IR DB",
+        description="Flash the IR code database into the irdb partition")
+elif __name__ == "__main__":
+    sys.exit(main())
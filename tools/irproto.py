@@ -0,0 +1,374 @@
+#
+# ir-gateway, build to automate ir remote control commands in smart homes.
+#
+# Copyright (C) 2026 Julian Friedrich
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+# You can file issues at https://github.com/fjulian79/ir-gateway/issues
+#
+
+"""
+Host client of the framed binary serial protocol, see SerialProto.
+
+Switches the CLI to the binary protocol, sends commands, prints received 
+codes and measures commands per second and round trip latency. Only needs 
+the Python standard library, works with any serial device or pseudo 
+terminal.
+
+    python3 tools/irproto.py /dev/ttyUSB0 --enter 2000000 bench --count 5000
+    python3 tools/irproto.py /dev/ttyUSB0 tx nec 0x20DF10EF
+    python3 tools/irproto.py /dev/ttyUSB0 listen
+    python3 tools/irproto.py /dev/ttyUSB0 --enter 2000000 check --hold 3
+"""
+
+import argparse
+import os
+import select
+import struct
+import sys
+import termios
+import time
+import tty
+
+SYNC = 0xA5
+HEADER = struct.Struct("<BHH")
+RECORD = struct.Struct("<hBBQHbB")
+EVENT = struct.Struct("<hBBQI")
+MAX_PAYLOAD = 32 * RECORD.size
+
+PING, TX, STATUS, BAUD, EXIT = 0x01, 0x02, 0x03, 0x04, 0x05
+ACK, NAK, RX, NOTICE = 0x80, 0x81, 0x82, 0x83
+ERR_BUSY = 3
+
+# Code database reference flag of RAW codes, see IRDB_REF
+DB_REF = 1 << 63
+
+# decode_type_t of IRremoteESP8266, other protocols by number
+TYPES = {"rc5": 1, "rc6": 2, "nec": 3, "sony": 4, "panasonic": 5, "jvc": 6, 
+         "samsung": 7, "lg": 10, "sharp": 14, "raw": 30}
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE as used by the gateway."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+        crc &= 0xFFFF
+    return crc
+
+
+def type_value(name):
+    """Protocol name or number to decode_type_t."""
+    name = name.lower()
+    return TYPES[name] if name in TYPES else int(name, 0)
+
+
+def type_name(value):
+    for name, number in TYPES.items():
+        if number == value:
+            return name.upper()
+    return str(value)
+
+
+class Link:
+    """A serial link speaking the binary protocol."""
+
+    def __init__(self, path, baud):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        self.rx = bytearray()
+        self.next_id = 1
+        self.events = []
+        self.notices = []
+        self.dropped = 0
+        self.stray = 0
+        self.set_baud(baud)
+
+    def set_baud(self, baud):
+        speed = getattr(termios, "B%d" % baud, None)
+        if speed is None:
+            raise SystemExit("Baud rate %d not supported by this host" % baud)
+        tty.setraw(self.fd)
+        attrs = termios.tcgetattr(self.fd)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(self.fd, termios.TCSADRAIN, attrs)
+
+    def write(self, data):
+        while data:
+            data = data[os.write(self.fd, data):]
+
+    def enter(self, baud):
+        """Switch the CLI to the binary protocol, at another baud rate if given."""
+        self.write(b"\rproto %s\r" % (str(baud).encode() if baud else b""))
+        deadline = time.monotonic() + 2
+        text = bytearray()
+        while b"EXIT" not in text and time.monotonic() < deadline:
+            ready, _, _ = select.select([self.fd], [], [], 0.1)
+            if ready:
+                text += os.read(self.fd, 256)
+        if b"EXIT" not in text:
+            raise SystemExit("No response of the CLI")
+        if baud:
+            time.sleep(0.05)
+            self.set_baud(baud)
+        termios.tcflush(self.fd, termios.TCIFLUSH)
+
+    def send(self, ftype, payload=b""):
+        fid = self.next_id
+        self.next_id = fid % 0xFFFF + 1
+        body = HEADER.pack(ftype, fid, len(payload)) + payload
+        self.write(bytes([SYNC]) + body + struct.pack("<H", crc16(body)))
+        return fid
+
+    def poll(self, timeout):
+        """Read what is available, wait up to timeout, and return the frames."""
+        ready, _, _ = select.select([self.fd], [], [], timeout)
+        if ready:
+            self.rx += os.read(self.fd, 4096)
+        frames = []
+        while True:
+            start = self.rx.find(SYNC)
+            if start < 0:
+                self.stray += len(self.rx)
+                self.rx.clear()
+                break
+            self.stray += start
+            del self.rx[:start]
+            if len(self.rx) < 6:
+                break
+            ftype, fid, length = HEADER.unpack_from(self.rx, 1)
+            if length > MAX_PAYLOAD:
+                self.stray += 1
+                del self.rx[0]
+                continue
+            end = 6 + length + 2
+            if len(self.rx) < end:
+                break
+            body = bytes(self.rx[1:6 + length])
+            if struct.unpack_from("<H", self.rx, 6 + length)[0] != crc16(body):
+                # Text of the gateway or a damaged frame, search the next sync
+                self.dropped += 1
+                del self.rx[0]
+                continue
+            del self.rx[:end]
+            if ftype == RX:
+                self.events.append(body[5:])
+            elif ftype == NOTICE:
+                self.notices.append(body[5:].decode(errors="replace"))
+            else:
+                frames.append((ftype, fid, body[5:]))
+        return frames
+
+    def request(self, ftype, payload=b"", timeout=1.0):
+        fid = self.send(ftype, payload)
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            for rtype, rid, data in self.poll(0.05):
+                if rid == fid:
+                    return rtype, data
+        raise SystemExit("No response to request %d" % fid)
+
+
+def record(args):
+    return RECORD.pack(type_value(args.type), args.bits, args.repeat, 
+                       int(args.code, 0), 0xFFFF, args.channel, 1 if args.force else 0)
+
+
+def nak_text(data):
+    idx = "" if data[1] == 0xFF else " (command %d)" % data[1]
+    return "NAK %d: %s%s" % (data[0], data[2:].decode(errors="replace"), idx)
+
+
+def print_events(link):
+    for text in link.notices:
+        print("Notice: %s" % text)
+    link.notices.clear()
+    for data in link.events:
+        ptype, bits, flags, code, stamp = EVENT.unpack(data)
+        print("%10u ms %s 0x%X %u bits%s" % (stamp, type_name(ptype), code, bits, 
+                                              " repeat" if flags & 1 else ""))
+    link.events.clear()
+
+
+def cmd_ping(link, args):
+    start = time.perf_counter()
+    rtype, data = link.request(PING, b"ping")
+    print("%s in %.3f ms" % ("ACK" if rtype == ACK else nak_text(data), 
+                             (time.perf_counter() - start) * 1000))
+
+
+def cmd_tx(link, args):
+    rtype, data = link.request(TX, record(args))
+    print("ACK, %u queued" % data[0] if rtype == ACK else nak_text(data))
+
+
+def cmd_status(link, args):
+    rtype, data = link.request(STATUS)
+    if rtype != ACK:
+        raise SystemExit(nak_text(data))
+    tx, rx, uptime, pending, frames, dropped = struct.unpack("<IIIHII", data)
+    print("TX %u, RX %u, up %.1f s, %u pending, %u frames received, %u dropped" % 
+          (tx, rx, uptime / 1000, pending, frames, dropped))
+
+
+def cmd_listen(link, args):
+    try:
+        while True:
+            link.poll(0.5)
+            print_events(link)
+    except KeyboardInterrupt:
+        pass
+
+
+def cmd_baud(link, args):
+    rtype, data = link.request(BAUD, struct.pack("<I", args.rate))
+    if rtype != ACK:
+        raise SystemExit(nak_text(data))
+    time.sleep(0.05)
+    link.set_baud(args.rate)
+    print("Switched to %u baud" % args.rate)
+
+
+def cmd_exit(link, args):
+    rtype, data = link.request(EXIT)
+    print("Back to the CLI at 115200 baud" if rtype == ACK else nak_text(data))
+
+
+def cmd_check(link, args):
+    """Provokes errors and a held key, only valid frames may come back."""
+    failed = []
+
+    unknown = RECORD.pack(TYPES["raw"], 0, 0, DB_REF | 0xFFFF, 0xFFFF, -1, 0)
+    rtype, data = link.request(TX, unknown)
+    if rtype != NAK:
+        failed.append("unknown database code was queued")
+    print("Unknown database code: %s" % (nak_text(data) if rtype == NAK else "ACK"))
+
+    args.repeat = 15
+    rtype, data = link.request(TX, record(args))
+    if rtype != ACK:
+        failed.append("held key was not queued: " + nak_text(data))
+    print("Held key, %s 15 repeats: %s" % (args.code, "ACK" if rtype == ACK else 
+                                             nak_text(data)))
+
+    if args.hold > 0:
+        print("Hold a key of a remote pointed at the gateway for %.1f s" % args.hold)
+    # Long enough for the release of the held key, IRRX_HOLD_TIMEOUT is 250 ms
+    deadline = time.monotonic() + args.hold + 1.0
+    while time.monotonic() < deadline:
+        link.poll(0.1)
+    repeats = sum(1 for data in link.events if EVENT.unpack(data)[2] & 1)
+    if args.hold > 0 and repeats == 0:
+        failed.append("no repeat frames received, the release was not covered")
+    print("%u RX frames, %u repeats, %u notices" % (len(link.events), repeats, 
+                                                     len(link.notices)))
+    print_events(link)
+
+    rtype, data = link.request(PING, b"check")
+    if rtype != ACK or data != b"check":
+        failed.append("PING was not echoed")
+    if link.dropped or link.stray:
+        failed.append("%u damaged frames, %u bytes outside of frames" % (link.dropped, 
+                                                                         link.stray))
+    if failed:
+        raise SystemExit("Check failed: " + "; ".join(failed))
+    print("Check passed, only valid frames received")
+
+
+def cmd_bench(link, args):
+    """Keeps window requests in flight until count have been acknowledged."""
+    payload = b"x" * 16 if args.ping else record(args)
+    ftype = PING if args.ping else TX
+    pending = {}
+    rtts = []
+    busy = lost = 0
+    sent = 0
+    start = time.perf_counter()
+
+    while len(rtts) < args.count:
+        while len(pending) < args.window and sent < args.count:
+            pending[link.send(ftype, payload)] = time.perf_counter()
+            sent += 1
+        now = time.perf_counter()
+        for rtype, fid, data in link.poll(0.2):
+            if fid not in pending:
+                continue
+            sent_at = pending.pop(fid)
+            if rtype == NAK and data[0] == ERR_BUSY:
+                busy += 1
+                sent -= 1
+            elif rtype == NAK:
+                raise SystemExit(nak_text(data))
+            else:
+                rtts.append(time.perf_counter() - sent_at)
+        for fid, sent_at in list(pending.items()):
+            if now - sent_at > 1.0:
+                del pending[fid]
+                lost += 1
+                sent -= 1
+    elapsed = time.perf_counter() - start
+
+    rtts.sort()
+    print("%u %s in %.2f s: %.0f commands/s" % (len(rtts), "pings" if args.ping else 
+          "commands", elapsed, len(rtts) / elapsed))
+    print("RTT ms: min %.3f, avg %.3f, p50 %.3f, p99 %.3f, max %.3f" % (
+          rtts[0] * 1000, sum(rtts) / len(rtts) * 1000, rtts[len(rtts) // 2] * 1000,
+          rtts[min(len(rtts) - 1, len(rtts) * 99 // 100)] * 1000, rtts[-1] * 1000))
+    print("Busy %u, lost %u, damaged frames %u, events %u" % (busy, lost, link.dropped, 
+          len(link.events)))
+    link.events.clear()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("port", help="serial device or pseudo terminal")
+    parser.add_argument("--baud", type=int, default=115200, help="current baud rate")
+    parser.add_argument("--enter", type=int, nargs="?", const=0, metavar="BAUD",
+                        help="switch the CLI to the binary protocol first")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    sub.add_parser("ping").set_defaults(func=cmd_ping)
+    sub.add_parser("status").set_defaults(func=cmd_status)
+    sub.add_parser("listen").set_defaults(func=cmd_listen)
+    sub.add_parser("exit").set_defaults(func=cmd_exit)
+    p = sub.add_parser("baud")
+    p.add_argument("rate", type=int)
+    p.set_defaults(func=cmd_baud)
+    for name, func in (("tx", cmd_tx), ("check", cmd_check), ("bench", cmd_bench)):
+        p = sub.add_parser(name)
+        p.add_argument("type", nargs=None if name == "tx" else "?", default="nec")
+        p.add_argument("code", nargs=None if name == "tx" else "?", default="0x20DF10EF")
+        p.add_argument("--bits", type=int, default=0)
+        p.add_argument("--repeat", type=int, default=0)
+        p.add_argument("--channel", type=int, default=-1)
+        p.add_argument("--force", action="store_true")
+        p.set_defaults(func=func)
+        if name == "check":
+            p.add_argument("--hold", type=float, default=0, 
+                           help="seconds to hold a remote key, 0 to skip")
+    p.add_argument("--count", type=int, default=1000)
+    p.add_argument("--window", type=int, default=4, help="requests in flight")
+    p.add_argument("--ping", action="store_true", help="send PING instead of TX")
+
+    args = parser.parse_args()
+    link = Link(args.port, args.baud)
+    if args.enter is not None:
+        link.enter(args.enter)
+    args.func(link, args)
+    print_events(link)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,262 @@
+#
+# ir-gateway, build to automate ir remote control commands in smart homes.
+#
+# Copyright (C) 2026 Julian Friedrich
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+# You can file issues at https://github.com/fjulian79/ir-gateway/issues
+
+"""
+Tests of the IR code database importer, run on the host:
+
+    python3 tools/test_irdb.py
+
+The sources in test/test_irdb/data are imported into the database embedded
+in test/test_irdb/irdb_fixture.h, which the C++ lookups of test_irdb run 
+against. After changing the sources or the format, regenerate it with:
+
+    python3 tools/test_irdb.py update
+"""
+
+import contextlib
+import io
+import os
+import struct
+import sys
+import tempfile
+import unittest
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+DATA_DIR = os.path.join(TOOLS_DIR, "..", "test", "test_irdb", "data")
+FIXTURE = os.path.join(TOOLS_DIR, "..", "test", "test_irdb", "irdb_fixture.h")
+
+sys.path.insert(0, TOOLS_DIR)
+import irdb  # noqa: E402
+
+
+def quiet(function, *args):
+    """Calls function with the warnings on stderr captured."""
+    err = io.StringIO()
+    with contextlib.redirect_stderr(err):
+        result = function(*args)
+    return result, err.getvalue()
+
+
+def nec_timings(code):
+    timings = [9000, 4500]
+    for pos in reversed(range(32)):
+        timings += [560, 1690 if code >> pos & 1 else 560]
+    return timings + [560, 40000]
+
+
+def fixture_database():
+    codes, _ = quiet(irdb.import_codes, [DATA_DIR])
+    return irdb.build(codes)
+
+
+def fixture_header(data):
+    lines = [
+        "/* Generated by tools/test_irdb.py from test/test_irdb/data, do not edit. */",
+        "",
+        "#pragma once",
+        "",
+        "#include <stdint.h>",
+        "",
+        "/* %u bytes */" % len(data),
+        "alignas(8) static const uint8_t irdbFixture[] = {",
+    ]
+    for pos in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[pos:pos + 16]) + ",")
+    lines.append("};")
+    lines.append("")
+    return "\n".join(lines)
+
+
+class TestNames(unittest.TestCase):
+
+    def test_fnv1a(self):
+        self.assertEqual(irdb.fnv1a(""), 2166136261)
+        self.assertEqual(irdb.fnv1a("a"), 0xE40C292C)
+        self.assertEqual(irdb.fnv1a("LG_TV/OK"), irdb.fnv1a("lg_tv/ok"))
+
+    def test_clean_name(self):
+        self.assertEqual(irdb.clean_name(" Power On "), "Power_On")
+        self.assertEqual(irdb.clean_name("a/b:c,d@e"), "a_b_c_d_e")
+        self.assertEqual(irdb.clean_name("Lautstärke"), "Lautst_rke")
+
+
+class TestClassify(unittest.TestCase):
+
+    def test_nec(self):
+        self.assertEqual(irdb.classify(nec_timings(0x20DF10EF)), (irdb.NEC, 32, 0x20DF10EF))
+
+    def test_tolerance(self):
+        timings = [t * 1.2 for t in nec_timings(0x20DF10EF)]
+        self.assertEqual(irdb.classify(timings), (irdb.NEC, 32, 0x20DF10EF))
+        timings = [t * 1.3 for t in nec_timings(0x20DF10EF)]
+        self.assertIsNone(irdb.classify(timings))
+
+    def test_sony(self):
+        timings = [2400, 600]
+        for pos in reversed(range(12)):
+            timings += [1200 if 0xA90 >> pos & 1 else 600, 600]
+        self.assertEqual(irdb.classify(timings), (irdb.SONY, 12, 0xA90))
+
+    def test_unknown(self):
+        self.assertIsNone(irdb.classify(nec_timings(0x20DF10EF)[:40]))
+        self.assertIsNone(irdb.classify([1000, 500, 1000, 500]))
+
+    def test_raw(self):
+        code = irdb.make_code("dev", "fn", [1000.4, 500, 1000], 36)
+        self.assertEqual(code["type"], irdb.RAW)
+        self.assertEqual(code["timings"], [1000, 500, 1000, irdb.DEFAULT_GAP])
+        self.assertEqual(code["bits"], 4)
+        code, err = quiet(irdb.make_code, "dev", "fn", [1000] * (irdb.MAX_TIMINGS + 1))
+        self.assertIsNone(code)
+        self.assertIn("at most", err)
+
+
+class TestParsers(unittest.TestCase):
+
+    def codes(self, parser, name):
+        codes, err = quiet(lambda: list(parser(os.path.join(DATA_DIR, name))))
+        return {"%s/%s" % (c["device"], c["function"]): c for c in codes if c}, err
+
+    def test_lirc(self):
+        codes, err = self.codes(irdb.parse_lirc, "remotes.conf")
+        self.assertEqual(codes["LG_AKB/KEY_POWER"]["code"], 0x20DF10EF)
+        self.assertEqual(codes["LG_AKB/KEY_POWER"]["type"], irdb.NEC)
+        self.assertEqual(codes["sony_tv/KEY_POWER"]["code"], 0xA90)
+        self.assertEqual(codes["philips/KEY_POWER"]["type"], irdb.RC5)
+        self.assertEqual(codes["philips/KEY_POWER"]["code"], 0xC)
+        self.assertNotIn("philips/KEY_X", codes)
+        self.assertIn("RC5X", err)
+
+        # 48 bits are no known protocol, the frame is kept as timings
+        panasonic = codes["panasonic/KEY_POWER"]
+        self.assertEqual(panasonic["type"], irdb.RAW)
+        self.assertEqual(panasonic["khz"], 37)
+        self.assertEqual(panasonic["timings"][:2], [3500, 1750])
+        # Timings are stored as 16 bit, the gap of 75ms is clamped
+        self.assertEqual(panasonic["timings"][-2:], [435, 0xFFFF])
+        self.assertEqual(len(panasonic["timings"]), 2 + 48 * 2 + 2)
+        self.assertEqual(codes["rawremote/KEY_A"]["timings"], [1000, 500, 1000, 500, 2000, 40000])
+
+    def test_pronto(self):
+        codes, err = self.codes(irdb.parse_pronto, "beamer.txt")
+        self.assertEqual(codes["Epson_Beamer/Power_On"]["type"], irdb.NEC)
+        self.assertEqual(codes["Epson_Beamer/Weird"]["type"], irdb.RAW)
+        self.assertEqual(codes["Epson_Beamer/Weird"]["khz"], 36)
+        self.assertNotIn("Epson_Beamer/Preset", codes)
+        self.assertIn("0000", err)
+
+    def test_irdb_csv(self):
+        codes, err = self.codes(irdb.parse_irdb, "LG_TV.csv")
+        self.assertEqual(len(codes), 8)
+        self.assertEqual(codes["LG_TV/Power_Toggle"]["code"], 0x20DF10EF)
+        self.assertEqual(codes["LG_TV/OK"]["code"], 0x20DF22DD)
+        self.assertEqual(err, "")
+
+    def test_irdb_protocols(self):
+        self.assertEqual(irdb.irdb_code("NECx2", 7, 7, 2), (irdb.SAMSUNG, 32, 0xE0E040BF))
+        self.assertEqual(irdb.irdb_code("Sony12", 1, -1, 21), (irdb.SONY, 12, 0xA90))
+        self.assertEqual(irdb.irdb_code("RC5", 0, -1, 12), (irdb.RC5, 12, 0xC))
+        self.assertIsNone(irdb.irdb_code("RC6", 0, -1, 12))
+
+    def test_duplicates(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            for name, content in (("a.csv", "Power,NEC1,4,-1,8\n"), 
+                                  ("b.csv", "power,NEC1,4,-1,9\n" + "x" * 70 + ",NEC1,4,-1,1\n")):
+                with open(os.path.join(tmp, name), "w") as f:
+                    f.write("functionname,protocol,device,subdevice,function\n" + content)
+            os.rename(os.path.join(tmp, "b.csv"), os.path.join(tmp, "A.csv"))
+            codes, err = quiet(irdb.import_codes, [tmp])
+
+        # The device is matched ignoring the case, the first name wins
+        self.assertEqual(len(codes), 1)
+        self.assertEqual(codes[0]["code"], irdb.irdb_code("NEC1", 4, -1, 9)[2])
+        self.assertIn("duplicate", err)
+        self.assertIn("longer", err)
+
+
+class TestDatabase(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(cls):
+        cls.codes, _ = quiet(irdb.import_codes, [DATA_DIR])
+        cls.data = irdb.build(cls.codes)
+        cls.db = irdb.Database(cls.data)
+
+    def test_header(self):
+        header = irdb.HEADER.unpack_from(self.data)
+        self.assertEqual(header[0], irdb.MAGIC)
+        self.assertEqual(header[3], len(self.data))
+        self.assertEqual(self.db.count, len(self.codes))
+        for offset in header[6:10]:
+            self.assertEqual(offset % 8, 0)
+
+    def test_lookups(self):
+        for code in self.codes:
+            name = "%s/%s" % (code["device"], code["function"])
+            entry = self.db.find(name.upper())
+            self.assertIsNotNone(entry, name)
+            self.assertEqual(self.db.name(entry), (code["device"], code["function"]))
+            self.assertIs(self.db.find_ref(name), entry)
+            found = self.db.find_code(code["type"], entry[0])
+            self.assertEqual((found[3], found[0]), (code["type"], entry[0]))
+        self.assertIsNone(self.db.find("LG_TV/Power"))
+        self.assertIsNone(self.db.find("LG_TV"))
+        self.assertIsNone(self.db.find_code(irdb.NEC, 0x20DF10EE))
+
+    def test_raw_timings(self):
+        entry = self.db.find("panasonic/KEY_POWER")
+        timings = struct.unpack_from("<%uH" % entry[4], self.data, 
+                                     self.db.timings + entry[0] * 2)
+        self.assertEqual(list(timings), [c for c in self.codes 
+                                         if c["device"] == "panasonic"][0]["timings"])
+
+    def test_reproducible(self):
+        self.assertEqual(irdb.build(list(reversed(self.codes))), self.data)
+
+    def test_corrupt(self):
+        data = bytearray(self.data)
+        data[len(data) // 2] ^= 1
+        with self.assertRaises(SystemExit):
+            irdb.Database(bytes(data))
+        with self.assertRaises(SystemExit):
+            irdb.Database(self.data[:-1])
+
+    def test_hash_collision(self):
+        fnv1a = irdb.fnv1a
+        irdb.fnv1a = lambda name: 1
+        try:
+            with self.assertRaises(SystemExit):
+                irdb.build(self.codes)
+        finally:
+            irdb.fnv1a = fnv1a
+
+    def test_fixture(self):
+        with open(FIXTURE) as f:
+            self.assertEqual(f.read(), fixture_header(self.data), 
+                             "run python3 tools/test_irdb.py update")
+
+
+if __name__ == "__main__":
+    if sys.argv[1:] == ["update"]:
+        with open(FIXTURE, "w") as f:
+            f.write(fixture_header(fixture_database()))
+        print("IR DB: %s updated" % os.path.relpath(FIXTURE))
+    else:
+        unittest.main()
@@ -0,0 +1,133 @@
+#
+# ir-gateway, build to automate ir remote control commands in smart homes.
+#
+# Copyright (C) 2026 Julian Friedrich
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+# You can file issues at https://github.com/fjulian79/ir-gateway/issues
+
+"""
+Tests of the binary protocol client, run on the host:
+
+    python3 tools/test_irproto.py
+
+A scripted gateway answers on a pseudo terminal. It replies to the check
+like the firmware does, optionally with console text or a damaged frame in
+between, which the check has to report.
+"""
+
+import contextlib
+import io
+import os
+import pty
+import select
+import struct
+import sys
+import threading
+import tty
+import types
+import unittest
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+
+sys.path.insert(0, TOOLS_DIR)
+import irproto  # noqa: E402
+
+
+def frame(ftype, fid, payload=b""):
+    body = irproto.HEADER.pack(ftype, fid, len(payload)) + payload
+    return bytes([irproto.SYNC]) + body + struct.pack("<H", irproto.crc16(body))
+
+
+class Gateway(threading.Thread):
+    """Answers requests on the master side of a pseudo terminal."""
+
+    def __init__(self, master, noise=b""):
+        super().__init__(daemon=True)
+        self.master = master
+        self.noise = noise
+        self.running = True
+
+    def run(self):
+        rx = bytearray()
+        while self.running:
+            ready, _, _ = select.select([self.master], [], [], 0.05)
+            if not ready:
+                continue
+            rx += os.read(self.master, 4096)
+            while len(rx) >= 8:
+                del rx[:max(rx.find(irproto.SYNC), 0)]
+                ftype, fid, length = irproto.HEADER.unpack_from(rx, 1)
+                if len(rx) < 8 + length:
+                    break
+                payload = bytes(rx[6:6 + length])
+                del rx[:8 + length]
+                self.answer(ftype, fid, payload)
+
+    def answer(self, ftype, fid, payload):
+        if ftype == irproto.PING:
+            os.write(self.master, frame(irproto.ACK, fid, payload))
+        elif irproto.RECORD.unpack(payload)[3] & irproto.DB_REF:
+            os.write(self.master, frame(irproto.NAK, fid, b"\x02\x00Unknown learned code"))
+        else:
+            os.write(self.master, frame(irproto.ACK, fid, b"\x01"))
+            os.write(self.master, frame(irproto.NOTICE, 0, b"IR TX: RAW not supported"))
+            for i in range(3):
+                event = irproto.EVENT.pack(3, 32, 1 if i else 0, 0x20DF10EF, i * 110)
+                os.write(self.master, frame(irproto.RX, 0, event))
+            os.write(self.master, self.noise)
+
+
+class CheckTest(unittest.TestCase):
+
+    def check(self, noise=b""):
+        master, slave = pty.openpty()
+        tty.setraw(master)
+        gateway = Gateway(master, noise)
+        gateway.start()
+        link = irproto.Link(os.ttyname(slave), 115200)
+        args = types.SimpleNamespace(type="nec", code="0x20DF10EF", bits=0, repeat=0,
+                                     channel=-1, force=False, hold=0.2)
+        try:
+            with contextlib.redirect_stdout(io.StringIO()) as out:
+                irproto.cmd_check(link, args)
+            return out.getvalue()
+        finally:
+            gateway.running = False
+            gateway.join()
+            os.close(link.fd)
+            os.close(slave)
+            os.close(master)
+
+    def test_valid_frames(self):
+        out = self.check()
+        self.assertIn("3 RX frames, 2 repeats, 1 notices", out)
+        self.assertIn("Notice: IR TX: RAW not supported", out)
+        self.assertIn("Check passed", out)
+
+    def test_console_text(self):
+        text = b"IR RX: released after 220ms, 2 repeats\n"
+        with self.assertRaisesRegex(SystemExit, "%u bytes outside of frames" % len(text)):
+            self.check(text)
+
+    def test_damaged_frame(self):
+        damaged = bytearray(frame(irproto.RX, 0, irproto.EVENT.pack(3, 32, 1, 0, 0)))
+        damaged[-1] ^= 0xFF
+        with self.assertRaisesRegex(SystemExit, "damaged frames"):
+            self.check(bytes(damaged))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,127 @@
+#
+# ir-gateway, build to automate ir remote control commands in smart homes.
+#
+# Copyright (C) 2026 Julian Friedrich
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+# You can file issues at https://github.com/fjulian79/ir-gateway/issues
+#
+
+"""
+Compresses the web UI in web/ into lib/webui/webassets.h.
+
+Every asset is gzipped and embedded as a const array, hence it is served 
+directly from flash. The ETag is taken from the hash of the compressed data.
+References like {{app.js}} in the HTML are replaced by app.js?v=<etag>, so 
+all assets but the HTML can be cached forever. Runs as PlatformIO pre script
+or standalone.
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+MIME_TYPES = {
+    ".html": "text/html",
+    ".js": "application/javascript",
+    ".css": "text/css",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+}
+
+
+def compress(data):
+    # A fixed mtime keeps the output and the ETag reproducible
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def etag_of(data):
+    return hashlib.sha1(data).hexdigest()[:16]
+
+
+def generate(project_dir):
+    web_dir = os.path.join(project_dir, "web")
+    out_file = os.path.join(project_dir, "lib", "webui", "webassets.h")
+    names = sorted(n for n in os.listdir(web_dir)
+                   if os.path.splitext(n)[1] in MIME_TYPES)
+    assets = []
+    versions = {}
+
+    # The HTML refers to the versions of the others, hence it comes last
+    for name in sorted(names, key=lambda n: n.endswith(".html")):
+        with open(os.path.join(web_dir, name), "rb") as f:
+            raw = f.read()
+
+        if name.endswith(".html"):
+            raw = re.sub(rb"\{\{([^}]+)\}\}", 
+                         lambda m: versions[m.group(1).decode()].encode(), raw)
+
+        gz = compress(raw)
+        etag = etag_of(gz)
+        versions[name] = "%s?v=%s" % (name, etag)
+        path = "/" if name == "index.html" else "/" + name
+        assets.append((path, MIME_TYPES[os.path.splitext(name)[1]], 
+                       not name.endswith(".html"), raw, gz, etag))
+
+    lines = [
+        "/* Generated by tools/webassets.py from web/, do not edit. */",
+        "",
+        "#pragma once",
+        "",
+        "#include \"webui.hpp\"",
+        "",
+    ]
+
+    for i, (path, mime, immutable, raw, gz, etag) in enumerate(assets):
+        lines.append("/* %s: %u bytes, %u gzipped */" % (path, len(raw), len(gz)))
+        lines.append("static const uint8_t webAsset%u[] PROGMEM = {" % i)
+        for pos in range(0, len(gz), 16):
+            lines.append("    " + ", ".join("0x%02x" % b for b in gz[pos:pos + 16]) + ",")
+        lines.append("};")
+        lines.append("")
+
+    lines.append("static const WebAsset_t webAssets[] = {")
+    for i, (path, mime, immutable, raw, gz, etag) in enumerate(assets):
+        lines.append("    {\"%s\", \"%s\", webAsset%u, %u, %u, \"\\\"%s\\\"\", %s}," % (
+            path, mime, i, len(gz), len(raw), etag, "true" if immutable else "false"))
+    lines.append("};")
+    lines.append("")
+
+    content = "\n".join(lines)
+    old = None
+    if os.path.exists(out_file):
+        with open(out_file) as f:
+            old = f.read()
+
+    # Unchanged output keeps the timestamp, nothing is rebuilt
+    if content != old:
+        with open(out_file, "w") as f:
+            f.write(content)
+
+    total_raw = sum(len(a[3]) for a in assets)
+    total_gz = sum(len(a[4]) for a in assets)
+    print("Web UI: %u assets, %u bytes, %u gzipped" % (len(assets), total_raw, total_gz))
+
+
+try:
+    Import("env")  # noqa: F821
+except NameError:
+    env = None
+
+if env is not None:
+    generate(env["PROJECT_DIR"])
+else:
+    generate(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
@@ -0,0 +1,126 @@
+'use strict';
+
+const $ = (id) => document.getElementById(id);
+const history = [];
+const HISTORY = 120;
+
+async function getJson(url) {
+  const res = await fetch(url, { cache: 'no-store' });
+  if (!res.ok) {
+    throw new Error(url + ': ' + res.status);
+  }
+  return res.json();
+}
+
+function send(params) {
+  const query = new URLSearchParams(params).toString();
+  $('result').textContent = '...';
+  fetch('/tx?' + query)
+    .then((res) => res.text())
+    .then((text) => { $('result').textContent = text.trim(); })
+    .catch((err) => { $('result').textContent = err.message; });
+}
+
+function addButton(label, params, cls) {
+  const btn = document.createElement('button');
+  btn.textContent = label;
+  if (cls) {
+    btn.className = cls;
+  }
+  btn.onclick = () => send(params);
+  $('catalog').appendChild(btn);
+}
+
+async function loadCatalog() {
+  const data = await getJson('/api/catalog');
+  $('catalog').textContent = '';
+  for (const e of data.catalog) {
+    const params = { type: e.type, code: e.code };
+    if (e.channel >= 0) {
+      params.channel = e.channel;
+    }
+    addButton(e.name, params);
+  }
+  for (const e of data.learned) {
+    addButton(e.name, { type: 'raw', code: e.name }, 'raw');
+  }
+  if (!$('catalog').firstChild) {
+    $('catalog').textContent = 'No catalog entries, add them with the cat command.';
+  }
+}
+
+function draw() {
+  const canvas = $('graph');
+  const ctx = canvas.getContext('2d');
+  const series = [
+    { key: 'free', color: '#1e88e5' },
+    { key: 'largest', color: '#43a047' },
+    { key: 'loopMax', color: '#e53935' },
+  ];
+
+  ctx.clearRect(0, 0, canvas.width, canvas.height);
+  for (const s of series) {
+    const values = history.map((h) => h[s.key]);
+    const max = Math.max(1, ...values);
+    ctx.strokeStyle = s.color;
+    ctx.beginPath();
+    values.forEach((v, i) => {
+      const x = i * canvas.width / (HISTORY - 1);
+      const y = canvas.height - 4 - v / max * (canvas.height - 8);
+      if (i === 0) {
+        ctx.moveTo(x, y);
+      } else {
+        ctx.lineTo(x, y);
+      }
+    });
+    ctx.stroke();
+  }
+}
+
+async function loadStatus() {
+  const s = await getJson('/api/status');
+  $('host').textContent = s.hostname;
+  $('version').textContent = s.version;
+  $('uptime').textContent = s.uptime;
+  $('counts').textContent = s.tx + ' / ' + s.rx;
+  $('rssi').textContent = s.rssi + ' dBm';
+  $('heap').textContent = s.heap.free + ' (min ' + s.heap.minFree + ')';
+  $('largest').textContent = s.heap.largest + ' (' + s.heap.frag + '% frag)';
+  $('loop').textContent = (s.loopMax / 1000).toFixed(1) + ' ms';
+  history.push({ free: s.heap.free, largest: s.heap.largest, loopMax: s.loopMax });
+  if (history.length > HISTORY) {
+    history.shift();
+  }
+  draw();
+}
+
+async function loadLogs() {
+  const [tx, rx] = await Promise.all([getJson('/api/log?dir=tx'), getJson('/api/log?dir=rx')]);
+  $('txlog').textContent = tx.reverse().join('\n');
+  $('rxlog').textContent = rx.reverse().join('\n');
+}
+
+function showLoadTiming() {
+  const nav = performance.getEntriesByType('navigation')[0];
+  let bytes = nav ? nav.transferSize : 0;
+  for (const r of performance.getEntriesByType('resource')) {
+    if (!r.name.includes('/api/')) {
+      bytes += r.transferSize;
+    }
+  }
+  if (nav) {
+    $('load').textContent = 'UI load: ' + bytes + ' bytes transferred, TTFB ' + 
+      Math.round(nav.responseStart - nav.requestStart) + ' ms, loaded in ' + 
+      Math.round(nav.loadEventStart) + ' ms';
+  }
+}
+
+function poll(fn, ms) {
+  const run = () => fn().catch(() => {}).finally(() => setTimeout(run, ms));
+  run();
+}
+
+window.addEventListener('load', () => setTimeout(showLoadTiming, 0));
+loadCatalog().catch((err) => { $('catalog').textContent = err.message; });
+poll(loadStatus, 2000);
+poll(loadLogs, 5000);